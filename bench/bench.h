@@ -0,0 +1,50 @@
+#ifndef JSON_PARSER_BENCH_H
+#define JSON_PARSER_BENCH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+static inline uint64_t bench_now_ns() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ull + (uint64_t) ts.tv_nsec;
+}
+
+// run body iterations times and store the average duration of one iteration in ns_per_iter
+#define BENCH_RUN(ns_per_iter, iterations, body) { \
+	uint64_t _start = bench_now_ns(); \
+	for (uint64_t _iter = 0; _iter < (iterations); _iter++) { \
+		body; \
+	} \
+	ns_per_iter = (double) (bench_now_ns() - _start) / (double) (iterations); \
+}
+
+#define BENCH_REPORT(name, ns_per_iter, bytes_per_iter) \
+	printf("%-40s %12.1f ns/iter %10.1f MB/s\n", name, ns_per_iter, \
+		   (double) (bytes_per_iter) * 1e9 / (ns_per_iter) / (1024.0 * 1024.0))
+
+// read file into a heap buffer, return NULL if failed
+static inline char* bench_read_file(const char* file_path, size_t* p_size) {
+	FILE* file = fopen(file_path, "rb");
+	if (file == NULL) {
+		printf("Failed to open file: %s\n", file_path);
+		return NULL;
+	}
+	fseek(file, 0, SEEK_END);
+	*p_size = ftell(file);
+	rewind(file);
+	char* buffer = malloc(*p_size + 1);
+	if (buffer == NULL || fread(buffer, *p_size, 1, file) != 1) {
+		printf("Failed to read file: %s\n", file_path);
+		free(buffer);
+		fclose(file);
+		return NULL;
+	}
+	buffer[*p_size] = '\0';
+	fclose(file);
+	return buffer;
+}
+
+#endif //JSON_PARSER_BENCH_H
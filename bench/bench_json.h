@@ -0,0 +1,25 @@
+#ifndef JSON_PARSER_BENCH_JSON_H
+#define JSON_PARSER_BENCH_JSON_H
+
+int bench_json_validate();
+int bench_json_large_string();
+int bench_json_ndjson();
+int bench_json_parallel();
+int bench_json_batch();
+int bench_json_stringify();
+int bench_json_tape();
+int bench_json_inline();
+int bench_json_key_pool();
+int bench_json_packed();
+int bench_json_columns();
+int bench_json_path();
+int bench_json_select();
+int bench_json_index();
+int bench_json_decode();
+int bench_json_encode();
+int bench_json_schema();
+int bench_json_writer();
+int bench_json_deep();
+int bench_json_arrays();
+
+#endif //JSON_PARSER_BENCH_JSON_H
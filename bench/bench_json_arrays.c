@@ -0,0 +1,101 @@
+#include <string.h>
+#include "bench.h"
+#include "bench_json.h"
+#include "json.h"
+
+#define BENCH_ARRAYS_NUM_ARRAYS		8
+#define BENCH_ARRAYS_NUM_RECORDS	12000
+#define BENCH_ARRAYS_ITERATIONS		10
+
+// Pages of records as an API returns them, every record holds a nested object and an array of strings
+static size_t bench_arrays_write_records(char* buffer, size_t offset) {
+	size_t size = offset;
+	size += sprintf(&buffer[size], "[");
+	for (size_t i = 0; i < BENCH_ARRAYS_NUM_RECORDS; i++) {
+		size += sprintf(&buffer[size], "%s{\"id\": %lu, \"name\": \"item %lu\", \"price\": %lu.%02lu, \"active\": %s,"
+									   " \"owner\": {\"id\": %lu, \"login\": \"user%lu\"}, \"tags\": [\"t%lu\", \"t%lu\"],"
+									   " \"scores\": [%lu, %lu, %lu]}",
+						i > 0 ? ", " : "", i, i, i % 1000, i % 100, i % 3 == 0 ? "true" : "false", i % 97, i % 97,
+						i % 7, i % 11, i % 5, i % 13, i % 17);
+	}
+	size += sprintf(&buffer[size], "]");
+	return size - offset;
+}
+
+static char* bench_arrays_document(size_t* p_size) {
+	char* buffer = malloc(BENCH_ARRAYS_NUM_ARRAYS * BENCH_ARRAYS_NUM_RECORDS * 256 + 64);
+	if (buffer == NULL) {
+		return NULL;
+	}
+	size_t size = sprintf(buffer, "{");
+	for (size_t i = 0; i < BENCH_ARRAYS_NUM_ARRAYS; i++) {
+		size += sprintf(&buffer[size], "%s\"page %lu\": ", i > 0 ? ", " : "", i);
+		size += bench_arrays_write_records(buffer, size);
+	}
+	size += sprintf(&buffer[size], "}");
+	*p_size = size;
+	return buffer;
+}
+
+int bench_json_arrays() {
+	size_t size = 0;
+	char* buffer = bench_arrays_document(&size);
+	if (buffer == NULL) {
+		return 1;
+	}
+
+	double ns;
+	BENCH_RUN(ns, BENCH_ARRAYS_ITERATIONS, {
+		if (json_validate(buffer, size, NULL) != JSON_RETVAL_OK) {
+			printf("Validation failed\n");
+		}
+	});
+	BENCH_REPORT("arrays/validate", ns, size);
+
+	json_tape_t tape;
+	BENCH_RUN(ns, BENCH_ARRAYS_ITERATIONS, {
+		if (json_parse_tape(buffer, size, &tape, NULL) != JSON_RETVAL_OK) {
+			printf("Parsing failed\n");
+		}
+		json_tape_free(&tape);
+	});
+	BENCH_REPORT("arrays/tape and free", ns, size);
+
+	json_object_t object;
+	BENCH_RUN(ns, BENCH_ARRAYS_ITERATIONS, {
+		if (json_parse(buffer, size, &object) != JSON_RETVAL_OK) {
+			printf("Parsing failed\n");
+		}
+		json_object_free(&object);
+	});
+	BENCH_REPORT("arrays/parse and free", ns, size);
+
+	// Ranges of records are parsed by the tasks of the pool
+	json_pool_t* p_pool = json_pool_new(4);
+	if (p_pool != NULL) {
+		json_parallel_options_t options = {.p_pool = p_pool};
+		BENCH_RUN(ns, BENCH_ARRAYS_ITERATIONS, {
+			if (json_parse_parallel(buffer, size, &object, &options, NULL) != JSON_RETVAL_OK) {
+				printf("Parsing failed\n");
+			}
+			json_object_free(&object);
+		});
+		BENCH_REPORT("arrays/parallel, 4 threads, parse and free", ns, size);
+		json_pool_free(p_pool);
+	}
+
+	// A single page as the document itself
+	size_t page_size = bench_arrays_write_records(buffer, 0);
+	json_value_t value;
+	json_value_type_t type;
+	BENCH_RUN(ns, BENCH_ARRAYS_ITERATIONS * BENCH_ARRAYS_NUM_ARRAYS, {
+		if (json_parse_value(buffer, page_size, &value, &type, NULL) != JSON_RETVAL_OK) {
+			printf("Parsing failed\n");
+		}
+		json_value_free(&value, type);
+	});
+	BENCH_REPORT("arrays/top-level array, parse and free", ns, page_size);
+
+	free(buffer);
+	return 0;
+}
@@ -0,0 +1,81 @@
+#include <string.h>
+#include "bench.h"
+#include "bench_json.h"
+#include "json.h"
+
+#define BENCH_BATCH_NUM_INPUTS		512
+#define BENCH_BATCH_ITERATIONS		20
+
+static const uint32_t m_thread_counts[] = {1, 2, 4, 8};
+
+// Messages of 1 to 4 KB
+static char* bench_batch_message(size_t index) {
+	char* buffer = malloc(8 * 1024);
+	if (buffer == NULL) {
+		return NULL;
+	}
+	size_t size = sprintf(buffer, "{\"id\": %lu, \"user\": \"user-%lu\", \"meta\": {\"ok\": true, \"region\": \"eu\"}, \"events\": [",
+						  index, index % 1000);
+	size_t target = 1024 + index * 37 % 3072;
+	for (size_t i = 0; size < target; i++) {
+		size += sprintf(&buffer[size], "%s\"event %lu\", %lu.25", i > 0 ? ", " : "", i, i * index % 10000);
+	}
+	sprintf(&buffer[size], "]}");
+	return buffer;
+}
+
+int bench_json_batch() {
+	json_input_t* inputs = malloc(BENCH_BATCH_NUM_INPUTS * sizeof(json_input_t));
+	json_document_t* outputs = malloc(BENCH_BATCH_NUM_INPUTS * sizeof(json_document_t));
+	if (inputs == NULL || outputs == NULL) {
+		free(inputs);
+		free(outputs);
+		return 1;
+	}
+	size_t size = 0;
+	for (size_t i = 0; i < BENCH_BATCH_NUM_INPUTS; i++) {
+		inputs[i].p_data = bench_batch_message(i);
+		inputs[i].size = inputs[i].p_data != NULL ? strlen(inputs[i].p_data) : 0;
+		size += inputs[i].size;
+	}
+
+	// All documents of a batch are alive at the same time, as they are for json_parse_batch
+	double ns;
+	BENCH_RUN(ns, BENCH_BATCH_ITERATIONS, {
+		for (size_t i = 0; i < BENCH_BATCH_NUM_INPUTS; i++) {
+			if (json_parse(inputs[i].p_data, inputs[i].size, &outputs[i].root) != JSON_RETVAL_OK) {
+				printf("Parsing failed\n");
+			}
+		}
+		for (size_t i = 0; i < BENCH_BATCH_NUM_INPUTS; i++) {
+			json_object_free(&outputs[i].root);
+		}
+	});
+	printf("batch/serial          %12.0f documents/s %10.1f MB/s\n", BENCH_BATCH_NUM_INPUTS * 1e9 / ns,
+		   (double) size * 1e9 / ns / (1024.0 * 1024.0));
+
+	for (size_t i = 0; i < sizeof(m_thread_counts) / sizeof(m_thread_counts[0]); i++) {
+		json_pool_t* pool = json_pool_new(m_thread_counts[i]);
+		if (pool == NULL) {
+			break;
+		}
+		BENCH_RUN(ns, BENCH_BATCH_ITERATIONS, {
+			if (json_parse_batch(inputs, BENCH_BATCH_NUM_INPUTS, outputs, NULL, pool) != JSON_RETVAL_OK) {
+				printf("Parsing failed\n");
+			}
+			for (size_t j = 0; j < BENCH_BATCH_NUM_INPUTS; j++) {
+				json_document_free(&outputs[j]);
+			}
+		});
+		printf("batch/threads=%-3u     %12.0f documents/s %10.1f MB/s\n", m_thread_counts[i],
+			   BENCH_BATCH_NUM_INPUTS * 1e9 / ns, (double) size * 1e9 / ns / (1024.0 * 1024.0));
+		json_pool_free(pool);
+	}
+
+	for (size_t i = 0; i < BENCH_BATCH_NUM_INPUTS; i++) {
+		free((char*) inputs[i].p_data);
+	}
+	free(inputs);
+	free(outputs);
+	return 0;
+}
@@ -0,0 +1,90 @@
+#include <string.h>
+#include "bench.h"
+#include "bench_json.h"
+#include "json.h"
+
+#define BENCH_COLUMNS_NUM_ROWS		100000
+#define BENCH_COLUMNS_ITERATIONS	10
+
+// Metrics payload, the tape needs an object around the rows
+static char* bench_columns_document(size_t* p_size) {
+	char* buffer = malloc(BENCH_COLUMNS_NUM_ROWS * 128 + 32);
+	if (buffer == NULL) {
+		return NULL;
+	}
+	size_t size = sprintf(buffer, "{\"rows\": [");
+	for (size_t i = 0; i < BENCH_COLUMNS_NUM_ROWS; i++) {
+		size += sprintf(&buffer[size], "%s{\"ts\": %lu, \"v\": %lu.%lu, \"host\": \"host-%lu\", \"tags\": {\"dc\": \"eu\"}}",
+						i > 0 ? ",\n" : "", 1700000000 + i, i % 1000, i % 7, i % 64);
+	}
+	size += sprintf(&buffer[size], "]}");
+	*p_size = size;
+	return buffer;
+}
+
+// Copies the fields of every row from the tape into column vectors
+static size_t bench_columns_from_tape(const json_tape_t* p_tape, int64_t* ts, double* v, uint64_t* host_offsets, char* hosts) {
+	json_tape_value_t rows = json_tape_object_get_value(json_tape_get_root(p_tape), "rows");
+	json_tape_iter_t iter = json_tape_iter_begin(rows);
+	json_tape_value_t row;
+	size_t num_rows = 0, hosts_length = 0;
+	while (json_tape_iter_next(&iter, &row, NULL)) {
+		ts[num_rows] = (int64_t) json_tape_value_get_number(json_tape_object_get_value(row, "ts"));
+		v[num_rows] = json_tape_value_get_number(json_tape_object_get_value(row, "v"));
+		size_t length = 0;
+		const char* host = json_tape_value_get_string(json_tape_object_get_value(row, "host"), &length);
+		host_offsets[num_rows] = hosts_length;
+		memcpy(&hosts[hosts_length], host, length);
+		hosts_length += length;
+		num_rows++;
+	}
+	host_offsets[num_rows] = hosts_length;
+	return num_rows;
+}
+
+int bench_json_columns() {
+	size_t size;
+	char* buffer = bench_columns_document(&size);
+	int64_t* ts = malloc(BENCH_COLUMNS_NUM_ROWS * sizeof(int64_t));
+	double* v = malloc(BENCH_COLUMNS_NUM_ROWS * sizeof(double));
+	uint64_t* host_offsets = malloc((BENCH_COLUMNS_NUM_ROWS + 1) * sizeof(uint64_t));
+	char* hosts = malloc(BENCH_COLUMNS_NUM_ROWS * 16);
+	if (buffer == NULL || ts == NULL || v == NULL || host_offsets == NULL || hosts == NULL) {
+		return 1;
+	}
+
+	double ns;
+	size_t num_rows = 0;
+	BENCH_RUN(ns, BENCH_COLUMNS_ITERATIONS, {
+		json_tape_t tape;
+		if (json_parse_tape(buffer, size, &tape, NULL) != JSON_RETVAL_OK) {
+			printf("Parsing failed\n");
+		}
+		num_rows = bench_columns_from_tape(&tape, ts, v, host_offsets, hosts);
+		json_tape_free(&tape);
+	});
+	BENCH_REPORT("columns/tape and copy", ns, size);
+
+	json_column_t columns[] = {
+		{.path = "ts", .type = JSON_COLUMN_TYPE_INT64},
+		{.path = "v", .type = JSON_COLUMN_TYPE_NUMBER},
+		{.path = "host", .type = JSON_COLUMN_TYPE_STRING},
+	};
+	BENCH_RUN(ns, BENCH_COLUMNS_ITERATIONS, {
+		if (json_extract_columns(buffer, size, "rows", columns, 3, &num_rows, NULL) != JSON_RETVAL_OK) {
+			printf("Extraction failed\n");
+		}
+		json_columns_free(columns, 3);
+	});
+	BENCH_REPORT("columns/extract", ns, size);
+	if (num_rows != BENCH_COLUMNS_NUM_ROWS) {
+		printf("Wrong number of rows: %lu\n", num_rows);
+	}
+
+	free(hosts);
+	free(host_offsets);
+	free(v);
+	free(ts);
+	free(buffer);
+	return 0;
+}
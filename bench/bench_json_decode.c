@@ -0,0 +1,88 @@
+#include <string.h>
+#include "bench.h"
+#include "bench_json.h"
+#include "json.h"
+
+#define BENCH_DECODE_ITERATIONS		1000000
+
+typedef struct {
+	double bid;
+	double ask;
+} bench_decode_quote_t;
+
+typedef struct {
+	int64_t id;
+	int64_t timestamp;
+	char symbol[16];
+	char venue[16];
+	double price;
+	double quantity;
+	bool is_buy;
+	bench_decode_quote_t quote;
+} bench_decode_order_t;
+
+JSON_STRUCT_DESC(m_bench_decode_quote_desc,
+	JSON_STRUCT_FIELD(bench_decode_quote_t, bid, JSON_FIELD_TYPE_DOUBLE),
+	JSON_STRUCT_FIELD(bench_decode_quote_t, ask, JSON_FIELD_TYPE_DOUBLE),
+);
+
+JSON_STRUCT_DESC(m_bench_decode_order_desc,
+	JSON_STRUCT_FIELD(bench_decode_order_t, id, JSON_FIELD_TYPE_INT64),
+	JSON_STRUCT_FIELD(bench_decode_order_t, timestamp, JSON_FIELD_TYPE_INT64),
+	JSON_STRUCT_FIELD(bench_decode_order_t, symbol, JSON_FIELD_TYPE_STRING),
+	JSON_STRUCT_FIELD(bench_decode_order_t, venue, JSON_FIELD_TYPE_STRING),
+	JSON_STRUCT_FIELD(bench_decode_order_t, price, JSON_FIELD_TYPE_DOUBLE),
+	JSON_STRUCT_FIELD(bench_decode_order_t, quantity, JSON_FIELD_TYPE_DOUBLE),
+	JSON_STRUCT_FIELD_KEY(bench_decode_order_t, is_buy, "buy", JSON_FIELD_TYPE_BOOL),
+	JSON_STRUCT_FIELD_OBJECT(bench_decode_order_t, quote, &m_bench_decode_quote_desc),
+);
+
+static const char* m_bench_decode_message =
+		"{\"id\": 184467440737, \"timestamp\": 1760000000123, \"symbol\": \"ACME\", \"venue\": \"XNAS\", \"price\": 101.25,"
+		" \"quantity\": 300, \"buy\": true, \"quote\": {\"bid\": 101.2, \"ask\": 101.3}, \"source\": \"gateway-7\"}";
+
+static void bench_decode_copy_string(char* p_dest, size_t size, const json_value_t* p_value) {
+	strncpy(p_dest, p_value->string, size - 1);
+	p_dest[size - 1] = '\0';
+}
+
+int bench_json_decode() {
+	size_t size = strlen(m_bench_decode_message);
+	bench_decode_order_t order = {0};
+	double ns;
+	double sum = 0;
+
+	BENCH_RUN(ns, BENCH_DECODE_ITERATIONS, {
+		json_object_t object;
+		if (json_parse(m_bench_decode_message, size, &object) != JSON_RETVAL_OK) {
+			printf("Parsing failed\n");
+			break;
+		}
+		order.id = (int64_t) json_object_get_value(&object, "id")->number;
+		order.timestamp = (int64_t) json_object_get_value(&object, "timestamp")->number;
+		bench_decode_copy_string(order.symbol, sizeof(order.symbol), json_object_get_value(&object, "symbol"));
+		bench_decode_copy_string(order.venue, sizeof(order.venue), json_object_get_value(&object, "venue"));
+		order.price = json_object_get_value(&object, "price")->number;
+		order.quantity = json_object_get_value(&object, "quantity")->number;
+		order.is_buy = json_object_get_value(&object, "buy")->boolean;
+		json_object_t* p_quote = json_object_get_value(&object, "quote")->object;
+		order.quote.bid = json_object_get_value(p_quote, "bid")->number;
+		order.quote.ask = json_object_get_value(p_quote, "ask")->number;
+		json_object_free(&object);
+		sum += order.price;
+	});
+	BENCH_REPORT("decode/parse and copy", ns, size);
+
+	BENCH_RUN(ns, BENCH_DECODE_ITERATIONS, {
+		if (json_decode_struct(m_bench_decode_message, size, &m_bench_decode_order_desc, &order, NULL) != JSON_RETVAL_OK) {
+			printf("Decoding failed\n");
+			break;
+		}
+		sum += order.price;
+	});
+	BENCH_REPORT("decode/struct", ns, size);
+	if (sum == 0) {
+		printf("Decoding failed\n");
+	}
+	return 0;
+}
@@ -0,0 +1,108 @@
+#include <string.h>
+#include "bench.h"
+#include "bench_json.h"
+#include "json.h"
+
+#define BENCH_DEEP_NESTING_LEVEL	100000
+#define BENCH_DEEP_ITERATIONS		20
+
+// Containers of a single entry, objects and arrays alternate: {"a":[{"a":[ ... {"leaf":true} ... ]}]}
+static bool bench_deep_build(json_object_t* p_root) {
+	*p_root = (json_object_t) {0};
+	json_object_t* p_inner = p_root;
+	for (uint32_t i = 0; i < BENCH_DEEP_NESTING_LEVEL / 2; i++) {
+		json_object_t* p_child = calloc(1, sizeof(json_object_t));
+		json_array_t* p_array = calloc(1, sizeof(json_array_t));
+		json_array_member_t* values = malloc(sizeof(json_array_member_t));
+		if (p_child == NULL || p_array == NULL || values == NULL ||
+			json_object_add_value(p_inner, "a", (json_value_t) {.array = p_array}, JSON_VALUE_TYPE_ARRAY) != JSON_RETVAL_OK) {
+			free(p_child);
+			free(p_array);
+			free(values);
+			return false;
+		}
+		values[0] = (json_array_member_t) {.value.object = p_child, .type = JSON_VALUE_TYPE_OBJECT};
+		*p_array = (json_array_t) {.values = values, .length = 1, .max_length = 1};
+		p_inner = p_child;
+	}
+	return json_object_add_value(p_inner, "leaf", (json_value_t) {.boolean = true}, JSON_VALUE_TYPE_BOOLEAN) == JSON_RETVAL_OK;
+}
+
+// The same number of containers side by side, as a reference for the cost per container
+static bool bench_deep_build_flat(json_object_t* p_root) {
+	*p_root = (json_object_t) {0};
+	json_array_t* p_array = calloc(1, sizeof(json_array_t));
+	json_array_member_t* values = malloc(BENCH_DEEP_NESTING_LEVEL / 2 * sizeof(json_array_member_t));
+	if (p_array == NULL || values == NULL ||
+		json_object_add_value(p_root, "a", (json_value_t) {.array = p_array}, JSON_VALUE_TYPE_ARRAY) != JSON_RETVAL_OK) {
+		free(p_array);
+		free(values);
+		return false;
+	}
+	*p_array = (json_array_t) {.values = values, .max_length = BENCH_DEEP_NESTING_LEVEL / 2};
+	for (uint32_t i = 0; i < BENCH_DEEP_NESTING_LEVEL / 2; i++) {
+		json_object_t* p_child = calloc(1, sizeof(json_object_t));
+		if (p_child == NULL) {
+			return false;
+		}
+		values[p_array->length++] = (json_array_member_t) {.value.object = p_child, .type = JSON_VALUE_TYPE_OBJECT};
+		if (json_object_add_value(p_child, "a", (json_value_t) {.boolean = true}, JSON_VALUE_TYPE_BOOLEAN) != JSON_RETVAL_OK) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static void bench_deep_run(const char* name, const json_object_t* p_object) {
+	char label[64];
+	double ns;
+	size_t length = 0;
+
+	BENCH_RUN(ns, BENCH_DEEP_ITERATIONS, {
+		char* string = json_stringify(p_object);
+		length = string != NULL ? strlen(string) : 0;
+		free(string);
+	});
+	snprintf(label, sizeof(label), "deep/%s, stringify", name);
+	BENCH_REPORT(label, ns, length);
+
+	// Copies are timed apart from freeing them
+	uint64_t copy_ns = 0;
+	uint64_t free_ns = 0;
+	for (int i = 0; i < BENCH_DEEP_ITERATIONS; i++) {
+		json_object_t copy;
+		uint64_t start = bench_now_ns();
+		if (json_object_copy(p_object, &copy) != JSON_RETVAL_OK) {
+			printf("Copy failed\n");
+			return;
+		}
+		uint64_t copied = bench_now_ns();
+		json_object_free(&copy);
+		copy_ns += copied - start;
+		free_ns += bench_now_ns() - copied;
+	}
+	snprintf(label, sizeof(label), "deep/%s, copy", name);
+	BENCH_REPORT(label, (double) copy_ns / BENCH_DEEP_ITERATIONS, length);
+	snprintf(label, sizeof(label), "deep/%s, free", name);
+	BENCH_REPORT(label, (double) free_ns / BENCH_DEEP_ITERATIONS, length);
+}
+
+int bench_json_deep() {
+	json_object_t deep;
+	json_object_t flat;
+	bool is_built = bench_deep_build(&deep);
+	is_built = bench_deep_build_flat(&flat) && is_built;
+	if (!is_built) {
+		printf("Setup failed\n");
+		json_object_free(&deep);
+		json_object_free(&flat);
+		return 1;
+	}
+
+	bench_deep_run("100k levels", &deep);
+	bench_deep_run("100k siblings", &flat);
+
+	json_object_free(&deep);
+	json_object_free(&flat);
+	return 0;
+}
@@ -0,0 +1,94 @@
+#include <string.h>
+#include "bench.h"
+#include "bench_json.h"
+#include "json.h"
+
+#define BENCH_ENCODE_ITERATIONS		1000000
+
+typedef struct {
+	char city[24];
+	char country[4];
+} bench_encode_address_t;
+
+typedef struct {
+	int64_t id;
+	int32_t status;
+	char user[24];
+	char email[32];
+	double balance;
+	double score;
+	bool is_verified;
+	bench_encode_address_t address;
+} bench_encode_response_t;
+
+JSON_STRUCT_DESC(m_bench_encode_address_desc,
+	JSON_STRUCT_FIELD(bench_encode_address_t, city, JSON_FIELD_TYPE_STRING),
+	JSON_STRUCT_FIELD(bench_encode_address_t, country, JSON_FIELD_TYPE_STRING),
+);
+
+JSON_STRUCT_DESC(m_bench_encode_response_desc,
+	JSON_STRUCT_FIELD(bench_encode_response_t, id, JSON_FIELD_TYPE_INT64),
+	JSON_STRUCT_FIELD(bench_encode_response_t, status, JSON_FIELD_TYPE_INT32),
+	JSON_STRUCT_FIELD(bench_encode_response_t, user, JSON_FIELD_TYPE_STRING),
+	JSON_STRUCT_FIELD(bench_encode_response_t, email, JSON_FIELD_TYPE_STRING),
+	JSON_STRUCT_FIELD(bench_encode_response_t, balance, JSON_FIELD_TYPE_DOUBLE),
+	JSON_STRUCT_FIELD(bench_encode_response_t, score, JSON_FIELD_TYPE_DOUBLE),
+	JSON_STRUCT_FIELD_KEY(bench_encode_response_t, is_verified, "verified", JSON_FIELD_TYPE_BOOL),
+	JSON_STRUCT_FIELD_OBJECT(bench_encode_response_t, address, &m_bench_encode_address_desc),
+);
+
+typedef struct {
+	char buffer[1024];
+	size_t length;
+} bench_encode_output_t;
+
+static json_ret_code_t bench_encode_sink(const char* p_data, size_t length, void* p_context) {
+	bench_encode_output_t* p_output = p_context;
+	if (length > sizeof(p_output->buffer)) {
+		return JSON_RETVAL_FAIL;
+	}
+	memcpy(p_output->buffer, p_data, length);
+	p_output->length = length;
+	return JSON_RETVAL_OK;
+}
+
+int bench_json_encode() {
+	const bench_encode_response_t response = {
+		.id = 184467440737, .status = 200, .user = "jdoe", .email = "jdoe@example.com", .balance = 1024,
+		.score = 0.875, .is_verified = true, .address = {.city = "Berlin", .country = "DE"},
+	};
+	bench_encode_output_t output = {0};
+	double ns;
+	size_t total = 0;
+
+	BENCH_RUN(ns, BENCH_ENCODE_ITERATIONS, {
+		json_object_t object = {0};
+		json_object_t* p_address = calloc(1, sizeof(json_object_t));
+		json_object_add_value(p_address, "city", (json_value_t) {.string = strdup(response.address.city)}, JSON_VALUE_TYPE_STRING);
+		json_object_add_value(p_address, "country", (json_value_t) {.string = strdup(response.address.country)}, JSON_VALUE_TYPE_STRING);
+		json_object_add_value(&object, "id", (json_value_t) {.number = (double) response.id}, JSON_VALUE_TYPE_NUMBER);
+		json_object_add_value(&object, "status", (json_value_t) {.number = response.status}, JSON_VALUE_TYPE_NUMBER);
+		json_object_add_value(&object, "user", (json_value_t) {.string = strdup(response.user)}, JSON_VALUE_TYPE_STRING);
+		json_object_add_value(&object, "email", (json_value_t) {.string = strdup(response.email)}, JSON_VALUE_TYPE_STRING);
+		json_object_add_value(&object, "balance", (json_value_t) {.number = response.balance}, JSON_VALUE_TYPE_NUMBER);
+		json_object_add_value(&object, "score", (json_value_t) {.number = response.score}, JSON_VALUE_TYPE_NUMBER);
+		json_object_add_value(&object, "verified", (json_value_t) {.boolean = response.is_verified}, JSON_VALUE_TYPE_BOOLEAN);
+		json_object_add_value(&object, "address", (json_value_t) {.object = p_address}, JSON_VALUE_TYPE_OBJECT);
+		char* string = json_stringify(&object);
+		total += string != NULL ? strlen(string) : 0;
+		free(string);
+		json_object_free(&object);
+	});
+	BENCH_REPORT("encode/add values and stringify", ns, total / BENCH_ENCODE_ITERATIONS);
+
+	total = 0;
+	BENCH_RUN(ns, BENCH_ENCODE_ITERATIONS, {
+		if (json_encode_struct(&m_bench_encode_response_desc, &response, bench_encode_sink, &output) != JSON_RETVAL_OK) {
+			printf("Encoding failed\n");
+			break;
+		}
+		total += output.length;
+	});
+	BENCH_REPORT("encode/struct", ns, total / BENCH_ENCODE_ITERATIONS);
+	return 0;
+}
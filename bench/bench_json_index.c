@@ -0,0 +1,80 @@
+#include <string.h>
+#include "bench.h"
+#include "bench_json.h"
+#include "json.h"
+
+#define BENCH_INDEX_NUM_ROWS		20000
+#define BENCH_INDEX_NUM_LOOKUPS		1000
+
+// Configuration entries {"id": ..., "name": ..., "enabled": ...} in an array, built directly as the parser keeps arrays flat
+static json_array_t* bench_index_rows(void) {
+	json_array_t* p_array = calloc(1, sizeof(json_array_t));
+	json_array_member_t* values = calloc(BENCH_INDEX_NUM_ROWS, sizeof(json_array_member_t));
+	if (p_array == NULL || values == NULL) {
+		free(p_array);
+		free(values);
+		return NULL;
+	}
+	*p_array = (json_array_t) {.values = values, .length = BENCH_INDEX_NUM_ROWS, .max_length = BENCH_INDEX_NUM_ROWS};
+	char name[32];
+	for (size_t i = 0; i < BENCH_INDEX_NUM_ROWS; i++) {
+		json_object_t* p_row = calloc(1, sizeof(json_object_t));
+		values[i] = (json_array_member_t) {.value.object = p_row, .type = JSON_VALUE_TYPE_OBJECT};
+		if (p_row == NULL) {
+			continue;
+		}
+		sprintf(name, "service-%05lu", (i * 7919) % BENCH_INDEX_NUM_ROWS);
+		json_object_add_value(p_row, "enabled", (json_value_t) {.boolean = true}, JSON_VALUE_TYPE_BOOLEAN);
+		json_object_add_value(p_row, "name", (json_value_t) {.string = strdup(name)}, JSON_VALUE_TYPE_STRING);
+		json_object_add_value(p_row, "id", (json_value_t) {.number = (double) i}, JSON_VALUE_TYPE_NUMBER);
+	}
+	return p_array;
+}
+
+int bench_json_index() {
+	json_object_t root = {0};
+	json_array_t* p_array = bench_index_rows();
+	if (p_array == NULL) {
+		return 1;
+	}
+	json_object_add_value(&root, "services", (json_value_t) {.array = p_array}, JSON_VALUE_TYPE_ARRAY);
+	json_value_t* p_services = json_object_get_value(&root, "services");
+
+	char names[BENCH_INDEX_NUM_LOOKUPS][32];
+	for (size_t i = 0; i < BENCH_INDEX_NUM_LOOKUPS; i++) {
+		sprintf(names[i], "service-%05lu", (i * 104729) % BENCH_INDEX_NUM_ROWS);
+	}
+
+	double ns;
+	size_t found = 0;
+	BENCH_RUN(ns, BENCH_INDEX_NUM_LOOKUPS, {
+		for (size_t i = 0; i < p_array->length; i++) {
+			json_value_t* p_name = json_object_get_value(p_array->values[i].value.object, "name");
+			if (strcmp(p_name->string, names[_iter]) == 0) {
+				found++;
+				break;
+			}
+		}
+	});
+	printf("%-40s %12.1f ns/lookup\n", "index/linear scan", ns);
+
+	const json_index_type_t types[] = {JSON_INDEX_TYPE_HASH, JSON_INDEX_TYPE_SORTED};
+	const char* labels[] = {"index/hash", "index/sorted"};
+	for (size_t t = 0; t < 2; t++) {
+		uint64_t start = bench_now_ns();
+		json_index_t* p_index = json_index_new(p_services, JSON_VALUE_TYPE_ARRAY, "name", types[t]);
+		double build_ms = (double) (bench_now_ns() - start) / 1e6;
+		BENCH_RUN(ns, BENCH_INDEX_NUM_LOOKUPS * 100, {
+			found += json_index_find(p_index, (json_value_t) {.string = names[_iter % BENCH_INDEX_NUM_LOOKUPS]},
+									 JSON_VALUE_TYPE_STRING) != NULL;
+		});
+		printf("%-40s %12.1f ns/lookup %10.2f ms build\n", labels[t], ns, build_ms);
+		json_index_free(p_index);
+	}
+	if (found != BENCH_INDEX_NUM_LOOKUPS * 201) {
+		printf("Lookup failed\n");
+	}
+
+	json_object_free(&root);
+	return 0;
+}
@@ -0,0 +1,44 @@
+#include <string.h>
+#include "bench.h"
+#include "bench_json.h"
+#include "json.h"
+
+#define BENCH_INLINE_NUM_RECORDS	5000
+#define BENCH_INLINE_ITERATIONS		50
+
+// Records of short keys and short string values, as in typical API messages
+static char* bench_inline_document(size_t* p_size) {
+	char* buffer = malloc(BENCH_INLINE_NUM_RECORDS * 160);
+	if (buffer == NULL) {
+		return NULL;
+	}
+	size_t size = sprintf(buffer, "{");
+	for (size_t i = 0; i < BENCH_INLINE_NUM_RECORDS; i++) {
+		size += sprintf(&buffer[size], "%s\"r%lu\": {\"id\": \"u%lu\", \"name\": \"user\", \"role\": \"admin\", \"region\": \"eu-west\", "
+						"\"state\": \"%s\", \"n\": %lu}", i > 0 ? ", " : "", i, i, i % 3 ? "active" : "idle", i);
+	}
+	size += sprintf(&buffer[size], "}");
+	*p_size = size;
+	return buffer;
+}
+
+int bench_json_inline() {
+	size_t size;
+	char* buffer = bench_inline_document(&size);
+	if (buffer == NULL) {
+		return 1;
+	}
+
+	double ns;
+	json_object_t object;
+	BENCH_RUN(ns, BENCH_INLINE_ITERATIONS, {
+		if (json_parse(buffer, size, &object) != JSON_RETVAL_OK) {
+			printf("Parsing failed\n");
+		}
+		json_object_free(&object);
+	});
+	BENCH_REPORT("inline/parse and free", ns, size);
+
+	free(buffer);
+	return 0;
+}
@@ -0,0 +1,116 @@
+#include <string.h>
+#include "bench.h"
+#include "bench_json.h"
+#include "json.h"
+
+#define BENCH_KEY_POOL_NUM_DOCUMENTS	2000
+#define BENCH_KEY_POOL_ITERATIONS		20
+
+// Cached API messages that all repeat the same long keys
+static char* bench_key_pool_document(size_t index, size_t* p_size) {
+	char* buffer = malloc(512);
+	if (buffer != NULL) {
+		*p_size = sprintf(buffer, "{\"customer_identifier\": %lu, \"customer_display_name\": \"user %lu\", "
+								  "\"subscription_tier_name\": \"premium\", \"last_successful_login_time\": %lu, "
+								  "\"preferred_notification_channel\": \"email\", \"account_metadata\": "
+								  "{\"creation_source_platform\": \"web\", \"marketing_consent_given\": true}}",
+						  index, index, 1700000000 + index);
+	}
+	return buffer;
+}
+
+// Bytes held by keys that are not stored inside their member
+static size_t bench_key_pool_key_bytes(const json_object_t* p_object) {
+	size_t bytes = 0;
+	for (uint32_t i = 0; i < p_object->num_members; i++) {
+		const json_object_member_t* p_member = &p_object->members[i];
+		if (!(p_member->flags & JSON_MEMBER_FLAG_INTERNED_KEY) &&
+			(p_member->key < p_member->inline_strings || p_member->key >= p_member->inline_strings + JSON_INLINE_STRINGS_SIZE)) {
+			bytes += strlen(p_member->key) + 1;
+		}
+		if (p_member->type == JSON_VALUE_TYPE_OBJECT) {
+			bytes += bench_key_pool_key_bytes(p_member->value.object);
+		}
+	}
+	return bytes;
+}
+
+int bench_json_key_pool() {
+	static char* buffers[BENCH_KEY_POOL_NUM_DOCUMENTS];
+	static size_t sizes[BENCH_KEY_POOL_NUM_DOCUMENTS];
+	static json_object_t objects[BENCH_KEY_POOL_NUM_DOCUMENTS];
+	size_t total_size = 0;
+	for (size_t i = 0; i < BENCH_KEY_POOL_NUM_DOCUMENTS; i++) {
+		buffers[i] = bench_key_pool_document(i, &sizes[i]);
+		if (buffers[i] == NULL) {
+			return 1;
+		}
+		total_size += sizes[i];
+	}
+
+	double ns;
+	size_t key_bytes = 0;
+	BENCH_RUN(ns, BENCH_KEY_POOL_ITERATIONS, {
+		for (size_t i = 0; i < BENCH_KEY_POOL_NUM_DOCUMENTS; i++) {
+			if (json_parse(buffers[i], sizes[i], &objects[i]) != JSON_RETVAL_OK) {
+				printf("Parsing failed\n");
+			}
+		}
+		key_bytes = 0;
+		for (size_t i = 0; i < BENCH_KEY_POOL_NUM_DOCUMENTS; i++) {
+			key_bytes += bench_key_pool_key_bytes(&objects[i]);
+			json_object_free(&objects[i]);
+		}
+	});
+	BENCH_REPORT("key_pool/parse plain", ns, total_size);
+	printf("%-40s %12lu bytes\n", "key_pool/key memory plain", key_bytes);
+
+	json_key_pool_t* p_pool = json_key_pool_new();
+	if (p_pool == NULL) {
+		return 1;
+	}
+	BENCH_RUN(ns, BENCH_KEY_POOL_ITERATIONS, {
+		for (size_t i = 0; i < BENCH_KEY_POOL_NUM_DOCUMENTS; i++) {
+			if (json_parse_interned(buffers[i], sizes[i], &objects[i], p_pool, NULL) != JSON_RETVAL_OK) {
+				printf("Parsing failed\n");
+			}
+		}
+		key_bytes = 0;
+		for (size_t i = 0; i < BENCH_KEY_POOL_NUM_DOCUMENTS; i++) {
+			key_bytes += bench_key_pool_key_bytes(&objects[i]);
+			json_object_free(&objects[i]);
+		}
+	});
+	BENCH_REPORT("key_pool/parse interned", ns, total_size);
+	printf("%-40s %12lu bytes in %lu pooled keys\n", "key_pool/key memory interned", key_bytes,
+		   json_key_pool_get_num_keys(p_pool));
+
+	// Lookup of one key in every document, by string and by interned pointer
+	const char* key = json_key_pool_intern(p_pool, "preferred_notification_channel", 30);
+	for (size_t i = 0; i < BENCH_KEY_POOL_NUM_DOCUMENTS; i++) {
+		json_parse_interned(buffers[i], sizes[i], &objects[i], p_pool, NULL);
+	}
+	size_t found = 0;
+	BENCH_RUN(ns, BENCH_KEY_POOL_ITERATIONS, {
+		for (size_t i = 0; i < BENCH_KEY_POOL_NUM_DOCUMENTS; i++) {
+			found += json_object_get_value(&objects[i], "preferred_notification_channel") != NULL;
+		}
+	});
+	BENCH_REPORT("key_pool/lookup by string", ns, total_size);
+	BENCH_RUN(ns, BENCH_KEY_POOL_ITERATIONS, {
+		for (size_t i = 0; i < BENCH_KEY_POOL_NUM_DOCUMENTS; i++) {
+			found += json_object_get_value_interned(&objects[i], key) != NULL;
+		}
+	});
+	BENCH_REPORT("key_pool/lookup by interned key", ns, total_size);
+	if (found != 2 * BENCH_KEY_POOL_ITERATIONS * BENCH_KEY_POOL_NUM_DOCUMENTS) {
+		printf("Lookup failed\n");
+	}
+
+	for (size_t i = 0; i < BENCH_KEY_POOL_NUM_DOCUMENTS; i++) {
+		json_object_free(&objects[i]);
+		free(buffers[i]);
+	}
+	json_key_pool_free(p_pool);
+	return 0;
+}
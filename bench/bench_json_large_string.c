@@ -0,0 +1,71 @@
+#include <string.h>
+#include "bench.h"
+#include "bench_json.h"
+#include "json.h"
+
+#define BENCH_LARGE_STRING_ITERATIONS	3
+
+static const size_t m_value_sizes[] = {
+	1ull << 20,
+	16ull << 20,
+	256ull << 20,
+};
+
+// {"blob":"<value_len bytes, an escape sequence every 4 KB>"}
+static char* bench_large_string_document(size_t value_len, size_t* p_size) {
+	const char* prefix = "{\"blob\":\"";
+	const char* suffix = "\"}";
+	size_t prefix_len = strlen(prefix), suffix_len = strlen(suffix);
+	char* buffer = malloc(prefix_len + value_len + suffix_len + 1);
+	if (buffer == NULL) {
+		return NULL;
+	}
+	memcpy(buffer, prefix, prefix_len);
+	for (size_t i = 0; i < value_len; i++) {
+		buffer[prefix_len + i] = (char) ('a' + i % 26);
+		if (i % 4096 == 4094) {
+			buffer[prefix_len + i++] = '\\';
+			buffer[prefix_len + i] = 'n';
+		}
+	}
+	memcpy(&buffer[prefix_len + value_len], suffix, suffix_len + 1);
+	*p_size = prefix_len + value_len + suffix_len;
+	return buffer;
+}
+
+int bench_json_large_string() {
+	for (size_t i = 0; i < sizeof(m_value_sizes) / sizeof(m_value_sizes[0]); i++) {
+		size_t size = 0;
+		char* buffer = bench_large_string_document(m_value_sizes[i], &size);
+		if (buffer == NULL) {
+			printf("Failed to allocate %zu byte document\n", m_value_sizes[i]);
+			return 1;
+		}
+
+		double ns_validate, ns_parse;
+		BENCH_RUN(ns_validate, BENCH_LARGE_STRING_ITERATIONS, {
+			if (json_validate(buffer, size, NULL) != JSON_RETVAL_OK) {
+				printf("Validation failed\n");
+				break;
+			}
+		});
+		BENCH_RUN(ns_parse, BENCH_LARGE_STRING_ITERATIONS, {
+			json_object_t object;
+			if (json_parse(buffer, size, &object) != JSON_RETVAL_OK) {
+				printf("Parsing failed\n");
+				break;
+			}
+			json_object_free(&object);
+		});
+
+		char name[64];
+		snprintf(name, sizeof(name), "large_string/%zuMB/json_validate", m_value_sizes[i] >> 20);
+		BENCH_REPORT(name, ns_validate, size);
+		snprintf(name, sizeof(name), "large_string/%zuMB/json_parse", m_value_sizes[i] >> 20);
+		BENCH_REPORT(name, ns_parse, size);
+
+		free(buffer);
+	}
+
+	return 0;
+}
@@ -0,0 +1,56 @@
+#include <string.h>
+#include "bench.h"
+#include "bench_json.h"
+#include "json.h"
+
+#define BENCH_NDJSON_NUM_RECORDS	200000
+
+static const uint32_t m_thread_counts[] = {1, 2, 4, 8, 16};
+
+static char* bench_ndjson_document(size_t num_records, size_t* p_size) {
+	char* buffer = malloc(num_records * 128);
+	if (buffer == NULL) {
+		return NULL;
+	}
+	size_t size = 0;
+	for (size_t i = 0; i < num_records; i++) {
+		size += sprintf(&buffer[size], "{\"ts\": %lu, \"host\": \"host-%03lu\", \"level\": \"info\", \"v\": %lu.%02lu, \"ok\": true}\n",
+						1700000000ul + i, i % 256, i % 1000, i % 100);
+	}
+	*p_size = size;
+	return buffer;
+}
+
+static json_ret_code_t bench_ndjson_callback(const json_ndjson_record_t* p_record, void* p_context) {
+	if (p_record->ret != JSON_RETVAL_OK) {
+		return p_record->ret;
+	}
+	__atomic_fetch_add((uint64_t*) p_context, 1, __ATOMIC_RELAXED);
+	return JSON_RETVAL_OK;
+}
+
+int bench_json_ndjson() {
+	size_t size = 0;
+	char* buffer = bench_ndjson_document(BENCH_NDJSON_NUM_RECORDS, &size);
+	if (buffer == NULL) {
+		return 1;
+	}
+
+	for (size_t unordered = 0; unordered <= 1; unordered++) {
+		for (size_t i = 0; i < sizeof(m_thread_counts) / sizeof(m_thread_counts[0]); i++) {
+			json_ndjson_options_t options = {.num_threads = m_thread_counts[i], .unordered = unordered};
+			uint64_t num_records = 0;
+			double ns;
+			BENCH_RUN(ns, 1, {
+				if (json_parse_ndjson(buffer, size, &options, bench_ndjson_callback, &num_records) != JSON_RETVAL_OK) {
+					printf("Parsing failed\n");
+				}
+			});
+			printf("ndjson/%-9s threads=%-3u %12.0f records/s %10.1f MB/s\n", unordered ? "unordered" : "ordered",
+				   m_thread_counts[i], (double) num_records * 1e9 / ns, (double) size * 1e9 / ns / (1024.0 * 1024.0));
+		}
+	}
+
+	free(buffer);
+	return 0;
+}
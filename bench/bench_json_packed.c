@@ -0,0 +1,78 @@
+#include <string.h>
+#include "bench.h"
+#include "bench_json.h"
+#include "json.h"
+
+#define BENCH_PACKED_NUM_ARRAYS		100
+#define BENCH_PACKED_ARRAY_LENGTH	10000
+#define BENCH_PACKED_ITERATIONS		10
+
+// Series of samples, each array is as long as an array of generic entries may be
+static char* bench_packed_document(size_t* p_size) {
+	char* buffer = malloc(BENCH_PACKED_NUM_ARRAYS * (BENCH_PACKED_ARRAY_LENGTH * 12 + 32));
+	if (buffer == NULL) {
+		return NULL;
+	}
+	size_t size = sprintf(buffer, "{");
+	for (size_t i = 0; i < BENCH_PACKED_NUM_ARRAYS; i++) {
+		size += sprintf(&buffer[size], "%s\"series%lu\": [", i > 0 ? ", " : "", i);
+		for (size_t j = 0; j < BENCH_PACKED_ARRAY_LENGTH; j++) {
+			size += sprintf(&buffer[size], "%s%lu.%lu", j > 0 ? "," : "", j % 1000, j % 97);
+		}
+		size += sprintf(&buffer[size], "]");
+	}
+	size += sprintf(&buffer[size], "}");
+	*p_size = size;
+	return buffer;
+}
+
+int bench_json_packed() {
+	size_t size;
+	char* buffer = bench_packed_document(&size);
+	if (buffer == NULL) {
+		return 1;
+	}
+
+	double ns;
+	json_object_t object;
+	BENCH_RUN(ns, BENCH_PACKED_ITERATIONS, {
+		if (json_parse(buffer, size, &object) != JSON_RETVAL_OK) {
+			printf("Parsing failed\n");
+		}
+		json_object_free(&object);
+	});
+	BENCH_REPORT("packed/parse and free", ns, size);
+
+	// Summing through the zero-copy accessor and through one value at a time
+	if (json_parse(buffer, size, &object) != JSON_RETVAL_OK) {
+		free(buffer);
+		return 1;
+	}
+	double sum = 0;
+	BENCH_RUN(ns, BENCH_PACKED_ITERATIONS, {
+		for (uint32_t i = 0; i < object.num_members; i++) {
+			size_t length;
+			const double* numbers = json_array_get_numbers(object.members[i].value.array, &length);
+			for (size_t j = 0; numbers != NULL && j < length; j++) {
+				sum += numbers[j];
+			}
+		}
+	});
+	BENCH_REPORT("packed/sum packed numbers", ns, size);
+	BENCH_RUN(ns, BENCH_PACKED_ITERATIONS, {
+		for (uint32_t i = 0; i < object.num_members; i++) {
+			json_value_t* p_value = &object.members[i].value;
+			for (uint32_t j = 0; j < p_value->array->length; j++) {
+				sum += json_value_get_array_member(p_value, j)->number;
+			}
+		}
+	});
+	BENCH_REPORT("packed/sum by member", ns, size);
+	if (sum == 0) {
+		printf("Sum failed\n");
+	}
+
+	json_object_free(&object);
+	free(buffer);
+	return 0;
+}
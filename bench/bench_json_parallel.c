@@ -0,0 +1,76 @@
+#include <string.h>
+#include "bench.h"
+#include "bench_json.h"
+#include "json.h"
+
+#define BENCH_PARALLEL_NUM_ARRAYS		64
+#define BENCH_PARALLEL_ARRAY_LENGTH		10000
+#define BENCH_PARALLEL_NUM_OBJECTS		64
+#define BENCH_PARALLEL_ITERATIONS		5
+
+static const uint32_t m_thread_counts[] = {1, 2, 4, 8};
+
+// Root object with large number arrays and medium sized objects, about 15 MB
+static char* bench_parallel_document(size_t* p_size) {
+	char* buffer = malloc(BENCH_PARALLEL_NUM_ARRAYS * BENCH_PARALLEL_ARRAY_LENGTH * 24 + BENCH_PARALLEL_NUM_OBJECTS * 64 * 1024);
+	if (buffer == NULL) {
+		return NULL;
+	}
+	size_t size = sprintf(buffer, "{");
+	for (size_t i = 0; i < BENCH_PARALLEL_NUM_ARRAYS; i++) {
+		size += sprintf(&buffer[size], "%s\"series %lu\": [", i > 0 ? ", " : "", i);
+		for (size_t j = 0; j < BENCH_PARALLEL_ARRAY_LENGTH; j++) {
+			size += sprintf(&buffer[size], "%s%lu.%03lu", j > 0 ? ", " : "", j * 31 % 100000, j % 1000);
+		}
+		size += sprintf(&buffer[size], "]");
+	}
+	for (size_t i = 0; i < BENCH_PARALLEL_NUM_OBJECTS; i++) {
+		size += sprintf(&buffer[size], ", \"object %lu\": {", i);
+		for (size_t j = 0; j < 1000; j++) {
+			size += sprintf(&buffer[size], "%s\"key %lu\": \"value %lu\"", j > 0 ? ", " : "", j, j * i);
+		}
+		size += sprintf(&buffer[size], "}");
+	}
+	size += sprintf(&buffer[size], "}");
+	*p_size = size;
+	return buffer;
+}
+
+int bench_json_parallel() {
+	size_t size = 0;
+	char* buffer = bench_parallel_document(&size);
+	if (buffer == NULL) {
+		return 1;
+	}
+
+	json_object_t object;
+	double ns;
+	BENCH_RUN(ns, BENCH_PARALLEL_ITERATIONS, {
+		if (json_parse(buffer, size, &object) != JSON_RETVAL_OK) {
+			printf("Parsing failed\n");
+		}
+		json_object_free(&object);
+	});
+	BENCH_REPORT("parallel/serial", ns, size);
+
+	for (size_t i = 0; i < sizeof(m_thread_counts) / sizeof(m_thread_counts[0]); i++) {
+		json_pool_t* pool = json_pool_new(m_thread_counts[i]);
+		if (pool == NULL) {
+			break;
+		}
+		json_parallel_options_t options = {.p_pool = pool};
+		BENCH_RUN(ns, BENCH_PARALLEL_ITERATIONS, {
+			if (json_parse_parallel(buffer, size, &object, &options, NULL) != JSON_RETVAL_OK) {
+				printf("Parsing failed\n");
+			}
+			json_object_free(&object);
+		});
+		char name[64];
+		snprintf(name, sizeof(name), "parallel/threads=%u", m_thread_counts[i]);
+		BENCH_REPORT(name, ns, size);
+		json_pool_free(pool);
+	}
+
+	free(buffer);
+	return 0;
+}
@@ -0,0 +1,80 @@
+#include <string.h>
+#include "bench.h"
+#include "bench_json.h"
+#include "json.h"
+
+#define BENCH_PATH_NUM_MEMBERS	32
+#define BENCH_PATH_ITERATIONS	1000000
+
+// Request payload with a few dozen members on every level, the wanted values sit near the end
+static char* bench_path_document(size_t* p_size) {
+	char* buffer = malloc(16 * 1024);
+	if (buffer == NULL) {
+		return NULL;
+	}
+	size_t size = sprintf(buffer, "{");
+	for (size_t i = 0; i < BENCH_PATH_NUM_MEMBERS; i++) {
+		size += sprintf(&buffer[size], "\"header_field_%lu\": %lu, ", i, i);
+	}
+	size += sprintf(&buffer[size], "\"payload\": {");
+	for (size_t i = 0; i < BENCH_PATH_NUM_MEMBERS; i++) {
+		size += sprintf(&buffer[size], "\"payload_field_%lu\": \"v\", ", i);
+	}
+	size += sprintf(&buffer[size], "\"customer\": {\"name\": \"x\", \"tier\": 2}, \"items\": [1.5, 2.5, 3.5, 4.5]}}");
+	*p_size = size;
+	return buffer;
+}
+
+int bench_json_path() {
+	size_t size;
+	char* buffer = bench_path_document(&size);
+	json_object_t object;
+	if (buffer == NULL || json_parse(buffer, size, &object) != JSON_RETVAL_OK) {
+		free(buffer);
+		return 1;
+	}
+
+	const char* expressions[] = {"/payload/items/3", "/payload/customer/tier", "/payload/customer/name", "/header_field_31"};
+	const size_t num_paths = sizeof(expressions) / sizeof(expressions[0]);
+	json_path_t* paths[sizeof(expressions) / sizeof(expressions[0])];
+	for (size_t i = 0; i < num_paths; i++) {
+		paths[i] = json_path_compile(expressions[i]);
+	}
+
+	double ns;
+	double sum = 0;
+	BENCH_RUN(ns, BENCH_PATH_ITERATIONS, {
+		json_value_t* p_payload = json_object_get_value(&object, "payload");
+		json_value_t* p_customer = json_object_get_value(p_payload->object, "customer");
+		sum += json_value_get_array_member(json_object_get_value(p_payload->object, "items"), 3)->number;
+		sum += json_object_get_value(p_customer->object, "tier")->number;
+		sum += json_object_get_value(p_customer->object, "name")->string[0];
+		sum += json_object_get_value(&object, "header_field_31")->number;
+	});
+	printf("%-40s %12.1f ns/iter\n", "path/chained lookups", ns);
+
+	BENCH_RUN(ns, BENCH_PATH_ITERATIONS, {
+		sum += json_path_eval(paths[0], &object, NULL)->number;
+		sum += json_path_eval(paths[1], &object, NULL)->number;
+		sum += json_path_eval(paths[2], &object, NULL)->string[0];
+		sum += json_path_eval(paths[3], &object, NULL)->number;
+	});
+	printf("%-40s %12.1f ns/iter\n", "path/compiled", ns);
+
+	json_value_t* values[sizeof(expressions) / sizeof(expressions[0])];
+	BENCH_RUN(ns, BENCH_PATH_ITERATIONS, {
+		json_path_eval_batch(paths, num_paths, &object, values, NULL);
+		sum += values[0]->number + values[1]->number + values[2]->string[0] + values[3]->number;
+	});
+	printf("%-40s %12.1f ns/iter\n", "path/compiled batch", ns);
+	if (sum == 0) {
+		printf("Evaluation failed\n");
+	}
+
+	for (size_t i = 0; i < num_paths; i++) {
+		json_path_free(paths[i]);
+	}
+	json_object_free(&object);
+	free(buffer);
+	return 0;
+}
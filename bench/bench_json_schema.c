@@ -0,0 +1,144 @@
+#include <string.h>
+#include "bench.h"
+#include "bench_json.h"
+#include "json.h"
+
+#define BENCH_SCHEMA_NUM_ORDERS		2000
+#define BENCH_SCHEMA_ITERATIONS		200
+
+static const char* m_bench_schema =
+		"{\"type\": \"object\", \"required\": [\"orders\"], \"properties\": {\"orders\": {\"type\": \"object\","
+		" \"additionalProperties\": {\"type\": \"object\", \"required\": [\"id\", \"symbol\", \"side\", \"price\"],"
+		" \"additionalProperties\": false, \"properties\": {"
+		"  \"id\": {\"type\": \"integer\", \"minimum\": 1},"
+		"  \"symbol\": {\"type\": \"string\", \"minLength\": 1, \"maxLength\": 8},"
+		"  \"side\": {\"enum\": [\"buy\", \"sell\"]},"
+		"  \"price\": {\"type\": \"number\", \"exclusiveMinimum\": 0},"
+		"  \"fills\": {\"type\": \"array\", \"items\": {\"type\": \"number\"}, \"maxItems\": 16}}}}}}";
+
+// Orders keyed by id, bad_order gets a negative id
+static char* bench_schema_document(size_t* p_size, size_t bad_order) {
+	char* buffer = malloc(BENCH_SCHEMA_NUM_ORDERS * 160 + 64);
+	if (buffer == NULL) {
+		return NULL;
+	}
+	size_t size = sprintf(buffer, "{\"orders\": {");
+	for (size_t i = 0; i < BENCH_SCHEMA_NUM_ORDERS; i++) {
+		size += sprintf(&buffer[size], "%s\"o%lu\": {\"id\": %ld, \"symbol\": \"SYM%lu\", \"side\": \"%s\", \"price\": %lu.25,"
+						" \"fills\": [%lu, %lu.5, 3]}", i > 0 ? ", " : "", i, i == bad_order ? -1l : (long) i + 1, i % 500,
+						i % 2 ? "buy" : "sell", 10 + i % 90, i % 7, i % 11);
+	}
+	size += sprintf(&buffer[size], "}}");
+	*p_size = size;
+	return buffer;
+}
+
+// The same checks written against the tree
+static bool bench_schema_check_tree(const json_object_t* p_root) {
+	json_value_t* p_orders = json_object_get_value(p_root, "orders");
+	if (p_orders == NULL || json_object_get_value_type(p_root, "orders") != JSON_VALUE_TYPE_OBJECT) {
+		return false;
+	}
+	for (uint32_t i = 0; i < p_orders->object->num_members; i++) {
+		const json_object_member_t* p_order = &p_orders->object->members[i];
+		if (p_order->type != JSON_VALUE_TYPE_OBJECT) {
+			return false;
+		}
+		uint32_t num_required = 0;
+		for (uint32_t j = 0; j < p_order->value.object->num_members; j++) {
+			const json_object_member_t* p_member = &p_order->value.object->members[j];
+			if (strcmp(p_member->key, "id") == 0) {
+				if (p_member->type != JSON_VALUE_TYPE_NUMBER || p_member->value.number < 1 ||
+					p_member->value.number != (double) (int64_t) p_member->value.number) {
+					return false;
+				}
+				num_required++;
+			} else if (strcmp(p_member->key, "symbol") == 0) {
+				size_t length = p_member->type == JSON_VALUE_TYPE_STRING ? strlen(p_member->value.string) : 0;
+				if (length < 1 || length > 8) {
+					return false;
+				}
+				num_required++;
+			} else if (strcmp(p_member->key, "side") == 0) {
+				if (p_member->type != JSON_VALUE_TYPE_STRING ||
+					(strcmp(p_member->value.string, "buy") != 0 && strcmp(p_member->value.string, "sell") != 0)) {
+					return false;
+				}
+				num_required++;
+			} else if (strcmp(p_member->key, "price") == 0) {
+				if (p_member->type != JSON_VALUE_TYPE_NUMBER || p_member->value.number <= 0) {
+					return false;
+				}
+				num_required++;
+			} else if (strcmp(p_member->key, "fills") == 0) {
+				json_value_t fills = p_member->value;
+				if (p_member->type != JSON_VALUE_TYPE_ARRAY || fills.array->length > 16) {
+					return false;
+				}
+				for (uint32_t k = 0; k < fills.array->length; k++) {
+					if (json_value_get_array_member_type(&fills, k) != JSON_VALUE_TYPE_NUMBER) {
+						return false;
+					}
+				}
+			} else {
+				return false;
+			}
+		}
+		if (num_required != 4) {
+			return false;
+		}
+	}
+	return true;
+}
+
+int bench_json_schema() {
+	size_t size, bad_size;
+	char* buffer = bench_schema_document(&size, SIZE_MAX);
+	char* bad_buffer = bench_schema_document(&bad_size, 10);
+	json_schema_t* p_schema = json_schema_compile(m_bench_schema, strlen(m_bench_schema));
+	if (buffer == NULL || bad_buffer == NULL || p_schema == NULL) {
+		printf("Setup failed\n");
+		free(buffer);
+		free(bad_buffer);
+		json_schema_free(p_schema);
+		return 1;
+	}
+
+	double ns;
+	size_t num_valid = 0;
+	BENCH_RUN(ns, BENCH_SCHEMA_ITERATIONS, {
+		json_object_t object;
+		num_valid += json_parse(buffer, size, &object) == JSON_RETVAL_OK && bench_schema_check_tree(&object);
+		json_object_free(&object);
+	});
+	BENCH_REPORT("schema/parse then walk tree", ns, size);
+
+	BENCH_RUN(ns, BENCH_SCHEMA_ITERATIONS, {
+		json_object_t object;
+		num_valid += json_parse_schema(buffer, size, p_schema, &object, NULL) == JSON_RETVAL_OK;
+		json_object_free(&object);
+	});
+	BENCH_REPORT("schema/parse with schema", ns, size);
+
+	BENCH_RUN(ns, BENCH_SCHEMA_ITERATIONS, {
+		json_object_t object;
+		num_valid += json_parse(bad_buffer, bad_size, &object) == JSON_RETVAL_OK && bench_schema_check_tree(&object);
+		json_object_free(&object);
+	});
+	BENCH_REPORT("schema/invalid, parse then walk tree", ns, bad_size);
+
+	BENCH_RUN(ns, BENCH_SCHEMA_ITERATIONS, {
+		json_object_t object;
+		num_valid += json_parse_schema(bad_buffer, bad_size, p_schema, &object, NULL) == JSON_RETVAL_OK;
+		json_object_free(&object);
+	});
+	BENCH_REPORT("schema/invalid, parse with schema", ns, bad_size);
+
+	if (num_valid != 2 * BENCH_SCHEMA_ITERATIONS) {
+		printf("Validation failed\n");
+	}
+	free(buffer);
+	free(bad_buffer);
+	json_schema_free(p_schema);
+	return 0;
+}
@@ -0,0 +1,86 @@
+#include <string.h>
+#include "bench.h"
+#include "bench_json.h"
+#include "json.h"
+
+#define BENCH_SELECT_NUM_SECTIONS	200
+#define BENCH_SELECT_NUM_SELECTORS	20
+#define BENCH_SELECT_ITERATIONS		10
+
+// Event log with a few hundred sections of samples and text, the wanted values are one small member per section
+static char* bench_select_document(size_t* p_size) {
+	char* buffer = malloc(BENCH_SELECT_NUM_SECTIONS * 24 * 1024);
+	if (buffer == NULL) {
+		return NULL;
+	}
+	size_t size = sprintf(buffer, "{");
+	for (size_t i = 0; i < BENCH_SELECT_NUM_SECTIONS; i++) {
+		size += sprintf(&buffer[size], "%s\"section_%lu\": {\"samples\": [", i > 0 ? ", " : "", i);
+		for (size_t j = 0; j < 1000; j++) {
+			size += sprintf(&buffer[size], "%s%lu.%lu", j > 0 ? ", " : "", (i * j) % 997, j % 10);
+		}
+		size += sprintf(&buffer[size], "], \"text\": \"");
+		for (size_t j = 0; j < 200; j++) {
+			size += sprintf(&buffer[size], "line %lu\\n", j);
+		}
+		size += sprintf(&buffer[size], "\", \"meta\": {\"host\": \"host-%lu\", \"id\": %lu, \"ok\": true}}", i % 16, i);
+	}
+	size += sprintf(&buffer[size], "}");
+	*p_size = size;
+	return buffer;
+}
+
+static json_ret_code_t bench_select_sum(const json_select_match_t* p_match, void* p_context) {
+	*(double*) p_context += p_match->value.number;
+	return JSON_RETVAL_OK;
+}
+
+int bench_json_select() {
+	size_t size;
+	char* buffer = bench_select_document(&size);
+	if (buffer == NULL) {
+		return 1;
+	}
+
+	char expressions[BENCH_SELECT_NUM_SELECTORS][64];
+	const char* p_expressions[BENCH_SELECT_NUM_SELECTORS];
+	json_path_t* paths[BENCH_SELECT_NUM_SELECTORS];
+	for (size_t i = 0; i < BENCH_SELECT_NUM_SELECTORS; i++) {
+		sprintf(expressions[i], "/section_%lu/meta/id", i * (BENCH_SELECT_NUM_SECTIONS / BENCH_SELECT_NUM_SELECTORS));
+		p_expressions[i] = expressions[i];
+		paths[i] = json_path_compile(expressions[i]);
+	}
+	json_selector_t* p_selector = json_selector_compile(p_expressions, BENCH_SELECT_NUM_SELECTORS);
+
+	double ns;
+	double sum = 0;
+	BENCH_RUN(ns, BENCH_SELECT_ITERATIONS, {
+		json_object_t object;
+		if (json_parse(buffer, size, &object) != JSON_RETVAL_OK) {
+			printf("Parsing failed\n");
+			break;
+		}
+		for (size_t i = 0; i < BENCH_SELECT_NUM_SELECTORS; i++) {
+			sum += json_path_eval(paths[i], &object, NULL)->number;
+		}
+		json_object_free(&object);
+	});
+	BENCH_REPORT("select/parse and paths", ns, size);
+
+	BENCH_RUN(ns, BENCH_SELECT_ITERATIONS, {
+		if (json_select(buffer, size, p_selector, bench_select_sum, &sum, NULL) != JSON_RETVAL_OK) {
+			printf("Selection failed\n");
+		}
+	});
+	BENCH_REPORT("select/one pass", ns, size);
+	if (sum == 0) {
+		printf("Selection failed\n");
+	}
+
+	for (size_t i = 0; i < BENCH_SELECT_NUM_SELECTORS; i++) {
+		json_path_free(paths[i]);
+	}
+	json_selector_free(p_selector);
+	free(buffer);
+	return 0;
+}
@@ -0,0 +1,89 @@
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include "bench.h"
+#include "bench_json.h"
+#include "json.h"
+
+#define BENCH_STRINGIFY_NUM_ARRAYS		32
+#define BENCH_STRINGIFY_ITERATIONS		5
+
+static const uint32_t m_thread_counts[] = {1, 2, 4, 8};
+
+// Export-like object, large number arrays and a large object of records
+static char* bench_stringify_document(size_t* p_size) {
+	char* buffer = malloc(BENCH_STRINGIFY_NUM_ARRAYS * 10000 * 16 + 4 * 1024 * 1024);
+	if (buffer == NULL) {
+		return NULL;
+	}
+	size_t size = sprintf(buffer, "{\"records\": {");
+	for (size_t i = 0; i < 9000; i++) {
+		size += sprintf(&buffer[size], "%s\"record %lu\": {\"name\": \"item %lu\", \"tags\": [\"a\", \"b\"], \"price\": %lu.99}",
+						i > 0 ? ", " : "", i, i, i % 1000);
+	}
+	size += sprintf(&buffer[size], "}");
+	for (size_t i = 0; i < BENCH_STRINGIFY_NUM_ARRAYS; i++) {
+		size += sprintf(&buffer[size], ", \"series %lu\": [", i);
+		for (size_t j = 0; j < 10000; j++) {
+			size += sprintf(&buffer[size], "%s%lu.%lu", j > 0 ? ", " : "", j * 7 % 1000, j % 10);
+		}
+		size += sprintf(&buffer[size], "]");
+	}
+	size += sprintf(&buffer[size], "}");
+	*p_size = size;
+	return buffer;
+}
+
+int bench_json_stringify() {
+	size_t size = 0;
+	char* buffer = bench_stringify_document(&size);
+	if (buffer == NULL) {
+		return 1;
+	}
+	json_object_t object;
+	if (json_parse(buffer, size, &object) != JSON_RETVAL_OK) {
+		printf("Parsing failed\n");
+		free(buffer);
+		return 1;
+	}
+	free(buffer);
+
+	char* string = json_stringify(&object);
+	size_t output_size = string != NULL ? strlen(string) : 0;
+	free(string);
+
+	double ns;
+	BENCH_RUN(ns, BENCH_STRINGIFY_ITERATIONS, {
+		free(json_stringify(&object));
+	});
+	BENCH_REPORT("stringify/serial", ns, output_size);
+
+	int fd = open("/dev/null", O_WRONLY);
+	for (size_t i = 0; i < sizeof(m_thread_counts) / sizeof(m_thread_counts[0]); i++) {
+		json_pool_t* pool = json_pool_new(m_thread_counts[i]);
+		if (pool == NULL) {
+			break;
+		}
+		char name[64];
+		BENCH_RUN(ns, BENCH_STRINGIFY_ITERATIONS, {
+			free(json_stringify_parallel(&object, false, pool));
+		});
+		snprintf(name, sizeof(name), "stringify/parallel threads=%u", m_thread_counts[i]);
+		BENCH_REPORT(name, ns, output_size);
+
+		if (fd >= 0) {
+			BENCH_RUN(ns, BENCH_STRINGIFY_ITERATIONS, {
+				json_stringify_write(fd, &object, false, pool);
+			});
+			snprintf(name, sizeof(name), "stringify/writev threads=%u", m_thread_counts[i]);
+			BENCH_REPORT(name, ns, output_size);
+		}
+		json_pool_free(pool);
+	}
+	if (fd >= 0) {
+		close(fd);
+	}
+
+	json_object_free(&object);
+	return 0;
+}
@@ -0,0 +1,146 @@
+#include <string.h>
+#include "bench.h"
+#include "bench_json.h"
+#include "json.h"
+
+#define BENCH_TAPE_NUM_RECORDS		500
+#define BENCH_TAPE_NUM_SCORES		200
+#define BENCH_TAPE_ITERATIONS		200
+
+// Records with scalars and a number array, a shape both the tree and the tape hold
+static char* bench_tape_document(size_t* p_size) {
+	char* buffer = malloc(BENCH_TAPE_NUM_RECORDS * (BENCH_TAPE_NUM_SCORES * 8 + 128));
+	if (buffer == NULL) {
+		return NULL;
+	}
+	size_t size = sprintf(buffer, "{");
+	for (size_t i = 0; i < BENCH_TAPE_NUM_RECORDS; i++) {
+		size += sprintf(&buffer[size], "%s\"record %lu\": {\"id\": %lu, \"name\": \"name-%lu\", \"active\": %s, \"scores\": [",
+						i > 0 ? ", " : "", i, i, i, i % 2 ? "true" : "false");
+		for (size_t j = 0; j < BENCH_TAPE_NUM_SCORES; j++) {
+			size += sprintf(&buffer[size], "%s%lu.5", j > 0 ? ", " : "", (i * j) % 1000);
+		}
+		size += sprintf(&buffer[size], "]}");
+	}
+	size += sprintf(&buffer[size], "}");
+	*p_size = size;
+	return buffer;
+}
+
+static double bench_tape_sum_object(const json_object_t* p_object) {
+	double sum = 0;
+	for (uint32_t i = 0; i < p_object->num_members; i++) {
+		const json_object_member_t* p_member = &p_object->members[i];
+		switch (p_member->type) {
+			case JSON_VALUE_TYPE_NUMBER:
+				sum += p_member->value.number;
+				break;
+			case JSON_VALUE_TYPE_OBJECT:
+				sum += bench_tape_sum_object(p_member->value.object);
+				break;
+			case JSON_VALUE_TYPE_ARRAY:
+				for (size_t j = 0; p_member->value.array->numbers != NULL && j < p_member->value.array->length; j++) {
+					sum += p_member->value.array->numbers[j];
+				}
+				for (size_t j = 0; p_member->value.array->values != NULL && j < p_member->value.array->length; j++) {
+					if (p_member->value.array->values[j].type == JSON_VALUE_TYPE_NUMBER) {
+						sum += p_member->value.array->values[j].value.number;
+					}
+				}
+				break;
+			default:
+				break;
+		}
+	}
+	return sum;
+}
+
+// Bytes allocated for the tree, including unused capacity of the entry arrays
+static size_t bench_tape_tree_size(const json_object_t* p_object) {
+	size_t size = sizeof(json_object_t) + p_object->max_num_members * sizeof(json_object_member_t);
+	for (uint32_t i = 0; i < p_object->num_members; i++) {
+		const json_object_member_t* p_member = &p_object->members[i];
+		size += strlen(p_member->key) + 1;
+		if (p_member->type == JSON_VALUE_TYPE_STRING) {
+			size += strlen(p_member->value.string) + 1;
+		} else if (p_member->type == JSON_VALUE_TYPE_OBJECT) {
+			size += bench_tape_tree_size(p_member->value.object);
+		} else if (p_member->type == JSON_VALUE_TYPE_ARRAY) {
+			size += sizeof(json_array_t) + p_member->value.array->max_length *
+					(p_member->value.array->numbers != NULL ? sizeof(double) : sizeof(json_array_member_t));
+		}
+	}
+	return size;
+}
+
+static double bench_tape_sum_container(json_tape_value_t container) {
+	double sum = 0;
+	json_tape_iter_t iter = json_tape_iter_begin(container);
+	json_tape_value_t value;
+	while (json_tape_iter_next(&iter, &value, NULL)) {
+		switch (json_tape_value_get_type(value)) {
+			case JSON_VALUE_TYPE_NUMBER:
+				sum += json_tape_value_get_number(value);
+				break;
+			case JSON_VALUE_TYPE_OBJECT:
+			case JSON_VALUE_TYPE_ARRAY:
+				sum += bench_tape_sum_container(value);
+				break;
+			default:
+				break;
+		}
+	}
+	return sum;
+}
+
+int bench_json_tape() {
+	size_t size;
+	char* buffer = bench_tape_document(&size);
+	if (buffer == NULL) {
+		return 1;
+	}
+
+	double ns;
+	json_object_t object;
+	json_tape_t tape;
+	BENCH_RUN(ns, BENCH_TAPE_ITERATIONS / 10, {
+		json_parse(buffer, size, &object);
+		json_object_free(&object);
+	});
+	BENCH_REPORT("tape/parse tree", ns, size);
+	BENCH_RUN(ns, BENCH_TAPE_ITERATIONS / 10, {
+		json_parse_tape(buffer, size, &tape, NULL);
+		json_tape_free(&tape);
+	});
+	BENCH_REPORT("tape/parse tape", ns, size);
+
+	if (json_parse(buffer, size, &object) != JSON_RETVAL_OK || json_parse_tape(buffer, size, &tape, NULL) != JSON_RETVAL_OK) {
+		printf("Parsing failed\n");
+		free(buffer);
+		return 1;
+	}
+
+	// Visit every value and sum the numbers
+	volatile double sum;
+	BENCH_RUN(ns, BENCH_TAPE_ITERATIONS, {
+		sum = bench_tape_sum_object(&object);
+	});
+	BENCH_REPORT("tape/iterate tree", ns, size);
+	double tree_sum = sum;
+	BENCH_RUN(ns, BENCH_TAPE_ITERATIONS, {
+		sum = bench_tape_sum_container(json_tape_get_root(&tape));
+	});
+	BENCH_REPORT("tape/iterate tape", ns, size);
+	if (sum != tree_sum) {
+		printf("Sums differ: %f != %f\n", sum, tree_sum);
+	}
+
+	size_t tape_bytes = tape.num_words * sizeof(uint64_t) + tape.strings_length;
+	printf("tape/memory tree      %12lu bytes\n", bench_tape_tree_size(&object));
+	printf("tape/memory tape      %12lu bytes\n", tape_bytes);
+
+	json_object_free(&object);
+	json_tape_free(&tape);
+	free(buffer);
+	return 0;
+}
@@ -0,0 +1,38 @@
+#include "bench.h"
+#include "bench_json.h"
+#include "json.h"
+
+#define BENCH_VALIDATE_ITERATIONS			20000
+#define BENCH_VALIDATE_PARSE_ITERATIONS		200
+
+int bench_json_validate() {
+	size_t size = 0;
+	char* buffer = bench_read_file("tests/files/complete.json", &size);
+	if (buffer == NULL) {
+		return 1;
+	}
+
+	double ns_validate, ns_parse;
+	json_error_t error;
+	BENCH_RUN(ns_validate, BENCH_VALIDATE_ITERATIONS, {
+		if (json_validate(buffer, size, &error) != JSON_RETVAL_OK) {
+			printf("Validation failed\n");
+			break;
+		}
+	});
+	BENCH_RUN(ns_parse, BENCH_VALIDATE_PARSE_ITERATIONS, {
+		json_object_t object;
+		if (json_parse(buffer, size, &object) != JSON_RETVAL_OK) {
+			printf("Parsing failed\n");
+			break;
+		}
+		json_object_free(&object);
+	});
+
+	BENCH_REPORT("validate/json_validate", ns_validate, size);
+	BENCH_REPORT("validate/json_parse+json_object_free", ns_parse, size);
+	printf("validate/speedup %.1fx\n", ns_parse / ns_validate);
+
+	free(buffer);
+	return 0;
+}
@@ -0,0 +1,118 @@
+#include <string.h>
+#include "bench.h"
+#include "bench_json.h"
+#include "json.h"
+
+#define BENCH_WRITER_ITERATIONS		500000
+#define BENCH_WRITER_NUM_SCORES		16
+
+// Response of a user lookup with a nested profile and a list of scores
+typedef struct {
+	int64_t id;
+	const char* user;
+	const char* email;
+	double balance;
+	bool is_verified;
+	const char* city;
+	const char* country;
+	double scores[BENCH_WRITER_NUM_SCORES];
+} bench_writer_response_t;
+
+static char* bench_writer_stringify(const bench_writer_response_t* p_response) {
+	json_object_t object = {0};
+	json_object_t* p_profile = calloc(1, sizeof(json_object_t));
+	json_array_t* p_scores = calloc(1, sizeof(json_array_t));
+	double* numbers = malloc(sizeof(p_response->scores));
+	if (p_profile == NULL || p_scores == NULL || numbers == NULL) {
+		free(p_profile);
+		free(p_scores);
+		free(numbers);
+		return NULL;
+	}
+	memcpy(numbers, p_response->scores, sizeof(p_response->scores));
+	*p_scores = (json_array_t) {.numbers = numbers, .length = BENCH_WRITER_NUM_SCORES, .max_length = BENCH_WRITER_NUM_SCORES};
+	json_object_add_value(p_profile, "city", (json_value_t) {.string = strdup(p_response->city)}, JSON_VALUE_TYPE_STRING);
+	json_object_add_value(p_profile, "country", (json_value_t) {.string = strdup(p_response->country)}, JSON_VALUE_TYPE_STRING);
+	json_object_add_value(&object, "status", (json_value_t) {.number = 200}, JSON_VALUE_TYPE_NUMBER);
+	json_object_add_value(&object, "id", (json_value_t) {.number = (double) p_response->id}, JSON_VALUE_TYPE_NUMBER);
+	json_object_add_value(&object, "user", (json_value_t) {.string = strdup(p_response->user)}, JSON_VALUE_TYPE_STRING);
+	json_object_add_value(&object, "email", (json_value_t) {.string = strdup(p_response->email)}, JSON_VALUE_TYPE_STRING);
+	json_object_add_value(&object, "balance", (json_value_t) {.number = p_response->balance}, JSON_VALUE_TYPE_NUMBER);
+	json_object_add_value(&object, "verified", (json_value_t) {.boolean = p_response->is_verified}, JSON_VALUE_TYPE_BOOLEAN);
+	json_object_add_value(&object, "profile", (json_value_t) {.object = p_profile}, JSON_VALUE_TYPE_OBJECT);
+	json_object_add_value(&object, "scores", (json_value_t) {.array = p_scores}, JSON_VALUE_TYPE_ARRAY);
+	json_object_add_value(&object, "next", (json_value_t) {0}, JSON_VALUE_TYPE_NULL);
+	char* string = json_stringify(&object);
+	json_object_free(&object);
+	return string;
+}
+
+static void bench_writer_write(json_writer_t* p_writer, const bench_writer_response_t* p_response) {
+	json_writer_begin_object(p_writer);
+	json_writer_key(p_writer, "status");
+	json_writer_int(p_writer, 200);
+	json_writer_key(p_writer, "id");
+	json_writer_int(p_writer, p_response->id);
+	json_writer_key(p_writer, "user");
+	json_writer_string(p_writer, p_response->user);
+	json_writer_key(p_writer, "email");
+	json_writer_string(p_writer, p_response->email);
+	json_writer_key(p_writer, "balance");
+	json_writer_double(p_writer, p_response->balance);
+	json_writer_key(p_writer, "verified");
+	json_writer_bool(p_writer, p_response->is_verified);
+	json_writer_key(p_writer, "profile");
+	json_writer_begin_object(p_writer);
+	json_writer_key(p_writer, "city");
+	json_writer_string(p_writer, p_response->city);
+	json_writer_key(p_writer, "country");
+	json_writer_string(p_writer, p_response->country);
+	json_writer_end_object(p_writer);
+	json_writer_key(p_writer, "scores");
+	json_writer_begin_array(p_writer);
+	for (size_t i = 0; i < BENCH_WRITER_NUM_SCORES; i++) {
+		json_writer_double(p_writer, p_response->scores[i]);
+	}
+	json_writer_end_array(p_writer);
+	json_writer_key(p_writer, "next");
+	json_writer_null(p_writer);
+	json_writer_end_object(p_writer);
+}
+
+int bench_json_writer() {
+	bench_writer_response_t response = {
+		.id = 184467440737, .user = "jdoe", .email = "jdoe@example.com", .balance = 1024.5, .is_verified = true,
+		.city = "Berlin", .country = "DE",
+	};
+	for (size_t i = 0; i < BENCH_WRITER_NUM_SCORES; i++) {
+		response.scores[i] = (double) (i * 37 % 100) / 4;
+	}
+	double ns;
+	size_t total = 0;
+
+	BENCH_RUN(ns, BENCH_WRITER_ITERATIONS, {
+		char* string = bench_writer_stringify(&response);
+		total += string != NULL ? strlen(string) : 0;
+		free(string);
+	});
+	BENCH_REPORT("writer/add values and stringify", ns, total / BENCH_WRITER_ITERATIONS);
+
+	json_writer_t* p_writer = json_writer_new(NULL, NULL);
+	if (p_writer == NULL) {
+		return 1;
+	}
+	total = 0;
+	BENCH_RUN(ns, BENCH_WRITER_ITERATIONS, {
+		json_writer_reset(p_writer);
+		bench_writer_write(p_writer, &response);
+		size_t length;
+		if (json_writer_finish(p_writer) != JSON_RETVAL_OK || json_writer_get_output(p_writer, &length) == NULL) {
+			printf("Writing failed\n");
+			break;
+		}
+		total += length;
+	});
+	BENCH_REPORT("writer/writer", ns, total / BENCH_WRITER_ITERATIONS);
+	json_writer_free(p_writer);
+	return 0;
+}
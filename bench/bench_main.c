@@ -0,0 +1,29 @@
+#include <string.h>
+#include "bench_json.h"
+
+int main(int argc, char** argv) {
+	const char* filter = argc > 1 ? argv[1] : NULL;
+
+	if (filter == NULL || strcmp(filter, "validate") == 0) bench_json_validate();
+	if (filter == NULL || strcmp(filter, "large_string") == 0) bench_json_large_string();
+	if (filter == NULL || strcmp(filter, "ndjson") == 0) bench_json_ndjson();
+	if (filter == NULL || strcmp(filter, "parallel") == 0) bench_json_parallel();
+	if (filter == NULL || strcmp(filter, "batch") == 0) bench_json_batch();
+	if (filter == NULL || strcmp(filter, "stringify") == 0) bench_json_stringify();
+	if (filter == NULL || strcmp(filter, "tape") == 0) bench_json_tape();
+	if (filter == NULL || strcmp(filter, "inline") == 0) bench_json_inline();
+	if (filter == NULL || strcmp(filter, "key_pool") == 0) bench_json_key_pool();
+	if (filter == NULL || strcmp(filter, "packed") == 0) bench_json_packed();
+	if (filter == NULL || strcmp(filter, "columns") == 0) bench_json_columns();
+	if (filter == NULL || strcmp(filter, "path") == 0) bench_json_path();
+	if (filter == NULL || strcmp(filter, "select") == 0) bench_json_select();
+	if (filter == NULL || strcmp(filter, "index") == 0) bench_json_index();
+	if (filter == NULL || strcmp(filter, "decode") == 0) bench_json_decode();
+	if (filter == NULL || strcmp(filter, "encode") == 0) bench_json_encode();
+	if (filter == NULL || strcmp(filter, "schema") == 0) bench_json_schema();
+	if (filter == NULL || strcmp(filter, "writer") == 0) bench_json_writer();
+	if (filter == NULL || strcmp(filter, "deep") == 0) bench_json_deep();
+	if (filter == NULL || strcmp(filter, "arrays") == 0) bench_json_arrays();
+
+	return 0;
+}
@@ -8,30 +8,35 @@
 #include "json_lex.h"
 #include "json_parse.h"
 #include "json_stringify.h"
-
-#define MAX_TOKEN_LENGTH		1000
+#include "json_validate.h"
+#include "json_file.h"
+#include "json_arena.h"
+#include "json_walk.h"
 
 json_ret_code_t json_parse(const char* p_data, size_t size, json_object_t* p_object) {
-	// Lex
-	json_token_t *tokens = malloc(MAX_TOKEN_LENGTH * sizeof(json_token_t));
-	uint32_t num_tokens = 0;
-	json_lex_init();
-	json_ret_code_t lex_ret = json_lex(p_data, size, tokens, &num_tokens, MAX_TOKEN_LENGTH);
-	if (lex_ret != JSON_RETVAL_OK) {
-		free(tokens);
-		return lex_ret;
-	}
+	return json_parse_ex(p_data, size, p_object, NULL);
+}
 
-	// Parse
-	json_ret_code_t parse_ret = json_parse_object(tokens, num_tokens, p_object);
-	if (parse_ret != JSON_RETVAL_OK) {
-		free(tokens);
-		return parse_ret;
-	}
+json_ret_code_t json_parse_ex(const char* p_data, size_t size, json_object_t* p_object, json_error_t* p_error) {
+	return json_parse_object_input(p_data, size, JSON_LEX_FLAG_NONE, NULL, NULL, NULL, p_object, p_error);
+}
 
-	free(tokens);
+json_ret_code_t json_parse_interned(const char* p_data, size_t size, json_object_t* p_object, json_key_pool_t* p_key_pool,
+									json_error_t* p_error) {
+	return json_parse_object_input(p_data, size, JSON_LEX_FLAG_NONE, NULL, p_key_pool, NULL, p_object, p_error);
+}
 
-	return JSON_RETVAL_OK;
+json_ret_code_t json_parse_value(const char* p_data, size_t size, json_value_t* p_value, json_value_type_t* p_type,
+								 json_error_t* p_error) {
+	return json_parse_value_input(p_data, size, p_value, p_type, p_error);
+}
+
+json_ret_code_t json_validate(const char* p_data, size_t size, json_error_t* p_error) {
+	return json_validate_document(p_data, size, p_error);
+}
+
+json_ret_code_t json_parse_file(const char* path, json_document_t* p_document, json_error_t* p_error) {
+	return json_file_parse(path, p_document, p_error);
 }
 
 json_value_t* json_object_get_value(const json_object_t* p_object, const char* key) {
@@ -40,8 +45,23 @@ json_value_t* json_object_get_value(const json_object_t* p_object, const char* k
 	}
 
 	for (uint32_t i = 0; i < p_object->num_members; i++) {
-		if (strcmp(p_object->members[i]->key, key) == 0) {
-			return &p_object->members[i]->value;
+		if (strcmp(p_object->members[i].key, key) == 0) {
+			return &p_object->members[i].value;
+		}
+	}
+
+	return NULL;
+}
+
+// Keys of objects parsed with a key pool are compared by address with a key interned in the same pool
+json_value_t* json_object_get_value_interned(const json_object_t* p_object, const char* key) {
+	if (p_object == NULL) {
+		return NULL;
+	}
+
+	for (uint32_t i = 0; i < p_object->num_members; i++) {
+		if (p_object->members[i].key == key) {
+			return &p_object->members[i].value;
 		}
 	}
 
@@ -54,8 +74,8 @@ json_value_type_t json_object_get_value_type(const json_object_t* p_object, cons
 	}
 
 	for (uint32_t i = 0; i < p_object->num_members; i++) {
-		if (strcmp(p_object->members[i]->key, key) == 0) {
-			return p_object->members[i]->type;
+		if (strcmp(p_object->members[i].key, key) == 0) {
+			return p_object->members[i].type;
 		}
 	}
 
@@ -71,7 +91,31 @@ json_value_t* json_value_get_array_member(json_value_t* p_value, uint32_t index)
 		return NULL;
 	}
 
-	return &p_value->array->values[index]->value;
+	// A packed number aliases the number member of a value
+	if (p_value->array->numbers != NULL) {
+		return (json_value_t*) &p_value->array->numbers[index];
+	}
+	return &p_value->array->values[index].value;
+}
+
+json_value_type_t json_value_get_array_member_type(const json_value_t* p_value, uint32_t index) {
+	if (p_value == NULL || index >= p_value->array->length) {
+		return JSON_VALUE_TYPE_UNDEFINED;
+	}
+
+	return p_value->array->numbers != NULL ? JSON_VALUE_TYPE_NUMBER : p_value->array->values[index].type;
+}
+
+// Entries of a packed array without copying them, NULL if the array holds other values than numbers
+const double* json_array_get_numbers(const json_array_t* p_array, size_t* p_length) {
+	if (p_array == NULL || p_array->numbers == NULL) {
+		return NULL;
+	}
+
+	if (p_length != NULL) {
+		*p_length = p_array->length;
+	}
+	return p_array->numbers;
 }
 
 bool json_object_has_key(const json_object_t* p_object, const char* key) {
@@ -80,7 +124,7 @@ bool json_object_has_key(const json_object_t* p_object, const char* key) {
 	}
 
 	for (uint32_t i = 0; i < p_object->num_members; i++) {
-		if (strcmp(p_object->members[i]->key, key) == 0) {
+		if (strcmp(p_object->members[i].key, key) == 0) {
 			return true;
 		}
 	}
@@ -89,47 +133,301 @@ bool json_object_has_key(const json_object_t* p_object, const char* key) {
 }
 
 json_ret_code_t json_object_add_value(json_object_t *p_object, const char* key, json_value_t value, json_value_type_t type) {
-	if (p_object == NULL) {
+	// Members of an arena document cannot grow outside of the arena
+	if (p_object == NULL || p_object->flags & JSON_OBJECT_FLAG_ARENA) {
 		return JSON_RETVAL_INVALID_PARAM;
 	}
 
-	if (p_object->num_members >= JSON_NUM_MEMBERS) {
+	if (json_parse_object_reserve(p_object, NULL) != JSON_RETVAL_OK) {
 		return JSON_RETVAL_FAIL;
 	}
 
-	p_object->members[p_object->num_members] = malloc(sizeof(json_object_member_t));
-	if (p_object->members[p_object->num_members] == NULL) {
+	// Short keys are copied into the member, the value is stored as given
+	json_object_member_t* p_member = &p_object->members[p_object->num_members];
+	size_t key_len = strlen(key);
+	p_member->key = key_len < JSON_INLINE_STRINGS_SIZE ? p_member->inline_strings : malloc(key_len + 1);
+	if (p_member->key == NULL) {
 		return JSON_RETVAL_FAIL;
 	}
 
-	p_object->members[p_object->num_members]->key = malloc(strlen(key) + 1);
-	if (p_object->members[p_object->num_members]->key == NULL) {
-		return JSON_RETVAL_FAIL;
+	memcpy(p_member->key, key, key_len + 1);
+	p_member->flags = JSON_MEMBER_FLAG_NONE;
+	p_member->value = value;
+	p_member->type = type;
+	p_object->num_members++;
+
+	return JSON_RETVAL_OK;
+}
+
+// Owned copy of a string, short strings of an object member stay inline
+static char* json_copy_string(json_object_member_t* p_copy, const json_object_member_t* p_member, const char* p_string) {
+	if (p_member != NULL && JSON_PARSE_IS_INLINE(p_member, p_string)) {
+		return &p_copy->inline_strings[p_string - p_member->inline_strings];
 	}
+	return strdup(p_string);
+}
 
-	strcpy(p_object->members[p_object->num_members]->key, key);
-	p_object->members[p_object->num_members]->value = value;
-	p_object->members[p_object->num_members]->type = type;
-	p_object->num_members++;
+// Containers are copied empty, their entries follow once the walk reaches them
+static bool json_copy_value(json_value_t* p_copy, json_object_member_t* p_copy_member, const json_value_t* p_value,
+							const json_object_member_t* p_member, json_value_type_t type) {
+	switch (type) {
+		case JSON_VALUE_TYPE_STRING:
+			return (p_copy->string = json_copy_string(p_copy_member, p_member, p_value->string)) != NULL;
+		case JSON_VALUE_TYPE_OBJECT:
+			return (p_copy->object = calloc(1, sizeof(json_object_t))) != NULL;
+		case JSON_VALUE_TYPE_ARRAY:
+			return (p_copy->array = calloc(1, sizeof(json_array_t))) != NULL;
+		default:
+			*p_copy = *p_value;
+			return true;
+	}
+}
+
+// Allocates the entries of the copy with their final size and opens the container, packed numbers are copied at once
+static json_ret_code_t json_copy_open(json_walk_t* p_walk, json_value_t value, json_value_type_t type, json_value_t target) {
+	if (type == JSON_VALUE_TYPE_OBJECT) {
+		if (value.object->num_members == 0) {
+			return JSON_RETVAL_OK;
+		}
+		if ((target.object->members = malloc(value.object->num_members * sizeof(json_object_member_t))) == NULL) {
+			return JSON_RETVAL_FAIL;
+		}
+		target.object->max_num_members = value.object->num_members;
+	} else if (value.array->numbers != NULL) {
+		if (value.array->length == 0) {
+			return JSON_RETVAL_OK;
+		}
+		if ((target.array->numbers = malloc(value.array->length * sizeof(double))) == NULL) {
+			return JSON_RETVAL_FAIL;
+		}
+		memcpy(target.array->numbers, value.array->numbers, value.array->length * sizeof(double));
+		target.array->length = target.array->max_length = value.array->length;
+		return JSON_RETVAL_OK;
+	} else {
+		if (value.array->values == NULL || value.array->length == 0) {
+			return JSON_RETVAL_OK;
+		}
+		if ((target.array->values = malloc(value.array->length * sizeof(json_array_member_t))) == NULL) {
+			return JSON_RETVAL_FAIL;
+		}
+		target.array->max_length = value.array->length;
+	}
 
+	json_walk_frame_t* p_frame = json_walk_push(p_walk, value, type);
+	if (p_frame == NULL) {
+		return JSON_RETVAL_FAIL;
+	}
+	p_frame->target = target;
 	return JSON_RETVAL_OK;
 }
 
-json_ret_code_t json_object_free(json_object_t* p_object) {
-	if (p_object == NULL) {
+/*
+ * Deep copy that owns its keys and strings, also when the source borrows them from a mapping or an arena. Interned
+ * keys are shared with the source. The open containers are kept on a heap stack instead of recursing, entries are
+ * counted once they are complete so a partial copy is released with json_object_free.
+ */
+json_ret_code_t json_object_copy(const json_object_t* p_source, json_object_t* p_copy) {
+	if (p_source == NULL || p_copy == NULL) {
 		return JSON_RETVAL_INVALID_PARAM;
 	}
 
-	for (uint32_t i = 0; i < p_object->num_members; i++) {
-		free(p_object->members[i]->key);
-		if (p_object->members[i]->type == JSON_VALUE_TYPE_OBJECT) {
-			json_object_free(p_object->members[i]->value.object);
-		} else if (p_object->members[i]->type == JSON_VALUE_TYPE_ARRAY) {
-			free(p_object->members[i]->value.array);
-		} else if (p_object->members[i]->type == JSON_VALUE_TYPE_STRING) {
-			free(p_object->members[i]->value.string);
+	*p_copy = (json_object_t) {0};
+	json_walk_t walk;
+	json_walk_init(&walk);
+	json_ret_code_t ret = json_copy_open(&walk, (json_value_t) {.object = (json_object_t*) p_source}, JSON_VALUE_TYPE_OBJECT,
+										 (json_value_t) {.object = p_copy});
+
+	json_walk_frame_t* p_frame;
+	while (ret == JSON_RETVAL_OK && (p_frame = json_walk_top(&walk)) != NULL) {
+		bool is_object = p_frame->type == JSON_VALUE_TYPE_OBJECT;
+		if (p_frame->index == (is_object ? p_frame->value.object->num_members : p_frame->value.array->length)) {
+			walk.depth--;
+			continue;
+		}
+
+		uint32_t index = p_frame->index++;
+		json_value_t child;
+		json_value_t child_copy;
+		json_value_type_t type;
+		if (is_object) {
+			const json_object_member_t* p_member = &p_frame->value.object->members[index];
+			json_object_member_t* p_copy_member = &p_frame->target.object->members[index];
+			*p_copy_member = *p_member;
+			if (!(p_member->flags & JSON_MEMBER_FLAG_INTERNED_KEY) &&
+				(p_copy_member->key = json_copy_string(p_copy_member, p_member, p_member->key)) == NULL) {
+				ret = JSON_RETVAL_FAIL;
+				break;
+			}
+			if (!json_copy_value(&p_copy_member->value, p_copy_member, &p_member->value, p_member, p_member->type)) {
+				if (!(p_member->flags & JSON_MEMBER_FLAG_INTERNED_KEY) && !JSON_PARSE_IS_INLINE(p_copy_member, p_copy_member->key)) {
+					free(p_copy_member->key);
+				}
+				ret = JSON_RETVAL_FAIL;
+				break;
+			}
+			if (p_member->type == JSON_VALUE_TYPE_OBJECT) {
+				p_copy_member->value.object->parent = p_frame->target.object;
+			}
+			p_frame->target.object->num_members++;
+			child = p_member->value;
+			child_copy = p_copy_member->value;
+			type = p_member->type;
+		} else {
+			const json_array_member_t* p_entry = &p_frame->value.array->values[index];
+			json_array_member_t* p_copy_entry = &p_frame->target.array->values[index];
+			p_copy_entry->type = p_entry->type;
+			if (!json_copy_value(&p_copy_entry->value, NULL, &p_entry->value, NULL, p_entry->type)) {
+				ret = JSON_RETVAL_FAIL;
+				break;
+			}
+			p_frame->target.array->length++;
+			child = p_entry->value;
+			child_copy = p_copy_entry->value;
+			type = p_entry->type;
+		}
+
+		if (type == JSON_VALUE_TYPE_OBJECT || type == JSON_VALUE_TYPE_ARRAY) {
+			ret = json_copy_open(&walk, child, type, child_copy);
 		}
-		free(p_object->members[i]);
+	}
+
+	json_walk_free(&walk);
+	if (ret != JSON_RETVAL_OK) {
+		json_object_free(p_copy);
+	}
+	return ret;
+}
+
+// Container value that the free walk descends into, partially built trees may hold unallocated ones
+#define JSON_IS_CONTAINER(value, type) \
+	(((type) == JSON_VALUE_TYPE_OBJECT && (value).object != NULL) || ((type) == JSON_VALUE_TYPE_ARRAY && (value).array != NULL))
+
+/*
+ * Frees the tree of a root container without recursion and without memory of its own. Entries are released from the
+ * last one, the count of a container is the cursor. Before descending into a child container, the slot of the child is
+ * overwritten with the link to the grandparent. Once the child is released, the slot right behind the count of the
+ * parent holds that link again. A root object owned by the caller is emptied instead of freed.
+ */
+static void json_free_tree(json_value_t root, json_value_type_t root_type, bool is_root_owned) {
+	json_value_t current = root;
+	json_value_type_t type = root_type;
+	json_value_t parent = {0};
+	json_value_type_t parent_type = JSON_VALUE_TYPE_UNDEFINED;
+
+	for (;;) {
+		json_value_t* p_slot = NULL;
+		json_value_type_t* p_slot_type = NULL;
+		if (type == JSON_VALUE_TYPE_OBJECT) {
+			json_object_t* p_object = current.object;
+			while (p_slot == NULL && p_object->num_members > 0) {
+				json_object_member_t* p_member = &p_object->members[--p_object->num_members];
+				if (!JSON_PARSE_IS_INLINE(p_member, p_member->key) &&
+					!(p_member->flags & JSON_MEMBER_FLAG_INTERNED_KEY)) {
+					free(p_member->key);
+				}
+				if (JSON_IS_CONTAINER(p_member->value, p_member->type)) {
+					p_slot = &p_member->value;
+					p_slot_type = &p_member->type;
+				} else if (p_member->type == JSON_VALUE_TYPE_STRING && !JSON_PARSE_IS_INLINE(p_member, p_member->value.string)) {
+					free(p_member->value.string);
+				}
+			}
+		} else {
+			json_array_t* p_array = current.array;
+			while (p_slot == NULL && p_array->values != NULL && p_array->length > 0) {
+				json_array_member_t* p_entry = &p_array->values[--p_array->length];
+				if (JSON_IS_CONTAINER(p_entry->value, p_entry->type)) {
+					p_slot = &p_entry->value;
+					p_slot_type = &p_entry->type;
+				} else if (p_entry->type == JSON_VALUE_TYPE_STRING) {
+					free(p_entry->value.string);
+				}
+			}
+		}
+
+		if (p_slot != NULL) {
+			json_value_t child = *p_slot;
+			json_value_type_t child_type = *p_slot_type;
+			*p_slot = parent;
+			*p_slot_type = parent_type;
+			parent = current;
+			parent_type = type;
+			current = child;
+			type = child_type;
+			continue;
+		}
+
+		// Every entry is released, the container itself follows
+		if (type == JSON_VALUE_TYPE_OBJECT) {
+			free(current.object->members);
+			if (current.object != root.object || !is_root_owned) {
+				free(current.object);
+			}
+		} else {
+			free(current.array->values);
+			free(current.array->numbers);
+			free(current.array);
+		}
+		if (parent_type == JSON_VALUE_TYPE_UNDEFINED) {
+			break;
+		}
+
+		current = parent;
+		type = parent_type;
+		if (type == JSON_VALUE_TYPE_OBJECT) {
+			parent = current.object->members[current.object->num_members].value;
+			parent_type = current.object->members[current.object->num_members].type;
+		} else {
+			parent = current.array->values[current.array->length].value;
+			parent_type = current.array->values[current.array->length].type;
+		}
+	}
+
+	if (is_root_owned) {
+		root.object->members = NULL;
+		root.object->num_members = 0;
+		root.object->max_num_members = 0;
+	}
+}
+
+json_ret_code_t json_object_free(json_object_t* p_object) {
+	// Arena documents are released by json_document_free
+	if (p_object == NULL || p_object->flags & JSON_OBJECT_FLAG_ARENA) {
+		return JSON_RETVAL_INVALID_PARAM;
+	}
+
+	json_free_tree((json_value_t) {.object = p_object}, JSON_VALUE_TYPE_OBJECT, true);
+
+	return JSON_RETVAL_OK;
+}
+
+json_ret_code_t json_value_free(json_value_t* p_value, json_value_type_t type) {
+	if (p_value == NULL) {
+		return JSON_RETVAL_INVALID_PARAM;
+	}
+
+	if (JSON_IS_CONTAINER(*p_value, type)) {
+		json_free_tree(*p_value, type, false);
+	} else if (type == JSON_VALUE_TYPE_STRING) {
+		free(p_value->string);
+	}
+	*p_value = (json_value_t) {0};
+
+	return JSON_RETVAL_OK;
+}
+
+json_ret_code_t json_document_free(json_document_t* p_document) {
+	if (p_document == NULL) {
+		return JSON_RETVAL_INVALID_PARAM;
+	}
+
+	// An arena holds every node and string of the tree, there is nothing to walk
+	if (p_document->p_arena != NULL) {
+		json_arena_free(p_document->p_arena);
+		p_document->p_arena = NULL;
+		p_document->root = (json_object_t) {0};
+	} else {
+		json_free_tree((json_value_t) {.object = &p_document->root}, JSON_VALUE_TYPE_OBJECT, true);
 	}
 
 	return JSON_RETVAL_OK;
@@ -142,3 +440,11 @@ char *json_stringify(const json_object_t* p_object) {
 char *json_stringify_pretty(const json_object_t* p_object) {
 	return json_object_stringify(p_object, true);
 }
+
+char *json_stringify_parallel(const json_object_t* p_object, bool pretty, json_pool_t* p_pool) {
+	return json_object_stringify_parallel(p_object, pretty, p_pool);
+}
+
+json_ret_code_t json_stringify_write(int fd, const json_object_t* p_object, bool pretty, json_pool_t* p_pool) {
+	return json_object_stringify_write(fd, p_object, pretty, p_pool);
+}
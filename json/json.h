@@ -10,7 +10,7 @@
 #include <stdint.h>
 #include <string.h>
 
-#define JSON_NUM_MEMBERS	10000
+#define JSON_INLINE_STRINGS_SIZE	19	// Fills the padding of an object member up to 40 bytes
 
 typedef enum {
 	JSON_RETVAL_OK,
@@ -32,6 +32,27 @@ typedef enum {
 	JSON_VALUE_TYPE_OBJECT,
 } json_value_type_t;
 
+typedef enum {
+	JSON_ERROR_NONE,
+	JSON_ERROR_UNEXPECTED_EOF,
+	JSON_ERROR_UNEXPECTED_TOKEN,
+	JSON_ERROR_EXPECTED_DIGIT,
+	JSON_ERROR_NAN,
+	JSON_ERROR_ILLEGAL_ESCAPE_SEQUENCE,
+	JSON_ERROR_INVALID_UNICODE_CHAR,
+	JSON_ERROR_CONTROL_CHAR,
+	JSON_ERROR_MAX_NESTING_LEVEL,
+	JSON_ERROR_OUT_OF_MEMORY,
+	JSON_ERROR_FILE_ACCESS,
+	JSON_ERROR_SCHEMA,
+} json_error_code_t;
+
+typedef struct {
+	json_error_code_t code;
+	uint64_t offset;
+	const char* expected;
+} json_error_t;
+
 typedef union json_value_t json_value_t;
 typedef struct json_object_t json_object_t;
 typedef struct json_array_t json_array_t;
@@ -44,44 +65,446 @@ union json_value_t {
 	struct json_object_t* object;
 };
 
+// 16-byte cell, the entries of a container are stored contiguously
 typedef struct {
 	json_value_t value;
 	json_value_type_t type;
 } json_array_member_t;
 
+// Arrays of numbers only are packed, numbers then holds the entries instead of values
 struct json_array_t {
-	json_array_member_t* values[JSON_NUM_MEMBERS];
+	json_array_member_t* values;
+	double* numbers;
 	size_t length;
+	size_t max_length;
 };
 
+#define JSON_MEMBER_FLAG_NONE			0x00
+#define JSON_MEMBER_FLAG_INTERNED_KEY	0x01	// The key belongs to a json_key_pool_t and is not freed with the member
+
+// Short keys and string values are stored in inline_strings, key and value.string then point into it and move with the member
 typedef struct {
 	char* key;
 	json_value_t value;
 	json_value_type_t type;
+	uint8_t flags;
+	char inline_strings[JSON_INLINE_STRINGS_SIZE];
 } json_object_member_t;
 
+#define JSON_OBJECT_FLAG_NONE			0x00
+#define JSON_OBJECT_FLAG_ARENA			0x01	// Members live in the arena of a document, the object is read-only
+
 struct json_object_t {
-	json_object_member_t* members[JSON_NUM_MEMBERS];
+	json_object_member_t* members;
 	uint32_t num_members;
+	uint32_t max_num_members;
 	struct json_object_t* parent;
+	uint8_t flags;
 };
 
+typedef struct json_arena_t json_arena_t;
+
+// Interned keys shared by documents and threads, it has to outlive every document parsed with it
+typedef struct json_key_pool_t json_key_pool_t;
+
+// Parsed file or batch input, string values and keys of a batch document live in its arena while the document is alive.
+// Documents with an arena are read-only, json_object_add_value and json_object_free reject their objects, copy them to modify.
+typedef struct {
+	json_object_t root;
+	json_arena_t* p_arena;	// Owns the whole tree when set
+} json_document_t;
+
+typedef struct json_parser_t json_parser_t;
+
+#define JSON_NDJSON_DEFAULT_BLOCK_SIZE	(64 * 1024)
+
+// One line of newline-delimited JSON, p_object is NULL and error is set when the line failed to parse
+typedef struct {
+	uint64_t offset;
+	size_t length;
+	json_object_t* p_object;
+	json_ret_code_t ret;
+	json_error_t error;
+} json_ndjson_record_t;
+
+// Records are released after the callback returns, any other return value than JSON_RETVAL_OK stops parsing
+typedef json_ret_code_t (*json_ndjson_callback_fn)(const json_ndjson_record_t* p_record, void* p_context);
+
+typedef struct {
+	uint32_t num_threads;	// 0 for one thread per online CPU
+	size_t block_size;		// Bytes claimed by a worker at once, 0 for JSON_NDJSON_DEFAULT_BLOCK_SIZE
+	bool unordered;			// Deliver records as soon as they are parsed, the callback is then called concurrently
+} json_ndjson_options_t;
+
+typedef struct json_pool_t json_pool_t;
+
+#define JSON_PARALLEL_DEFAULT_CHUNK_SIZE	(1024 * 1024)
+
+typedef struct {
+	json_pool_t* p_pool;	// Pool running the tasks, NULL for a pool that lives for the call only
+	size_t chunk_size;		// Bytes of array elements per task, 0 for JSON_PARALLEL_DEFAULT_CHUNK_SIZE
+} json_parallel_options_t;
+
+// One document of a batch, the data is copied and may be released once json_parse_batch returns
+typedef struct {
+	const char* p_data;
+	size_t size;
+} json_input_t;
+
+// Read-only document in one contiguous tape of 64-bit words, strings live in a separate buffer
+typedef struct {
+	uint64_t* words;
+	size_t num_words;
+	size_t max_num_words;
+	char* strings;
+	size_t strings_length;
+	size_t max_strings_length;
+} json_tape_t;
+
+// Value on a tape, index 0 is not a value and marks a missing one
+typedef struct {
+	const json_tape_t* p_tape;
+	size_t index;
+} json_tape_value_t;
+
+// Iterates the entries of an object or array in order
+typedef struct {
+	const json_tape_t* p_tape;
+	size_t index;
+	bool is_object;
+} json_tape_iter_t;
+
+// Compiled JSON Pointer or JSONPath expression, see json_path.c
+typedef struct json_path_t json_path_t;
+
+// JSON Pointer or JSONPath expressions compiled into one automaton for json_select, see json_select.c
+typedef struct json_selector_t json_selector_t;
+
+// Value matched by a selector, only scalars are decoded, strings point into a buffer that is valid during the callback
+typedef struct {
+	size_t selector;			// Index of the expression passed to json_selector_compile
+	json_value_type_t type;
+	uint64_t offset;			// Extent of the value in the input
+	size_t length;
+	json_value_t value;
+	size_t string_length;
+} json_select_match_t;
+
+// Any other return value than JSON_RETVAL_OK stops the pass and is returned by json_select
+typedef json_ret_code_t (*json_select_callback_fn)(const json_select_match_t* p_match, void* p_context);
+
+typedef enum {
+	JSON_INDEX_TYPE_HASH,		// Point lookups
+	JSON_INDEX_TYPE_SORTED,		// Point lookups and range scans
+} json_index_type_t;
+
+// Index over the rows of an array of objects or an object of objects by one field, see json_index.c
+typedef struct json_index_t json_index_t;
+
+// Subset of JSON Schema compiled for json_parse_schema, see json_schema.c
+typedef struct json_schema_t json_schema_t;
+
+#define JSON_SCHEMA_MAX_POINTER		256
+
+// Syntax error or schema violation, on a violation error.expected is the keyword that failed
+typedef struct {
+	json_error_t error;
+	char pointer[JSON_SCHEMA_MAX_POINTER];	// JSON Pointer of the failing value, truncated to fit
+} json_schema_error_t;
+
+typedef enum {
+	JSON_FIELD_TYPE_DOUBLE,
+	JSON_FIELD_TYPE_INT64,		// Numbers with a fraction or exponent or out of range are an error
+	JSON_FIELD_TYPE_INT32,
+	JSON_FIELD_TYPE_BOOL,
+	JSON_FIELD_TYPE_STRING,		// char array in the struct, strings that do not fit are an error
+	JSON_FIELD_TYPE_OBJECT,		// Nested struct described by p_desc
+} json_field_type_t;
+
+typedef struct json_struct_desc_t json_struct_desc_t;
+
+// Member of a struct and the key it is stored under, created with the JSON_STRUCT_FIELD macros
+typedef struct {
+	const char* key;
+	size_t key_length;
+	const char* fragment;	// Key as written by json_encode_struct, quoted and followed by ':'
+	size_t fragment_length;
+	size_t offset;
+	size_t size;
+	json_field_type_t type;
+	const json_struct_desc_t* p_desc;
+} json_field_desc_t;
+
+// Receives output in order, any other return value than JSON_RETVAL_OK stops writing and is returned
+typedef json_ret_code_t (*json_sink_fn)(const char* p_data, size_t length, void* p_context);
+
+// Writes JSON from a sequence of calls without building a tree, see json_writer.c
+typedef struct json_writer_t json_writer_t;
+
+// Mapping of a struct to the members of an object, created with JSON_STRUCT_DESC, the lookup table is filled on first use
+struct json_struct_desc_t {
+	const json_field_desc_t* fields;
+	uint32_t num_fields;
+	uint64_t* hashes;
+	uint16_t* slots;	// Field position + 1 by key hash, 0 for an empty slot
+	uint32_t num_slots;
+	bool is_compiled;
+};
+
+// json_key has to be a string literal, keys that would need escaping are rejected when the descriptor is first used
+#define JSON_STRUCT_FIELD_KEY(struct_type, member, json_key, field_type) \
+	{.key = (json_key), .key_length = sizeof(json_key) - 1, .fragment = "\"" json_key "\":", \
+	 .fragment_length = sizeof(json_key) + 2, .offset = offsetof(struct_type, member), \
+	 .size = sizeof(((struct_type*) 0)->member), .type = (field_type)}
+#define JSON_STRUCT_FIELD(struct_type, member, field_type) JSON_STRUCT_FIELD_KEY(struct_type, member, #member, field_type)
+#define JSON_STRUCT_FIELD_OBJECT(struct_type, member, p_nested_desc) \
+	{.key = #member, .key_length = sizeof(#member) - 1, .fragment = "\"" #member "\":", \
+	 .fragment_length = sizeof(#member) + 2, .offset = offsetof(struct_type, member), \
+	 .size = sizeof(((struct_type*) 0)->member), .type = JSON_FIELD_TYPE_OBJECT, .p_desc = (p_nested_desc)}
+
+// Power of two with at least twice as many slots as fields, up to 1024 slots
+#define JSON_STRUCT_NUM_SLOTS(num_fields) \
+	((num_fields) <= 4 ? 8 : (num_fields) <= 8 ? 16 : (num_fields) <= 16 ? 32 : (num_fields) <= 32 ? 64 : \
+	 (num_fields) <= 64 ? 128 : (num_fields) <= 128 ? 256 : (num_fields) <= 256 ? 512 : 1024)
+
+// Declares the descriptor name with the given fields, at most 512 of them
+#define JSON_STRUCT_DESC(name, ...) \
+	static const json_field_desc_t name ## _fields[] = {__VA_ARGS__}; \
+	static uint64_t name ## _hashes[sizeof(name ## _fields) / sizeof(json_field_desc_t)]; \
+	static uint16_t name ## _slots[JSON_STRUCT_NUM_SLOTS(sizeof(name ## _fields) / sizeof(json_field_desc_t))]; \
+	static json_struct_desc_t name = { \
+		.fields = name ## _fields, .num_fields = sizeof(name ## _fields) / sizeof(json_field_desc_t), \
+		.hashes = name ## _hashes, .slots = name ## _slots, \
+		.num_slots = JSON_STRUCT_NUM_SLOTS(sizeof(name ## _fields) / sizeof(json_field_desc_t)), \
+	}
+
+typedef enum {
+	JSON_COLUMN_TYPE_NUMBER,	// numbers
+	JSON_COLUMN_TYPE_INT64,		// integers, numbers with a fraction or exponent or out of range are null
+	JSON_COLUMN_TYPE_STRING,	// string_offsets and strings
+} json_column_type_t;
+
+// One field of every row of an array of objects, missing fields, JSON null and values of another type are null
+typedef struct {
+	const char* path;			// Key of the field in a row, keys of nested objects are separated by '.'
+	json_column_type_t type;
+	double* numbers;
+	int64_t* integers;
+	uint64_t* string_offsets;	// Row i spans strings[string_offsets[i]] up to string_offsets[i + 1], not terminated
+	char* strings;
+	size_t strings_length;
+	uint8_t* null_bitmap;		// Bit i % 8 of byte i / 8 is set when row i is null
+	size_t num_nulls;
+} json_column_t;
+
 #define json_parse_string(string, name) \
 	json_object_t name; \
 	json_ret_code_t name ## _return = json_parse(string, strlen(string), &(name));
 
+// A failed parse leaves the tree built so far in *p_object, *p_value or the object of json_parser_new, the caller
+// releases it like a complete one with json_object_free or json_value_free. json_parse_file and json_parse_batch
+// release their documents themselves.
 json_ret_code_t json_parse(const char* p_data, size_t size, json_object_t* p_object);
+json_ret_code_t json_parse_ex(const char* p_data, size_t size, json_object_t* p_object, json_error_t* p_error);
+json_ret_code_t json_parse_interned(const char* p_data, size_t size, json_object_t* p_object, json_key_pool_t* p_key_pool,
+									json_error_t* p_error);
+json_ret_code_t json_parse_value(const char* p_data, size_t size, json_value_t* p_value, json_value_type_t* p_type,
+								 json_error_t* p_error);
+json_ret_code_t json_validate(const char* p_data, size_t size, json_error_t* p_error);
+json_ret_code_t json_parse_schema(const char* p_data, size_t size, const json_schema_t* p_schema, json_object_t* p_object,
+								  json_schema_error_t* p_error);
+json_parser_t* json_parser_new(json_object_t* p_object);
+json_ret_code_t json_parser_feed(json_parser_t* p_parser, const char* p_chunk, size_t chunk_len);
+json_ret_code_t json_parser_finish(json_parser_t* p_parser, json_error_t* p_error);
+void json_parser_free(json_parser_t* p_parser);
+json_ret_code_t json_parse_ndjson(const char* p_data, size_t size, const json_ndjson_options_t* p_options,
+								  json_ndjson_callback_fn callback, void* p_context);
+json_ret_code_t json_parse_parallel(const char* p_data, size_t size, json_object_t* p_object,
+									const json_parallel_options_t* p_options, json_error_t* p_error);
+json_ret_code_t json_parse_batch(const json_input_t* inputs, size_t num_inputs, json_document_t* outputs,
+								 json_error_t* p_errors, json_pool_t* p_pool);
+json_ret_code_t json_parse_tape(const char* p_data, size_t size, json_tape_t* p_tape, json_error_t* p_error);
+json_ret_code_t json_parse_file(const char* path, json_document_t* p_document, json_error_t* p_error);
+json_ret_code_t json_decode_struct(const char* p_data, size_t size, json_struct_desc_t* p_desc, void* p_out, json_error_t* p_error);
+json_ret_code_t json_encode_struct(json_struct_desc_t* p_desc, const void* p_in, json_sink_fn sink, void* p_context);
 
+json_writer_t* json_writer_new(json_sink_fn sink, void* p_context);
+json_ret_code_t json_writer_begin_object(json_writer_t* p_writer);
+json_ret_code_t json_writer_end_object(json_writer_t* p_writer);
+json_ret_code_t json_writer_begin_array(json_writer_t* p_writer);
+json_ret_code_t json_writer_end_array(json_writer_t* p_writer);
+json_ret_code_t json_writer_key(json_writer_t* p_writer, const char* key);
+json_ret_code_t json_writer_string(json_writer_t* p_writer, const char* string);
+json_ret_code_t json_writer_string_length(json_writer_t* p_writer, const char* string, size_t length);
+json_ret_code_t json_writer_int(json_writer_t* p_writer, int64_t integer);
+json_ret_code_t json_writer_double(json_writer_t* p_writer, double number);
+json_ret_code_t json_writer_bool(json_writer_t* p_writer, bool boolean);
+json_ret_code_t json_writer_null(json_writer_t* p_writer);
+json_ret_code_t json_writer_finish(json_writer_t* p_writer);
+const char* json_writer_get_output(json_writer_t* p_writer, size_t* p_length);
+void json_writer_reset(json_writer_t* p_writer);
+void json_writer_free(json_writer_t* p_writer);
+json_ret_code_t json_extract_columns(const char* p_data, size_t size, const char* array_path, json_column_t* columns,
+									 size_t num_columns, size_t* p_num_rows, json_error_t* p_error);
+
+json_pool_t* json_pool_new(uint32_t num_threads);
+void json_pool_free(json_pool_t* p_pool);
+
+json_key_pool_t* json_key_pool_new(void);
+const char* json_key_pool_intern(json_key_pool_t* p_pool, const char* key, size_t length);
+size_t json_key_pool_get_num_keys(json_key_pool_t* p_pool);
+void json_key_pool_free(json_key_pool_t* p_pool);
+
+const char* json_error_get_str(json_error_code_t code);
+void json_error_get_position(const char* p_data, size_t size, const json_error_t* p_error, uint64_t* p_line, uint64_t* p_column);
+void json_error_print(const char* p_data, size_t size, const json_error_t* p_error);
+
+// Values point into the members of their object, they move when json_object_add_value grows the object. Short strings
+// are stored inside the member and move along, longer ones stay where they are.
 json_value_t* json_object_get_value(const json_object_t* p_object, const char* key);
 json_value_t* json_value_get_array_member(json_value_t* p_value, uint32_t index);
+json_value_type_t json_value_get_array_member_type(const json_value_t* p_value, uint32_t index);
+const double* json_array_get_numbers(const json_array_t* p_array, size_t* p_length);
+json_value_t* json_object_get_value_interned(const json_object_t* p_object, const char* key);
 json_value_type_t json_object_get_value_type(const json_object_t* p_object, const char* key);
 bool json_object_has_key(const json_object_t* p_object, const char* key);
 
+json_path_t* json_path_compile(const char* expression);
+json_value_t* json_path_eval(json_path_t* p_path, const json_object_t* p_object, json_value_type_t* p_type);
+size_t json_path_eval_batch(json_path_t* const* paths, size_t num_paths, const json_object_t* p_object, json_value_t** values,
+							json_value_type_t* types);
+void json_path_free(json_path_t* p_path);
+
+json_selector_t* json_selector_compile(const char* const* expressions, size_t num_expressions);
+json_ret_code_t json_select(const char* p_data, size_t size, const json_selector_t* p_selector, json_select_callback_fn callback,
+							void* p_context, json_error_t* p_error);
+void json_selector_free(json_selector_t* p_selector);
+
+json_index_t* json_index_new(const json_value_t* p_container, json_value_type_t container_type, const char* field,
+							 json_index_type_t type);
+json_object_t* json_index_find(json_index_t* p_index, json_value_t key, json_value_type_t key_type);
+size_t json_index_range(json_index_t* p_index, json_value_t lower, json_value_t upper, json_value_type_t key_type,
+						json_object_t** rows, size_t max_rows);
+json_ret_code_t json_index_rebuild(json_index_t* p_index);
+void json_index_free(json_index_t* p_index);
+
+json_schema_t* json_schema_compile(const char* p_data, size_t size);
+void json_schema_free(json_schema_t* p_schema);
+
+json_tape_value_t json_tape_get_root(const json_tape_t* p_tape);
+json_tape_value_t json_tape_object_get_value(json_tape_value_t object, const char* key);
+json_tape_value_t json_tape_value_get_array_member(json_tape_value_t array, uint32_t index);
+uint32_t json_tape_value_get_length(json_tape_value_t value);
+json_tape_iter_t json_tape_iter_begin(json_tape_value_t container);
+
 json_ret_code_t json_object_add_value(json_object_t *p_object, const char* key, json_value_t value, json_value_type_t type);
+json_ret_code_t json_object_copy(const json_object_t* p_source, json_object_t* p_copy);
 
 json_ret_code_t json_object_free(json_object_t* p_object);
+json_ret_code_t json_value_free(json_value_t* p_value, json_value_type_t type);
+json_ret_code_t json_document_free(json_document_t* p_document);
+void json_tape_free(json_tape_t* p_tape);
+void json_columns_free(json_column_t* columns, size_t num_columns);
 
 char *json_stringify(const json_object_t* p_object);
 char *json_stringify_pretty(const json_object_t* p_object);
+char *json_stringify_parallel(const json_object_t* p_object, bool pretty, json_pool_t* p_pool);
+json_ret_code_t json_stringify_write(int fd, const json_object_t* p_object, bool pretty, json_pool_t* p_pool);
+
+// Tape word layout, see json_tape.c
+#define JSON_TAPE_TYPE(word)			((char) ((word) >> 56))
+#define JSON_TAPE_PAYLOAD(word)			((word) & 0x00FFFFFFFFFFFFFFull)
+#define JSON_TAPE_END_INDEX(word)		((size_t) ((word) & 0xFFFFFFFFull))
+
+// Walking a tape calls these for every value, they are inline so that the walk compiles to a tight loop
+static inline char json_tape_get_type_char(json_tape_value_t value) {
+	if (value.p_tape == NULL || value.index == 0 || value.index >= value.p_tape->num_words) {
+		return '\0';
+	}
+	return JSON_TAPE_TYPE(value.p_tape->words[value.index]);
+}
+
+// Index of the value behind the one at index
+static inline size_t json_tape_skip(const json_tape_t* p_tape, size_t index) {
+	uint64_t word = p_tape->words[index];
+	char type = JSON_TAPE_TYPE(word);
+	// Branches instead of arithmetic on the type, predicted branches keep the walk from waiting on each load
+	if (type == 'd') {
+		return index + 2;
+	}
+	if (type == '{' || type == '[') {
+		return JSON_TAPE_END_INDEX(word);
+	}
+	return index + 1;
+}
+
+static inline const char* json_tape_get_string(const json_tape_t* p_tape, size_t index, size_t* p_length) {
+	size_t offset = JSON_TAPE_PAYLOAD(p_tape->words[index]);
+	uint32_t length;
+	memcpy(&length, &p_tape->strings[offset], sizeof(uint32_t));
+	if (p_length != NULL) {
+		*p_length = length;
+	}
+	return &p_tape->strings[offset + sizeof(uint32_t)];
+}
+
+static inline json_value_type_t json_tape_value_get_type(json_tape_value_t value) {
+	switch (json_tape_get_type_char(value)) {
+		case '{': return JSON_VALUE_TYPE_OBJECT;
+		case '[': return JSON_VALUE_TYPE_ARRAY;
+		case '"': return JSON_VALUE_TYPE_STRING;
+		case 'd': return JSON_VALUE_TYPE_NUMBER;
+		case 't':
+		case 'f': return JSON_VALUE_TYPE_BOOLEAN;
+		case 'n': return JSON_VALUE_TYPE_NULL;
+		default: return JSON_VALUE_TYPE_UNDEFINED;
+	}
+}
+
+static inline double json_tape_value_get_number(json_tape_value_t value) {
+	if (json_tape_get_type_char(value) != 'd') {
+		return 0.0;
+	}
+	double number;
+	memcpy(&number, &value.p_tape->words[value.index + 1], sizeof(number));
+	return number;
+}
+
+static inline bool json_tape_value_get_boolean(json_tape_value_t value) {
+	return json_tape_get_type_char(value) == 't';
+}
+
+static inline const char* json_tape_value_get_string(json_tape_value_t value, size_t* p_length) {
+	if (json_tape_get_type_char(value) != '"') {
+		return NULL;
+	}
+	return json_tape_get_string(value.p_tape, value.index, p_length);
+}
+
+static inline bool json_tape_iter_next(json_tape_iter_t* p_iter, json_tape_value_t* p_value, const char** p_key) {
+	if (p_iter->p_tape == NULL) {
+		return false;
+	}
+	char type = JSON_TAPE_TYPE(p_iter->p_tape->words[p_iter->index]);
+	if (type == '}' || type == ']') {
+		return false;
+	}
+	size_t index = p_iter->index;
+	if (p_iter->is_object) {
+		if (p_key != NULL) {
+			*p_key = json_tape_get_string(p_iter->p_tape, index, NULL);
+		}
+		index++;
+	}
+	if (p_value != NULL) {
+		*p_value = (json_tape_value_t) {.p_tape = p_iter->p_tape, .index = index};
+	}
+	p_iter->index = json_tape_skip(p_iter->p_tape, index);
+	return true;
+}
+
+static inline bool json_column_is_null(const json_column_t* p_column, size_t row) {
+	return (p_column->null_bitmap[row / 8] >> (row % 8)) & 1;
+}
 
 #endif //JSON_PARSER_JSON_H
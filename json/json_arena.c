@@ -0,0 +1,124 @@
+#include <stdlib.h>
+#include <string.h>
+#include "json_arena.h"
+#include "json_lex.h"
+
+/*
+ * Bump allocator owning every allocation of one document. Allocations are carved from the current block, a new
+ * block is linked in when it runs out. Requests larger than a block get a block of their own that is linked in
+ * behind the current one, so the remaining space of the current block is not lost. Nothing is freed on its own,
+ * the whole tree is released at once by json_arena_free.
+ */
+
+#define JSON_ARENA_ALIGNMENT	16
+
+typedef struct json_arena_block_t {
+	struct json_arena_block_t* p_next;
+	size_t size;
+	size_t used;
+	char data[] __attribute__((aligned(JSON_ARENA_ALIGNMENT)));
+} json_arena_block_t;
+
+struct json_arena_t {
+	json_arena_block_t* p_head;
+	size_t block_size;
+};
+
+static json_arena_block_t* json_arena_block_new(size_t size) {
+	json_arena_block_t* p_block = malloc(sizeof(json_arena_block_t) + size);
+	if (p_block == NULL) {
+		return NULL;
+	}
+	p_block->p_next = NULL;
+	p_block->size = size;
+	p_block->used = 0;
+	return p_block;
+}
+
+json_arena_t* json_arena_new(size_t block_size) {
+	json_arena_t* p_arena = malloc(sizeof(json_arena_t));
+	if (p_arena == NULL) {
+		return NULL;
+	}
+	p_arena->block_size = MAX(block_size, (size_t) JSON_ARENA_MIN_BLOCK_SIZE);
+	p_arena->p_head = json_arena_block_new(p_arena->block_size);
+	if (p_arena->p_head == NULL) {
+		free(p_arena);
+		return NULL;
+	}
+	return p_arena;
+}
+
+void* json_arena_alloc(json_arena_t* p_arena, size_t size) {
+	size = (size + JSON_ARENA_ALIGNMENT - 1) & ~((size_t) JSON_ARENA_ALIGNMENT - 1);
+	json_arena_block_t* p_head = p_arena->p_head;
+	if (p_head->size - p_head->used >= size) {
+		void* p_data = &p_head->data[p_head->used];
+		p_head->used += size;
+		return p_data;
+	}
+
+	if (size > p_arena->block_size / 4) {
+		json_arena_block_t* p_block = json_arena_block_new(size);
+		if (p_block == NULL) {
+			return NULL;
+		}
+		p_block->used = size;
+		p_block->p_next = p_head->p_next;
+		p_head->p_next = p_block;
+		return p_block->data;
+	}
+
+	json_arena_block_t* p_block = json_arena_block_new(p_arena->block_size);
+	if (p_block == NULL) {
+		return NULL;
+	}
+	p_block->used = size;
+	p_block->p_next = p_head;
+	p_arena->p_head = p_block;
+	return p_block->data;
+}
+
+void* json_arena_calloc(json_arena_t* p_arena, size_t size) {
+	void* p_data = json_arena_alloc(p_arena, size);
+	if (p_data != NULL) {
+		memset(p_data, 0, size);
+	}
+	return p_data;
+}
+
+void* json_arena_resize(json_arena_t* p_arena, void* p_entries, size_t num_entries, size_t max_num_entries, size_t entry_size) {
+	void* p_new;
+	if (p_arena == NULL) {
+		p_new = realloc(p_entries, max_num_entries * entry_size);
+	} else {
+		// The latest allocation of the head block grows in place, others are copied and their old space is lost
+		json_arena_block_t* p_head = p_arena->p_head;
+		size_t old_size = (num_entries * entry_size + JSON_ARENA_ALIGNMENT - 1) & ~((size_t) JSON_ARENA_ALIGNMENT - 1);
+		size_t new_size = (max_num_entries * entry_size + JSON_ARENA_ALIGNMENT - 1) & ~((size_t) JSON_ARENA_ALIGNMENT - 1);
+		if (p_entries != NULL && (char*) p_entries + old_size == &p_head->data[p_head->used] &&
+			p_head->used - old_size + new_size <= p_head->size) {
+			p_head->used += new_size - old_size;
+			p_new = p_entries;
+		} else if ((p_new = json_arena_alloc(p_arena, new_size)) != NULL && num_entries > 0) {
+			memcpy(p_new, p_entries, num_entries * entry_size);
+		}
+	}
+	if (p_new != NULL) {
+		memset((char*) p_new + num_entries * entry_size, 0, (max_num_entries - num_entries) * entry_size);
+	}
+	return p_new;
+}
+
+void json_arena_free(json_arena_t* p_arena) {
+	if (p_arena == NULL) {
+		return;
+	}
+	json_arena_block_t* p_block = p_arena->p_head;
+	while (p_block != NULL) {
+		json_arena_block_t* p_next = p_block->p_next;
+		free(p_block);
+		p_block = p_next;
+	}
+	free(p_arena);
+}
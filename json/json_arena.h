@@ -0,0 +1,18 @@
+#ifndef JSON_PARSER_JSON_ARENA_H
+#define JSON_PARSER_JSON_ARENA_H
+
+#include "json.h"
+
+#define JSON_ARENA_MIN_BLOCK_SIZE	(16 * 1024)
+
+// Capacity of an entry array that has to grow beyond max_num_entries
+#define JSON_ARENA_GROW(max_num_entries)	((max_num_entries) < 4 ? 4 : (max_num_entries) * 2)
+
+json_arena_t* json_arena_new(size_t block_size);
+void* json_arena_alloc(json_arena_t* p_arena, size_t size);
+void* json_arena_calloc(json_arena_t* p_arena, size_t size);
+// Resizes an array of num_entries entries to max_num_entries, on the heap if p_arena is NULL, new entries are zeroed
+void* json_arena_resize(json_arena_t* p_arena, void* p_entries, size_t num_entries, size_t max_num_entries, size_t entry_size);
+void json_arena_free(json_arena_t* p_arena);
+
+#endif //JSON_PARSER_JSON_ARENA_H
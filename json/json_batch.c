@@ -0,0 +1,123 @@
+#include <stdlib.h>
+#include <string.h>
+#include "json.h"
+#include "json_lex.h"
+#include "json_parse.h"
+#include "json_arena.h"
+#include "json_pool.h"
+
+/*
+ * Batch parse of many small documents on the work-stealing pool. Consecutive inputs are grouped into tasks of
+ * about JSON_BATCH_TASK_SIZE bytes, so the pool overhead is paid per group instead of per document. Every document
+ * gets its own arena holding a copy of the input, all strings are unescaped in place inside that copy and all
+ * nodes are carved from the same arena. Parsing a document therefore costs a handful of allocations and freeing
+ * it releases the arena without walking the tree.
+ */
+
+#define JSON_BATCH_TASK_SIZE		(64 * 1024)
+#define JSON_BATCH_ARENA_FACTOR		4
+
+typedef struct {
+	const json_input_t* inputs;
+	json_document_t* outputs;
+	json_error_t* p_errors;
+	size_t first_index;
+	size_t num_inputs;
+	bool failed;
+} json_batch_task_t;
+
+static json_ret_code_t json_batch_parse_document(const json_input_t* p_input, json_document_t* p_document, json_error_t* p_error) {
+	p_document->root = (json_object_t) {0};
+	p_document->p_arena = json_arena_new(p_input->size * JSON_BATCH_ARENA_FACTOR);
+	char* p_copy = p_document->p_arena != NULL ? json_arena_alloc(p_document->p_arena, p_input->size + 1) : NULL;
+	if (p_copy == NULL) {
+		json_document_free(p_document);
+		if (p_error != NULL) {
+			*p_error = (json_error_t) {.code = JSON_ERROR_OUT_OF_MEMORY};
+		}
+		return JSON_RETVAL_FAIL;
+	}
+	memcpy(p_copy, p_input->p_data, p_input->size);
+	p_copy[p_input->size] = '\0';
+
+	json_ret_code_t ret = json_parse_object_input(p_copy, p_input->size, JSON_LEX_FLAG_IN_PLACE, p_document->p_arena, NULL, NULL,
+												  &p_document->root, p_error);
+	if (ret != JSON_RETVAL_OK) {
+		json_document_free(p_document);
+	}
+	return ret;
+}
+
+static void json_batch_run_task(void* p_arg, uint32_t worker_index) {
+	(void) worker_index;
+	json_batch_task_t* p_task = p_arg;
+	for (size_t i = p_task->first_index; i < p_task->first_index + p_task->num_inputs; i++) {
+		json_error_t* p_error = p_task->p_errors != NULL ? &p_task->p_errors[i] : NULL;
+		if (json_batch_parse_document(&p_task->inputs[i], &p_task->outputs[i], p_error) != JSON_RETVAL_OK) {
+			p_task->failed = true;
+		}
+	}
+}
+
+json_ret_code_t json_parse_batch(const json_input_t* inputs, size_t num_inputs, json_document_t* outputs,
+								 json_error_t* p_errors, json_pool_t* p_pool) {
+	if ((inputs == NULL || outputs == NULL) && num_inputs > 0) {
+		return JSON_RETVAL_INVALID_PARAM;
+	}
+	if (p_errors != NULL) {
+		memset(p_errors, 0, num_inputs * sizeof(json_error_t));
+	}
+
+	size_t num_tasks = 0;
+	for (size_t i = 0, size = 0; i < num_inputs; i++) {
+		size += inputs[i].size;
+		if (size >= JSON_BATCH_TASK_SIZE || i + 1 == num_inputs) {
+			num_tasks++;
+			size = 0;
+		}
+	}
+	json_batch_task_t* tasks = malloc(num_tasks * sizeof(json_batch_task_t));
+	if (tasks == NULL && num_tasks > 0) {
+		return JSON_RETVAL_FAIL;
+	}
+
+	bool own_pool = p_pool == NULL && num_tasks > 1;
+	if (own_pool) {
+		p_pool = json_pool_new(0);
+	}
+
+	// A single task or a missing pool is run by the calling thread
+	json_pool_group_t group = {0};
+	size_t task_index = 0;
+	for (size_t i = 0, first_index = 0, size = 0; i < num_inputs; i++) {
+		size += inputs[i].size;
+		if (size < JSON_BATCH_TASK_SIZE && i + 1 < num_inputs) {
+			continue;
+		}
+		json_batch_task_t* p_task = &tasks[task_index++];
+		*p_task = (json_batch_task_t) {.inputs = inputs, .outputs = outputs, .p_errors = p_errors,
+									   .first_index = first_index, .num_inputs = i + 1 - first_index};
+		if (num_tasks == 1 || p_pool == NULL ||
+			json_pool_submit(p_pool, &group, json_batch_run_task, p_task) != JSON_RETVAL_OK) {
+			json_batch_run_task(p_task, 0);
+		}
+		first_index = i + 1;
+		size = 0;
+	}
+
+	if (p_pool != NULL) {
+		json_pool_wait(p_pool, &group);
+	}
+	if (own_pool) {
+		json_pool_free(p_pool);
+	}
+
+	json_ret_code_t ret = JSON_RETVAL_OK;
+	for (size_t i = 0; i < num_tasks; i++) {
+		if (tasks[i].failed) {
+			ret = JSON_RETVAL_FAIL;
+		}
+	}
+	free(tasks);
+	return ret;
+}
@@ -0,0 +1,510 @@
+#include <stdlib.h>
+#include <string.h>
+#include "json.h"
+#include "json_lex.h"
+
+/*
+ * Column extraction from an array of objects. The input is lexed once and the wanted fields are written straight
+ * into typed columns, no tree is built. Every column tracks how many leading components of its path match the keys
+ * on the way from the row to the current member (matched). Entering a member at depth d only has to look at the
+ * columns that matched the first d components, so sibling members and nested objects need no path stack. Values
+ * that no column asks for are skipped token by token and are still checked for syntax.
+ */
+
+#define JSON_COLUMNS_MAX_NESTING_LEVEL	1000
+#define JSON_COLUMNS_MIN_ROWS			64
+
+typedef struct {
+	const char* key;
+	size_t length;
+} json_columns_key_t;
+
+typedef struct {
+	json_columns_key_t* components;
+	uint32_t num_components;
+	uint32_t matched;
+} json_columns_path_t;
+
+typedef struct {
+	const char* p_data;
+	size_t size;
+	size_t consumed;
+	json_lex_t lex;
+	json_error_t error;
+	json_column_t* columns;
+	json_columns_path_t* paths;
+	size_t num_columns;
+	size_t num_rows;
+	size_t max_rows;
+	size_t max_strings_length[];	// Indexed like columns, allocated with the scan
+} json_columns_scan_t;
+
+// Next token of the input, FINISHED is reported as an unexpected end of input
+static json_ret_code_t json_columns_next(json_columns_scan_t* p_scan, json_token_t* p_token, const char* expected) {
+	size_t consumed = 0;
+	*p_token = (json_token_t) {0};
+	json_ret_code_t ret = json_lex_next_token(&p_scan->lex, &p_scan->p_data[p_scan->consumed], p_scan->size - p_scan->consumed,
+											  &consumed, p_token);
+	if (ret == JSON_RETVAL_FINISHED) {
+		p_scan->error = (json_error_t) {.code = JSON_ERROR_UNEXPECTED_EOF, .offset = p_scan->size, .expected = expected};
+		return JSON_RETVAL_FAIL;
+	}
+	if (ret != JSON_RETVAL_OK) {
+		p_scan->error = p_scan->lex.error;
+		p_scan->error.offset += p_scan->consumed;
+		return ret == JSON_RETVAL_INCOMPLETE ? JSON_RETVAL_ILLEGAL : ret;
+	}
+	p_token->offset += p_scan->consumed;
+	p_scan->consumed += consumed;
+	return JSON_RETVAL_OK;
+}
+
+static json_ret_code_t json_columns_unexpected(json_columns_scan_t* p_scan, const json_token_t* p_token, const char* expected) {
+	p_scan->error = (json_error_t) {.code = JSON_ERROR_UNEXPECTED_TOKEN, .offset = p_token->offset, .expected = expected};
+	return JSON_RETVAL_FAIL;
+}
+
+#define JSON_COLUMNS_HANDLE_RET(ret) { \
+	json_ret_code_t _ret = (ret); \
+	if (_ret != JSON_RETVAL_OK) { \
+		return _ret; \
+	} \
+}
+
+// Reads the next key of an object and the name value delimiter behind it, p_end is set at the end of the object
+static json_ret_code_t json_columns_next_key(json_columns_scan_t* p_scan, bool is_first, json_token_t* p_key, bool* p_end) {
+	JSON_COLUMNS_HANDLE_RET(json_columns_next(p_scan, p_key, is_first ? "object key or object end" : "member delimiter or object end"));
+	*p_end = p_key->type == JSON_TOKEN_TYPE_END_OBJECT;
+	if (*p_end) {
+		return JSON_RETVAL_OK;
+	}
+	if (!is_first) {
+		if (p_key->type != JSON_TOKEN_TYPE_MEMBER_DELIM) {
+			return json_columns_unexpected(p_scan, p_key, "member delimiter or object end");
+		}
+		JSON_COLUMNS_HANDLE_RET(json_columns_next(p_scan, p_key, "object key"));
+	}
+	if (p_key->type != JSON_TOKEN_TYPE_VAL_STRING) {
+		return json_columns_unexpected(p_scan, p_key, is_first ? "object key or object end" : "object key");
+	}
+	json_token_t delim;
+	JSON_COLUMNS_HANDLE_RET(json_columns_next(p_scan, &delim, "name value delimiter"));
+	if (delim.type != JSON_TOKEN_TYPE_NAME_VAL_DELIM) {
+		return json_columns_unexpected(p_scan, &delim, "name value delimiter");
+	}
+	return JSON_RETVAL_OK;
+}
+
+// Reads the first token of the next array element, p_end is set at the end of the array
+static json_ret_code_t json_columns_next_element(json_columns_scan_t* p_scan, bool is_first, json_token_t* p_token, bool* p_end) {
+	JSON_COLUMNS_HANDLE_RET(json_columns_next(p_scan, p_token, is_first ? "value or array end" : "value delimiter"));
+	*p_end = p_token->type == JSON_TOKEN_TYPE_VAL_END_ARRAY;
+	if (*p_end || is_first) {
+		return JSON_RETVAL_OK;
+	}
+	if (p_token->type != JSON_TOKEN_TYPE_MEMBER_DELIM) {
+		return json_columns_unexpected(p_scan, p_token, "value delimiter");
+	}
+	return json_columns_next(p_scan, p_token, "value");
+}
+
+// Skips the value that starts with p_token
+static json_ret_code_t json_columns_skip(json_columns_scan_t* p_scan, const json_token_t* p_token, uint32_t depth) {
+	json_token_t token;
+	bool is_end = false;
+	if (depth >= JSON_COLUMNS_MAX_NESTING_LEVEL) {
+		p_scan->error = (json_error_t) {.code = JSON_ERROR_MAX_NESTING_LEVEL, .offset = p_token->offset};
+		return JSON_RETVAL_FAIL;
+	}
+	switch (p_token->type) {
+		case JSON_TOKEN_TYPE_START_OBJECT:
+			for (bool is_first = true;; is_first = false) {
+				JSON_COLUMNS_HANDLE_RET(json_columns_next_key(p_scan, is_first, &token, &is_end));
+				if (is_end) {
+					return JSON_RETVAL_OK;
+				}
+				JSON_COLUMNS_HANDLE_RET(json_columns_next(p_scan, &token, "value"));
+				JSON_COLUMNS_HANDLE_RET(json_columns_skip(p_scan, &token, depth + 1));
+			}
+		case JSON_TOKEN_TYPE_VAL_START_ARRAY:
+			for (bool is_first = true;; is_first = false) {
+				JSON_COLUMNS_HANDLE_RET(json_columns_next_element(p_scan, is_first, &token, &is_end));
+				if (is_end) {
+					return JSON_RETVAL_OK;
+				}
+				JSON_COLUMNS_HANDLE_RET(json_columns_skip(p_scan, &token, depth + 1));
+			}
+		case JSON_TOKEN_TYPE_VAL_NULL:
+		case JSON_TOKEN_TYPE_VAL_BOOLEAN:
+		case JSON_TOKEN_TYPE_VAL_STRING:
+		case JSON_TOKEN_TYPE_VAL_NUMBER:
+			return JSON_RETVAL_OK;
+		default:
+			return json_columns_unexpected(p_scan, p_token, "value");
+	}
+}
+
+static json_ret_code_t json_columns_reserve(void** p_buffer, size_t* p_capacity, size_t length, size_t additional, size_t element_size) {
+	if (length + additional <= *p_capacity) {
+		return JSON_RETVAL_OK;
+	}
+	size_t capacity = MAX(*p_capacity * 2, (size_t) JSON_COLUMNS_MIN_ROWS);
+	while (capacity < length + additional) {
+		capacity *= 2;
+	}
+	void* p_new = realloc(*p_buffer, capacity * element_size);
+	if (p_new == NULL) {
+		return JSON_RETVAL_FAIL;
+	}
+	*p_buffer = p_new;
+	*p_capacity = capacity;
+	return JSON_RETVAL_OK;
+}
+
+// Makes room for one more row in every column, the row starts out null
+static json_ret_code_t json_columns_add_row(json_columns_scan_t* p_scan) {
+	size_t row = p_scan->num_rows;
+	if (row == p_scan->max_rows) {
+		size_t max_rows = MAX(p_scan->max_rows * 2, (size_t) JSON_COLUMNS_MIN_ROWS);
+		for (size_t i = 0; i < p_scan->num_columns; i++) {
+			json_column_t* p_column = &p_scan->columns[i];
+			void** p_values = (void**) &p_column->numbers;
+			size_t values_size = max_rows * sizeof(double);
+			if (p_column->type == JSON_COLUMN_TYPE_INT64) {
+				p_values = (void**) &p_column->integers;
+				values_size = max_rows * sizeof(int64_t);
+			} else if (p_column->type == JSON_COLUMN_TYPE_STRING) {
+				// One more offset closes the last row
+				p_values = (void**) &p_column->string_offsets;
+				values_size = (max_rows + 1) * sizeof(uint64_t);
+			}
+			void* p_new_values = realloc(*p_values, values_size);
+			if (p_new_values != NULL) {
+				*p_values = p_new_values;
+			}
+			uint8_t* null_bitmap = realloc(p_column->null_bitmap, max_rows / 8);
+			if (null_bitmap != NULL) {
+				p_column->null_bitmap = null_bitmap;
+			}
+			if (p_new_values == NULL || null_bitmap == NULL) {
+				p_scan->error = (json_error_t) {.code = JSON_ERROR_OUT_OF_MEMORY, .offset = p_scan->consumed};
+				return JSON_RETVAL_FAIL;
+			}
+		}
+		p_scan->max_rows = max_rows;
+	}
+
+	for (size_t i = 0; i < p_scan->num_columns; i++) {
+		json_column_t* p_column = &p_scan->columns[i];
+		if (row % 8 == 0) {
+			p_column->null_bitmap[row / 8] = 0;
+		}
+		p_column->null_bitmap[row / 8] |= (uint8_t) (1 << (row % 8));
+		p_column->num_nulls++;
+		switch (p_column->type) {
+			case JSON_COLUMN_TYPE_NUMBER:
+				p_column->numbers[row] = 0;
+				break;
+			case JSON_COLUMN_TYPE_INT64:
+				p_column->integers[row] = 0;
+				break;
+			case JSON_COLUMN_TYPE_STRING:
+				p_column->string_offsets[row] = p_column->strings_length;
+				break;
+		}
+		p_scan->paths[i].matched = 0;
+	}
+	p_scan->num_rows++;
+	return JSON_RETVAL_OK;
+}
+
+// Stores a scalar in the current row of a column unless the row already has a value
+static json_ret_code_t json_columns_store(json_columns_scan_t* p_scan, size_t index, const json_token_t* p_token) {
+	json_column_t* p_column = &p_scan->columns[index];
+	size_t row = p_scan->num_rows - 1;
+	if (!json_column_is_null(p_column, row)) {
+		return JSON_RETVAL_OK;
+	}
+	switch (p_column->type) {
+		case JSON_COLUMN_TYPE_NUMBER:
+			if (p_token->type != JSON_TOKEN_TYPE_VAL_NUMBER) {
+				return JSON_RETVAL_OK;
+			}
+			p_column->numbers[row] = p_token->value.number;
+			break;
+		case JSON_COLUMN_TYPE_INT64:
+			if (p_token->type != JSON_TOKEN_TYPE_VAL_NUMBER ||
+				!json_parse_integer(&p_scan->p_data[p_token->offset], p_scan->size - p_token->offset, INT64_MIN, INT64_MAX,
+									&p_column->integers[row])) {
+				return JSON_RETVAL_OK;
+			}
+			break;
+		case JSON_COLUMN_TYPE_STRING: {
+			if (p_token->type != JSON_TOKEN_TYPE_VAL_STRING) {
+				return JSON_RETVAL_OK;
+			}
+			// Unescaping writes a terminator, the next string overwrites it
+			size_t raw_len = p_token->value.string.length;
+			if (json_columns_reserve((void**) &p_column->strings, &p_scan->max_strings_length[index], p_column->strings_length,
+									 raw_len + 1, 1) != JSON_RETVAL_OK) {
+				p_scan->error = (json_error_t) {.code = JSON_ERROR_OUT_OF_MEMORY, .offset = p_token->offset};
+				return JSON_RETVAL_FAIL;
+			}
+			size_t length = 0;
+			json_lex_unescape(&p_column->strings[p_column->strings_length], p_token->value.string.data, raw_len, &length);
+			p_column->strings_length += length;
+			break;
+		}
+	}
+	p_column->null_bitmap[row / 8] &= (uint8_t) ~(1 << (row % 8));
+	p_column->num_nulls--;
+	return JSON_RETVAL_OK;
+}
+
+// Key of a member, keys with escapes are unescaped into p_buffer which is grown as needed
+static json_ret_code_t json_columns_get_key(json_columns_scan_t* p_scan, const json_token_t* p_token, char** p_buffer,
+											size_t* p_buffer_size, json_columns_key_t* p_key) {
+	p_key->key = p_token->value.string.data;
+	p_key->length = p_token->value.string.length;
+	if (memchr(p_key->key, '\\', p_key->length) == NULL) {
+		return JSON_RETVAL_OK;
+	}
+	if (json_columns_reserve((void**) p_buffer, p_buffer_size, 0, p_key->length + 1, 1) != JSON_RETVAL_OK) {
+		p_scan->error = (json_error_t) {.code = JSON_ERROR_OUT_OF_MEMORY, .offset = p_token->offset};
+		return JSON_RETVAL_FAIL;
+	}
+	json_lex_unescape(*p_buffer, p_token->value.string.data, p_token->value.string.length, &p_key->length);
+	p_key->key = *p_buffer;
+	return JSON_RETVAL_OK;
+}
+
+static inline bool json_columns_key_equal(const json_columns_key_t* p_a, const json_columns_key_t* p_b) {
+	return p_a->length == p_b->length && memcmp(p_a->key, p_b->key, p_a->length) == 0;
+}
+
+// Members of an object of a row at depth, the object start has been read
+static json_ret_code_t json_columns_scan_object(json_columns_scan_t* p_scan, uint32_t depth, char** p_buffer, size_t* p_buffer_size) {
+	json_token_t token;
+	bool is_end = false;
+	for (bool is_first = true;; is_first = false) {
+		JSON_COLUMNS_HANDLE_RET(json_columns_next_key(p_scan, is_first, &token, &is_end));
+		if (is_end) {
+			return JSON_RETVAL_OK;
+		}
+		json_columns_key_t key;
+		JSON_COLUMNS_HANDLE_RET(json_columns_get_key(p_scan, &token, p_buffer, p_buffer_size, &key));
+
+		// Columns whose path matched up to this object compare their next component with the key
+		bool is_leaf = false, is_prefix = false;
+		for (size_t i = 0; i < p_scan->num_columns; i++) {
+			json_columns_path_t* p_path = &p_scan->paths[i];
+			if (p_path->matched < depth) {
+				continue;
+			}
+			p_path->matched = depth;
+			if (depth < p_path->num_components && json_columns_key_equal(&p_path->components[depth], &key)) {
+				p_path->matched++;
+				is_leaf = is_leaf || p_path->matched == p_path->num_components;
+				is_prefix = is_prefix || p_path->matched < p_path->num_components;
+			}
+		}
+
+		JSON_COLUMNS_HANDLE_RET(json_columns_next(p_scan, &token, "value"));
+		if (token.type == JSON_TOKEN_TYPE_START_OBJECT && is_prefix) {
+			if (depth + 1 >= JSON_COLUMNS_MAX_NESTING_LEVEL) {
+				p_scan->error = (json_error_t) {.code = JSON_ERROR_MAX_NESTING_LEVEL, .offset = token.offset};
+				return JSON_RETVAL_FAIL;
+			}
+			JSON_COLUMNS_HANDLE_RET(json_columns_scan_object(p_scan, depth + 1, p_buffer, p_buffer_size));
+			continue;
+		}
+		if (is_leaf && token.type != JSON_TOKEN_TYPE_START_OBJECT && token.type != JSON_TOKEN_TYPE_VAL_START_ARRAY) {
+			for (size_t i = 0; i < p_scan->num_columns; i++) {
+				if (p_scan->paths[i].matched == depth + 1 && p_scan->paths[i].num_components == depth + 1) {
+					JSON_COLUMNS_HANDLE_RET(json_columns_store(p_scan, i, &token));
+				}
+			}
+		}
+		JSON_COLUMNS_HANDLE_RET(json_columns_skip(p_scan, &token, depth + 1));
+	}
+}
+
+// Rows of the array, the array start has been read
+static json_ret_code_t json_columns_scan_rows(json_columns_scan_t* p_scan) {
+	char* p_buffer = NULL;
+	size_t buffer_size = 0;
+	json_ret_code_t ret = JSON_RETVAL_OK;
+	json_token_t token;
+	bool is_end = false;
+	for (bool is_first = true; ret == JSON_RETVAL_OK; is_first = false) {
+		if ((ret = json_columns_next_element(p_scan, is_first, &token, &is_end)) != JSON_RETVAL_OK || is_end) {
+			break;
+		}
+		if (token.type != JSON_TOKEN_TYPE_START_OBJECT) {
+			ret = json_columns_unexpected(p_scan, &token, "object start");
+			break;
+		}
+		if ((ret = json_columns_add_row(p_scan)) == JSON_RETVAL_OK) {
+			ret = json_columns_scan_object(p_scan, 0, &p_buffer, &buffer_size);
+		}
+	}
+	free(p_buffer);
+	return ret;
+}
+
+// Walks from the value that starts with p_token along the array path to the rows, other members are skipped
+static json_ret_code_t json_columns_scan_path(json_columns_scan_t* p_scan, const json_token_t* p_token, const char* array_path,
+											  uint32_t depth) {
+	if (array_path == NULL || *array_path == '\0') {
+		if (p_token->type != JSON_TOKEN_TYPE_VAL_START_ARRAY) {
+			return json_columns_unexpected(p_scan, p_token, "array start");
+		}
+		return json_columns_scan_rows(p_scan);
+	}
+	if (p_token->type != JSON_TOKEN_TYPE_START_OBJECT) {
+		return json_columns_unexpected(p_scan, p_token, "object start");
+	}
+	const char* p_dot = strchr(array_path, '.');
+	json_columns_key_t component = {.key = array_path, .length = p_dot != NULL ? (size_t) (p_dot - array_path) : strlen(array_path)};
+	const char* next_path = p_dot != NULL ? p_dot + 1 : NULL;
+	bool is_found = false, is_end = false;
+	char* p_buffer = NULL;
+	size_t buffer_size = 0;
+	json_ret_code_t ret = JSON_RETVAL_OK;
+	for (bool is_first = true; ret == JSON_RETVAL_OK; is_first = false) {
+		json_token_t token;
+		json_columns_key_t key;
+		if ((ret = json_columns_next_key(p_scan, is_first, &token, &is_end)) != JSON_RETVAL_OK || is_end ||
+			(ret = json_columns_get_key(p_scan, &token, &p_buffer, &buffer_size, &key)) != JSON_RETVAL_OK) {
+			break;
+		}
+		bool is_match = !is_found && json_columns_key_equal(&component, &key);
+		if ((ret = json_columns_next(p_scan, &token, "value")) != JSON_RETVAL_OK) {
+			break;
+		}
+		// Only the first member with the key is followed, like json_object_get_value does
+		if (is_match && depth + 1 < JSON_COLUMNS_MAX_NESTING_LEVEL) {
+			is_found = true;
+			ret = json_columns_scan_path(p_scan, &token, next_path, depth + 1);
+		} else {
+			ret = json_columns_skip(p_scan, &token, depth + 1);
+		}
+	}
+	free(p_buffer);
+	return ret;
+}
+
+// Splits the paths of all columns into key components, one allocation for all of them
+static json_ret_code_t json_columns_split_paths(json_columns_scan_t* p_scan) {
+	size_t num_components = 0;
+	for (size_t i = 0; i < p_scan->num_columns; i++) {
+		if (p_scan->columns[i].path == NULL || p_scan->columns[i].type > JSON_COLUMN_TYPE_STRING) {
+			return JSON_RETVAL_INVALID_PARAM;
+		}
+		num_components++;
+		for (const char* p = p_scan->columns[i].path; *p != '\0'; p++) {
+			num_components += *p == '.';
+		}
+	}
+	p_scan->paths = malloc(p_scan->num_columns * sizeof(json_columns_path_t) + num_components * sizeof(json_columns_key_t));
+	if (p_scan->paths == NULL) {
+		return JSON_RETVAL_FAIL;
+	}
+	json_columns_key_t* p_component = (json_columns_key_t*) &p_scan->paths[p_scan->num_columns];
+	for (size_t i = 0; i < p_scan->num_columns; i++) {
+		json_columns_path_t* p_path = &p_scan->paths[i];
+		*p_path = (json_columns_path_t) {.components = p_component};
+		const char* p_start = p_scan->columns[i].path;
+		while (true) {
+			const char* p_end = strchr(p_start, '.');
+			size_t length = p_end != NULL ? (size_t) (p_end - p_start) : strlen(p_start);
+			*p_component++ = (json_columns_key_t) {.key = p_start, .length = length};
+			p_path->num_components++;
+			if (p_end == NULL) {
+				break;
+			}
+			p_start = p_end + 1;
+		}
+	}
+	return JSON_RETVAL_OK;
+}
+
+json_ret_code_t json_extract_columns(const char* p_data, size_t size, const char* array_path, json_column_t* columns,
+									 size_t num_columns, size_t* p_num_rows, json_error_t* p_error) {
+	if ((p_data == NULL && size > 0) || (columns == NULL && num_columns > 0)) {
+		return JSON_RETVAL_INVALID_PARAM;
+	}
+	for (size_t i = 0; i < num_columns; i++) {
+		columns[i] = (json_column_t) {.path = columns[i].path, .type = columns[i].type};
+	}
+	if (p_num_rows != NULL) {
+		*p_num_rows = 0;
+	}
+
+	json_columns_scan_t* p_scan = calloc(1, sizeof(json_columns_scan_t) + num_columns * sizeof(size_t));
+	if (p_scan == NULL) {
+		if (p_error != NULL) {
+			*p_error = (json_error_t) {.code = JSON_ERROR_OUT_OF_MEMORY};
+		}
+		return JSON_RETVAL_FAIL;
+	}
+	p_scan->p_data = p_data;
+	p_scan->size = size;
+	p_scan->lex.flags = JSON_LEX_FLAG_RAW_STRINGS;
+	p_scan->columns = columns;
+	p_scan->num_columns = num_columns;
+
+	json_ret_code_t ret = json_columns_split_paths(p_scan);
+	if (ret == JSON_RETVAL_FAIL) {
+		p_scan->error = (json_error_t) {.code = JSON_ERROR_OUT_OF_MEMORY};
+	}
+	json_token_t token;
+	if (ret == JSON_RETVAL_OK && (ret = json_columns_next(p_scan, &token, array_path != NULL ? "object start" : "array start")) == JSON_RETVAL_OK) {
+		ret = json_columns_scan_path(p_scan, &token, array_path, 0);
+	}
+	// Nothing but whitespace may follow the document
+	if (ret == JSON_RETVAL_OK) {
+		size_t consumed = 0;
+		ret = json_lex_next_token(&p_scan->lex, &p_data[p_scan->consumed], size - p_scan->consumed, &consumed, &token);
+		if (ret == JSON_RETVAL_FINISHED) {
+			ret = JSON_RETVAL_OK;
+		} else if (ret == JSON_RETVAL_OK) {
+			token.offset += p_scan->consumed;
+			ret = json_columns_unexpected(p_scan, &token, "end of input");
+		} else {
+			p_scan->error = p_scan->lex.error;
+			p_scan->error.offset += p_scan->consumed;
+			ret = ret == JSON_RETVAL_INCOMPLETE ? JSON_RETVAL_ILLEGAL : ret;
+		}
+	}
+
+	// Close the string offsets behind the last row
+	for (size_t i = 0; ret == JSON_RETVAL_OK && i < num_columns; i++) {
+		if (columns[i].type == JSON_COLUMN_TYPE_STRING && p_scan->num_rows > 0) {
+			columns[i].string_offsets[p_scan->num_rows] = columns[i].strings_length;
+		}
+	}
+	if (p_error != NULL) {
+		*p_error = p_scan->error;
+	}
+	if (ret == JSON_RETVAL_OK && p_num_rows != NULL) {
+		*p_num_rows = p_scan->num_rows;
+	}
+	if (ret != JSON_RETVAL_OK) {
+		json_columns_free(columns, num_columns);
+	}
+	free(p_scan->paths);
+	free(p_scan);
+	return ret;
+}
+
+void json_columns_free(json_column_t* columns, size_t num_columns) {
+	for (size_t i = 0; columns != NULL && i < num_columns; i++) {
+		free(columns[i].numbers);
+		free(columns[i].integers);
+		free(columns[i].string_offsets);
+		free(columns[i].strings);
+		free(columns[i].null_bitmap);
+		columns[i] = (json_column_t) {.path = columns[i].path, .type = columns[i].type};
+	}
+}
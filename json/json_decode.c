@@ -0,0 +1,363 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include "json.h"
+#include "json_lex.h"
+#include "json_struct.h"
+
+/*
+ * Decoding straight into a C struct described by a json_struct_desc_t. The descriptor holds the key, offset and
+ * type of every field, the first use fills a hash table of its keys. The input is scanned once without tokens:
+ * keys are hashed in place and looked up in the table, values of known fields are converted into the struct and
+ * values of unknown keys are checked and skipped. No tree and no heap strings are built, strings are unescaped
+ * into the char arrays of the struct. JSON null leaves a field as it is, a value of another type is an error.
+ */
+
+#define JSON_DECODE_MAX_NESTING_LEVEL	1000
+#define JSON_DECODE_MAX_ESCAPED_KEY		256
+
+// Descriptors are compiled once under this lock and published with is_compiled
+static pthread_mutex_t m_decode_compile_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static json_ret_code_t json_struct_desc_compile_locked(json_struct_desc_t* p_desc) {
+	if (p_desc->is_compiled) {
+		return JSON_RETVAL_OK;
+	}
+	if (p_desc->num_fields * 2 > p_desc->num_slots || p_desc->num_fields >= UINT16_MAX) {
+		return JSON_RETVAL_INVALID_PARAM;
+	}
+	memset(p_desc->slots, 0, p_desc->num_slots * sizeof(uint16_t));
+	for (uint32_t i = 0; i < p_desc->num_fields; i++) {
+		const json_field_desc_t* p_field = &p_desc->fields[i];
+		size_t expected_size = 0;
+		switch (p_field->type) {
+			case JSON_FIELD_TYPE_DOUBLE: expected_size = sizeof(double); break;
+			case JSON_FIELD_TYPE_INT64: expected_size = sizeof(int64_t); break;
+			case JSON_FIELD_TYPE_INT32: expected_size = sizeof(int32_t); break;
+			case JSON_FIELD_TYPE_BOOL: expected_size = sizeof(bool); break;
+			case JSON_FIELD_TYPE_STRING: expected_size = p_field->size > 0 ? p_field->size : 1; break;
+			case JSON_FIELD_TYPE_OBJECT:
+				expected_size = p_field->size;
+				if (p_field->p_desc == NULL || json_struct_desc_compile_locked((json_struct_desc_t*) p_field->p_desc) != JSON_RETVAL_OK) {
+					return JSON_RETVAL_INVALID_PARAM;
+				}
+				break;
+		}
+		if (p_field->key == NULL || p_field->size != expected_size || !json_struct_key_is_plain(p_field->key, p_field->key_length) ||
+			p_field->fragment == NULL || p_field->fragment_length != p_field->key_length + 3) {
+			return JSON_RETVAL_INVALID_PARAM;
+		}
+		p_desc->hashes[i] = json_lex_hash(p_field->key, p_field->key_length);
+		size_t slot = p_desc->hashes[i] & (p_desc->num_slots - 1);
+		while (p_desc->slots[slot] != 0) {
+			slot = (slot + 1) & (p_desc->num_slots - 1);
+		}
+		p_desc->slots[slot] = (uint16_t) (i + 1);
+	}
+	__atomic_store_n(&p_desc->is_compiled, true, __ATOMIC_RELEASE);
+	return JSON_RETVAL_OK;
+}
+
+// Fills the lookup table and checks the fields on the first use of a descriptor, for decoding and encoding alike
+json_ret_code_t json_struct_desc_compile(json_struct_desc_t* p_desc) {
+	if (__atomic_load_n(&p_desc->is_compiled, __ATOMIC_ACQUIRE)) {
+		return JSON_RETVAL_OK;
+	}
+	pthread_mutex_lock(&m_decode_compile_mutex);
+	json_ret_code_t ret = json_struct_desc_compile_locked(p_desc);
+	pthread_mutex_unlock(&m_decode_compile_mutex);
+	return ret;
+}
+
+static inline const json_field_desc_t* json_decode_find_field(const json_struct_desc_t* p_desc, const char* key, size_t length) {
+	uint64_t hash = json_lex_hash(key, length);
+	for (size_t slot = hash & (p_desc->num_slots - 1); p_desc->slots[slot] != 0; slot = (slot + 1) & (p_desc->num_slots - 1)) {
+		uint32_t field = p_desc->slots[slot] - 1u;
+		const json_field_desc_t* p_field = &p_desc->fields[field];
+		if (p_desc->hashes[field] == hash && p_field->key_length == length && memcmp(p_field->key, key, length) == 0) {
+			return p_field;
+		}
+	}
+	return NULL;
+}
+
+#define JSON_DECODE_HANDLE_RET(ret) { \
+	json_ret_code_t _ret = (ret); \
+	if (_ret != JSON_RETVAL_OK) { \
+		return _ret; \
+	} \
+}
+
+static json_ret_code_t json_decode_scan_string(json_lex_cursor_t* p_dec, size_t* p_len) {
+	json_error_code_t err = JSON_ERROR_NONE;
+	json_ret_code_t ret = json_lex_scan_string(&p_dec->p_data[p_dec->pos], p_dec->size - p_dec->pos, p_len, &err);
+	return ret == JSON_RETVAL_OK ? JSON_RETVAL_OK : json_lex_cursor_scan_error(p_dec, ret, err, *p_len, "string");
+}
+
+static json_ret_code_t json_decode_scan_number(json_lex_cursor_t* p_dec, size_t* p_len) {
+	json_error_code_t err = JSON_ERROR_UNEXPECTED_TOKEN;
+	json_ret_code_t ret = json_lex_scan_number(&p_dec->p_data[p_dec->pos], p_dec->size - p_dec->pos, p_len, &err);
+	return ret == JSON_RETVAL_OK ? JSON_RETVAL_OK : json_lex_cursor_scan_error(p_dec, ret, err, *p_len, "value");
+}
+
+static json_ret_code_t json_decode_scan_literal(json_lex_cursor_t* p_dec, const char* literal, size_t literal_len) {
+	size_t len = 0;
+	json_ret_code_t ret = json_lex_scan_literal(&p_dec->p_data[p_dec->pos], p_dec->size - p_dec->pos, literal, literal_len, &len);
+	if (ret != JSON_RETVAL_OK) {
+		return json_lex_cursor_scan_error(p_dec, ret, JSON_ERROR_UNEXPECTED_TOKEN, len, "value");
+	}
+	p_dec->pos += len;
+	return JSON_RETVAL_OK;
+}
+
+typedef json_ret_code_t (*json_decode_member_fn)(json_lex_cursor_t* p_dec, const char* key, size_t key_len, void* p_context,
+												 uint32_t depth);
+
+static json_ret_code_t json_decode_skip(json_lex_cursor_t* p_dec, uint32_t depth);
+
+// Calls member_fn for every key of the object at pos with pos at the value, which it has to consume
+static json_ret_code_t json_decode_members(json_lex_cursor_t* p_dec, json_decode_member_fn member_fn, void* p_context, uint32_t depth) {
+	if (depth >= JSON_DECODE_MAX_NESTING_LEVEL) {
+		return json_lex_cursor_error(p_dec, JSON_ERROR_MAX_NESTING_LEVEL, p_dec->pos, NULL);
+	}
+	p_dec->pos++;
+	JSON_DECODE_HANDLE_RET(json_lex_cursor_next_char(p_dec, "object key or object end"));
+	if (p_dec->p_data[p_dec->pos] == '}') {
+		p_dec->pos++;
+		return JSON_RETVAL_OK;
+	}
+	char escaped_key[JSON_DECODE_MAX_ESCAPED_KEY];
+	while (true) {
+		JSON_DECODE_HANDLE_RET(json_lex_cursor_next_char(p_dec, "object key"));
+		if (p_dec->p_data[p_dec->pos] != '"') {
+			return json_lex_cursor_error(p_dec, JSON_ERROR_UNEXPECTED_TOKEN, p_dec->pos, "object key");
+		}
+		size_t len;
+		JSON_DECODE_HANDLE_RET(json_decode_scan_string(p_dec, &len));
+		const char* key = &p_dec->p_data[p_dec->pos + 1];
+		size_t key_len = len - 2;
+		// Keys with escapes are unescaped first, longer ones cannot be the key of a field
+		if (memchr(key, '\\', key_len) != NULL) {
+			if (key_len < JSON_DECODE_MAX_ESCAPED_KEY) {
+				json_lex_unescape(escaped_key, key, key_len, &key_len);
+				key = escaped_key;
+			} else {
+				key = NULL;
+			}
+		}
+		p_dec->pos += len;
+
+		JSON_DECODE_HANDLE_RET(json_lex_cursor_next_char(p_dec, "name value delimiter"));
+		if (p_dec->p_data[p_dec->pos] != ':') {
+			return json_lex_cursor_error(p_dec, JSON_ERROR_UNEXPECTED_TOKEN, p_dec->pos, "name value delimiter");
+		}
+		p_dec->pos++;
+		JSON_DECODE_HANDLE_RET(json_lex_cursor_next_char(p_dec, "value"));
+		JSON_DECODE_HANDLE_RET(key != NULL && member_fn != NULL ? member_fn(p_dec, key, key_len, p_context, depth) :
+							   json_decode_skip(p_dec, depth + 1));
+
+		JSON_DECODE_HANDLE_RET(json_lex_cursor_next_char(p_dec, "member delimiter or object end"));
+		char c = p_dec->p_data[p_dec->pos++];
+		if (c == '}') {
+			return JSON_RETVAL_OK;
+		}
+		if (c != ',') {
+			return json_lex_cursor_error(p_dec, JSON_ERROR_UNEXPECTED_TOKEN, p_dec->pos - 1, "member delimiter or object end");
+		}
+	}
+}
+
+// Checks and skips the value at pos
+static json_ret_code_t json_decode_skip(json_lex_cursor_t* p_dec, uint32_t depth) {
+	size_t len = 0;
+	switch (p_dec->p_data[p_dec->pos]) {
+		case '{':
+			return json_decode_members(p_dec, NULL, NULL, depth);
+		case '[':
+			if (depth >= JSON_DECODE_MAX_NESTING_LEVEL) {
+				return json_lex_cursor_error(p_dec, JSON_ERROR_MAX_NESTING_LEVEL, p_dec->pos, NULL);
+			}
+			p_dec->pos++;
+			JSON_DECODE_HANDLE_RET(json_lex_cursor_next_char(p_dec, "value or array end"));
+			if (p_dec->p_data[p_dec->pos] == ']') {
+				p_dec->pos++;
+				return JSON_RETVAL_OK;
+			}
+			while (true) {
+				JSON_DECODE_HANDLE_RET(json_lex_cursor_next_char(p_dec, "value"));
+				JSON_DECODE_HANDLE_RET(json_decode_skip(p_dec, depth + 1));
+				JSON_DECODE_HANDLE_RET(json_lex_cursor_next_char(p_dec, "value delimiter"));
+				char c = p_dec->p_data[p_dec->pos++];
+				if (c == ']') {
+					return JSON_RETVAL_OK;
+				}
+				if (c != ',') {
+					return json_lex_cursor_error(p_dec, JSON_ERROR_UNEXPECTED_TOKEN, p_dec->pos - 1, "value delimiter");
+				}
+			}
+		case '"':
+			JSON_DECODE_HANDLE_RET(json_decode_scan_string(p_dec, &len));
+			break;
+		case 't':
+			return json_decode_scan_literal(p_dec, "true", 4);
+		case 'f':
+			return json_decode_scan_literal(p_dec, "false", 5);
+		case 'n':
+			return json_decode_scan_literal(p_dec, "null", 4);
+		default:
+			JSON_DECODE_HANDLE_RET(json_decode_scan_number(p_dec, &len));
+			break;
+	}
+	p_dec->pos += len;
+	return JSON_RETVAL_OK;
+}
+
+// Integer value of the number at pos, fractions, exponents and values beyond the limits are an error
+static json_ret_code_t json_decode_integer(json_lex_cursor_t* p_dec, int64_t min, int64_t max, int64_t* p_integer) {
+	size_t len;
+	JSON_DECODE_HANDLE_RET(json_decode_scan_number(p_dec, &len));
+	if (!json_parse_integer(&p_dec->p_data[p_dec->pos], len, min, max, p_integer)) {
+		return json_lex_cursor_error(p_dec, JSON_ERROR_UNEXPECTED_TOKEN, p_dec->pos, "integer");
+	}
+	p_dec->pos += len;
+	return JSON_RETVAL_OK;
+}
+
+// Unescapes the string at pos into the char array of the field
+static json_ret_code_t json_decode_string(json_lex_cursor_t* p_dec, char* p_dest, size_t size) {
+	size_t len;
+	JSON_DECODE_HANDLE_RET(json_decode_scan_string(p_dec, &len));
+	const char* p_raw = &p_dec->p_data[p_dec->pos + 1];
+	size_t raw_len = len - 2, dest_len = raw_len;
+	if (memchr(p_raw, '\\', raw_len) == NULL) {
+		if (raw_len >= size) {
+			return json_lex_cursor_error(p_dec, JSON_ERROR_UNEXPECTED_TOKEN, p_dec->pos, "shorter string");
+		}
+		memcpy(p_dest, p_raw, raw_len);
+		p_dest[raw_len] = '\0';
+	} else if (raw_len < size) {
+		json_lex_unescape(p_dest, p_raw, raw_len, &dest_len);
+	} else {
+		// Escapes only ever shorten a string, the unescaped one may still fit
+		char* p_buffer = malloc(raw_len + 1);
+		if (p_buffer == NULL) {
+			return json_lex_cursor_error(p_dec, JSON_ERROR_OUT_OF_MEMORY, p_dec->pos, NULL);
+		}
+		json_lex_unescape(p_buffer, p_raw, raw_len, &dest_len);
+		if (dest_len < size) {
+			memcpy(p_dest, p_buffer, dest_len + 1);
+		}
+		free(p_buffer);
+		if (dest_len >= size) {
+			return json_lex_cursor_error(p_dec, JSON_ERROR_UNEXPECTED_TOKEN, p_dec->pos, "shorter string");
+		}
+	}
+	p_dec->pos += len;
+	return JSON_RETVAL_OK;
+}
+
+static json_ret_code_t json_decode_field(json_lex_cursor_t* p_dec, const json_field_desc_t* p_field, char* p_dest, uint32_t depth);
+
+typedef struct {
+	const json_struct_desc_t* p_desc;
+	char* p_out;
+} json_decode_struct_t;
+
+static json_ret_code_t json_decode_member(json_lex_cursor_t* p_dec, const char* key, size_t key_len, void* p_context, uint32_t depth) {
+	json_decode_struct_t* p_struct = p_context;
+	const json_field_desc_t* p_field = json_decode_find_field(p_struct->p_desc, key, key_len);
+	if (p_field == NULL) {
+		return json_decode_skip(p_dec, depth + 1);
+	}
+	return json_decode_field(p_dec, p_field, p_struct->p_out + p_field->offset, depth + 1);
+}
+
+static json_ret_code_t json_decode_object(json_lex_cursor_t* p_dec, const json_struct_desc_t* p_desc, char* p_out, uint32_t depth) {
+	if (p_dec->p_data[p_dec->pos] != '{') {
+		return json_lex_cursor_error(p_dec, JSON_ERROR_UNEXPECTED_TOKEN, p_dec->pos, "object");
+	}
+	json_decode_struct_t context = {.p_desc = p_desc, .p_out = p_out};
+	return json_decode_members(p_dec, json_decode_member, &context, depth);
+}
+
+static json_ret_code_t json_decode_field(json_lex_cursor_t* p_dec, const json_field_desc_t* p_field, char* p_dest, uint32_t depth) {
+	char c = p_dec->p_data[p_dec->pos];
+	if (c == 'n') {
+		return json_decode_scan_literal(p_dec, "null", 4);
+	}
+	int64_t integer;
+	double number;
+	size_t len;
+	switch (p_field->type) {
+		case JSON_FIELD_TYPE_DOUBLE:
+			if (c != '-' && (c < '0' || c > '9')) {
+				return json_lex_cursor_error(p_dec, JSON_ERROR_UNEXPECTED_TOKEN, p_dec->pos, "number");
+			}
+			JSON_DECODE_HANDLE_RET(json_decode_scan_number(p_dec, &len));
+			if (json_parse_number(&number, &p_dec->p_data[p_dec->pos], len) != JSON_RETVAL_OK) {
+				return json_lex_cursor_error(p_dec, JSON_ERROR_NAN, p_dec->pos, NULL);
+			}
+			memcpy(p_dest, &number, sizeof(double));
+			p_dec->pos += len;
+			return JSON_RETVAL_OK;
+		case JSON_FIELD_TYPE_INT64:
+		case JSON_FIELD_TYPE_INT32: {
+			bool is_64 = p_field->type == JSON_FIELD_TYPE_INT64;
+			if (c != '-' && (c < '0' || c > '9')) {
+				return json_lex_cursor_error(p_dec, JSON_ERROR_UNEXPECTED_TOKEN, p_dec->pos, "integer");
+			}
+			JSON_DECODE_HANDLE_RET(json_decode_integer(p_dec, is_64 ? INT64_MIN : INT32_MIN, is_64 ? INT64_MAX : INT32_MAX, &integer));
+			if (is_64) {
+				memcpy(p_dest, &integer, sizeof(int64_t));
+			} else {
+				int32_t integer32 = (int32_t) integer;
+				memcpy(p_dest, &integer32, sizeof(int32_t));
+			}
+			return JSON_RETVAL_OK;
+		}
+		case JSON_FIELD_TYPE_BOOL: {
+			if (c != 't' && c != 'f') {
+				return json_lex_cursor_error(p_dec, JSON_ERROR_UNEXPECTED_TOKEN, p_dec->pos, "boolean");
+			}
+			bool boolean = c == 't';
+			JSON_DECODE_HANDLE_RET(json_decode_scan_literal(p_dec, boolean ? "true" : "false", boolean ? 4 : 5));
+			memcpy(p_dest, &boolean, sizeof(bool));
+			return JSON_RETVAL_OK;
+		}
+		case JSON_FIELD_TYPE_STRING:
+			if (c != '"') {
+				return json_lex_cursor_error(p_dec, JSON_ERROR_UNEXPECTED_TOKEN, p_dec->pos, "string");
+			}
+			return json_decode_string(p_dec, p_dest, p_field->size);
+		case JSON_FIELD_TYPE_OBJECT:
+			return json_decode_object(p_dec, p_field->p_desc, p_dest, depth);
+	}
+	return JSON_RETVAL_INVALID_PARAM;
+}
+
+json_ret_code_t json_decode_struct(const char* p_data, size_t size, json_struct_desc_t* p_desc, void* p_out, json_error_t* p_error) {
+	if ((p_data == NULL && size > 0) || p_desc == NULL || p_out == NULL) {
+		return JSON_RETVAL_INVALID_PARAM;
+	}
+	json_ret_code_t ret = json_struct_desc_compile(p_desc);
+	if (ret != JSON_RETVAL_OK) {
+		return ret;
+	}
+
+	json_lex_cursor_t dec = {.p_data = p_data, .size = size};
+	ret = json_lex_cursor_next_char(&dec, "object");
+	if (ret == JSON_RETVAL_OK) {
+		ret = json_decode_object(&dec, p_desc, p_out, 0);
+	}
+	// Nothing but whitespace may follow the object
+	if (ret == JSON_RETVAL_OK) {
+		dec.pos += json_lex_skip_whitespace(&p_data[dec.pos], size - dec.pos);
+		if (dec.pos < size) {
+			ret = json_lex_cursor_error(&dec, JSON_ERROR_UNEXPECTED_TOKEN, dec.pos, "end of input");
+		}
+	}
+	if (p_error != NULL) {
+		*p_error = dec.error;
+	}
+	return ret;
+}
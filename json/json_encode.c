@@ -0,0 +1,72 @@
+#include <string.h>
+#include "json.h"
+#include "json_struct.h"
+#include "json_writer.h"
+
+/*
+ * Encoding a C struct described by a json_struct_desc_t, the counterpart of json_decode_struct. Keys are written
+ * from the fragments the descriptor macros build at compile time ("\"id\":"), values are formatted from the struct
+ * directly with the json_writer_t helpers. The writer lives on the stack and hands its buffer to the sink
+ * whenever it is full, so nothing is allocated. Doubles are written with the fewest digits that read back the same
+ * value, NaN and infinity as null.
+ */
+
+static void json_encode_object(json_writer_t* p_writer, const json_struct_desc_t* p_desc, const char* p_in) {
+	json_writer_append_char(p_writer, '{');
+	for (uint32_t i = 0; i < p_desc->num_fields && p_writer->ret == JSON_RETVAL_OK; i++) {
+		const json_field_desc_t* p_field = &p_desc->fields[i];
+		const char* p_value = p_in + p_field->offset;
+		if (i > 0) {
+			json_writer_append_char(p_writer, ',');
+		}
+		json_writer_append(p_writer, p_field->fragment, p_field->fragment_length);
+		switch (p_field->type) {
+			case JSON_FIELD_TYPE_DOUBLE: {
+				double number;
+				memcpy(&number, p_value, sizeof(double));
+				json_writer_append_double(p_writer, number);
+				break;
+			}
+			case JSON_FIELD_TYPE_INT64: {
+				int64_t integer;
+				memcpy(&integer, p_value, sizeof(int64_t));
+				json_writer_append_integer(p_writer, integer);
+				break;
+			}
+			case JSON_FIELD_TYPE_INT32: {
+				int32_t integer;
+				memcpy(&integer, p_value, sizeof(int32_t));
+				json_writer_append_integer(p_writer, integer);
+				break;
+			}
+			case JSON_FIELD_TYPE_BOOL: {
+				bool boolean;
+				memcpy(&boolean, p_value, sizeof(bool));
+				json_writer_append(p_writer, boolean ? "true" : "false", boolean ? 4 : 5);
+				break;
+			}
+			case JSON_FIELD_TYPE_STRING:
+				json_writer_append_string(p_writer, p_value, strnlen(p_value, p_field->size));
+				break;
+			case JSON_FIELD_TYPE_OBJECT:
+				json_encode_object(p_writer, p_field->p_desc, p_value);
+				break;
+		}
+	}
+	json_writer_append_char(p_writer, '}');
+}
+
+json_ret_code_t json_encode_struct(json_struct_desc_t* p_desc, const void* p_in, json_sink_fn sink, void* p_context) {
+	if (p_desc == NULL || p_in == NULL || sink == NULL) {
+		return JSON_RETVAL_INVALID_PARAM;
+	}
+	json_ret_code_t ret = json_struct_desc_compile(p_desc);
+	if (ret != JSON_RETVAL_OK) {
+		return ret;
+	}
+	json_writer_t writer;
+	json_writer_init(&writer, sink, p_context);
+	json_encode_object(&writer, p_desc, p_in);
+	json_writer_flush(&writer);
+	return writer.ret;
+}
@@ -0,0 +1,91 @@
+#include <stdio.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "json.h"
+
+/*
+ * Errors are reported as a code and a byte offset only. Line, column and the source snippet are derived here,
+ * on request, so that failing inputs cost nothing beyond filling in the json_error_t. The lexer does not track
+ * lines at all, the line number is a newline count up to the error offset.
+ */
+
+const char* json_error_get_str(json_error_code_t code) {
+	switch (code) {
+		case JSON_ERROR_NONE:
+			return "No error";
+		case JSON_ERROR_UNEXPECTED_EOF:
+			return "Unexpected end of file";
+		case JSON_ERROR_UNEXPECTED_TOKEN:
+			return "Unexpected token";
+		case JSON_ERROR_EXPECTED_DIGIT:
+			return "Expected digit";
+		case JSON_ERROR_NAN:
+			return "Not a number";
+		case JSON_ERROR_ILLEGAL_ESCAPE_SEQUENCE:
+			return "Illegal escape sequence";
+		case JSON_ERROR_INVALID_UNICODE_CHAR:
+			return "Invalid unicode escape sequence in string";
+		case JSON_ERROR_CONTROL_CHAR:
+			return "Unescaped control character in string";
+		case JSON_ERROR_MAX_NESTING_LEVEL:
+			return "Maximum nesting level exceeded";
+		case JSON_ERROR_OUT_OF_MEMORY:
+			return "Failed to allocate memory";
+		case JSON_ERROR_FILE_ACCESS:
+			return "Failed to open or map file";
+		case JSON_ERROR_SCHEMA:
+			return "Schema violation";
+		default:
+			return "Unknown error";
+	}
+}
+
+static uint64_t json_error_count_newlines(const char* p_data, uint64_t len) {
+	uint64_t count = 0, i = 0;
+#if defined(__SSE2__)
+	const __m128i newline = _mm_set1_epi8('\n');
+	for (; i + 16 <= len; i += 16) {
+		__m128i chunk = _mm_loadu_si128((const __m128i*) &p_data[i]);
+		count += __builtin_popcount(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline)));
+	}
+#endif
+	for (; i < len; i++) {
+		count += p_data[i] == '\n';
+	}
+	return count;
+}
+
+static uint64_t json_error_get_line_start(const char* p_data, uint64_t offset) {
+	while (offset > 0 && p_data[offset - 1] != '\n') {
+		offset--;
+	}
+	return offset;
+}
+
+void json_error_get_position(const char* p_data, size_t size, const json_error_t* p_error, uint64_t* p_line, uint64_t* p_column) {
+	uint64_t offset = p_error->offset < size ? p_error->offset : size;
+
+	*p_line = json_error_count_newlines(p_data, offset) + 1;
+	*p_column = offset - json_error_get_line_start(p_data, offset) + 1;
+}
+
+void json_error_print(const char* p_data, size_t size, const json_error_t* p_error) {
+	uint64_t line, column;
+	json_error_get_position(p_data, size, p_error, &line, &column);
+
+	printf("\033[31mSyntaxError: %s", json_error_get_str(p_error->code));
+	if (p_error->expected != NULL) {
+		printf(", expected %s", p_error->expected);
+	}
+	printf(" at %llu:%llu\033[0m\n", (unsigned long long) line, (unsigned long long) column);
+
+	uint64_t line_start = json_error_get_line_start(p_data, p_error->offset < size ? p_error->offset : size);
+	uint64_t line_end = line_start;
+	while (line_end < size && p_data[line_end] != '\n' && p_data[line_end] != '\r') {
+		line_end++;
+	}
+
+	printf("%5llu |     %.*s\n", (unsigned long long) line, (int) (line_end - line_start), &p_data[line_start]);
+	printf("      |     %*s\033[31m^\033[0m\n", (int) column - 1, "");
+}
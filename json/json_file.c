@@ -0,0 +1,64 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "json_file.h"
+#include "json_lex.h"
+#include "json_parse.h"
+
+/*
+ * Files are parsed straight from a read-only mapping, there is no read into a heap buffer. The mapped pages stay
+ * clean and belong to the page cache, the strings are copied out and the mapping is released after parsing.
+ */
+
+#define JSON_FILE_SET_ERROR(_code) { \
+	if (p_error != NULL) { \
+		p_error->code = (_code); \
+		p_error->offset = 0; \
+		p_error->expected = NULL; \
+	} \
+}
+
+json_ret_code_t json_file_parse(const char* path, json_document_t* p_document, json_error_t* p_error) {
+	if (path == NULL || p_document == NULL) {
+		return JSON_RETVAL_INVALID_PARAM;
+	}
+	memset(p_document, 0, sizeof(json_document_t));
+
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		JSON_FILE_SET_ERROR(JSON_ERROR_FILE_ACCESS);
+		return JSON_RETVAL_FAIL;
+	}
+	struct stat file_stat;
+	if (fstat(fd, &file_stat) != 0) {
+		close(fd);
+		JSON_FILE_SET_ERROR(JSON_ERROR_FILE_ACCESS);
+		return JSON_RETVAL_FAIL;
+	}
+
+	// An empty file cannot be mapped, it is parsed as empty input
+	size_t size = (size_t) file_stat.st_size;
+	char* p_data = NULL;
+	if (size > 0) {
+		p_data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (p_data == MAP_FAILED) {
+			close(fd);
+			JSON_FILE_SET_ERROR(JSON_ERROR_FILE_ACCESS);
+			return JSON_RETVAL_FAIL;
+		}
+		madvise(p_data, size, MADV_SEQUENTIAL);
+	}
+	close(fd);
+
+	json_ret_code_t ret = json_parse_object_input(p_data != NULL ? p_data : "", size, JSON_LEX_FLAG_NONE, NULL, NULL, NULL,
+												  &p_document->root, p_error);
+	if (p_data != NULL) {
+		munmap(p_data, size);
+	}
+	if (ret != JSON_RETVAL_OK) {
+		json_document_free(p_document);
+	}
+
+	return ret;
+}
@@ -0,0 +1,8 @@
+#ifndef JSON_PARSER_JSON_FILE_H
+#define JSON_PARSER_JSON_FILE_H
+
+#include "json.h"
+
+json_ret_code_t json_file_parse(const char* path, json_document_t* p_document, json_error_t* p_error);
+
+#endif //JSON_PARSER_JSON_FILE_H
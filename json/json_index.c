@@ -0,0 +1,341 @@
+#include <stdlib.h>
+#include <string.h>
+#include "json.h"
+#include "json_lex.h"
+
+/*
+ * Secondary index over the rows of a container, the objects in an array or the object values of an object, keyed
+ * by one field of each row. Entries reference the row and the position of the field among its members, members
+ * only ever get appended so the position stays valid while the row grows. A hash index keeps the entries in an
+ * open addressing table for point lookups, a sorted index keeps them ordered by type and value for point lookups
+ * and range scans. Only string and number fields are indexed.
+ *
+ * Every lookup first catches up with json_object_add_value: rows appended to the container are added, and rows
+ * that did not have the field are looked at again when their number of members changed. A container that shrank
+ * is indexed again from scratch. Other changes, like replacing a field value in place, need json_index_rebuild.
+ */
+
+#define JSON_INDEX_MIN_CAPACITY		64
+#define JSON_INDEX_NO_MEMBER		UINT32_MAX
+
+typedef struct {
+	json_object_t* p_row;
+	uint32_t member;	// Position of the field among the members of the row
+	uint64_t hash;
+} json_index_entry_t;
+
+// Row without the field, looked at again when it gets new members
+typedef struct {
+	json_object_t* p_row;
+	uint32_t num_members;
+} json_index_pending_t;
+
+struct json_index_t {
+	json_index_type_t type;
+	json_value_type_t container_type;
+	json_value_t container;
+	char* field;
+	json_index_entry_t* entries;
+	size_t num_entries;
+	size_t max_entries;
+	uint32_t* slots;		// Hash index only, entry position + 1 or 0 for an empty slot
+	size_t mask;
+	json_index_pending_t* pending;
+	size_t num_pending;
+	size_t max_pending;
+	size_t num_rows;		// Rows of the container that were added
+	bool is_sorted;
+};
+
+static inline size_t json_index_get_num_rows(const json_index_t* p_index) {
+	if (p_index->container_type == JSON_VALUE_TYPE_OBJECT) {
+		return p_index->container.object->num_members;
+	}
+	return p_index->container.array->numbers != NULL ? 0 : p_index->container.array->length;
+}
+
+static inline json_object_t* json_index_get_row(const json_index_t* p_index, size_t row) {
+	if (p_index->container_type == JSON_VALUE_TYPE_OBJECT) {
+		const json_object_member_t* p_member = &p_index->container.object->members[row];
+		return p_member->type == JSON_VALUE_TYPE_OBJECT ? p_member->value.object : NULL;
+	}
+	const json_array_member_t* p_member = &p_index->container.array->values[row];
+	return p_member->type == JSON_VALUE_TYPE_OBJECT ? p_member->value.object : NULL;
+}
+
+static inline const json_object_member_t* json_index_entry_member(const json_index_entry_t* p_entry) {
+	return &p_entry->p_row->members[p_entry->member];
+}
+
+// Hash of the string, or of the bits of the number with -0 folded into 0
+static uint64_t json_index_hash(json_value_t key, json_value_type_t type) {
+	if (type == JSON_VALUE_TYPE_STRING) {
+		return json_lex_hash(key.string, strlen(key.string));
+	}
+	double number = key.number == 0 ? 0 : key.number;
+	return json_lex_hash((const char*) &number, sizeof(number));
+}
+
+// Orders by type, then by value
+static int json_index_compare(const json_value_t* p_a, json_value_type_t a_type, const json_value_t* p_b, json_value_type_t b_type) {
+	if (a_type != b_type) {
+		return a_type < b_type ? -1 : 1;
+	}
+	if (a_type == JSON_VALUE_TYPE_STRING) {
+		return strcmp(p_a->string, p_b->string);
+	}
+	return p_a->number < p_b->number ? -1 : p_a->number > p_b->number;
+}
+
+static int json_index_compare_entries(const void* p_a, const void* p_b) {
+	const json_object_member_t* p_member_a = json_index_entry_member(p_a);
+	const json_object_member_t* p_member_b = json_index_entry_member(p_b);
+	return json_index_compare(&p_member_a->value, p_member_a->type, &p_member_b->value, p_member_b->type);
+}
+
+// Position of the field in the row, JSON_INDEX_NO_MEMBER if it is missing or not a string or number
+static uint32_t json_index_find_field(const json_index_t* p_index, const json_object_t* p_row, bool* p_is_present) {
+	for (uint32_t i = 0; i < p_row->num_members; i++) {
+		if (strcmp(p_row->members[i].key, p_index->field) == 0) {
+			json_value_type_t type = p_row->members[i].type;
+			*p_is_present = true;
+			return type == JSON_VALUE_TYPE_STRING || type == JSON_VALUE_TYPE_NUMBER ? i : JSON_INDEX_NO_MEMBER;
+		}
+	}
+	*p_is_present = false;
+	return JSON_INDEX_NO_MEMBER;
+}
+
+static void json_index_insert_slot(json_index_t* p_index, size_t entry) {
+	size_t slot = p_index->entries[entry].hash & p_index->mask;
+	while (p_index->slots[slot] != 0) {
+		slot = (slot + 1) & p_index->mask;
+	}
+	p_index->slots[slot] = (uint32_t) entry + 1;
+}
+
+// Keeps the load factor of the table at or below one half
+static json_ret_code_t json_index_reserve_slots(json_index_t* p_index, size_t num_entries) {
+	size_t capacity = p_index->slots != NULL ? p_index->mask + 1 : JSON_INDEX_MIN_CAPACITY / 2;
+	if (p_index->slots != NULL && num_entries * 2 <= capacity) {
+		return JSON_RETVAL_OK;
+	}
+	while (num_entries * 2 > capacity) {
+		capacity *= 2;
+	}
+	uint32_t* slots = calloc(capacity, sizeof(uint32_t));
+	if (slots == NULL) {
+		return JSON_RETVAL_FAIL;
+	}
+	free(p_index->slots);
+	p_index->slots = slots;
+	p_index->mask = capacity - 1;
+	for (size_t i = 0; i < p_index->num_entries; i++) {
+		json_index_insert_slot(p_index, i);
+	}
+	return JSON_RETVAL_OK;
+}
+
+static json_ret_code_t json_index_add_entry(json_index_t* p_index, json_object_t* p_row, uint32_t member) {
+	if (p_index->num_entries >= UINT32_MAX - 1) {
+		return JSON_RETVAL_FAIL;
+	}
+	if (p_index->num_entries == p_index->max_entries) {
+		size_t max_entries = MAX(p_index->max_entries * 2, (size_t) JSON_INDEX_MIN_CAPACITY);
+		json_index_entry_t* entries = realloc(p_index->entries, max_entries * sizeof(json_index_entry_t));
+		if (entries == NULL) {
+			return JSON_RETVAL_FAIL;
+		}
+		p_index->entries = entries;
+		p_index->max_entries = max_entries;
+	}
+	if (p_index->type == JSON_INDEX_TYPE_HASH && json_index_reserve_slots(p_index, p_index->num_entries + 1) != JSON_RETVAL_OK) {
+		return JSON_RETVAL_FAIL;
+	}
+	json_index_entry_t* p_entry = &p_index->entries[p_index->num_entries];
+	*p_entry = (json_index_entry_t) {.p_row = p_row, .member = member};
+	p_entry->hash = json_index_hash(p_row->members[member].value, p_row->members[member].type);
+	if (p_index->type == JSON_INDEX_TYPE_HASH) {
+		json_index_insert_slot(p_index, p_index->num_entries);
+	}
+	p_index->num_entries++;
+	p_index->is_sorted = false;
+	return JSON_RETVAL_OK;
+}
+
+static json_ret_code_t json_index_add_pending(json_index_t* p_index, json_object_t* p_row) {
+	if (p_index->num_pending == p_index->max_pending) {
+		size_t max_pending = MAX(p_index->max_pending * 2, (size_t) JSON_INDEX_MIN_CAPACITY);
+		json_index_pending_t* pending = realloc(p_index->pending, max_pending * sizeof(json_index_pending_t));
+		if (pending == NULL) {
+			return JSON_RETVAL_FAIL;
+		}
+		p_index->pending = pending;
+		p_index->max_pending = max_pending;
+	}
+	p_index->pending[p_index->num_pending++] = (json_index_pending_t) {.p_row = p_row, .num_members = p_row->num_members};
+	return JSON_RETVAL_OK;
+}
+
+// Catches up with rows and fields added since the last lookup
+static json_ret_code_t json_index_sync(json_index_t* p_index) {
+	size_t num_rows = json_index_get_num_rows(p_index);
+	if (num_rows < p_index->num_rows) {
+		return json_index_rebuild(p_index);
+	}
+
+	for (size_t i = 0; i < p_index->num_pending;) {
+		json_index_pending_t* p_pending = &p_index->pending[i];
+		if (p_pending->p_row->num_members == p_pending->num_members) {
+			i++;
+			continue;
+		}
+		bool is_present;
+		uint32_t member = json_index_find_field(p_index, p_pending->p_row, &is_present);
+		if (member != JSON_INDEX_NO_MEMBER && json_index_add_entry(p_index, p_pending->p_row, member) != JSON_RETVAL_OK) {
+			return JSON_RETVAL_FAIL;
+		}
+		if (is_present) {
+			*p_pending = p_index->pending[--p_index->num_pending];
+		} else {
+			p_pending->num_members = p_pending->p_row->num_members;
+			i++;
+		}
+	}
+
+	for (; p_index->num_rows < num_rows; p_index->num_rows++) {
+		json_object_t* p_row = json_index_get_row(p_index, p_index->num_rows);
+		if (p_row == NULL) {
+			continue;
+		}
+		bool is_present;
+		uint32_t member = json_index_find_field(p_index, p_row, &is_present);
+		json_ret_code_t ret = JSON_RETVAL_OK;
+		if (member != JSON_INDEX_NO_MEMBER) {
+			ret = json_index_add_entry(p_index, p_row, member);
+		} else if (!is_present) {
+			ret = json_index_add_pending(p_index, p_row);
+		}
+		if (ret != JSON_RETVAL_OK) {
+			return ret;
+		}
+	}
+
+	if (p_index->type == JSON_INDEX_TYPE_SORTED && !p_index->is_sorted) {
+		qsort(p_index->entries, p_index->num_entries, sizeof(json_index_entry_t), json_index_compare_entries);
+		p_index->is_sorted = true;
+	}
+	return JSON_RETVAL_OK;
+}
+
+json_index_t* json_index_new(const json_value_t* p_container, json_value_type_t container_type, const char* field,
+							 json_index_type_t type) {
+	if (p_container == NULL || field == NULL || (container_type != JSON_VALUE_TYPE_ARRAY && container_type != JSON_VALUE_TYPE_OBJECT) ||
+		(type != JSON_INDEX_TYPE_HASH && type != JSON_INDEX_TYPE_SORTED) || p_container->object == NULL) {
+		return NULL;
+	}
+	json_index_t* p_index = calloc(1, sizeof(json_index_t));
+	if (p_index == NULL) {
+		return NULL;
+	}
+	p_index->type = type;
+	p_index->container_type = container_type;
+	p_index->container = *p_container;
+	p_index->field = strdup(field);
+	if (p_index->field == NULL || json_index_sync(p_index) != JSON_RETVAL_OK) {
+		json_index_free(p_index);
+		return NULL;
+	}
+	return p_index;
+}
+
+json_ret_code_t json_index_rebuild(json_index_t* p_index) {
+	if (p_index == NULL) {
+		return JSON_RETVAL_INVALID_PARAM;
+	}
+	p_index->num_entries = 0;
+	p_index->num_pending = 0;
+	p_index->num_rows = 0;
+	if (p_index->slots != NULL) {
+		memset(p_index->slots, 0, (p_index->mask + 1) * sizeof(uint32_t));
+	}
+	return json_index_sync(p_index);
+}
+
+void json_index_free(json_index_t* p_index) {
+	if (p_index == NULL) {
+		return;
+	}
+	free(p_index->field);
+	free(p_index->entries);
+	free(p_index->slots);
+	free(p_index->pending);
+	free(p_index);
+}
+
+// First sorted entry that is not less than the key
+static size_t json_index_lower_bound(const json_index_t* p_index, const json_value_t* p_key, json_value_type_t key_type) {
+	size_t low = 0, high = p_index->num_entries;
+	while (low < high) {
+		size_t mid = low + (high - low) / 2;
+		const json_object_member_t* p_member = json_index_entry_member(&p_index->entries[mid]);
+		if (json_index_compare(&p_member->value, p_member->type, p_key, key_type) < 0) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+	return low;
+}
+
+json_object_t* json_index_find(json_index_t* p_index, json_value_t key, json_value_type_t key_type) {
+	if (p_index == NULL || (key_type != JSON_VALUE_TYPE_STRING && key_type != JSON_VALUE_TYPE_NUMBER) ||
+		(key_type == JSON_VALUE_TYPE_STRING && key.string == NULL) || json_index_sync(p_index) != JSON_RETVAL_OK) {
+		return NULL;
+	}
+
+	if (p_index->type == JSON_INDEX_TYPE_SORTED) {
+		size_t position = json_index_lower_bound(p_index, &key, key_type);
+		if (position == p_index->num_entries) {
+			return NULL;
+		}
+		const json_object_member_t* p_member = json_index_entry_member(&p_index->entries[position]);
+		return json_index_compare(&p_member->value, p_member->type, &key, key_type) == 0 ? p_index->entries[position].p_row : NULL;
+	}
+
+	if (p_index->slots == NULL) {
+		return NULL;
+	}
+	uint64_t hash = json_index_hash(key, key_type);
+	for (size_t slot = hash & p_index->mask; p_index->slots[slot] != 0; slot = (slot + 1) & p_index->mask) {
+		const json_index_entry_t* p_entry = &p_index->entries[p_index->slots[slot] - 1];
+		const json_object_member_t* p_member = json_index_entry_member(p_entry);
+		if (p_entry->hash == hash && json_index_compare(&p_member->value, p_member->type, &key, key_type) == 0) {
+			return p_entry->p_row;
+		}
+	}
+	return NULL;
+}
+
+size_t json_index_range(json_index_t* p_index, json_value_t lower, json_value_t upper, json_value_type_t key_type,
+						json_object_t** rows, size_t max_rows) {
+	if (p_index == NULL || p_index->type != JSON_INDEX_TYPE_SORTED ||
+		(key_type != JSON_VALUE_TYPE_STRING && key_type != JSON_VALUE_TYPE_NUMBER) ||
+		(key_type == JSON_VALUE_TYPE_STRING && (lower.string == NULL || upper.string == NULL)) ||
+		json_index_sync(p_index) != JSON_RETVAL_OK) {
+		return 0;
+	}
+
+	size_t num_rows = 0;
+	for (size_t i = json_index_lower_bound(p_index, &lower, key_type); i < p_index->num_entries; i++) {
+		const json_object_member_t* p_member = json_index_entry_member(&p_index->entries[i]);
+		if (json_index_compare(&p_member->value, p_member->type, &upper, key_type) > 0) {
+			break;
+		}
+		if (num_rows < max_rows) {
+			rows[num_rows] = p_index->entries[i].p_row;
+		}
+		num_rows++;
+	}
+	return num_rows;
+}
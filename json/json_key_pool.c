@@ -0,0 +1,154 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include "json.h"
+#include "json_arena.h"
+#include "json_lex.h"
+
+/*
+ * Pool of interned keys shared by many documents and threads. Keys live in an open addressing hash table of
+ * entry pointers. Lookups run without a lock: they load the current table and its slots with acquire semantics,
+ * entries are immutable once published. Inserts take the mutex, look again and publish the new entry with a
+ * release store. A table that has to grow is copied into a new one that is then published, the old table stays
+ * allocated until json_key_pool_free because readers may still probe it. A reader that misses a key on an old
+ * table falls through to the locked path, which always uses the current table. Entries are allocated from an
+ * arena and never move, so an interned key stays valid until the pool is freed.
+ */
+
+#define JSON_KEY_POOL_MIN_CAPACITY		256
+#define JSON_KEY_POOL_ARENA_BLOCK_SIZE	(64 * 1024)
+
+typedef struct {
+	uint64_t hash;
+	size_t length;
+	char key[];
+} json_key_pool_entry_t;
+
+typedef struct json_key_pool_table_t {
+	struct json_key_pool_table_t* p_retired;	// Previous tables, freed with the pool
+	size_t mask;
+	json_key_pool_entry_t* entries[];
+} json_key_pool_table_t;
+
+struct json_key_pool_t {
+	json_key_pool_table_t* p_table;
+	size_t num_entries;
+	json_arena_t* p_arena;
+	pthread_mutex_t mutex;
+};
+
+static json_key_pool_table_t* json_key_pool_table_new(size_t capacity) {
+	json_key_pool_table_t* p_table = calloc(1, sizeof(json_key_pool_table_t) + capacity * sizeof(json_key_pool_entry_t*));
+	if (p_table != NULL) {
+		p_table->mask = capacity - 1;
+	}
+	return p_table;
+}
+
+// Slot of the key in the table, or the empty slot where it would be inserted
+static inline size_t json_key_pool_find(const json_key_pool_table_t* p_table, uint64_t hash, const char* key, size_t length,
+										json_key_pool_entry_t** p_entry) {
+	size_t index = hash & p_table->mask;
+	while (true) {
+		json_key_pool_entry_t* p_current = __atomic_load_n(&p_table->entries[index], __ATOMIC_ACQUIRE);
+		if (p_current == NULL ||
+			(p_current->hash == hash && p_current->length == length && memcmp(p_current->key, key, length) == 0)) {
+			*p_entry = p_current;
+			return index;
+		}
+		index = (index + 1) & p_table->mask;
+	}
+}
+
+json_key_pool_t* json_key_pool_new(void) {
+	json_key_pool_t* p_pool = calloc(1, sizeof(json_key_pool_t));
+	if (p_pool == NULL) {
+		return NULL;
+	}
+	pthread_mutex_init(&p_pool->mutex, NULL);
+	p_pool->p_table = json_key_pool_table_new(JSON_KEY_POOL_MIN_CAPACITY);
+	p_pool->p_arena = json_arena_new(JSON_KEY_POOL_ARENA_BLOCK_SIZE);
+	if (p_pool->p_table == NULL || p_pool->p_arena == NULL) {
+		json_key_pool_free(p_pool);
+		return NULL;
+	}
+	return p_pool;
+}
+
+void json_key_pool_free(json_key_pool_t* p_pool) {
+	if (p_pool == NULL) {
+		return;
+	}
+	json_key_pool_table_t* p_table = p_pool->p_table;
+	while (p_table != NULL) {
+		json_key_pool_table_t* p_retired = p_table->p_retired;
+		free(p_table);
+		p_table = p_retired;
+	}
+	json_arena_free(p_pool->p_arena);
+	pthread_mutex_destroy(&p_pool->mutex);
+	free(p_pool);
+}
+
+// Rehashes into a table of twice the size, called with the mutex held
+static json_ret_code_t json_key_pool_grow(json_key_pool_t* p_pool) {
+	json_key_pool_table_t* p_old = p_pool->p_table;
+	json_key_pool_table_t* p_new = json_key_pool_table_new((p_old->mask + 1) * 2);
+	if (p_new == NULL) {
+		return JSON_RETVAL_FAIL;
+	}
+	for (size_t i = 0; i <= p_old->mask; i++) {
+		json_key_pool_entry_t* p_entry = p_old->entries[i];
+		if (p_entry == NULL) {
+			continue;
+		}
+		size_t index = p_entry->hash & p_new->mask;
+		while (p_new->entries[index] != NULL) {
+			index = (index + 1) & p_new->mask;
+		}
+		p_new->entries[index] = p_entry;
+	}
+	p_new->p_retired = p_old;
+	__atomic_store_n(&p_pool->p_table, p_new, __ATOMIC_RELEASE);
+	return JSON_RETVAL_OK;
+}
+
+const char* json_key_pool_intern(json_key_pool_t* p_pool, const char* key, size_t length) {
+	if (p_pool == NULL || key == NULL) {
+		return NULL;
+	}
+	uint64_t hash = json_lex_hash(key, length);
+	json_key_pool_entry_t* p_entry;
+	json_key_pool_find(__atomic_load_n(&p_pool->p_table, __ATOMIC_ACQUIRE), hash, key, length, &p_entry);
+	if (p_entry != NULL) {
+		return p_entry->key;
+	}
+
+	pthread_mutex_lock(&p_pool->mutex);
+	// Keep the load factor at or below one half
+	if ((p_pool->num_entries + 1) * 2 > p_pool->p_table->mask + 1 && json_key_pool_grow(p_pool) != JSON_RETVAL_OK) {
+		pthread_mutex_unlock(&p_pool->mutex);
+		return NULL;
+	}
+	size_t index = json_key_pool_find(p_pool->p_table, hash, key, length, &p_entry);
+	if (p_entry == NULL && (p_entry = json_arena_alloc(p_pool->p_arena, sizeof(json_key_pool_entry_t) + length + 1)) != NULL) {
+		p_entry->hash = hash;
+		p_entry->length = length;
+		memcpy(p_entry->key, key, length);
+		p_entry->key[length] = '\0';
+		p_pool->num_entries++;
+		__atomic_store_n(&p_pool->p_table->entries[index], p_entry, __ATOMIC_RELEASE);
+	}
+	pthread_mutex_unlock(&p_pool->mutex);
+	return p_entry != NULL ? p_entry->key : NULL;
+}
+
+size_t json_key_pool_get_num_keys(json_key_pool_t* p_pool) {
+	if (p_pool == NULL) {
+		return 0;
+	}
+	pthread_mutex_lock(&p_pool->mutex);
+	size_t num_keys = p_pool->num_entries;
+	pthread_mutex_unlock(&p_pool->mutex);
+	return num_keys;
+}
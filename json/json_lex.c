@@ -6,6 +6,10 @@
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <math.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 #include "json_lex.h"
 
 #define JSON_TOKEN_STR_REPR_START_OBJECT				"{"
@@ -39,31 +43,10 @@
 #define JSON_TOKEN_STR_REPR_WHITESPACE_HORIZ_TAB		"\t"
 #define JSON_TOKEN_STR_REPR_WHITESPACE_CRLF				"\r\n"
 
-#define JSON_LEX_CHAR_BUFFER_SIZE	1000 * 1024
-
-typedef enum {
-	JSON_LEX_ERRCODE_OK,
-	JSON_LEX_ERRCODE_UNEXPECTED_EOF,
-	JSON_LEX_ERRCODE_UNEXPECTED_TOKEN,
-	JSON_LEX_ERRCODE_EXPECTED_DIGIT,
-	JSON_LEX_ERRCODE_NAN,
-	JSON_LEX_ERRCODE_ILLEGAL_ESCAPE_SEQUENCE,
-	JSON_LEX_ERRCODE_INVALID_UNICODE_CHAR,
-} json_lex_errcode;
-
-static struct {
-	char buffer[JSON_LEX_CHAR_BUFFER_SIZE];
-	uint16_t buffer_len;
-	json_token_t token;
-	json_ret_code_t ret_code;
-	uint16_t line;
-	uint16_t column;
-	uint16_t line_start;
-	json_lex_errcode err_code;
-} m_json_lex;
+static json_lex_t m_json_lex;
 
 json_ret_code_t json_strcmp_partial(const char* expect_str, const char* actual_str,
-												  uint16_t expect_str_len, uint16_t actual_str_len) {
+												  size_t expect_str_len, size_t actual_str_len) {
 	if (expect_str_len < actual_str_len || actual_str_len == 0) {
 		return JSON_RETVAL_FAIL;
 	}
@@ -73,41 +56,58 @@ json_ret_code_t json_strcmp_partial(const char* expect_str, const char* actual_s
 	return strncmp(expect_str, actual_str, actual_str_len) == 0 ? JSON_RETVAL_INCOMPLETE : JSON_RETVAL_FAIL;
 }
 
-json_ret_code_t json_str_unescape(char* str_dest, const char* str_src, uint16_t str_len) {
-	uint16_t j = 0;
-	for (uint16_t i = 0; i < str_len; i++) {
-		if (str_src[i] == '\\') {
-			if (i + 1 >= str_len) {
-				return JSON_RETVAL_INCOMPLETE;
-			}
-			switch (str_src[++i]) {
-				case '"': str_dest[j++] = '"'; break;
-				case '\\': str_dest[j++] = '\\'; break;
-				case '/': str_dest[j++] = '/'; break;
-				case 'b': str_dest[j++] = '\b'; break;
-				case 'f': str_dest[j++] = '\f'; break;
-				case 'n': str_dest[j++] = '\n'; break;
-				case 'r': str_dest[j++] = '\r'; break;
-				case 't': str_dest[j++] = '\t'; break;
-				case 'u':
-					i++;
-					if (i + 4 >= str_len) {
-						return JSON_RETVAL_INCOMPLETE;
-					}
-					uint16_t unicode_char = strtol(&str_src[i], NULL, 16);
-					str_dest[j++] = (char) unicode_char;
-					i += 4;
-					break;
-				default:
-					return JSON_RETVAL_ILLEGAL;
-			}
-			continue;
+json_ret_code_t json_lex_unescape(char* str_dest, const char* str_src, size_t str_len, size_t* p_dest_len) {
+	size_t i = 0, j = 0;
+	while (i < str_len) {
+		// Copy runs without escape sequences at once, source and destination may overlap when unescaping in place
+		const char* p_esc = memchr(&str_src[i], '\\', str_len - i);
+		size_t run_len = p_esc == NULL ? str_len - i : (size_t) (p_esc - &str_src[i]);
+		if (&str_dest[j] != &str_src[i]) {
+			memmove(&str_dest[j], &str_src[i], run_len);
+		}
+		i += run_len;
+		j += run_len;
+		if (i >= str_len) {
+			break;
 		}
-		str_dest[j++] = str_src[i];
+		if (i + 1 >= str_len) {
+			return JSON_RETVAL_INCOMPLETE;
+		}
+		switch (str_src[++i]) {
+			case '"': str_dest[j++] = '"'; break;
+			case '\\': str_dest[j++] = '\\'; break;
+			case '/': str_dest[j++] = '/'; break;
+			case 'b': str_dest[j++] = '\b'; break;
+			case 'f': str_dest[j++] = '\f'; break;
+			case 'n': str_dest[j++] = '\n'; break;
+			case 'r': str_dest[j++] = '\r'; break;
+			case 't': str_dest[j++] = '\t'; break;
+			case 'u':
+				i++;
+				if (i + 4 > str_len) {
+					return JSON_RETVAL_INCOMPLETE;
+				}
+				char hex[5] = {str_src[i], str_src[i + 1], str_src[i + 2], str_src[i + 3], '\0'};
+				uint16_t unicode_char = strtol(hex, NULL, 16);
+				str_dest[j++] = (char) unicode_char;
+				i += 3;
+				break;
+			default:
+				return JSON_RETVAL_ILLEGAL;
+		}
+		i++;
+	}
+	str_dest[j] = '\0';
+	if (p_dest_len != NULL) {
+		*p_dest_len = j;
 	}
 	return JSON_RETVAL_OK;
 }
 
+json_ret_code_t json_str_unescape(char* str_dest, const char* str_src, size_t str_len) {
+	return json_lex_unescape(str_dest, str_src, str_len, NULL);
+}
+
 typedef enum {
 	JSON_PARSE_NUMBER_STATE_INIT,
 	JSON_PARSE_NUMBER_STATE_SIGN,
@@ -128,26 +128,55 @@ typedef enum {
 #define JSON_PARSE_NUMBER_GOTO(_state)			state = _state; continue;
 #define JSON_PARSE_NUMBER_NEXT_ON(c, _state)	if ((c) == str_src[i]) { JSON_PARSE_NUMBER_NEXT(_state); }
 
-static inline double pow10fast(uint32_t n) {
-	if (n <= 10) {
-		uint32_t pow10_table[] = {
-			1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
-		};
-		return (double) pow10_table[n];
+// Powers of ten that are exact in a double
+static const double m_pow10[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20,
+	1e21, 1e22
+};
+
+#define JSON_PARSE_NUMBER_MAX_DIGITS	19			// Significant digits that fit into the 64 bit mantissa
+#define JSON_PARSE_NUMBER_MAX_EXACT		(1ull << 53)	// Largest mantissa converted to a double without rounding
+#define JSON_PARSE_NUMBER_MAX_EXP		100000		// Exponents beyond this are infinity or zero anyway
+
+// Numbers that cannot be converted exactly are left to strtod, which rounds correctly
+static double json_parse_number_slow(const char* str_src, size_t str_len) {
+	char buffer[64];
+	char* p_copy = str_len < sizeof(buffer) ? buffer : malloc(str_len + 1);
+	if (p_copy == NULL) {
+		return NAN;
 	}
-	uint32_t i;
-	double result = 1.0f;
-	for (i = 0; i < n; i++) {
-		result *= 10.0f;
+	memcpy(p_copy, str_src, str_len);
+	p_copy[str_len] = '\0';
+	double result = strtod(p_copy, NULL);
+	if (p_copy != buffer) {
+		free(p_copy);
 	}
 	return result;
 }
 
-json_ret_code_t json_parse_number(double *p_dest, const char* str_src, uint16_t str_len) {
+/*
+ * The significant digits are collected into a 64 bit mantissa and the position of the decimal point into a power of
+ * ten. A mantissa of at most 2^53 scaled by at most 10^22 is exact in a double, a single multiplication or division
+ * then rounds correctly. Anything else goes through strtod.
+ */
+json_ret_code_t json_parse_number(double *p_dest, const char* str_src, size_t str_len) {
 	json_parse_number_state_t state = JSON_PARSE_NUMBER_STATE_INIT;
-	bool sign = false, exp_sign = false;
-	uint32_t integer = 0, exp = 0, i = 0;
-	double frac = 0.0f, frac_part = 10.0f;
+	bool sign = false, exp_sign = false, is_exact = true;
+	uint64_t mantissa = 0;
+	uint32_t num_digits = 0, exp = 0;
+	int32_t exp10 = 0;
+	size_t i = 0;
+
+// Appends a digit to the mantissa, digits that do not fit any more only move the decimal point
+#define JSON_PARSE_NUMBER_DIGIT(c, is_frac) \
+	if (num_digits < JSON_PARSE_NUMBER_MAX_DIGITS) { \
+		mantissa = mantissa * 10 + (uint64_t) ((c) - '0'); \
+		num_digits += mantissa != 0; \
+		exp10 -= (is_frac); \
+	} else { \
+		is_exact = is_exact && (c) == '0'; \
+		exp10 += !(is_frac); \
+	}
 
 	while (i < str_len) {
 		switch (state) {
@@ -164,7 +193,7 @@ json_ret_code_t json_parse_number(double *p_dest, const char* str_src, uint16_t
 				JSON_PARSE_NUMBER_GOTO(JSON_PARSE_NUMBER_STATE_SWITCH2);
 			case JSON_PARSE_NUMBER_STATE_DIGIT_NON_ZERO:
 				if (str_src[i] > '0' && str_src[i] <= '9') {
-					integer = str_src[i] - '0';
+					JSON_PARSE_NUMBER_DIGIT(str_src[i], false);
 					state = JSON_PARSE_NUMBER_STATE_DIGIT;
 					i++;
 					break;
@@ -173,7 +202,7 @@ json_ret_code_t json_parse_number(double *p_dest, const char* str_src, uint16_t
 				JSON_PARSE_NUMBER_GOTO(JSON_PARSE_NUMBER_STATE_SWITCH2);
 			case JSON_PARSE_NUMBER_STATE_DIGIT:
 				if (str_src[i] >= '0' && str_src[i] <= '9') {
-					integer = integer * 10 + str_src[i] - '0';
+					JSON_PARSE_NUMBER_DIGIT(str_src[i], false);
 					i++;
 					break;
 				}
@@ -186,18 +215,15 @@ json_ret_code_t json_parse_number(double *p_dest, const char* str_src, uint16_t
 				JSON_PARSE_NUMBER_GOTO(JSON_PARSE_NUMBER_STATE_FINISH);
 			case JSON_PARSE_NUMBER_STATE_FRAC_DOT:
 				if (str_src[i] >= '0' && str_src[i] <= '9') {
-					frac += (double) (str_src[i] - '0') / frac_part;
-					frac_part *= 10.0f;
+					JSON_PARSE_NUMBER_DIGIT(str_src[i], true);
 					state = JSON_PARSE_NUMBER_STATE_FRAC_DIGIT;
 					i++;
 					break;
 				}
-				m_json_lex.err_code = JSON_LEX_ERRCODE_EXPECTED_DIGIT;
 				return JSON_RETVAL_ILLEGAL;
 			case JSON_PARSE_NUMBER_STATE_FRAC_DIGIT:
 				if (str_src[i] >= '0' && str_src[i] <= '9') {
-					frac += (double) (str_src[i] - '0') / frac_part;
-					frac_part *= 10.0f;
+					JSON_PARSE_NUMBER_DIGIT(str_src[i], true);
 					i++;
 					break;
 				}
@@ -217,18 +243,17 @@ json_ret_code_t json_parse_number(double *p_dest, const char* str_src, uint16_t
 			case JSON_PARSE_NUMBER_STATE_EXP_SIGN:
 				if (str_src[i] >= '0' && str_src[i] <= '9') {
 					state = JSON_PARSE_NUMBER_STATE_EXP_DIGIT;
-					i++;
 					break;
 				}
-				m_json_lex.err_code = JSON_LEX_ERRCODE_EXPECTED_DIGIT;
 				return JSON_RETVAL_ILLEGAL;
 			case JSON_PARSE_NUMBER_STATE_EXP_DIGIT:
 				if (str_src[i] >= '0' && str_src[i] <= '9') {
-					exp = exp * 10 + str_src[i] - '0';
+					if (exp < JSON_PARSE_NUMBER_MAX_EXP) {
+						exp = exp * 10 + str_src[i] - '0';
+					}
 					i++;
 					break;
 				}
-				m_json_lex.err_code = JSON_LEX_ERRCODE_EXPECTED_DIGIT;
 				return JSON_RETVAL_ILLEGAL;
 			case JSON_PARSE_NUMBER_STATE_FINISH: {
 				return JSON_RETVAL_FAIL;
@@ -237,119 +262,270 @@ json_ret_code_t json_parse_number(double *p_dest, const char* str_src, uint16_t
 				return JSON_RETVAL_FAIL;
 		}
 	}
+#undef JSON_PARSE_NUMBER_DIGIT
 
 	// Valid finish states
-	if (state == JSON_PARSE_NUMBER_STATE_FINISH || state == JSON_PARSE_NUMBER_STATE_DIGIT ||
+	if (state == JSON_PARSE_NUMBER_STATE_FINISH || state == JSON_PARSE_NUMBER_STATE_ZERO || state == JSON_PARSE_NUMBER_STATE_DIGIT ||
 		state == JSON_PARSE_NUMBER_STATE_DIGIT_NON_ZERO || state == JSON_PARSE_NUMBER_STATE_FRAC_DIGIT ||
 		state == JSON_PARSE_NUMBER_STATE_EXP_DIGIT) {
-		double integer_signed = integer * (sign ? -1.0 : 1.0f);
-		double frac_signed = frac * (sign ? -1.0f : 1.0f);
-		double exp_signed = exp_sign ? 1.0f / pow10fast(exp) : pow10fast(exp);
-		double result =  (integer_signed + frac_signed) * exp_signed;
-		*p_dest = result;
+		exp10 += exp_sign ? -(int32_t) exp : (int32_t) exp;
+		double result;
+		if (mantissa == 0) {
+			result = 0.0;
+		} else if (is_exact && mantissa <= JSON_PARSE_NUMBER_MAX_EXACT && exp10 >= -22 && exp10 <= 22) {
+			result = exp10 >= 0 ? (double) mantissa * m_pow10[exp10] : (double) mantissa / m_pow10[-exp10];
+		} else {
+			*p_dest = json_parse_number_slow(str_src, str_len);
+			return JSON_RETVAL_OK;
+		}
+		*p_dest = sign ? -result : result;
 		return JSON_RETVAL_OK;
 	}
 
-	m_json_lex.err_code = JSON_LEX_ERRCODE_NAN;
 	return JSON_RETVAL_INCOMPLETE;
 }
 
-#define JSON_RETURN_COND_FALSE(c)		if (!(c)) { JSON_RETURN_BOOL(false); }
+// Exact value of the integer at the start of a valid number, false for fractions, exponents and values beyond min and max
+bool json_parse_integer(const char* p_input, size_t input_len, int64_t min, int64_t max, int64_t* p_integer) {
+	bool is_negative = input_len > 0 && p_input[0] == '-';
+	uint64_t limit = is_negative ? (uint64_t) -(min + 1) + 1 : (uint64_t) max;
+	uint64_t value = 0;
+	size_t i = is_negative;
+	for (; i < input_len && p_input[i] >= '0' && p_input[i] <= '9'; i++) {
+		uint64_t digit = (uint64_t) (p_input[i] - '0');
+		if (value > limit / 10 || (value == limit / 10 && digit > limit % 10)) {
+			return false;
+		}
+		value = value * 10 + digit;
+	}
+	if (i < input_len && (p_input[i] == '.' || p_input[i] == 'e' || p_input[i] == 'E')) {
+		return false;
+	}
+	*p_integer = is_negative ? (int64_t) (0 - value) : (int64_t) value;
+	return true;
+}
 
-#define JSON_MATCH_CHAR(c)					(m_json_lex.buffer[0] == (c))
-#define JSON_MATCH_STRING(s)				(strncmp(m_json_lex.buffer, (s), MAX(m_json_lex.buffer_len + 1, strlen(s))) == 0)
-#define JSON_MATCH_STRING_PARTIAL(s)		(json_strcmp_partial((s), m_json_lex.buffer, strlen(s), m_json_lex.buffer_len + 1))
-#define JSON_RETURN_MATCH_STRING(s)			JSON_RETURN_BOOL(JSON_MATCH_STRING(s))
-#define JSON_RETURN_MATCH_STRING_PARTIAL(s)	return JSON_MATCH_STRING_PARTIAL(s)
+/*
+ * Scanners operating directly on the input. They only determine the extent of a token and check its syntax,
+ * so they never allocate. On success *p_len is the token length, on JSON_RETVAL_INCOMPLETE the input ended
+ * inside the token and on JSON_RETVAL_ILLEGAL *p_len is the offset of the offending character.
+ */
 
-JSON_IS_TOKEN_TYPE_FN_IMPL(JSON_TOKEN_TYPE_START_OBJECT) { JSON_RETURN_MATCH_STRING(JSON_TOKEN_STR_REPR_START_OBJECT); }
-JSON_IS_TOKEN_TYPE_FN_IMPL(JSON_TOKEN_TYPE_END_OBJECT) { JSON_RETURN_MATCH_STRING(JSON_TOKEN_STR_REPR_END_OBJECT); }
-JSON_IS_TOKEN_TYPE_FN_IMPL(JSON_TOKEN_TYPE_MEMBER_DELIM) { JSON_RETURN_MATCH_STRING(JSON_TOKEN_STR_REPR_MEMBER_DELIM); }
-JSON_IS_TOKEN_TYPE_FN_IMPL(JSON_TOKEN_TYPE_NAME_VAL_DELIM) { JSON_RETURN_MATCH_STRING(JSON_TOKEN_STR_REPR_NAME_VAL_DELIM); }
-JSON_IS_TOKEN_TYPE_FN_IMPL(JSON_TOKEN_TYPE_VAL_START_ARRAY) { JSON_RETURN_MATCH_STRING(JSON_TOKEN_STR_REPR_VAL_START_ARRAY); }
-JSON_IS_TOKEN_TYPE_FN_IMPL(JSON_TOKEN_TYPE_VAL_END_ARRAY) { JSON_RETURN_MATCH_STRING(JSON_TOKEN_STR_REPR_VAL_END_ARRAY); }
-JSON_IS_TOKEN_TYPE_FN_IMPL(JSON_TOKEN_TYPE_VAL_NULL) { JSON_RETURN_MATCH_STRING_PARTIAL(JSON_TOKEN_STR_REPR_VAL_NULL); }
+static inline bool json_lex_is_digit(char c) {
+	return c >= '0' && c <= '9';
+}
 
-JSON_IS_TOKEN_TYPE_FN_IMPL(JSON_TOKEN_TYPE_VAL_BOOLEAN) {
-	json_ret_code_t ret;
-	if ((ret = JSON_MATCH_STRING_PARTIAL(JSON_TOKEN_STR_REPR_VAL_BOOLEAN_TRUE)) <= JSON_RETVAL_INCOMPLETE) {
-		m_json_lex.token.value.boolean = true;
-		return ret;
-	}
-	if ((ret = JSON_MATCH_STRING_PARTIAL(JSON_TOKEN_STR_REPR_VAL_BOOLEAN_FALSE)) <= JSON_RETVAL_INCOMPLETE) {
-		m_json_lex.token.value.boolean = false;
-		return ret;
+static inline bool json_lex_is_hex_digit(char c) {
+	return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+// Number of leading characters that need no handling inside a string, i.e. no quote, backslash or control char
+static inline size_t json_lex_skip_string_chars(const char* p_input, size_t input_len) {
+	size_t i = 0;
+#if defined(__SSE2__)
+	const __m128i quote = _mm_set1_epi8('"');
+	const __m128i backslash = _mm_set1_epi8('\\');
+	const __m128i control = _mm_set1_epi8(0x1F);
+	while (i + 16 <= input_len) {
+		__m128i chunk = _mm_loadu_si128((const __m128i*) &p_input[i]);
+		__m128i special = _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash));
+		special = _mm_or_si128(special, _mm_cmpeq_epi8(_mm_max_epu8(chunk, control), control));
+		int mask = _mm_movemask_epi8(special);
+		if (mask != 0) {
+			return i + __builtin_ctz(mask);
+		}
+		i += 16;
 	}
-	JSON_RETURN_BOOL(false);
+#endif
+	return i;
 }
 
-JSON_IS_TOKEN_TYPE_FN_IMPL(JSON_TOKEN_TYPE_VAL_STRING) {
-	bool match = true;
-	JSON_RETURN_COND_FALSE(JSON_MATCH_CHAR(*JSON_TOKEN_STR_REPR_VAL_STRING_QUOTES));
-
-	bool do_escape = false;
-	uint16_t num_unicode_chars = 0;
-	for (uint16_t i = 1; i < m_json_lex.buffer_len; i++) {
-		if (num_unicode_chars > 0) {
-			if ((m_json_lex.buffer[i] >= '0' && m_json_lex.buffer[i] <= '9') ||
-				(m_json_lex.buffer[i] >= 'a' && m_json_lex.buffer[i] <= 'f') ||
-				(m_json_lex.buffer[i] >= 'A' && m_json_lex.buffer[i] <= 'F')) {
-				num_unicode_chars--;
-				continue;
-			}
-			m_json_lex.err_code = JSON_LEX_ERRCODE_INVALID_UNICODE_CHAR;
-			JSON_RETURN_BOOL(false);
+#define JSON_LEX_SCAN_RETURN(ret, len, err) { \
+	*p_len = (len); \
+	if (p_err != NULL) *p_err = (err); \
+	return (ret); \
+}
+
+json_ret_code_t json_lex_scan_string(const char* p_input, size_t input_len, size_t* p_len, json_error_code_t* p_err) {
+	if (input_len == 0 || p_input[0] != *JSON_TOKEN_STR_REPR_VAL_STRING_QUOTES) {
+		JSON_LEX_SCAN_RETURN(JSON_RETVAL_ILLEGAL, 0, JSON_ERROR_UNEXPECTED_TOKEN);
+	}
+
+	size_t i = 1;
+	while (i < input_len) {
+		i += json_lex_skip_string_chars(&p_input[i], input_len - i);
+		if (i >= input_len) {
+			break;
 		}
-		if (do_escape) {
-			if (m_json_lex.buffer[i] == *JSON_TOKEN_STR_REPR_VAL_STRING_ESC_QUOTE ||
-				m_json_lex.buffer[i] == *JSON_TOKEN_STR_REPR_VAL_STRING_ESC_BACKSLASH ||
-				m_json_lex.buffer[i] == *JSON_TOKEN_STR_REPR_VAL_STRING_ESC_SLASH ||
-				m_json_lex.buffer[i] == *JSON_TOKEN_STR_REPR_VAL_STRING_ESC_BACKSPACE ||
-				m_json_lex.buffer[i] == *JSON_TOKEN_STR_REPR_VAL_STRING_ESC_FORMFEED ||
-				m_json_lex.buffer[i] == *JSON_TOKEN_STR_REPR_VAL_STRING_ESC_LINEFEED ||
-				m_json_lex.buffer[i] == *JSON_TOKEN_STR_REPR_VAL_STRING_ESC_CARRIAGE_RET ||
-				m_json_lex.buffer[i] == *JSON_TOKEN_STR_REPR_VAL_STRING_ESC_HORIZ_TAB) {
-				do_escape = false;
-				continue;
-			}
-			if (m_json_lex.buffer[i] == *JSON_TOKEN_STR_REPR_VAL_STRING_ESC_UNICODE) {
-				do_escape = false;
-				num_unicode_chars = 4;
-				continue;
-			}
-			m_json_lex.err_code = JSON_LEX_ERRCODE_ILLEGAL_ESCAPE_SEQUENCE;
-			JSON_RETURN_BOOL(false);
+		unsigned char c = (unsigned char) p_input[i];
+		if (c == *JSON_TOKEN_STR_REPR_VAL_STRING_QUOTES) {
+			JSON_LEX_SCAN_RETURN(JSON_RETVAL_OK, i + 1, JSON_ERROR_NONE);
+		}
+		if (c < 0x20) {
+			JSON_LEX_SCAN_RETURN(JSON_RETVAL_ILLEGAL, i, JSON_ERROR_CONTROL_CHAR);
 		}
-		if (m_json_lex.buffer[i] == *JSON_TOKEN_STR_REPR_VAL_STRING_ESC_BACKSLASH) {
-			do_escape = true;
+		if (c != *JSON_TOKEN_STR_REPR_VAL_STRING_ESC) {
+			i++;
 			continue;
 		}
-		if (m_json_lex.buffer[i] == *JSON_TOKEN_STR_REPR_VAL_STRING_ESC_QUOTE) {
-			JSON_RETURN_BOOL(false);
+		if (++i >= input_len) {
+			break;
 		}
+		switch (p_input[i]) {
+			case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+				i++;
+				break;
+			case 'u':
+				for (uint8_t j = 0; j < 4; j++) {
+					if (++i >= input_len) {
+						JSON_LEX_SCAN_RETURN(JSON_RETVAL_INCOMPLETE, input_len, JSON_ERROR_UNEXPECTED_EOF);
+					}
+					if (!json_lex_is_hex_digit(p_input[i])) {
+						JSON_LEX_SCAN_RETURN(JSON_RETVAL_ILLEGAL, i, JSON_ERROR_INVALID_UNICODE_CHAR);
+					}
+				}
+				i++;
+				break;
+			default:
+				JSON_LEX_SCAN_RETURN(JSON_RETVAL_ILLEGAL, i, JSON_ERROR_ILLEGAL_ESCAPE_SEQUENCE);
+		}
+	}
+
+	JSON_LEX_SCAN_RETURN(JSON_RETVAL_INCOMPLETE, input_len, JSON_ERROR_UNEXPECTED_EOF);
+}
+
+json_ret_code_t json_lex_scan_number(const char* p_input, size_t input_len, size_t* p_len, json_error_code_t* p_err) {
+	size_t i = 0;
+
+	if (i < input_len && p_input[i] == *JSON_TOKEN_STR_REPR_VAL_NUMBER_SIGN_NEG) {
+		i++;
 	}
-	if (m_json_lex.buffer_len >= 2 && m_json_lex.buffer[m_json_lex.buffer_len] == *JSON_TOKEN_STR_REPR_VAL_STRING_QUOTES) {
-		m_json_lex.token.value.string.data = calloc(m_json_lex.buffer_len, sizeof(char));
-		json_str_unescape(m_json_lex.token.value.string.data, m_json_lex.buffer + 1, m_json_lex.buffer_len - 1);
-		m_json_lex.token.value.string.length = m_json_lex.buffer_len - 1;
+	if (i >= input_len) {
+		JSON_LEX_SCAN_RETURN(JSON_RETVAL_INCOMPLETE, input_len, JSON_ERROR_UNEXPECTED_EOF);
+	}
+	if (p_input[i] == '0') {
+		i++;
+	} else if (json_lex_is_digit(p_input[i])) {
+		while (i < input_len && json_lex_is_digit(p_input[i])) {
+			i++;
+		}
 	} else {
-		return JSON_RETVAL_INCOMPLETE;
+		JSON_LEX_SCAN_RETURN(JSON_RETVAL_ILLEGAL, i, i == 0 ? JSON_ERROR_UNEXPECTED_TOKEN : JSON_ERROR_EXPECTED_DIGIT);
+	}
+
+	// Fraction
+	if (i < input_len && p_input[i] == *JSON_TOKEN_STR_REPR_VAL_NUMBER_FRAC) {
+		if (++i >= input_len) {
+			JSON_LEX_SCAN_RETURN(JSON_RETVAL_INCOMPLETE, input_len, JSON_ERROR_UNEXPECTED_EOF);
+		}
+		if (!json_lex_is_digit(p_input[i])) {
+			JSON_LEX_SCAN_RETURN(JSON_RETVAL_ILLEGAL, i, JSON_ERROR_EXPECTED_DIGIT);
+		}
+		while (i < input_len && json_lex_is_digit(p_input[i])) {
+			i++;
+		}
+	}
+
+	// Exponent
+	if (i < input_len && (p_input[i] == *JSON_TOKEN_STR_REPR_VAL_NUMBER_EXPONENT ||
+						  p_input[i] == *JSON_TOKEN_STR_REPR_VAL_NUMBER_EXPONENT_UPPER)) {
+		i++;
+		if (i < input_len && (p_input[i] == *JSON_TOKEN_STR_REPR_VAL_NUMBER_SIGN_POS ||
+							  p_input[i] == *JSON_TOKEN_STR_REPR_VAL_NUMBER_SIGN_NEG)) {
+			i++;
+		}
+		if (i >= input_len) {
+			JSON_LEX_SCAN_RETURN(JSON_RETVAL_INCOMPLETE, input_len, JSON_ERROR_UNEXPECTED_EOF);
+		}
+		if (!json_lex_is_digit(p_input[i])) {
+			JSON_LEX_SCAN_RETURN(JSON_RETVAL_ILLEGAL, i, JSON_ERROR_EXPECTED_DIGIT);
+		}
+		while (i < input_len && json_lex_is_digit(p_input[i])) {
+			i++;
+		}
 	}
-	JSON_RETURN_BOOL(match);
+
+	JSON_LEX_SCAN_RETURN(JSON_RETVAL_OK, i, JSON_ERROR_NONE);
+}
+
+json_ret_code_t json_lex_scan_literal(const char* p_input, size_t input_len, const char* literal, size_t literal_len, size_t* p_len) {
+	for (size_t i = 0; i < literal_len; i++) {
+		if (i >= input_len) {
+			*p_len = input_len;
+			return JSON_RETVAL_INCOMPLETE;
+		}
+		if (p_input[i] != literal[i]) {
+			*p_len = i;
+			return JSON_RETVAL_ILLEGAL;
+		}
+	}
+	*p_len = literal_len;
+	return JSON_RETVAL_OK;
+}
+
+JSON_IS_TOKEN_TYPE_FN_IMPL(JSON_TOKEN_TYPE_START_OBJECT) { *p_len = 1; JSON_RETURN_BOOL(p_input[0] == *JSON_TOKEN_STR_REPR_START_OBJECT); }
+JSON_IS_TOKEN_TYPE_FN_IMPL(JSON_TOKEN_TYPE_END_OBJECT) { *p_len = 1; JSON_RETURN_BOOL(p_input[0] == *JSON_TOKEN_STR_REPR_END_OBJECT); }
+JSON_IS_TOKEN_TYPE_FN_IMPL(JSON_TOKEN_TYPE_MEMBER_DELIM) { *p_len = 1; JSON_RETURN_BOOL(p_input[0] == *JSON_TOKEN_STR_REPR_MEMBER_DELIM); }
+JSON_IS_TOKEN_TYPE_FN_IMPL(JSON_TOKEN_TYPE_NAME_VAL_DELIM) { *p_len = 1; JSON_RETURN_BOOL(p_input[0] == *JSON_TOKEN_STR_REPR_NAME_VAL_DELIM); }
+JSON_IS_TOKEN_TYPE_FN_IMPL(JSON_TOKEN_TYPE_VAL_START_ARRAY) { *p_len = 1; JSON_RETURN_BOOL(p_input[0] == *JSON_TOKEN_STR_REPR_VAL_START_ARRAY); }
+JSON_IS_TOKEN_TYPE_FN_IMPL(JSON_TOKEN_TYPE_VAL_END_ARRAY) { *p_len = 1; JSON_RETURN_BOOL(p_input[0] == *JSON_TOKEN_STR_REPR_VAL_END_ARRAY); }
+
+JSON_IS_TOKEN_TYPE_FN_IMPL(JSON_TOKEN_TYPE_VAL_NULL) {
+	p_lex->err_code = JSON_ERROR_UNEXPECTED_TOKEN;
+	return json_lex_scan_literal(p_input, input_len, JSON_TOKEN_STR_REPR_VAL_NULL, strlen(JSON_TOKEN_STR_REPR_VAL_NULL), p_len);
+}
+
+JSON_IS_TOKEN_TYPE_FN_IMPL(JSON_TOKEN_TYPE_VAL_BOOLEAN) {
+	p_lex->err_code = JSON_ERROR_UNEXPECTED_TOKEN;
+	p_token->value.boolean = p_input[0] == *JSON_TOKEN_STR_REPR_VAL_BOOLEAN_TRUE;
+	if (p_token->value.boolean) {
+		return json_lex_scan_literal(p_input, input_len, JSON_TOKEN_STR_REPR_VAL_BOOLEAN_TRUE, strlen(JSON_TOKEN_STR_REPR_VAL_BOOLEAN_TRUE), p_len);
+	}
+	return json_lex_scan_literal(p_input, input_len, JSON_TOKEN_STR_REPR_VAL_BOOLEAN_FALSE, strlen(JSON_TOKEN_STR_REPR_VAL_BOOLEAN_FALSE), p_len);
+}
+
+JSON_IS_TOKEN_TYPE_FN_IMPL(JSON_TOKEN_TYPE_VAL_STRING) {
+	json_ret_code_t ret = json_lex_scan_string(p_input, input_len, p_len, &p_lex->err_code);
+	if (ret != JSON_RETVAL_OK) {
+		return ret;
+	}
+
+	// The unescaped string is never longer than the raw string between the quotes
+	size_t raw_len = *p_len - 2;
+	if (p_lex->flags & JSON_LEX_FLAG_RAW_STRINGS) {
+		p_token->value.string.data = (char*) p_input + 1;
+		p_token->value.string.length = raw_len;
+		p_token->value.string.is_borrowed = true;
+		return JSON_RETVAL_OK;
+	}
+	if (p_lex->flags & JSON_LEX_FLAG_IN_PLACE) {
+		// Unescape over the raw string, the terminator replaces the closing quote at the latest
+		p_token->value.string.data = (char*) p_input + 1;
+		p_token->value.string.is_borrowed = true;
+		json_lex_unescape(p_token->value.string.data, p_input + 1, raw_len, &p_token->value.string.length);
+		return JSON_RETVAL_OK;
+	}
+	p_token->value.string.data = malloc(raw_len + 1);
+	if (p_token->value.string.data == NULL) {
+		p_lex->err_code = JSON_ERROR_OUT_OF_MEMORY;
+		*p_len = 0;
+		return JSON_RETVAL_FAIL;
+	}
+	json_lex_unescape(p_token->value.string.data, p_input + 1, raw_len, &p_token->value.string.length);
+	return JSON_RETVAL_OK;
 }
 
 JSON_IS_TOKEN_TYPE_FN_IMPL(JSON_TOKEN_TYPE_VAL_NUMBER) {
-	return json_parse_number(&m_json_lex.token.value.number, m_json_lex.buffer, m_json_lex.buffer_len + 1);
+	json_ret_code_t ret = json_lex_scan_number(p_input, input_len, p_len, &p_lex->err_code);
+	if (ret != JSON_RETVAL_OK) {
+		return ret;
+	}
+	return json_parse_number(&p_token->value.number, p_input, *p_len);
 }
 
 JSON_IS_TOKEN_TYPE_FN_IMPL(JSON_TOKEN_TYPE_WHITESPACE) {
-	JSON_RETURN_BOOL(
-		JSON_MATCH_STRING(JSON_TOKEN_STR_REPR_WHITESPACE_SPACE) ||
-		JSON_MATCH_STRING(JSON_TOKEN_STR_REPR_WHITESPACE_LINEFEED) ||
-		JSON_MATCH_STRING(JSON_TOKEN_STR_REPR_WHITESPACE_CARRIAGE_RET) ||
-		JSON_MATCH_STRING(JSON_TOKEN_STR_REPR_WHITESPACE_HORIZ_TAB) ||
-		JSON_MATCH_STRING(JSON_TOKEN_STR_REPR_WHITESPACE_CRLF)
-	);
+	*p_len = json_lex_skip_whitespace(p_input, input_len);
+	JSON_RETURN_BOOL(*p_len > 0);
 }
 
 static json_token_type_def_t json_token_type_def[] = {
@@ -410,154 +586,202 @@ static json_token_type_def_t json_token_type_def[] = {
 		),
 };
 
-static json_ret_code_t get_next_token(const char* p_input, uint32_t input_len, uint32_t* p_consumed, json_token_t* p_token);
+// Token type by first character, tokens are recognized without trying every token type
+static const json_token_type_t json_token_type_by_char[256] = {
+		['{'] = JSON_TOKEN_TYPE_START_OBJECT,
+		['}'] = JSON_TOKEN_TYPE_END_OBJECT,
+		[','] = JSON_TOKEN_TYPE_MEMBER_DELIM,
+		[':'] = JSON_TOKEN_TYPE_NAME_VAL_DELIM,
+		['['] = JSON_TOKEN_TYPE_VAL_START_ARRAY,
+		[']'] = JSON_TOKEN_TYPE_VAL_END_ARRAY,
+		['t'] = JSON_TOKEN_TYPE_VAL_BOOLEAN,
+		['f'] = JSON_TOKEN_TYPE_VAL_BOOLEAN,
+		['n'] = JSON_TOKEN_TYPE_VAL_NULL,
+		['"'] = JSON_TOKEN_TYPE_VAL_STRING,
+		['-'] = JSON_TOKEN_TYPE_VAL_NUMBER,
+		['0' ... '9'] = JSON_TOKEN_TYPE_VAL_NUMBER,
+		[' '] = JSON_TOKEN_TYPE_WHITESPACE,
+		['\n'] = JSON_TOKEN_TYPE_WHITESPACE,
+		['\r'] = JSON_TOKEN_TYPE_WHITESPACE,
+		['\t'] = JSON_TOKEN_TYPE_WHITESPACE,
+};
+
+static json_ret_code_t get_next_token(json_lex_t* p_lex, const char* p_input, size_t input_len, size_t* p_consumed, json_token_t* p_token);
 
 void json_lex_init() {
 	memset(&m_json_lex, 0, sizeof(m_json_lex));
-	m_json_lex.ret_code = JSON_RETVAL_FAIL;
 }
 
-char* json_lex_get_err_str(json_lex_errcode err) {
-	switch (err) {
-		case JSON_LEX_ERRCODE_UNEXPECTED_TOKEN:
-			return "Unexpected token";
-		case JSON_LEX_ERRCODE_UNEXPECTED_EOF:
-			return "Unexpected end of file";
-		case JSON_LEX_ERRCODE_ILLEGAL_ESCAPE_SEQUENCE:
-			return "Illegal escape sequence";
-		case JSON_LEX_ERRCODE_EXPECTED_DIGIT:
-			return "Expected digit after";
-		case JSON_LEX_ERRCODE_NAN:
-			return "Not a number";
-		case JSON_LEX_ERRCODE_INVALID_UNICODE_CHAR:
-			return "Invalid unicode escape sequence in string";
-		default:
-			return "Unknown error";
+void json_lex_get_error(json_error_t* p_error) {
+	if (p_error != NULL) {
+		*p_error = m_json_lex.error;
 	}
 }
 
-static void json_lex_error_handler(const char* p_input, uint32_t input_len, json_ret_code_t ret) {
-	if (ret == JSON_RETVAL_ILLEGAL) {
-		printf("\033[31mSyntaxError: %s \"%.*s\" at %u:%u\033[0m\n", json_lex_get_err_str(m_json_lex.err_code), m_json_lex.buffer_len + 1, m_json_lex.buffer, m_json_lex.line + 1, m_json_lex.column + 1);
-		printf("%5u |     ", m_json_lex.line + 1);
-		for (uint16_t i = m_json_lex.line_start; i < input_len && p_input[i] != '\n' && p_input[i] != '\r'; i++) {
-			printf("%c", p_input[i]);
-		}
-		printf("\n");
-		printf("      |     ");
-		for (uint16_t i = 0; i < m_json_lex.column; i++) {
-			printf(" ");
+json_ret_code_t json_lex_next_token(json_lex_t* p_lex, const char* p_input, size_t input_len, size_t* p_consumed, json_token_t* p_token) {
+	size_t consumed_total = 0;
+
+	while (true) {
+		size_t consumed = 0;
+		json_ret_code_t ret = get_next_token(p_lex, &p_input[consumed_total], input_len - consumed_total, &consumed, p_token);
+
+		switch (ret) {
+			case JSON_RETVAL_OK:
+				p_token->offset = consumed_total;
+				*p_consumed = consumed_total + consumed;
+				return JSON_RETVAL_OK;
+			case JSON_RETVAL_BUSY:
+				break;
+			case JSON_RETVAL_FINISHED:
+				*p_consumed = consumed_total;
+				return JSON_RETVAL_FINISHED;
+			default:
+				// An incomplete token is reported with the consumed length pointing at its start
+				p_lex->error.code = p_lex->err_code;
+				p_lex->error.offset = consumed_total + consumed;
+				p_lex->error.expected = NULL;
+				*p_consumed = consumed_total;
+				return ret;
 		}
-		printf("\033[31m^\033[0m\n");
-	} else {
-		printf("\033[31mInternal Error\033[0m\n");
+		consumed_total += consumed;
 	}
 }
 
-json_ret_code_t json_lex(const char* p_input, uint32_t input_len, json_token_t* p_tokens, uint32_t *p_num_tokens, uint32_t max_num_tokens) {
-	uint32_t consumed_total = 0;
-	m_json_lex.line_start = 0;
+json_ret_code_t json_lex(const char* p_input, size_t input_len, json_token_t* p_tokens, uint32_t *p_num_tokens, uint32_t max_num_tokens) {
+	uint64_t consumed_total = 0;
 
-	while (*p_num_tokens <= max_num_tokens) {
+	while (true) {
 		json_token_t token = {0};
-		uint32_t consumed = 0;
-		uint16_t line_num_before = m_json_lex.line;
-		json_ret_code_t ret = get_next_token(&p_input[consumed_total], input_len - consumed_total, &consumed, &token);
+		size_t consumed = 0;
+		json_ret_code_t ret = json_lex_next_token(&m_json_lex, &p_input[consumed_total], input_len - consumed_total, &consumed, &token);
 
 		switch (ret) {
 			case JSON_RETVAL_OK:
+				if (*p_num_tokens >= max_num_tokens) {
+					json_lex_free_tokens(&token, 1);
+					m_json_lex.error.code = JSON_ERROR_OUT_OF_MEMORY;
+					m_json_lex.error.offset = consumed_total + token.offset;
+					m_json_lex.error.expected = NULL;
+					return JSON_RETVAL_INCOMPLETE;
+				}
+				token.offset += consumed_total;
 				p_tokens[(*p_num_tokens)++] = token;
 				break;
-			case JSON_RETVAL_BUSY:
-				break;
 			case JSON_RETVAL_FINISHED:
 				return JSON_RETVAL_OK;
 			default:
-				json_lex_error_handler(p_input, input_len, ret);
-				return ret;
+				m_json_lex.error.offset += consumed_total;
+				return ret == JSON_RETVAL_INCOMPLETE ? JSON_RETVAL_ILLEGAL : ret;
 		}
 		consumed_total += consumed;
-		if (m_json_lex.line != line_num_before) {
-			m_json_lex.line_start = consumed_total;
-		}
 	}
-
-	return JSON_RETVAL_OK;
 }
 
-static void clear_token(json_token_t* p_token) {
-	if (p_token->type == JSON_TOKEN_TYPE_VAL_STRING) {
-		free(p_token->value.string.data);
+// Extent of the value at p_input, containers are matched by bracket depth only and scalars end at the next delimiter,
+// the caller checks the syntax if it needs to
+json_ret_code_t json_lex_skip_value(const char* p_input, size_t input_len, size_t* p_len) {
+	json_error_code_t err;
+	if (input_len == 0) {
+		return JSON_RETVAL_INCOMPLETE;
+	}
+	if (p_input[0] == '"') {
+		return json_lex_scan_string(p_input, input_len, p_len, &err);
+	}
+	if (p_input[0] != '{' && p_input[0] != '[') {
+		size_t i = 0;
+		while (i < input_len && p_input[i] != ',' && p_input[i] != '}' && p_input[i] != ']' &&
+			   json_lex_skip_whitespace(&p_input[i], 1) == 0) {
+			i++;
+		}
+		*p_len = i;
+		return JSON_RETVAL_OK;
 	}
-	memset(p_token, 0, sizeof(json_token_t));
-}
 
-static void copy_token(json_token_t* p_dest, const json_token_t* p_src) {
-	memcpy(p_dest, p_src, sizeof(json_token_t));
-	if (p_src->type == JSON_TOKEN_TYPE_VAL_STRING) {
-		p_dest->value.string.data = calloc(p_src->value.string.length + 1, sizeof(char));
-		memcpy(p_dest->value.string.data, p_src->value.string.data, p_src->value.string.length);
+	size_t depth = 0;
+	for (size_t i = 0; i < input_len; i++) {
+		switch (p_input[i]) {
+			case '"': {
+				size_t string_len;
+				json_ret_code_t ret = json_lex_scan_string(&p_input[i], input_len - i, &string_len, &err);
+				if (ret != JSON_RETVAL_OK) {
+					return ret;
+				}
+				i += string_len - 1;
+				break;
+			}
+			case '{':
+			case '[':
+				depth++;
+				break;
+			case '}':
+			case ']':
+				if (--depth == 0) {
+					*p_len = i + 1;
+					return JSON_RETVAL_OK;
+				}
+				break;
+			default:
+				break;
+		}
 	}
+	return JSON_RETVAL_INCOMPLETE;
 }
 
-static json_ret_code_t get_next_token(const char* p_input, uint32_t input_len, uint32_t* p_consumed, json_token_t* p_token) {
-	while (*p_consumed < input_len) {
-		m_json_lex.buffer[m_json_lex.buffer_len] = p_input[(*p_consumed)++];
-		uint8_t num_matches = 0;
+json_ret_code_t json_lex_cursor_error(json_lex_cursor_t* p_cursor, json_error_code_t code, size_t offset, const char* expected) {
+	p_cursor->error = (json_error_t) {.code = code, .offset = offset, .expected = expected};
+	return JSON_RETVAL_FAIL;
+}
 
-		for (json_token_type_t token_type = 1; token_type < JSON_TOKEN_TYPE_COUNT; token_type++) {
-			assert(json_token_type_def[token_type].is_token_type_fn != NULL);
-			json_ret_code_t ret = json_token_type_def[token_type].is_token_type_fn();
+// Reports errors of the scanners at the offset they stopped at, the end of the input as unexpected
+json_ret_code_t json_lex_cursor_scan_error(json_lex_cursor_t* p_cursor, json_ret_code_t ret, json_error_code_t code, size_t len,
+										   const char* expected) {
+	if (ret == JSON_RETVAL_INCOMPLETE) {
+		return json_lex_cursor_error(p_cursor, JSON_ERROR_UNEXPECTED_EOF, p_cursor->size, expected);
+	}
+	return json_lex_cursor_error(p_cursor, code, p_cursor->pos + len, code == JSON_ERROR_UNEXPECTED_TOKEN ? expected : NULL);
+}
 
-			if (ret == JSON_RETVAL_OK || ret == JSON_RETVAL_INCOMPLETE) {
-				m_json_lex.token.type = token_type;
-				m_json_lex.ret_code = ret;
-				num_matches++;
-			}
+void json_lex_free_tokens(json_token_t* p_tokens, uint32_t num_tokens) {
+	for (uint32_t i = 0; i < num_tokens; i++) {
+		if (p_tokens[i].type == JSON_TOKEN_TYPE_VAL_STRING && !p_tokens[i].value.string.is_borrowed) {
+			free(p_tokens[i].value.string.data);
+			p_tokens[i].value.string.data = NULL;
 		}
+	}
+}
 
-		if (num_matches == 0 || *p_consumed == input_len) {
-			m_json_lex.column += m_json_lex.buffer_len;
-			if (m_json_lex.buffer[0] == '\n' || m_json_lex.buffer[0] == '\r') {
-				m_json_lex.line++;
-				m_json_lex.column = 0;
-			}
-			if (m_json_lex.ret_code != JSON_RETVAL_OK) {
-				return JSON_RETVAL_ILLEGAL;
-			}
-			bool return_token = false;
+static json_ret_code_t get_next_token(json_lex_t* p_lex, const char* p_input, size_t input_len, size_t* p_consumed, json_token_t* p_token) {
+	if (input_len == 0) {
+		return JSON_RETVAL_FINISHED;
+	}
 
-			// Found token
-			if (m_json_lex.token.type != JSON_TOKEN_TYPE_UNDEFINED) {
-				if ((json_token_type_def[m_json_lex.token.type].flags & JSON_TOKEN_FLAG_IGNORED) == 0) {
-					copy_token(p_token, &m_json_lex.token);
-					return_token = true;
-				}
-			}
+	json_token_type_t token_type = json_token_type_by_char[(unsigned char) p_input[0]];
+	if (token_type == JSON_TOKEN_TYPE_UNDEFINED) {
+		p_lex->err_code = JSON_ERROR_UNEXPECTED_TOKEN;
+		*p_consumed = 0;
+		return JSON_RETVAL_ILLEGAL;
+	}
 
-			// Reset
-			clear_token(&m_json_lex.token);
-			m_json_lex.buffer_len = 0;
-			memset(m_json_lex.buffer, 0, sizeof(m_json_lex.buffer));
-			m_json_lex.ret_code = JSON_RETVAL_FAIL;
-			m_json_lex.token.line = m_json_lex.line;
-			m_json_lex.token.column = m_json_lex.column;
-			m_json_lex.err_code = JSON_LEX_ERRCODE_UNEXPECTED_TOKEN;
-
-			// Reached end of input
-			if (num_matches == 1 && *p_consumed == input_len) {
-				return return_token ? JSON_RETVAL_OK : JSON_RETVAL_FINISHED;
-			}
+	assert(json_token_type_def[token_type].is_token_type_fn != NULL);
+	json_ret_code_t ret = json_token_type_def[token_type].is_token_type_fn(p_lex, p_input, input_len, p_consumed, p_token);
+	if (ret == JSON_RETVAL_INCOMPLETE) {
+		p_lex->err_code = JSON_ERROR_UNEXPECTED_EOF;
+		*p_consumed = input_len;
+		return JSON_RETVAL_INCOMPLETE;
+	}
+	if (ret != JSON_RETVAL_OK) {
+		return ret == JSON_RETVAL_FAIL && p_lex->err_code == JSON_ERROR_OUT_OF_MEMORY ? JSON_RETVAL_FAIL : JSON_RETVAL_ILLEGAL;
+	}
 
-			// Push back
-			(*p_consumed)--;
-			return return_token ? JSON_RETVAL_OK : JSON_RETVAL_BUSY;
-		} else {
-			m_json_lex.buffer_len++;
-		}
+	if (json_token_type_def[token_type].flags & JSON_TOKEN_FLAG_IGNORED) {
+		return JSON_RETVAL_BUSY;
 	}
+	p_token->type = token_type;
+	return JSON_RETVAL_OK;
+}
 
-	return JSON_RETVAL_FINISHED;
+json_token_type_t json_lex_get_token_type(char first_char) {
+	return json_token_type_by_char[(unsigned char) first_char];
 }
 
 char* json_get_token_name(json_token_type_t token_type) {
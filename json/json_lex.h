@@ -25,17 +25,10 @@ typedef enum {
 	JSON_TOKEN_TYPE_COUNT,
 } json_token_type_t;
 
-typedef json_ret_code_t (*json_is_token_type_fn)();
-
-typedef struct {
-	char* name;
-	uint8_t flags;
-	json_is_token_type_fn is_token_type_fn;
-} json_token_type_def_t;
-
 typedef struct {
 	char* data;
-	uint16_t length;
+	size_t length;
+	bool is_borrowed;
 } json_value_string_t;
 
 typedef union {
@@ -47,18 +40,43 @@ typedef union {
 typedef struct {
 	json_token_type_t type;
 	json_token_value_t value;
-	uint16_t line;
-	uint16_t column;
+	uint64_t offset;
 } json_token_t;
 
+typedef struct {
+	json_error_code_t err_code;
+	json_error_t error;
+	uint8_t flags;
+} json_lex_t;
+
+// Position in an input that is scanned without tokens, the first error ends the scan
+typedef struct {
+	const char* p_data;
+	size_t size;
+	size_t pos;
+	json_error_t error;
+} json_lex_cursor_t;
+
+typedef json_ret_code_t (*json_is_token_type_fn)(json_lex_t* p_lex, const char* p_input, size_t input_len, size_t* p_len, json_token_t* p_token);
+
+typedef struct {
+	char* name;
+	uint8_t flags;
+	json_is_token_type_fn is_token_type_fn;
+} json_token_type_def_t;
+
 #define JSON_TOKEN_FLAG_NONE		0x00
 #define JSON_TOKEN_FLAG_RESERVED	0x01
 #define JSON_TOKEN_FLAG_IGNORED		0x02
 #define JSON_TOKEN_FLAG_CONTINUOUS	0x04
 
+#define JSON_LEX_FLAG_NONE			0x00
+#define JSON_LEX_FLAG_IN_PLACE		0x01	// Unescape strings inside the (writable) input instead of allocating them
+#define JSON_LEX_FLAG_RAW_STRINGS	0x02	// Reference the raw string in the input, the caller unescapes it with json_lex_unescape
+
 #define JSON_IS_TOKEN_TYPE_FN_NAME(token_type) json_is_token_type_ ## token_type
-#define JSON_IS_TOKEN_TYPE_FN_DECL(token_type) json_ret_code_t JSON_IS_TOKEN_TYPE_FN_NAME(token_type)();
-#define JSON_IS_TOKEN_TYPE_FN_IMPL(token_type) json_ret_code_t JSON_IS_TOKEN_TYPE_FN_NAME(token_type)()
+#define JSON_IS_TOKEN_TYPE_FN_DECL(token_type) json_ret_code_t JSON_IS_TOKEN_TYPE_FN_NAME(token_type)(json_lex_t* p_lex, const char* p_input, size_t input_len, size_t* p_len, json_token_t* p_token);
+#define JSON_IS_TOKEN_TYPE_FN_IMPL(token_type) json_ret_code_t JSON_IS_TOKEN_TYPE_FN_NAME(token_type)(json_lex_t* p_lex, const char* p_input, size_t input_len, size_t* p_len, json_token_t* p_token)
 
 #define JSON_RETURN_BOOL(boolean) return (boolean) ? JSON_RETVAL_OK : JSON_RETVAL_FAIL
 
@@ -84,7 +102,7 @@ JSON_IS_TOKEN_TYPE_FN_DECL(JSON_TOKEN_TYPE_WHITESPACE)
 #define MIN(a,b) \
    ({ __typeof__ (a) _a = (a); \
        __typeof__ (b) _b = (b); \
-     _a > _b ? _a : _b; })
+     _a < _b ? _a : _b; })
 #endif
 
 #ifndef MAX
@@ -96,13 +114,54 @@ JSON_IS_TOKEN_TYPE_FN_DECL(JSON_TOKEN_TYPE_WHITESPACE)
 
 
 json_ret_code_t json_strcmp_partial(const char* expect_str, const char* actual_str,
-										   uint16_t expect_str_len, uint16_t actual_str_len);
-json_ret_code_t json_str_unescape(char* str_dest, const char* str_src, uint16_t str_len);
-json_ret_code_t json_parse_number(double *p_dest, const char* str_src, uint16_t str_len);
+										   size_t expect_str_len, size_t actual_str_len);
+json_ret_code_t json_str_unescape(char* str_dest, const char* str_src, size_t str_len);
+json_ret_code_t json_lex_unescape(char* str_dest, const char* str_src, size_t str_len, size_t* p_dest_len);
+json_ret_code_t json_parse_number(double *p_dest, const char* str_src, size_t str_len);
+bool json_parse_integer(const char* p_input, size_t input_len, int64_t min, int64_t max, int64_t* p_integer);
+
+json_ret_code_t json_lex_scan_string(const char* p_input, size_t input_len, size_t* p_len, json_error_code_t* p_err);
+json_ret_code_t json_lex_scan_number(const char* p_input, size_t input_len, size_t* p_len, json_error_code_t* p_err);
+json_ret_code_t json_lex_scan_literal(const char* p_input, size_t input_len, const char* literal, size_t literal_len, size_t* p_len);
+json_ret_code_t json_lex_skip_value(const char* p_input, size_t input_len, size_t* p_len);
+
+// FNV-1a, keys are short and mostly ASCII
+static inline uint64_t json_lex_hash(const char* p_key, size_t length) {
+	uint64_t hash = 0xcbf29ce484222325ull;
+	for (size_t i = 0; i < length; i++) {
+		hash = (hash ^ (uint8_t) p_key[i]) * 0x100000001b3ull;
+	}
+	return hash;
+}
+
+static inline size_t json_lex_skip_whitespace(const char* p_input, size_t input_len) {
+	size_t i = 0;
+	while (i < input_len && (p_input[i] == ' ' || p_input[i] == '\n' || p_input[i] == '\r' || p_input[i] == '\t')) {
+		i++;
+	}
+	return i;
+}
+
+json_ret_code_t json_lex_cursor_error(json_lex_cursor_t* p_cursor, json_error_code_t code, size_t offset, const char* expected);
+json_ret_code_t json_lex_cursor_scan_error(json_lex_cursor_t* p_cursor, json_ret_code_t ret, json_error_code_t code, size_t len,
+										   const char* expected);
+
+// Skips whitespace, the end of the input is reported as an error
+static inline json_ret_code_t json_lex_cursor_next_char(json_lex_cursor_t* p_cursor, const char* expected) {
+	p_cursor->pos += json_lex_skip_whitespace(&p_cursor->p_data[p_cursor->pos], p_cursor->size - p_cursor->pos);
+	if (p_cursor->pos >= p_cursor->size) {
+		return json_lex_cursor_error(p_cursor, JSON_ERROR_UNEXPECTED_EOF, p_cursor->size, expected);
+	}
+	return JSON_RETVAL_OK;
+}
 
 void json_lex_init();
-json_ret_code_t json_lex(const char* p_input, uint32_t input_len, json_token_t* p_tokens, uint32_t *p_num_tokens, uint32_t max_num_tokens);
+json_ret_code_t json_lex_next_token(json_lex_t* p_lex, const char* p_input, size_t input_len, size_t* p_consumed, json_token_t* p_token);
+json_ret_code_t json_lex(const char* p_input, size_t input_len, json_token_t* p_tokens, uint32_t *p_num_tokens, uint32_t max_num_tokens);
+void json_lex_free_tokens(json_token_t* p_tokens, uint32_t num_tokens);
+void json_lex_get_error(json_error_t* p_error);
 
+json_token_type_t json_lex_get_token_type(char first_char);
 char* json_get_token_name(json_token_type_t token_type);
 void json_get_token_str_repr(json_token_t* p_token, char* str, uint32_t str_len);
 
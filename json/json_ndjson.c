@@ -0,0 +1,230 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "json.h"
+#include "json_lex.h"
+#include "json_parse.h"
+
+/*
+ * The input is cut into blocks of block_size bytes, workers claim blocks through an atomic counter. A record
+ * belongs to the block that contains its first byte, so every worker finds the record boundaries of its own block
+ * with memchr and no serial pre-scan is needed. For in-order delivery a worker parses its whole block and then
+ * waits until all earlier blocks were delivered, at most one block per worker is held in memory.
+ */
+
+#define JSON_NDJSON_MAX_THREADS		256
+
+typedef struct {
+	const char* p_data;
+	size_t size;
+	size_t block_size;
+	uint64_t num_blocks;
+	bool unordered;
+	json_ndjson_callback_fn callback;
+	void* p_context;
+
+	uint64_t next_block;
+	bool abort;
+	json_ret_code_t ret;
+
+	pthread_mutex_t deliver_mutex;
+	pthread_cond_t deliver_cond;
+	uint64_t deliver_block;
+} json_ndjson_t;
+
+typedef struct {
+	json_ndjson_record_t* records;
+	size_t num_records;
+	size_t capacity;
+} json_ndjson_block_t;
+
+static void json_ndjson_set_abort(json_ndjson_t* p_ndjson, json_ret_code_t ret) {
+	pthread_mutex_lock(&p_ndjson->deliver_mutex);
+	if (!p_ndjson->abort) {
+		p_ndjson->ret = ret;
+		__atomic_store_n(&p_ndjson->abort, true, __ATOMIC_RELAXED);
+	}
+	pthread_cond_broadcast(&p_ndjson->deliver_cond);
+	pthread_mutex_unlock(&p_ndjson->deliver_mutex);
+}
+
+static bool json_ndjson_is_aborted(json_ndjson_t* p_ndjson) {
+	return __atomic_load_n(&p_ndjson->abort, __ATOMIC_RELAXED);
+}
+
+static void json_ndjson_record_free(json_ndjson_record_t* p_record) {
+	if (p_record->p_object != NULL) {
+		json_object_free(p_record->p_object);
+		free(p_record->p_object);
+		p_record->p_object = NULL;
+	}
+}
+
+static json_ret_code_t json_ndjson_parse_record(const char* p_line, size_t line_len, uint64_t offset, json_ndjson_record_t* p_record) {
+	memset(p_record, 0, sizeof(json_ndjson_record_t));
+	p_record->offset = offset;
+	p_record->length = line_len;
+	p_record->p_object = malloc(sizeof(json_object_t));
+	if (p_record->p_object == NULL) {
+		return JSON_RETVAL_FAIL;
+	}
+	p_record->ret = json_parse_object_input(p_line, line_len, JSON_LEX_FLAG_NONE, NULL, NULL, NULL, p_record->p_object,
+											&p_record->error);
+	if (p_record->ret != JSON_RETVAL_OK) {
+		p_record->error.offset += offset;
+		json_ndjson_record_free(p_record);
+	}
+	return JSON_RETVAL_OK;
+}
+
+static json_ret_code_t json_ndjson_block_push(json_ndjson_block_t* p_block) {
+	if (p_block->num_records < p_block->capacity) {
+		return JSON_RETVAL_OK;
+	}
+	size_t capacity = p_block->capacity == 0 ? 64 : p_block->capacity * 2;
+	json_ndjson_record_t* records = realloc(p_block->records, capacity * sizeof(json_ndjson_record_t));
+	if (records == NULL) {
+		return JSON_RETVAL_FAIL;
+	}
+	p_block->records = records;
+	p_block->capacity = capacity;
+	return JSON_RETVAL_OK;
+}
+
+static void json_ndjson_block_deliver(json_ndjson_t* p_ndjson, uint64_t block_index, json_ndjson_block_t* p_block) {
+	pthread_mutex_lock(&p_ndjson->deliver_mutex);
+	while (p_ndjson->deliver_block != block_index && !p_ndjson->abort) {
+		pthread_cond_wait(&p_ndjson->deliver_cond, &p_ndjson->deliver_mutex);
+	}
+	pthread_mutex_unlock(&p_ndjson->deliver_mutex);
+
+	// Only the worker holding the turn gets here, callbacks are serialized by the turn itself
+	for (size_t i = 0; i < p_block->num_records && !json_ndjson_is_aborted(p_ndjson); i++) {
+		json_ret_code_t ret = p_ndjson->callback(&p_block->records[i], p_ndjson->p_context);
+		if (ret != JSON_RETVAL_OK) {
+			json_ndjson_set_abort(p_ndjson, ret);
+		}
+	}
+
+	pthread_mutex_lock(&p_ndjson->deliver_mutex);
+	p_ndjson->deliver_block++;
+	pthread_cond_broadcast(&p_ndjson->deliver_cond);
+	pthread_mutex_unlock(&p_ndjson->deliver_mutex);
+}
+
+static void json_ndjson_process_block(json_ndjson_t* p_ndjson, uint64_t block_index, json_ndjson_block_t* p_block) {
+	size_t start = block_index * p_ndjson->block_size;
+	size_t end = MIN(start + p_ndjson->block_size, p_ndjson->size);
+
+	// Skip the record that began in the previous block
+	if (start > 0 && p_ndjson->p_data[start - 1] != '\n') {
+		const char* p_newline = memchr(&p_ndjson->p_data[start], '\n', p_ndjson->size - start);
+		start = p_newline == NULL ? p_ndjson->size : (size_t) (p_newline - p_ndjson->p_data) + 1;
+	}
+
+	p_block->num_records = 0;
+	while (start < end && !json_ndjson_is_aborted(p_ndjson)) {
+		const char* p_line = &p_ndjson->p_data[start];
+		const char* p_newline = memchr(p_line, '\n', p_ndjson->size - start);
+		size_t line_len = p_newline == NULL ? p_ndjson->size - start : (size_t) (p_newline - p_line);
+		size_t next = start + line_len + 1;
+
+		// Blank lines are not records
+		if (json_lex_skip_whitespace(p_line, line_len) == line_len) {
+			start = next;
+			continue;
+		}
+
+		json_ndjson_record_t record;
+		if (json_ndjson_parse_record(p_line, line_len, start, &record) != JSON_RETVAL_OK) {
+			json_ndjson_set_abort(p_ndjson, JSON_RETVAL_FAIL);
+			break;
+		}
+		if (p_ndjson->unordered) {
+			json_ret_code_t ret = p_ndjson->callback(&record, p_ndjson->p_context);
+			json_ndjson_record_free(&record);
+			if (ret != JSON_RETVAL_OK) {
+				json_ndjson_set_abort(p_ndjson, ret);
+			}
+		} else if (json_ndjson_block_push(p_block) == JSON_RETVAL_OK) {
+			p_block->records[p_block->num_records++] = record;
+		} else {
+			json_ndjson_record_free(&record);
+			json_ndjson_set_abort(p_ndjson, JSON_RETVAL_FAIL);
+		}
+		start = next;
+	}
+
+	if (!p_ndjson->unordered) {
+		json_ndjson_block_deliver(p_ndjson, block_index, p_block);
+		for (size_t i = 0; i < p_block->num_records; i++) {
+			json_ndjson_record_free(&p_block->records[i]);
+		}
+	}
+}
+
+static void* json_ndjson_worker(void* p_arg) {
+	json_ndjson_t* p_ndjson = p_arg;
+	json_ndjson_block_t block = {0};
+
+	while (!json_ndjson_is_aborted(p_ndjson)) {
+		uint64_t block_index = __atomic_fetch_add(&p_ndjson->next_block, 1, __ATOMIC_RELAXED);
+		if (block_index >= p_ndjson->num_blocks) {
+			break;
+		}
+		json_ndjson_process_block(p_ndjson, block_index, &block);
+	}
+
+	free(block.records);
+	return NULL;
+}
+
+json_ret_code_t json_parse_ndjson(const char* p_data, size_t size, const json_ndjson_options_t* p_options,
+								  json_ndjson_callback_fn callback, void* p_context) {
+	if ((p_data == NULL && size > 0) || callback == NULL) {
+		return JSON_RETVAL_INVALID_PARAM;
+	}
+
+	json_ndjson_options_t options = p_options != NULL ? *p_options : (json_ndjson_options_t) {0};
+	if (options.num_threads == 0) {
+		long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		options.num_threads = num_cpus > 0 ? (uint32_t) num_cpus : 1;
+	}
+	options.num_threads = MIN(options.num_threads, (uint32_t) JSON_NDJSON_MAX_THREADS);
+	if (options.block_size == 0) {
+		options.block_size = JSON_NDJSON_DEFAULT_BLOCK_SIZE;
+	}
+
+	json_ndjson_t ndjson = {
+		.p_data = p_data,
+		.size = size,
+		.block_size = options.block_size,
+		.num_blocks = (size + options.block_size - 1) / options.block_size,
+		.unordered = options.unordered,
+		.callback = callback,
+		.p_context = p_context,
+		.ret = JSON_RETVAL_OK,
+	};
+	pthread_mutex_init(&ndjson.deliver_mutex, NULL);
+	pthread_cond_init(&ndjson.deliver_cond, NULL);
+
+	// The calling thread is one of the workers
+	uint32_t num_workers = (uint32_t) MIN((uint64_t) options.num_threads, MAX(ndjson.num_blocks, (uint64_t) 1));
+	pthread_t threads[JSON_NDJSON_MAX_THREADS];
+	uint32_t num_started = 0;
+	for (uint32_t i = 1; i < num_workers; i++) {
+		if (pthread_create(&threads[num_started], NULL, json_ndjson_worker, &ndjson) != 0) {
+			break;
+		}
+		num_started++;
+	}
+	json_ndjson_worker(&ndjson);
+	for (uint32_t i = 0; i < num_started; i++) {
+		pthread_join(threads[i], NULL);
+	}
+
+	pthread_cond_destroy(&ndjson.deliver_cond);
+	pthread_mutex_destroy(&ndjson.deliver_mutex);
+	return ndjson.ret;
+}
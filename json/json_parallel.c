@@ -0,0 +1,402 @@
+#include <stdlib.h>
+#include <string.h>
+#include "json.h"
+#include "json_lex.h"
+#include "json_parse.h"
+#include "json_pool.h"
+#include "json_arena.h"
+
+/*
+ * Parallel parse of one large document. A structural pre-scan walks the members of the root object without
+ * building anything, it only finds where each value starts and ends. Large object values and ranges of array
+ * elements become tasks for the work-stealing pool, each task parses its byte range into a slot that was
+ * allocated during the pre-scan. The cells of an array are allocated once all of its elements are counted, its
+ * range tasks are only submitted then. Stitching is therefore done by the time the pool is drained. Small values and
+ * scalars are parsed inline by the pre-scan, containers inside an array range by the task of the range. On any error
+ * the partial tree is dropped and the document is parsed serially once more, so errors are reported exactly like
+ * json_parse_ex does.
+ */
+
+typedef enum {
+	JSON_PARALLEL_TASK_OBJECT,
+	JSON_PARALLEL_TASK_ARRAY_RANGE,
+} json_parallel_task_type_t;
+
+typedef struct json_parallel_task_t {
+	json_parallel_task_type_t type;
+	const char* p_input;
+	size_t input_len;
+	json_object_t* p_object;
+	json_array_t* p_array;
+	size_t first_index;
+	size_t num_elements;
+	json_ret_code_t ret;
+	struct json_parallel_task_t* p_next;
+} json_parallel_task_t;
+
+typedef struct {
+	const char* p_data;
+	size_t size;
+	size_t chunk_size;
+	json_pool_t* p_pool;
+	json_pool_group_t group;
+	json_parallel_task_t* p_tasks;
+} json_parallel_t;
+
+// Parses the container that p_token opens into p_member, the input is consumed up to its end. Strings are placed by
+// the parser like json_parse_ex does, short ones inside their member.
+static json_ret_code_t json_parallel_parse_container(json_parallel_task_t* p_task, size_t* p_consumed_total,
+													 json_token_t* p_token, json_array_member_t* p_member) {
+	json_lex_t lex = {.flags = JSON_LEX_FLAG_RAW_STRINGS};
+	json_parse_t parse;
+	json_parse_value_begin(&parse, &p_member->value, &p_member->type);
+	parse.raw_strings = true;
+	json_ret_code_t ret = json_parse_object_token(&parse, p_token);
+	while (ret == JSON_RETVAL_BUSY && parse.stack.depth > 0) {
+		json_token_t token = {0};
+		size_t consumed = 0;
+		if (json_lex_next_token(&lex, &p_task->p_input[*p_consumed_total], p_task->input_len - *p_consumed_total, &consumed,
+								&token) != JSON_RETVAL_OK) {
+			break;
+		}
+		*p_consumed_total += consumed;
+		ret = json_parse_object_token(&parse, &token);
+		json_lex_free_tokens(&token, 1);
+	}
+	return json_parse_object_end(&parse, *p_consumed_total, NULL) == JSON_RETVAL_OK ? JSON_RETVAL_OK : JSON_RETVAL_FAIL;
+}
+
+static json_ret_code_t json_parallel_parse_array_range(json_parallel_task_t* p_task) {
+	json_lex_t lex = {0};
+	size_t consumed_total = 0;
+	for (size_t i = 0; i < p_task->num_elements; i++) {
+		json_token_t token = {0};
+		size_t consumed = 0;
+		if (i > 0) {
+			if (json_lex_next_token(&lex, &p_task->p_input[consumed_total], p_task->input_len - consumed_total, &consumed,
+									&token) != JSON_RETVAL_OK || token.type != JSON_TOKEN_TYPE_MEMBER_DELIM) {
+				return JSON_RETVAL_FAIL;
+			}
+			consumed_total += consumed;
+		}
+		if (json_lex_next_token(&lex, &p_task->p_input[consumed_total], p_task->input_len - consumed_total, &consumed,
+								&token) != JSON_RETVAL_OK) {
+			return JSON_RETVAL_FAIL;
+		}
+		consumed_total += consumed;
+
+		// Objects and arrays are handed to the serial parser token by token until they are closed
+		if (p_task->p_array->values != NULL &&
+			(token.type == JSON_TOKEN_TYPE_START_OBJECT || token.type == JSON_TOKEN_TYPE_VAL_START_ARRAY)) {
+			json_array_member_t* p_member = &p_task->p_array->values[p_task->first_index + i];
+			if (json_parallel_parse_container(p_task, &consumed_total, &token, p_member) != JSON_RETVAL_OK) {
+				return JSON_RETVAL_FAIL;
+			}
+			continue;
+		}
+
+		if (p_task->p_array->numbers != NULL) {
+			if (token.type != JSON_TOKEN_TYPE_VAL_NUMBER) {
+				return JSON_RETVAL_FAIL;
+			}
+			p_task->p_array->numbers[p_task->first_index + i] = token.value.number;
+			continue;
+		}
+		json_array_member_t* p_member = &p_task->p_array->values[p_task->first_index + i];
+		switch (token.type) {
+			case JSON_TOKEN_TYPE_VAL_NULL:
+				p_member->type = JSON_VALUE_TYPE_NULL;
+				break;
+			case JSON_TOKEN_TYPE_VAL_BOOLEAN:
+				p_member->type = JSON_VALUE_TYPE_BOOLEAN;
+				p_member->value.boolean = token.value.boolean;
+				break;
+			case JSON_TOKEN_TYPE_VAL_NUMBER:
+				p_member->type = JSON_VALUE_TYPE_NUMBER;
+				p_member->value.number = token.value.number;
+				break;
+			case JSON_TOKEN_TYPE_VAL_STRING:
+				p_member->type = JSON_VALUE_TYPE_STRING;
+				p_member->value.string = token.value.string.data;
+				break;
+			default:
+				return JSON_RETVAL_FAIL;
+		}
+	}
+
+	// The pre-scan does not lex scalars, anything left behind the last element like "2x" is an error
+	consumed_total += json_lex_skip_whitespace(&p_task->p_input[consumed_total], p_task->input_len - consumed_total);
+	return consumed_total == p_task->input_len ? JSON_RETVAL_OK : JSON_RETVAL_FAIL;
+}
+
+static void json_parallel_run_task(void* p_arg, uint32_t worker_index) {
+	(void) worker_index;
+	json_parallel_task_t* p_task = p_arg;
+	if (p_task->type == JSON_PARALLEL_TASK_OBJECT) {
+		json_object_t* p_parent = p_task->p_object->parent;
+		p_task->ret = json_parse_object_input(p_task->p_input, p_task->input_len, JSON_LEX_FLAG_NONE, NULL, NULL, NULL,
+											  p_task->p_object, NULL);
+		p_task->p_object->parent = p_parent;
+	} else {
+		p_task->ret = json_parallel_parse_array_range(p_task);
+	}
+}
+
+// Tasks that are never submitted keep their busy state and fail the parse
+static json_parallel_task_t* json_parallel_queue_task(json_parallel_t* p_parallel, json_parallel_task_t* p_template) {
+	json_parallel_task_t* p_task = malloc(sizeof(json_parallel_task_t));
+	if (p_task == NULL) {
+		return NULL;
+	}
+	*p_task = *p_template;
+	p_task->ret = JSON_RETVAL_BUSY;
+	p_task->p_next = p_parallel->p_tasks;
+	p_parallel->p_tasks = p_task;
+	return p_task;
+}
+
+static void json_parallel_submit_task(json_parallel_t* p_parallel, json_parallel_task_t* p_task) {
+	// Tasks of tiny values run inline, a pool round trip costs more than parsing them
+	if (p_task->input_len < p_parallel->chunk_size / 16 ||
+		json_pool_submit(p_parallel->p_pool, &p_parallel->group, json_parallel_run_task, p_task) != JSON_RETVAL_OK) {
+		json_parallel_run_task(p_task, 0);
+	}
+}
+
+// Splits the elements of the array at p_input into ranges of about chunk_size bytes
+static json_ret_code_t json_parallel_scan_array(json_parallel_t* p_parallel, const char* p_input, size_t input_len,
+												json_array_t* p_array, size_t* p_len) {
+	size_t i = 1 + json_lex_skip_whitespace(&p_input[1], input_len - 1);
+	json_parallel_task_t range = {.type = JSON_PARALLEL_TASK_ARRAY_RANGE, .p_input = &p_input[i], .p_array = p_array};
+	json_parallel_task_t* p_last_task = p_parallel->p_tasks;
+	size_t length = 0;
+	// Arrays of numbers are packed, the tasks check that the values really are numbers
+	bool is_packed = true;
+	if (i < input_len && p_input[i] == ']') {
+		*p_len = i + 1;
+		return JSON_RETVAL_OK;
+	}
+
+	while (i < input_len) {
+		size_t value_len;
+		is_packed = is_packed && (p_input[i] == '-' || (p_input[i] >= '0' && p_input[i] <= '9'));
+		if (json_lex_skip_value(&p_input[i], input_len - i, &value_len) != JSON_RETVAL_OK) {
+			return JSON_RETVAL_FAIL;
+		}
+		i += value_len;
+		length++;
+		range.num_elements++;
+		range.input_len = (size_t) (&p_input[i] - range.p_input);
+		i += json_lex_skip_whitespace(&p_input[i], input_len - i);
+		if (i >= input_len) {
+			return JSON_RETVAL_FAIL;
+		}
+
+		bool is_end = p_input[i] == ']';
+		if (is_end || range.input_len >= p_parallel->chunk_size) {
+			if (json_parallel_queue_task(p_parallel, &range) == NULL) {
+				return JSON_RETVAL_FAIL;
+			}
+			range.first_index = length;
+			range.num_elements = 0;
+			range.p_input = &p_input[i + 1];
+		}
+		if (is_end) {
+			*p_len = i + 1;
+			if (is_packed) {
+				p_array->numbers = malloc(length * sizeof(double));
+			} else {
+				p_array->values = json_arena_resize(NULL, NULL, 0, length, sizeof(json_array_member_t));
+			}
+			if (p_array->numbers == NULL && p_array->values == NULL) {
+				return JSON_RETVAL_FAIL;
+			}
+			p_array->length = length;
+			p_array->max_length = length;
+			for (json_parallel_task_t* p_task = p_parallel->p_tasks; p_task != p_last_task; p_task = p_task->p_next) {
+				json_parallel_submit_task(p_parallel, p_task);
+			}
+			return JSON_RETVAL_OK;
+		}
+		if (p_input[i] != ',') {
+			return JSON_RETVAL_FAIL;
+		}
+		i++;
+		i += json_lex_skip_whitespace(&p_input[i], input_len - i);
+		if (range.num_elements == 0) {
+			range.p_input = &p_input[i];
+		}
+	}
+	return JSON_RETVAL_FAIL;
+}
+
+static json_ret_code_t json_parallel_scan_value(json_parallel_t* p_parallel, json_object_t* p_object,
+												json_object_member_t* p_member, const char* p_input, size_t input_len,
+												size_t* p_len) {
+	if (p_input[0] == '{') {
+		size_t value_len;
+		if (json_lex_skip_value(p_input, input_len, &value_len) != JSON_RETVAL_OK) {
+			return JSON_RETVAL_FAIL;
+		}
+		p_member->type = JSON_VALUE_TYPE_OBJECT;
+		p_member->value.object = malloc(sizeof(json_object_t));
+		if (p_member->value.object == NULL) {
+			return JSON_RETVAL_FAIL;
+		}
+		*p_member->value.object = (json_object_t) {.parent = p_object};
+		*p_len = value_len;
+		json_parallel_task_t task = {.type = JSON_PARALLEL_TASK_OBJECT, .p_input = p_input, .input_len = value_len,
+									 .p_object = p_member->value.object};
+		json_parallel_task_t* p_task = json_parallel_queue_task(p_parallel, &task);
+		if (p_task == NULL) {
+			return JSON_RETVAL_FAIL;
+		}
+		json_parallel_submit_task(p_parallel, p_task);
+		return JSON_RETVAL_OK;
+	}
+	if (p_input[0] == '[') {
+		p_member->type = JSON_VALUE_TYPE_ARRAY;
+		p_member->value.array = calloc(1, sizeof(json_array_t));
+		if (p_member->value.array == NULL) {
+			return JSON_RETVAL_FAIL;
+		}
+		return json_parallel_scan_array(p_parallel, p_input, input_len, p_member->value.array, p_len);
+	}
+
+	// Scalars are lexed right away
+	json_lex_t lex = {0};
+	json_token_t token = {0};
+	size_t consumed;
+	if (json_lex_next_token(&lex, p_input, input_len, &consumed, &token) != JSON_RETVAL_OK) {
+		return JSON_RETVAL_FAIL;
+	}
+	*p_len = consumed;
+	switch (token.type) {
+		case JSON_TOKEN_TYPE_VAL_NULL:
+			p_member->type = JSON_VALUE_TYPE_NULL;
+			return JSON_RETVAL_OK;
+		case JSON_TOKEN_TYPE_VAL_BOOLEAN:
+			p_member->type = JSON_VALUE_TYPE_BOOLEAN;
+			p_member->value.boolean = token.value.boolean;
+			return JSON_RETVAL_OK;
+		case JSON_TOKEN_TYPE_VAL_NUMBER:
+			p_member->type = JSON_VALUE_TYPE_NUMBER;
+			p_member->value.number = token.value.number;
+			return JSON_RETVAL_OK;
+		case JSON_TOKEN_TYPE_VAL_STRING:
+			p_member->type = JSON_VALUE_TYPE_STRING;
+			p_member->value.string = token.value.string.data;
+			return JSON_RETVAL_OK;
+		default:
+			return JSON_RETVAL_FAIL;
+	}
+}
+
+static json_ret_code_t json_parallel_scan_root(json_parallel_t* p_parallel, json_object_t* p_object) {
+	const char* p_data = p_parallel->p_data;
+	size_t size = p_parallel->size;
+	size_t i = json_lex_skip_whitespace(p_data, size);
+	if (i >= size || p_data[i] != '{') {
+		return JSON_RETVAL_FAIL;
+	}
+	i++;
+	i += json_lex_skip_whitespace(&p_data[i], size - i);
+	if (i < size && p_data[i] == '}') {
+		i++;
+		return json_lex_skip_whitespace(&p_data[i], size - i) == size - i ? JSON_RETVAL_OK : JSON_RETVAL_FAIL;
+	}
+
+	json_lex_t lex = {0};
+	while (i < size) {
+		json_token_t token = {0};
+		size_t consumed;
+		if (json_lex_next_token(&lex, &p_data[i], size - i, &consumed, &token) != JSON_RETVAL_OK) {
+			return JSON_RETVAL_FAIL;
+		}
+		if (token.type != JSON_TOKEN_TYPE_VAL_STRING) {
+			json_lex_free_tokens(&token, 1);
+			return JSON_RETVAL_FAIL;
+		}
+		if (json_parse_object_reserve(p_object, NULL) != JSON_RETVAL_OK) {
+			json_lex_free_tokens(&token, 1);
+			return JSON_RETVAL_FAIL;
+		}
+		json_object_member_t* p_member = &p_object->members[p_object->num_members++];
+		p_member->key = token.value.string.data;
+		p_member->type = JSON_VALUE_TYPE_NULL;
+		i += consumed;
+
+		i += json_lex_skip_whitespace(&p_data[i], size - i);
+		if (i >= size || p_data[i] != ':') {
+			return JSON_RETVAL_FAIL;
+		}
+		i++;
+		i += json_lex_skip_whitespace(&p_data[i], size - i);
+		if (i >= size || json_parallel_scan_value(p_parallel, p_object, p_member, &p_data[i], size - i, &consumed) != JSON_RETVAL_OK) {
+			return JSON_RETVAL_FAIL;
+		}
+		i += consumed;
+
+		i += json_lex_skip_whitespace(&p_data[i], size - i);
+		if (i >= size) {
+			return JSON_RETVAL_FAIL;
+		}
+		if (p_data[i] == '}') {
+			i++;
+			return json_lex_skip_whitespace(&p_data[i], size - i) == size - i ? JSON_RETVAL_OK : JSON_RETVAL_FAIL;
+		}
+		if (p_data[i] != ',') {
+			return JSON_RETVAL_FAIL;
+		}
+		i++;
+	}
+	return JSON_RETVAL_FAIL;
+}
+
+json_ret_code_t json_parse_parallel(const char* p_data, size_t size, json_object_t* p_object,
+									const json_parallel_options_t* p_options, json_error_t* p_error) {
+	if (p_data == NULL || p_object == NULL) {
+		return JSON_RETVAL_INVALID_PARAM;
+	}
+
+	json_parallel_t parallel = {
+		.p_data = p_data,
+		.size = size,
+		.chunk_size = p_options != NULL && p_options->chunk_size > 0 ? p_options->chunk_size : JSON_PARALLEL_DEFAULT_CHUNK_SIZE,
+		.p_pool = p_options != NULL ? p_options->p_pool : NULL,
+	};
+
+	// Small documents are not worth the pre-scan
+	if (size < parallel.chunk_size) {
+		return json_parse_object_input(p_data, size, JSON_LEX_FLAG_NONE, NULL, NULL, NULL, p_object, p_error);
+	}
+	bool own_pool = parallel.p_pool == NULL;
+	if (own_pool && (parallel.p_pool = json_pool_new(0)) == NULL) {
+		return json_parse_object_input(p_data, size, JSON_LEX_FLAG_NONE, NULL, NULL, NULL, p_object, p_error);
+	}
+
+	*p_object = (json_object_t) {0};
+	json_ret_code_t ret = json_parallel_scan_root(&parallel, p_object);
+	json_pool_wait(parallel.p_pool, &parallel.group);
+	if (own_pool) {
+		json_pool_free(parallel.p_pool);
+	}
+
+	while (parallel.p_tasks != NULL) {
+		json_parallel_task_t* p_task = parallel.p_tasks;
+		if (p_task->ret != JSON_RETVAL_OK) {
+			ret = JSON_RETVAL_FAIL;
+		}
+		parallel.p_tasks = p_task->p_next;
+		free(p_task);
+	}
+
+	if (ret != JSON_RETVAL_OK) {
+		json_object_free(p_object);
+		return json_parse_object_input(p_data, size, JSON_LEX_FLAG_NONE, NULL, NULL, NULL, p_object, p_error);
+	}
+	if (p_error != NULL) {
+		*p_error = (json_error_t) {0};
+	}
+	return JSON_RETVAL_OK;
+}
@@ -2,310 +2,532 @@
 // Created by tholz on 06.06.2022.
 //
 
-#include <stdio.h>
 #include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include "json_parse.h"
+#include "json_arena.h"
 
 #define MAX_NESTING_LEVEL		1000
 
-typedef enum {
-	JSON_PARSE_STATE_INIT,
-	JSON_PARSE_STATE_OBJECT_START,
-	JSON_PARSE_STATE_OBJECT_KEY,
-	JSON_PARSE_STATE_NAME_VAL_DELIM,
-	JSON_PARSE_STATE_OBJECT_VALUE,
-	JSON_PARSE_STATE_OBJECT_VALUE_ARRAY,
-	JSON_PARSE_STATE_OBJECT_VALUE_ARRAY_DELIM,
-	JSON_PARSE_STATE_OBJECT_END,
-	JSON_PARSE_STATE_MEMBER_DELIM,
-	JSON_PARSE_STATE_END,
-	JSON_PARSE_STATE_ERROR,
-} json_parse_state_t;
-
-static struct {
-	json_parse_state_t state;
-	json_object_t *root;
-	json_object_t *current;
-	int32_t nesting_level;
-	bool is_array;
-} m_json_parse;
-
-static json_ret_code_t json_parse_object_token(json_token_t* p_token);
-
-static json_parse_state_t json_parse_state_init(json_token_t *p_token);
-static json_parse_state_t json_parse_state_object_start(json_token_t *p_token);
-static json_parse_state_t json_parse_state_object_key(json_token_t *p_token);
-static json_parse_state_t json_parse_state_name_val_delim(json_token_t *p_token);
-static json_parse_state_t json_parse_state_object_value(json_token_t *p_token);
-static json_parse_state_t json_parse_state_object_value_array(json_token_t *p_token);
-static json_parse_state_t json_parse_state_object_value_array_delim(json_token_t *p_token);
-static json_parse_state_t json_parse_state_object_end(json_token_t *p_token);
-static json_parse_state_t json_parse_state_member_delim(json_token_t *p_token);
-static json_parse_state_t json_parse_state_end(json_token_t *p_token);
-
-json_ret_code_t json_parse_object(json_token_t* tokens, uint32_t num_tokens, json_object_t* p_object) {
-	uint32_t tokens_consumed = 0;
-	if (p_object == NULL) {
+/*
+ * Token driven parser building the tree in a single pass. The open containers are kept on an explicit typed stack
+ * instead of recursing, a value is placed into the innermost one: behind the last key of an object or at the end of
+ * an array. Every entry is counted as soon as it exists, a member with its key and an array entry before their value
+ * is parsed, both are null until then. The tree is therefore complete at every point and a partial tree is released
+ * like any other. Closing a container pops it, the state then only depends on the container on top of the stack.
+ */
+
+static json_parse_state_t json_parse_state_value(json_parse_t* p_parse, json_token_t *p_token);
+static json_parse_state_t json_parse_state_object_start(json_parse_t* p_parse, json_token_t *p_token);
+static json_parse_state_t json_parse_state_object_key(json_parse_t* p_parse, json_token_t *p_token);
+static json_parse_state_t json_parse_state_member_delim(json_parse_t* p_parse, json_token_t *p_token);
+static json_parse_state_t json_parse_state_array_start(json_parse_t* p_parse, json_token_t *p_token);
+static json_parse_state_t json_parse_state_value_end(json_parse_t* p_parse, json_token_t *p_token);
+
+#define JSON_PARSE_SET_ERROR(_code, _offset, _expected) { \
+	p_parse->error.code = (_code); \
+	p_parse->error.offset = (_offset); \
+	p_parse->error.expected = (_expected); \
+}
+
+json_ret_code_t json_parse_object_reserve(json_object_t* p_object, json_arena_t* p_arena) {
+	if (p_object->num_members < p_object->max_num_members) {
+		return JSON_RETVAL_OK;
+	}
+	// The number of members is only limited by its type
+	if (p_object->num_members == UINT32_MAX) {
+		return JSON_RETVAL_FAIL;
+	}
+	size_t max_num_members = MIN(JSON_ARENA_GROW((size_t) p_object->max_num_members), (size_t) UINT32_MAX);
+	uintptr_t old_members = (uintptr_t) p_object->members;
+	json_object_member_t* p_members = json_arena_resize(p_arena, p_object->members, p_object->num_members, max_num_members,
+														sizeof(json_object_member_t));
+	if (p_members == NULL) {
+		return JSON_RETVAL_FAIL;
+	}
+
+	// Inline strings moved along with their members
+	if ((uintptr_t) p_members != old_members) {
+		for (uint32_t i = 0; i < p_object->num_members; i++) {
+			json_object_member_t* p_member = &p_members[i];
+			uintptr_t old_inline = old_members + i * sizeof(json_object_member_t) + offsetof(json_object_member_t, inline_strings);
+			if ((uintptr_t) p_member->key - old_inline < JSON_INLINE_STRINGS_SIZE) {
+				p_member->key = &p_member->inline_strings[(uintptr_t) p_member->key - old_inline];
+			}
+			if (p_member->type == JSON_VALUE_TYPE_STRING && (uintptr_t) p_member->value.string - old_inline < JSON_INLINE_STRINGS_SIZE) {
+				p_member->value.string = &p_member->inline_strings[(uintptr_t) p_member->value.string - old_inline];
+			}
+		}
+	}
+	p_object->members = p_members;
+	p_object->max_num_members = max_num_members;
+	return JSON_RETVAL_OK;
+}
+
+json_ret_code_t json_parse_object_begin(json_parse_t* p_parse, json_object_t* p_object) {
+	if (p_parse == NULL || p_object == NULL) {
 		return JSON_RETVAL_INVALID_PARAM;
 	}
-	memset(&m_json_parse, 0, sizeof(m_json_parse));
+	memset(p_parse, 0, sizeof(json_parse_t));
 	memset(p_object, 0, sizeof(json_object_t));
-	m_json_parse.root = p_object;
-	m_json_parse.current = p_object;
+	p_parse->root = p_object;
+	json_walk_init(&p_parse->stack);
+	return JSON_RETVAL_OK;
+}
+
+json_ret_code_t json_parse_value_begin(json_parse_t* p_parse, json_value_t* p_value, json_value_type_t* p_type) {
+	if (p_parse == NULL || p_value == NULL || p_type == NULL) {
+		return JSON_RETVAL_INVALID_PARAM;
+	}
+	memset(p_parse, 0, sizeof(json_parse_t));
+	*p_value = (json_value_t) {0};
+	*p_type = JSON_VALUE_TYPE_UNDEFINED;
+	p_parse->p_root_value = p_value;
+	p_parse->p_root_type = p_type;
+	json_walk_init(&p_parse->stack);
+	return JSON_RETVAL_OK;
+}
+
+json_ret_code_t json_parse_object_end(json_parse_t* p_parse, uint64_t end_offset, json_error_t* p_error) {
+	json_ret_code_t ret = JSON_RETVAL_OK;
+	json_walk_frame_t* p_frame = json_walk_top(&p_parse->stack);
+	if (p_parse->state == JSON_PARSE_STATE_ERROR) {
+		ret = JSON_RETVAL_FAIL;
+	} else if (p_frame != NULL || p_parse->state != JSON_PARSE_STATE_VALUE_END) {
+		JSON_PARSE_SET_ERROR(JSON_ERROR_UNEXPECTED_EOF, end_offset,
+							 p_frame != NULL ? (p_frame->type == JSON_VALUE_TYPE_OBJECT ? "object end" : "array end") :
+							 p_parse->root != NULL ? "object start" : "value");
+		ret = JSON_RETVAL_FAIL;
+	}
+	json_walk_free(&p_parse->stack);
+
+	if (p_error != NULL) {
+		*p_error = p_parse->error;
+	}
+
+	return ret;
+}
 
-	while (tokens_consumed < num_tokens) {
-		json_ret_code_t ret = json_parse_object_token(&tokens[tokens_consumed]);
+json_ret_code_t json_parse_object(json_token_t* tokens, uint32_t num_tokens, json_object_t* p_object, json_error_t* p_error) {
+	json_parse_t parse;
+	json_ret_code_t ret = json_parse_object_begin(&parse, p_object);
+	if (ret != JSON_RETVAL_OK) {
+		return ret;
+	}
+
+	for (uint32_t i = 0; i < num_tokens; i++) {
+		if (json_parse_object_token(&parse, &tokens[i]) != JSON_RETVAL_BUSY) {
+			break;
+		}
+	}
+
+	return json_parse_object_end(&parse, num_tokens > 0 ? tokens[num_tokens - 1].offset + 1 : 0, p_error);
+}
+
+// Lex and parse token by token, the number of tokens is not limited
+static json_ret_code_t json_parse_input(json_parse_t* p_parse, const char* p_input, size_t input_len, uint8_t lex_flags,
+										json_error_t* p_error) {
+	// Strings that are not unescaped in place are placed by the parser, short ones inside their member
+	if (!(lex_flags & JSON_LEX_FLAG_IN_PLACE)) {
+		lex_flags |= JSON_LEX_FLAG_RAW_STRINGS;
+	}
+	json_lex_t lex = {.flags = lex_flags};
+	p_parse->raw_strings = lex_flags & JSON_LEX_FLAG_RAW_STRINGS;
+
+	size_t consumed_total = 0;
+	while (true) {
+		json_token_t token = {0};
+		size_t consumed = 0;
+		json_ret_code_t ret = json_lex_next_token(&lex, &p_input[consumed_total], input_len - consumed_total, &consumed, &token);
+		if (ret == JSON_RETVAL_FINISHED) {
+			break;
+		}
+		if (ret != JSON_RETVAL_OK) {
+			json_walk_free(&p_parse->stack);
+			if (p_error != NULL) {
+				*p_error = lex.error;
+				p_error->offset += consumed_total;
+			}
+			return ret == JSON_RETVAL_INCOMPLETE ? JSON_RETVAL_ILLEGAL : ret;
+		}
+		token.offset += consumed_total;
+		consumed_total += consumed;
+
+		// String values are handed over from the token to the tree
+		ret = json_parse_object_token(p_parse, &token);
+		json_lex_free_tokens(&token, 1);
 		if (ret != JSON_RETVAL_BUSY) {
-			return ret;
+			break;
 		}
-		tokens_consumed++;
 	}
 
-	if (m_json_parse.nesting_level != 0) {
-		printf("\033[31mFailed to parse object: Unclosed object\033[0m\n");
-		return JSON_RETVAL_FAIL;
+	return json_parse_object_end(p_parse, input_len, p_error);
+}
+
+json_ret_code_t json_parse_object_input(const char* p_input, size_t input_len, uint8_t lex_flags, json_arena_t* p_arena,
+										json_key_pool_t* p_key_pool, json_schema_check_t* p_schema_check, json_object_t* p_object,
+										json_error_t* p_error) {
+	json_parse_t parse;
+	json_ret_code_t ret = json_parse_object_begin(&parse, p_object);
+	if (ret != JSON_RETVAL_OK) {
+		return ret;
 	}
+	parse.p_arena = p_arena;
+	p_object->flags = p_arena != NULL ? JSON_OBJECT_FLAG_ARENA : JSON_OBJECT_FLAG_NONE;
+	parse.p_key_pool = p_key_pool;
+	parse.p_schema_check = p_schema_check;
+	return json_parse_input(&parse, p_input, input_len, lex_flags, p_error);
+}
 
-	return JSON_RETVAL_OK;
+json_ret_code_t json_parse_value_input(const char* p_input, size_t input_len, json_value_t* p_value, json_value_type_t* p_type,
+									   json_error_t* p_error) {
+	json_parse_t parse;
+	json_ret_code_t ret = json_parse_value_begin(&parse, p_value, p_type);
+	if (ret != JSON_RETVAL_OK) {
+		return ret;
+	}
+	return json_parse_input(&parse, p_input, input_len, JSON_LEX_FLAG_NONE, p_error);
 }
 
-static json_ret_code_t json_parse_object_token(json_token_t* p_token) {
+json_ret_code_t json_parse_object_token(json_parse_t* p_parse, json_token_t* p_token) {
 	assert(p_token != NULL);
-	switch (m_json_parse.state) {
-		case JSON_PARSE_STATE_INIT:
-			m_json_parse.state = json_parse_state_init(p_token);
+	switch (p_parse->state) {
+		case JSON_PARSE_STATE_VALUE:
+			p_parse->state = json_parse_state_value(p_parse, p_token);
 			break;
 		case JSON_PARSE_STATE_OBJECT_START:
-			m_json_parse.state = json_parse_state_object_start(p_token);
+			p_parse->state = json_parse_state_object_start(p_parse, p_token);
 			break;
 		case JSON_PARSE_STATE_OBJECT_KEY:
-			m_json_parse.state = json_parse_state_object_key(p_token);
-			break;
-		case JSON_PARSE_STATE_NAME_VAL_DELIM:
-			m_json_parse.state = json_parse_state_name_val_delim(p_token);
-			break;
-		case JSON_PARSE_STATE_OBJECT_VALUE:
-			m_json_parse.state = json_parse_state_object_value(p_token);
-			break;
-		case JSON_PARSE_STATE_OBJECT_VALUE_ARRAY:
-			m_json_parse.state = json_parse_state_object_value_array(p_token);
-			break;
-		case JSON_PARSE_STATE_OBJECT_VALUE_ARRAY_DELIM:
-			m_json_parse.state = json_parse_state_object_value_array_delim(p_token);
-			break;
-		case JSON_PARSE_STATE_OBJECT_END:
-			m_json_parse.state = json_parse_state_object_end(p_token);
+			p_parse->state = json_parse_state_object_key(p_parse, p_token);
 			break;
 		case JSON_PARSE_STATE_MEMBER_DELIM:
-			m_json_parse.state = json_parse_state_member_delim(p_token);
+			p_parse->state = json_parse_state_member_delim(p_parse, p_token);
 			break;
-		case JSON_PARSE_STATE_END:
-			m_json_parse.state = json_parse_state_end(p_token);
+		case JSON_PARSE_STATE_ARRAY_START:
+			p_parse->state = json_parse_state_array_start(p_parse, p_token);
+			break;
+		case JSON_PARSE_STATE_VALUE_END:
+			p_parse->state = json_parse_state_value_end(p_parse, p_token);
 			break;
 		case JSON_PARSE_STATE_ERROR:
 			return JSON_RETVAL_FAIL;
 		default:
-			printf("Unhandled state %d\n", m_json_parse.state);
 			return JSON_RETVAL_FAIL;
 	}
-	if (m_json_parse.state == JSON_PARSE_STATE_ERROR) {
+	if (p_parse->state == JSON_PARSE_STATE_ERROR) {
 		return JSON_RETVAL_FAIL;
 	}
 	return JSON_RETVAL_BUSY;
 }
 
-#define JSON_PARSER_REPORT_ERROR(msg, ...) { \
-	printf("\033[31mFailed to parse object: "); \
-	printf(msg, ##__VA_ARGS__);                 \
-	printf(" at %u:%u\033[0m\n", p_token->line, p_token->column); \
-	return JSON_PARSE_STATE_ERROR;              \
+#define JSON_PARSER_REPORT_ERROR(code, expected) { \
+	JSON_PARSE_SET_ERROR(code, p_token->offset, expected); \
+	return JSON_PARSE_STATE_ERROR; \
 }
 
-static json_parse_state_t json_parse_state_init(json_token_t *p_token) {
-	if (p_token->type == JSON_TOKEN_TYPE_START_OBJECT) {
-		if (m_json_parse.nesting_level + 1 >= MAX_NESTING_LEVEL) {
-			JSON_PARSER_REPORT_ERROR("Maximum nesting level (%u) exceeded", MAX_NESTING_LEVEL);
+// Appends one reference token, '~' and '/' are escaped, the pointer is cut off when the buffer is full
+static size_t json_parse_append_pointer(char* pointer, size_t length, const char* token) {
+	const size_t max_length = JSON_SCHEMA_MAX_POINTER - 1;
+	if (length < max_length) {
+		pointer[length++] = '/';
+	}
+	for (; *token != '\0' && length < max_length; token++) {
+		if (*token == '~' || *token == '/') {
+			pointer[length++] = '~';
+			if (length == max_length) {
+				break;
+			}
 		}
-		m_json_parse.nesting_level++;
-		return JSON_PARSE_STATE_OBJECT_START;
+		pointer[length++] = *token == '~' ? '0' : *token == '/' ? '1' : *token;
 	}
-	JSON_PARSER_REPORT_ERROR("Expected object start, but got %s", json_get_token_name(p_token->type));
+	pointer[length] = '\0';
+	return length;
 }
 
+// A violation reported by the schema check. The pointer leads through the last entry of the first num_frames open
+// containers, which is the path to the value that was just placed or to the container that is being closed.
+static void json_parse_schema_error(json_parse_t* p_parse, json_ret_code_t ret, uint64_t offset, size_t num_frames) {
+	if (ret != JSON_RETVAL_ILLEGAL) {
+		JSON_PARSE_SET_ERROR(JSON_ERROR_OUT_OF_MEMORY, offset, NULL);
+		return;
+	}
+	JSON_PARSE_SET_ERROR(JSON_ERROR_SCHEMA, offset, p_parse->p_schema_check->keyword);
+	char* pointer = p_parse->p_schema_check->pointer;
+	size_t length = 0;
+	pointer[0] = '\0';
+	for (size_t i = 0; i < num_frames; i++) {
+		const json_walk_frame_t* p_frame = &p_parse->stack.frames[i];
+		if (p_frame->type == JSON_VALUE_TYPE_OBJECT) {
+			length = json_parse_append_pointer(pointer, length, p_frame->value.object->members[p_frame->value.object->num_members - 1].key);
+		} else {
+			char digits[24];
+			snprintf(digits, sizeof(digits), "%zu", p_frame->value.array->length - 1);
+			length = json_parse_append_pointer(pointer, length, digits);
+		}
+	}
+}
+
+// Checks the last key or value, num_frames selects the path that is reported on a violation
+#define JSON_PARSE_CHECK_SCHEMA(check, num_frames) \
+	if (p_parse->p_schema_check != NULL) { \
+		json_ret_code_t _ret = (check); \
+		if (_ret != JSON_RETVAL_OK) { \
+			json_parse_schema_error(p_parse, _ret, p_token->offset, (num_frames)); \
+			return JSON_PARSE_STATE_ERROR; \
+		} \
+	}
+
 #define JSON_PARSE_HANDLE_MALLOC(not_null) \
 	if ((not_null) == NULL) { \
-		JSON_PARSER_REPORT_ERROR("Failed to allocate memory"); \
-		return JSON_PARSE_STATE_ERROR; \
+		JSON_PARSER_REPORT_ERROR(JSON_ERROR_OUT_OF_MEMORY, NULL); \
 	}
 
-static json_parse_state_t json_parse_state_object_start(json_token_t *p_token) {
-	if (p_token->type == JSON_TOKEN_TYPE_VAL_STRING) {
-		JSON_PARSE_HANDLE_MALLOC(m_json_parse.current->members[m_json_parse.current->num_members] = calloc(1, sizeof(json_object_member_t)));
-		JSON_PARSE_HANDLE_MALLOC(m_json_parse.current->members[m_json_parse.current->num_members]->key = malloc(p_token->value.string.length + 1));
-		memcpy(m_json_parse.current->members[m_json_parse.current->num_members]->key, p_token->value.string.data, p_token->value.string.length);
-		m_json_parse.current->members[m_json_parse.current->num_members]->key[p_token->value.string.length] = '\0';
+#define JSON_PARSE_MALLOC(size) \
+	(p_parse->p_arena != NULL ? json_arena_alloc(p_parse->p_arena, (size)) : malloc(size))
 
-		return JSON_PARSE_STATE_OBJECT_KEY;
+// Raw strings that fit into inline_size bytes are unescaped into p_inline, longer ones into a new allocation
+static char* json_parse_take_string(json_parse_t* p_parse, json_token_t* p_token, char* p_inline, size_t inline_size) {
+	char* p_string = p_token->value.string.data;
+	if (!p_parse->raw_strings) {
+		// Take over the string allocated by the lexer instead of copying it
+		p_token->value.string.data = NULL;
+		return p_string;
 	}
-	if (p_token->type == JSON_TOKEN_TYPE_END_OBJECT) {
-		m_json_parse.nesting_level--;
-		if (m_json_parse.nesting_level <= 0) {
-			return JSON_PARSE_STATE_END;
-		}
-		return JSON_PARSE_STATE_OBJECT_END;
+	// The unescaped string is never longer than the raw one
+	size_t raw_len = p_token->value.string.length;
+	char* p_dest = raw_len < inline_size ? p_inline : JSON_PARSE_MALLOC(raw_len + 1);
+	if (p_dest != NULL) {
+		json_lex_unescape(p_dest, p_string, raw_len, NULL);
 	}
-	JSON_PARSER_REPORT_ERROR("Expected object key or object end, but got %s", json_get_token_name(p_token->type));
+	return p_dest;
 }
 
-static json_parse_state_t json_parse_state_object_key(json_token_t *p_token) {
-	if (p_token->type == JSON_TOKEN_TYPE_NAME_VAL_DELIM) {
-		return JSON_PARSE_STATE_NAME_VAL_DELIM;
+// Room is made for the array entry at index count
+#define JSON_PARSE_RESERVE(p_entries, count, max_count) \
+	if ((count) >= (max_count)) { \
+		size_t _max_count = JSON_ARENA_GROW((size_t) (max_count)); \
+		void* _p_entries = json_arena_resize(p_parse->p_arena, (p_entries), (count), _max_count, sizeof(*(p_entries))); \
+		JSON_PARSE_HANDLE_MALLOC(_p_entries); \
+		(p_entries) = _p_entries; \
+		(max_count) = _max_count; \
 	}
-	JSON_PARSER_REPORT_ERROR("Expected name value delimiter, but got %s", json_get_token_name(p_token->type));
+
+// Keys are stored with the member, or interned when parsing with a key pool
+static char* json_parse_take_key(json_parse_t* p_parse, json_token_t* p_token, json_object_member_t* p_member) {
+	if (p_parse->p_key_pool == NULL) {
+		return p_member->key = json_parse_take_string(p_parse, p_token, p_member->inline_strings, JSON_INLINE_STRINGS_SIZE);
+	}
+
+	// Raw keys with escapes are unescaped into a scratch buffer first, the lexer frees keys it allocated itself
+	char buffer[256];
+	char* p_key = p_token->value.string.data;
+	size_t length = p_token->value.string.length;
+	if (p_parse->raw_strings && memchr(p_key, '\\', length) != NULL) {
+		p_key = length < sizeof(buffer) ? buffer : malloc(length + 1);
+		if (p_key == NULL) {
+			return NULL;
+		}
+		json_lex_unescape(p_key, p_token->value.string.data, length, &length);
+	}
+	p_member->key = (char*) json_key_pool_intern(p_parse->p_key_pool, p_key, length);
+	p_member->flags |= JSON_MEMBER_FLAG_INTERNED_KEY;
+	if (p_key != buffer && p_key != p_token->value.string.data) {
+		free(p_key);
+	}
+	return p_member->key;
 }
 
-static json_parse_state_t json_parse_state_name_val_delim(json_token_t *p_token) {
-	switch (p_token->type) {
-		case JSON_TOKEN_TYPE_VAL_NULL:
-			m_json_parse.current->members[m_json_parse.current->num_members]->type = JSON_VALUE_TYPE_NULL;
-			m_json_parse.current->num_members++;
-			return JSON_PARSE_STATE_OBJECT_VALUE;
-		case JSON_TOKEN_TYPE_VAL_BOOLEAN:
-			m_json_parse.current->members[m_json_parse.current->num_members]->type = JSON_VALUE_TYPE_BOOLEAN;
-			m_json_parse.current->members[m_json_parse.current->num_members]->value.boolean = p_token->value.boolean;
-			m_json_parse.current->num_members++;
-			return JSON_PARSE_STATE_OBJECT_VALUE;
-		case JSON_TOKEN_TYPE_VAL_NUMBER:
-			m_json_parse.current->members[m_json_parse.current->num_members]->type = JSON_VALUE_TYPE_NUMBER;
-			m_json_parse.current->members[m_json_parse.current->num_members]->value.number = p_token->value.number;
-			m_json_parse.current->num_members++;
-			return JSON_PARSE_STATE_OBJECT_VALUE;
+static inline json_value_type_t json_parse_get_value_type(json_token_type_t type) {
+	switch (type) {
 		case JSON_TOKEN_TYPE_VAL_STRING:
-			m_json_parse.current->members[m_json_parse.current->num_members]->type = JSON_VALUE_TYPE_STRING;
-			JSON_PARSE_HANDLE_MALLOC(m_json_parse.current->members[m_json_parse.current->num_members]->value.string = malloc(p_token->value.string.length + 1));
-			memcpy(m_json_parse.current->members[m_json_parse.current->num_members]->value.string, p_token->value.string.data, p_token->value.string.length);
-			m_json_parse.current->members[m_json_parse.current->num_members]->value.string[p_token->value.string.length] = '\0';
-			m_json_parse.current->num_members++;
-			return JSON_PARSE_STATE_OBJECT_VALUE;
+			return JSON_VALUE_TYPE_STRING;
+		case JSON_TOKEN_TYPE_VAL_NUMBER:
+			return JSON_VALUE_TYPE_NUMBER;
+		case JSON_TOKEN_TYPE_VAL_BOOLEAN:
+			return JSON_VALUE_TYPE_BOOLEAN;
+		case JSON_TOKEN_TYPE_VAL_NULL:
+			return JSON_VALUE_TYPE_NULL;
 		case JSON_TOKEN_TYPE_VAL_START_ARRAY:
-			m_json_parse.is_array = true;
-			m_json_parse.current->members[m_json_parse.current->num_members]->type = JSON_VALUE_TYPE_ARRAY;
-			JSON_PARSE_HANDLE_MALLOC(m_json_parse.current->members[m_json_parse.current->num_members]->value.array = calloc(1, sizeof(json_array_t)));
-			return JSON_PARSE_STATE_OBJECT_VALUE_ARRAY;
+			return JSON_VALUE_TYPE_ARRAY;
 		case JSON_TOKEN_TYPE_START_OBJECT:
-			m_json_parse.current->members[m_json_parse.current->num_members]->type = JSON_VALUE_TYPE_OBJECT;
-			JSON_PARSE_HANDLE_MALLOC(m_json_parse.current->members[m_json_parse.current->num_members]->value.object = calloc(1, sizeof(json_object_t)));
-			m_json_parse.current->members[m_json_parse.current->num_members]->value.object->parent = m_json_parse.current;
-			m_json_parse.current = m_json_parse.current->members[m_json_parse.current->num_members]->value.object;
-			if (m_json_parse.nesting_level + 1 >= MAX_NESTING_LEVEL) {
-				JSON_PARSER_REPORT_ERROR("Maximum nesting level (%u) exceeded", MAX_NESTING_LEVEL);
-			}
-			m_json_parse.nesting_level++;
-			return JSON_PARSE_STATE_OBJECT_START;
+			return JSON_VALUE_TYPE_OBJECT;
 		default:
-			JSON_PARSER_REPORT_ERROR("Expected value, but got %s", json_get_token_name(p_token->type));
+			return JSON_VALUE_TYPE_UNDEFINED;
 	}
 }
 
-static json_parse_state_t json_parse_state_object_value(json_token_t *p_token) {
-	if (p_token->type == JSON_TOKEN_TYPE_MEMBER_DELIM) {
-		return JSON_PARSE_STATE_MEMBER_DELIM;
+// Pushes an allocated container, the next token is its first entry or its end
+static json_parse_state_t json_parse_open(json_parse_t* p_parse, json_token_t* p_token, json_value_t container, json_value_type_t type) {
+	JSON_PARSE_HANDLE_MALLOC(json_walk_push(&p_parse->stack, container, type));
+	return type == JSON_VALUE_TYPE_OBJECT ? JSON_PARSE_STATE_OBJECT_START : JSON_PARSE_STATE_ARRAY_START;
+}
+
+static json_parse_state_t json_parse_close(json_parse_t* p_parse, json_token_t* p_token) {
+	JSON_PARSE_CHECK_SCHEMA(json_schema_check_end(p_parse->p_schema_check), p_parse->stack.depth - 1);
+	p_parse->stack.depth--;
+	return JSON_PARSE_STATE_VALUE_END;
+}
+
+// Counts a new member with its key, the value is null until it is parsed
+static json_parse_state_t json_parse_key(json_parse_t* p_parse, json_token_t* p_token) {
+	json_object_t* p_object = json_walk_top(&p_parse->stack)->value.object;
+	if (json_parse_object_reserve(p_object, p_parse->p_arena) != JSON_RETVAL_OK) {
+		JSON_PARSER_REPORT_ERROR(JSON_ERROR_OUT_OF_MEMORY, NULL);
 	}
-	if (p_token->type == JSON_TOKEN_TYPE_END_OBJECT) {
-		m_json_parse.nesting_level--;
-		if (m_json_parse.nesting_level <= 0) {
-			return JSON_PARSE_STATE_END;
+	json_object_member_t* p_member = &p_object->members[p_object->num_members];
+	JSON_PARSE_HANDLE_MALLOC(json_parse_take_key(p_parse, p_token, p_member));
+	p_member->type = JSON_VALUE_TYPE_NULL;
+	p_member->value = (json_value_t) {0};
+	p_object->num_members++;
+	JSON_PARSE_CHECK_SCHEMA(json_schema_check_key(p_parse->p_schema_check, p_member->key, strlen(p_member->key)),
+							p_parse->stack.depth);
+	return JSON_PARSE_STATE_OBJECT_KEY;
+}
+
+// Places a value behind the last key of the innermost object, at the end of the innermost array or at the root
+static json_parse_state_t json_parse_state_value(json_parse_t* p_parse, json_token_t *p_token) {
+	json_value_type_t type = json_parse_get_value_type(p_token->type);
+	json_walk_frame_t* p_frame = json_walk_top(&p_parse->stack);
+	if (p_frame == NULL && p_parse->root != NULL) {
+		// The root object is the one of the caller
+		if (type != JSON_VALUE_TYPE_OBJECT) {
+			JSON_PARSER_REPORT_ERROR(JSON_ERROR_UNEXPECTED_TOKEN, "object start");
+		}
+		JSON_PARSE_CHECK_SCHEMA(json_schema_check_value(p_parse->p_schema_check, JSON_VALUE_TYPE_OBJECT,
+														(json_value_t) {.object = p_parse->root}), 0);
+		return json_parse_open(p_parse, p_token, (json_value_t) {.object = p_parse->root}, JSON_VALUE_TYPE_OBJECT);
+	}
+	if (type == JSON_VALUE_TYPE_UNDEFINED) {
+		JSON_PARSER_REPORT_ERROR(JSON_ERROR_UNEXPECTED_TOKEN, "value");
+	}
+	if (type == JSON_VALUE_TYPE_OBJECT || type == JSON_VALUE_TYPE_ARRAY) {
+		if (p_parse->stack.depth + 1 >= MAX_NESTING_LEVEL) {
+			JSON_PARSER_REPORT_ERROR(JSON_ERROR_MAX_NESTING_LEVEL, NULL);
 		}
-		return JSON_PARSE_STATE_OBJECT_END;
 	}
-	JSON_PARSER_REPORT_ERROR("Expected member delimiter or object end, but got %s", json_get_token_name(p_token->type));
-}
 
-static json_parse_state_t json_parse_state_member_delim(json_token_t *p_token) {
-	if (p_token->type == JSON_TOKEN_TYPE_VAL_STRING) {
-		JSON_PARSE_HANDLE_MALLOC(m_json_parse.current->members[m_json_parse.current->num_members] = calloc(1, sizeof(json_object_member_t)));
-		JSON_PARSE_HANDLE_MALLOC(m_json_parse.current->members[m_json_parse.current->num_members]->key = malloc(p_token->value.string.length + 1));
-		memcpy(m_json_parse.current->members[m_json_parse.current->num_members]->key, p_token->value.string.data, p_token->value.string.length);
-		m_json_parse.current->members[m_json_parse.current->num_members]->key[p_token->value.string.length] = '\0';
-
-		return JSON_PARSE_STATE_OBJECT_KEY;
-	}
-	if (p_token->type == JSON_TOKEN_TYPE_START_OBJECT) { // TODO: ?
-		m_json_parse.current->members[m_json_parse.current->num_members]->type = JSON_VALUE_TYPE_OBJECT;
-		JSON_PARSE_HANDLE_MALLOC(m_json_parse.current->members[m_json_parse.current->num_members]->value.object = calloc(1, sizeof(json_object_t)));
-		m_json_parse.current->members[m_json_parse.current->num_members]->value.object->parent = m_json_parse.current;
-		m_json_parse.current = m_json_parse.current->members[m_json_parse.current->num_members]->value.object;
-		m_json_parse.nesting_level++;
-		return JSON_PARSE_STATE_OBJECT_START;
-	}
-	JSON_PARSER_REPORT_ERROR("Expected object key or object start, but got %s", json_get_token_name(p_token->type));
-}
+	json_value_t* p_value;
+	json_value_type_t* p_type;
+	char* p_inline = NULL;
+	size_t inline_size = 0;
+	if (p_frame == NULL) {
+		p_value = p_parse->p_root_value;
+		p_type = p_parse->p_root_type;
+	} else if (p_frame->type == JSON_VALUE_TYPE_OBJECT) {
+		// The value takes the inline space the key left
+		json_object_member_t* p_member = &p_frame->value.object->members[p_frame->value.object->num_members - 1];
+		size_t inline_used = JSON_PARSE_IS_INLINE(p_member, p_member->key) ? strlen(p_member->key) + 1 : 0;
+		p_value = &p_member->value;
+		p_type = &p_member->type;
+		p_inline = &p_member->inline_strings[inline_used];
+		inline_size = JSON_INLINE_STRINGS_SIZE - inline_used;
+	} else {
+		json_array_t* p_array = p_frame->value.array;
+		// Arrays stay packed until an entry other than a number shows up
+		if (type == JSON_VALUE_TYPE_NUMBER && (p_array->numbers != NULL || p_array->length == 0)) {
+			JSON_PARSE_RESERVE(p_array->numbers, p_array->length, p_array->max_length);
+			p_array->numbers[p_array->length++] = p_token->value.number;
+			JSON_PARSE_CHECK_SCHEMA(json_schema_check_value(p_parse->p_schema_check, JSON_VALUE_TYPE_NUMBER,
+															(json_value_t) {.number = p_token->value.number}), p_parse->stack.depth);
+			return JSON_PARSE_STATE_VALUE_END;
+		}
+		if (p_array->numbers != NULL) {
+			JSON_PARSE_HANDLE_MALLOC(p_array->values = JSON_PARSE_MALLOC(p_array->max_length * sizeof(json_array_member_t)));
+			for (size_t i = 0; i < p_array->length; i++) {
+				p_array->values[i] = (json_array_member_t) {.value.number = p_array->numbers[i], .type = JSON_VALUE_TYPE_NUMBER};
+			}
+			if (p_parse->p_arena == NULL) {
+				free(p_array->numbers);
+			}
+			p_array->numbers = NULL;
+		}
+		JSON_PARSE_RESERVE(p_array->values, p_array->length, p_array->max_length);
+		json_array_member_t* p_entry = &p_array->values[p_array->length++];
+		*p_entry = (json_array_member_t) {.type = JSON_VALUE_TYPE_NULL};
+		p_value = &p_entry->value;
+		p_type = &p_entry->type;
+	}
 
-static json_parse_state_t json_parse_state_object_value_array(json_token_t *p_token) {
-	json_array_t* p_array = m_json_parse.current->members[m_json_parse.current->num_members]->value.array;
-	switch (p_token->type) {
-		case JSON_TOKEN_TYPE_VAL_NULL:
-			JSON_PARSE_HANDLE_MALLOC(p_array->values[p_array->length] = malloc(sizeof(json_value_t)));
-			p_array->values[p_array->length++]->type = JSON_VALUE_TYPE_NULL;
-			return JSON_PARSE_STATE_OBJECT_VALUE_ARRAY_DELIM;
-		case JSON_TOKEN_TYPE_VAL_BOOLEAN:
-			JSON_PARSE_HANDLE_MALLOC(p_array->values[p_array->length] = malloc(sizeof(json_value_t)));
-			p_array->values[p_array->length]->type = JSON_VALUE_TYPE_BOOLEAN;
-			p_array->values[p_array->length++]->value.boolean = p_token->value.boolean;
-			return JSON_PARSE_STATE_OBJECT_VALUE_ARRAY_DELIM;
-		case JSON_TOKEN_TYPE_VAL_NUMBER:
-			JSON_PARSE_HANDLE_MALLOC(p_array->values[p_array->length] = malloc(sizeof(json_value_t)));
-			p_array->values[p_array->length]->type = JSON_VALUE_TYPE_NUMBER;
-			p_array->values[p_array->length++]->value.number = p_token->value.number;
-			return JSON_PARSE_STATE_OBJECT_VALUE_ARRAY_DELIM;
-		case JSON_TOKEN_TYPE_VAL_STRING:
-			JSON_PARSE_HANDLE_MALLOC(p_array->values[p_array->length] = malloc(sizeof(json_value_t)));
-			p_array->values[p_array->length]->type = JSON_VALUE_TYPE_STRING;
-			JSON_PARSE_HANDLE_MALLOC(p_array->values[p_array->length]->value.string = malloc(p_token->value.string.length + 1));
-			memcpy(p_array->values[p_array->length]->value.string, p_token->value.string.data, p_token->value.string.length);
-			p_array->values[p_array->length++]->value.string[p_token->value.string.length] = '\0';
-			return JSON_PARSE_STATE_OBJECT_VALUE_ARRAY_DELIM;
+	switch (type) {
+		case JSON_VALUE_TYPE_OBJECT:
+			// Containers are checked before they are allocated, a rejected one stays null
+			JSON_PARSE_CHECK_SCHEMA(json_schema_check_value(p_parse->p_schema_check, type, (json_value_t) {0}), p_parse->stack.depth);
+			JSON_PARSE_HANDLE_MALLOC(p_value->object = JSON_PARSE_MALLOC(sizeof(json_object_t)));
+			*p_value->object = (json_object_t) {.parent = p_frame != NULL && p_frame->type == JSON_VALUE_TYPE_OBJECT ? p_frame->value.object : NULL,
+												.flags = p_parse->p_arena != NULL ? JSON_OBJECT_FLAG_ARENA : JSON_OBJECT_FLAG_NONE};
+			*p_type = type;
+			return json_parse_open(p_parse, p_token, *p_value, type);
+		case JSON_VALUE_TYPE_ARRAY:
+			JSON_PARSE_CHECK_SCHEMA(json_schema_check_value(p_parse->p_schema_check, type, (json_value_t) {0}), p_parse->stack.depth);
+			JSON_PARSE_HANDLE_MALLOC(p_value->array = JSON_PARSE_MALLOC(sizeof(json_array_t)));
+			*p_value->array = (json_array_t) {0};
+			*p_type = type;
+			return json_parse_open(p_parse, p_token, *p_value, type);
+		case JSON_VALUE_TYPE_STRING:
+			JSON_PARSE_HANDLE_MALLOC(p_value->string = json_parse_take_string(p_parse, p_token, p_inline, inline_size));
+			break;
+		case JSON_VALUE_TYPE_NUMBER:
+			p_value->number = p_token->value.number;
+			break;
+		case JSON_VALUE_TYPE_BOOLEAN:
+			p_value->boolean = p_token->value.boolean;
+			break;
 		default:
-			JSON_PARSER_REPORT_ERROR("Expected value, but got %s", json_get_token_name(p_token->type));
+			*p_value = (json_value_t) {0};
+			break;
 	}
+	*p_type = type;
+	JSON_PARSE_CHECK_SCHEMA(json_schema_check_value(p_parse->p_schema_check, type, *p_value), p_parse->stack.depth);
+	return JSON_PARSE_STATE_VALUE_END;
 }
 
-static json_parse_state_t json_parse_state_object_value_array_delim(json_token_t *p_token) {
-	if (p_token->type == JSON_TOKEN_TYPE_MEMBER_DELIM) {
-		return JSON_PARSE_STATE_OBJECT_VALUE_ARRAY;
+static json_parse_state_t json_parse_state_object_start(json_parse_t* p_parse, json_token_t *p_token) {
+	if (p_token->type == JSON_TOKEN_TYPE_VAL_STRING) {
+		return json_parse_key(p_parse, p_token);
 	}
-	if (p_token->type == JSON_TOKEN_TYPE_VAL_END_ARRAY) {
-		m_json_parse.is_array = false;
-		m_json_parse.current->num_members++;
-		return JSON_PARSE_STATE_OBJECT_VALUE;
+	if (p_token->type == JSON_TOKEN_TYPE_END_OBJECT) {
+		return json_parse_close(p_parse, p_token);
 	}
-	JSON_PARSER_REPORT_ERROR("Expected value delimiter, but got %s", json_get_token_name(p_token->type));
+	JSON_PARSER_REPORT_ERROR(JSON_ERROR_UNEXPECTED_TOKEN, "object key or object end");
 }
 
-static json_parse_state_t json_parse_state_object_end(json_token_t *p_token) {
-	if (m_json_parse.nesting_level <= 0) {
-		return JSON_PARSE_STATE_END;
+static json_parse_state_t json_parse_state_object_key(json_parse_t* p_parse, json_token_t *p_token) {
+	if (p_token->type == JSON_TOKEN_TYPE_NAME_VAL_DELIM) {
+		return JSON_PARSE_STATE_VALUE;
 	}
-	m_json_parse.current = m_json_parse.current->parent;
-	m_json_parse.current->num_members++;
+	JSON_PARSER_REPORT_ERROR(JSON_ERROR_UNEXPECTED_TOKEN, "name value delimiter");
+}
 
-	if (p_token->type == JSON_TOKEN_TYPE_MEMBER_DELIM) {
-		return JSON_PARSE_STATE_MEMBER_DELIM;
+static json_parse_state_t json_parse_state_member_delim(json_parse_t* p_parse, json_token_t *p_token) {
+	if (p_token->type == JSON_TOKEN_TYPE_VAL_STRING) {
+		return json_parse_key(p_parse, p_token);
 	}
+	JSON_PARSER_REPORT_ERROR(JSON_ERROR_UNEXPECTED_TOKEN, "object key");
+}
 
-	m_json_parse.nesting_level--;
-	if (m_json_parse.nesting_level <= 0) {
-		return JSON_PARSE_STATE_END;
+static json_parse_state_t json_parse_state_array_start(json_parse_t* p_parse, json_token_t *p_token) {
+	if (p_token->type == JSON_TOKEN_TYPE_VAL_END_ARRAY) {
+		return json_parse_close(p_parse, p_token);
 	}
+	return json_parse_state_value(p_parse, p_token);
+}
 
-	if (p_token->type == JSON_TOKEN_TYPE_END_OBJECT) {
-		return JSON_PARSE_STATE_OBJECT_END;
+static json_parse_state_t json_parse_state_value_end(json_parse_t* p_parse, json_token_t *p_token) {
+	json_walk_frame_t* p_frame = json_walk_top(&p_parse->stack);
+	if (p_frame == NULL) {
+		JSON_PARSER_REPORT_ERROR(JSON_ERROR_UNEXPECTED_TOKEN, "end of input");
 	}
-	JSON_PARSER_REPORT_ERROR("Expected member delimiter or object end, but got %s", json_get_token_name(p_token->type));
+	bool is_array = p_frame->type == JSON_VALUE_TYPE_ARRAY;
+	if (p_token->type == JSON_TOKEN_TYPE_MEMBER_DELIM) {
+		return is_array ? JSON_PARSE_STATE_VALUE : JSON_PARSE_STATE_MEMBER_DELIM;
+	}
+	if (p_token->type == (is_array ? JSON_TOKEN_TYPE_VAL_END_ARRAY : JSON_TOKEN_TYPE_END_OBJECT)) {
+		return json_parse_close(p_parse, p_token);
+	}
+	JSON_PARSER_REPORT_ERROR(JSON_ERROR_UNEXPECTED_TOKEN, is_array ? "value delimiter or array end" : "member delimiter or object end");
 }
-
-static json_parse_state_t json_parse_state_end(json_token_t *p_token) {
-	JSON_PARSER_REPORT_ERROR("Unexpected token `%s` after end of object", json_get_token_name(p_token->type));
-}
\ No newline at end of file
@@ -7,7 +7,48 @@
 
 #include "json.h"
 #include "json_lex.h"
+#include "json_schema.h"
+#include "json_walk.h"
 
-json_ret_code_t json_parse_object(json_token_t* tokens, uint32_t num_tokens, json_object_t* p_object);
+typedef enum {
+	JSON_PARSE_STATE_VALUE,			// The root value, or a value behind a name value or value delimiter
+	JSON_PARSE_STATE_OBJECT_START,	// A key or the end of the object that was just opened
+	JSON_PARSE_STATE_OBJECT_KEY,	// The name value delimiter behind a key
+	JSON_PARSE_STATE_MEMBER_DELIM,	// A key behind a member delimiter
+	JSON_PARSE_STATE_ARRAY_START,	// A value or the end of the array that was just opened
+	JSON_PARSE_STATE_VALUE_END,		// A delimiter or the end of the innermost container, nothing once the root is complete
+	JSON_PARSE_STATE_ERROR,
+} json_parse_state_t;
+
+typedef struct {
+	json_parse_state_t state;
+	json_object_t *root;	// The root has to be an object and is parsed into this one, NULL for a root of any type
+	json_value_t *p_root_value;	// Root of any type, only used when root is NULL
+	json_value_type_t *p_root_type;
+	json_walk_t stack;		// Open containers, the innermost one on top
+	json_error_t error;
+	json_arena_t* p_arena;	// Allocate the tree from this arena instead of the heap, may be NULL
+	bool raw_strings;		// String tokens reference the raw input (JSON_LEX_FLAG_RAW_STRINGS), the parser places them
+	json_key_pool_t* p_key_pool;	// Intern keys in this pool instead of storing them with the member, may be NULL
+	json_schema_check_t* p_schema_check;	// Check keys and values against a schema while parsing, may be NULL
+} json_parse_t;
+
+// The string is stored inside the member instead of being allocated
+#define JSON_PARSE_IS_INLINE(p_member, p_string) \
+	((const char*) (p_string) >= (p_member)->inline_strings && \
+	 (const char*) (p_string) < (p_member)->inline_strings + JSON_INLINE_STRINGS_SIZE)
+
+json_ret_code_t json_parse_object_reserve(json_object_t* p_object, json_arena_t* p_arena);
+json_ret_code_t json_parse_object_begin(json_parse_t* p_parse, json_object_t* p_object);
+json_ret_code_t json_parse_value_begin(json_parse_t* p_parse, json_value_t* p_value, json_value_type_t* p_type);
+json_ret_code_t json_parse_object_token(json_parse_t* p_parse, json_token_t* p_token);
+json_ret_code_t json_parse_object_end(json_parse_t* p_parse, uint64_t end_offset, json_error_t* p_error);
+
+json_ret_code_t json_parse_object(json_token_t* tokens, uint32_t num_tokens, json_object_t* p_object, json_error_t* p_error);
+json_ret_code_t json_parse_object_input(const char* p_input, size_t input_len, uint8_t lex_flags, json_arena_t* p_arena,
+										json_key_pool_t* p_key_pool, json_schema_check_t* p_schema_check, json_object_t* p_object,
+										json_error_t* p_error);
+json_ret_code_t json_parse_value_input(const char* p_input, size_t input_len, json_value_t* p_value, json_value_type_t* p_type,
+									   json_error_t* p_error);
 
 #endif //JSON_PARSER_JSON_PARSE_H
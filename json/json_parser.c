@@ -0,0 +1,234 @@
+#include <stdlib.h>
+#include <string.h>
+#include "json.h"
+#include "json_lex.h"
+#include "json_parse.h"
+
+/*
+ * Incremental parser, input arrives in chunks of any size. Complete tokens are lexed straight from the chunk and
+ * handed to the parser state machine, so the tree grows while the input arrives. A token cut off at the end of a
+ * chunk is kept in a partial buffer together with its scan state (inside a string, after a backslash, within a
+ * number or literal). The next chunk is only scanned up to the end of that token, after which the buffered token
+ * is lexed as a whole. Each byte is therefore scanned at most twice, independent of how the input is split.
+ */
+
+#define JSON_PARSER_PARTIAL_MIN_CAPACITY	64
+
+struct json_parser_t {
+	json_lex_t lex;
+	json_parse_t parse;
+	json_ret_code_t status;
+	json_error_t error;
+	uint64_t offset;
+	struct {
+		char* data;
+		size_t length;
+		size_t capacity;
+		uint64_t offset;
+		json_token_type_t type;
+		bool in_escape;
+	} partial;
+};
+
+static json_ret_code_t json_parser_consume_token(json_parser_t* p_parser, json_token_t* p_token) {
+	json_ret_code_t ret = json_parse_object_token(&p_parser->parse, p_token);
+	json_lex_free_tokens(p_token, 1);
+	if (ret != JSON_RETVAL_BUSY) {
+		p_parser->status = ret;
+		p_parser->error = p_parser->parse.error;
+	}
+	return p_parser->status;
+}
+
+static json_ret_code_t json_parser_set_lex_error(json_parser_t* p_parser, json_ret_code_t ret, uint64_t base_offset) {
+	p_parser->status = ret == JSON_RETVAL_INCOMPLETE ? JSON_RETVAL_ILLEGAL : ret;
+	p_parser->error = p_parser->lex.error;
+	p_parser->error.offset += base_offset;
+	return p_parser->status;
+}
+
+static json_ret_code_t json_parser_partial_append(json_parser_t* p_parser, const char* p_data, size_t len) {
+	if (p_parser->partial.length + len > p_parser->partial.capacity) {
+		size_t capacity = MAX(p_parser->partial.capacity * 2, (size_t) JSON_PARSER_PARTIAL_MIN_CAPACITY);
+		while (capacity < p_parser->partial.length + len) {
+			capacity *= 2;
+		}
+		char* p_buffer = realloc(p_parser->partial.data, capacity);
+		if (p_buffer == NULL) {
+			p_parser->status = JSON_RETVAL_FAIL;
+			p_parser->error = (json_error_t) {.code = JSON_ERROR_OUT_OF_MEMORY, .offset = p_parser->partial.offset};
+			return JSON_RETVAL_FAIL;
+		}
+		p_parser->partial.data = p_buffer;
+		p_parser->partial.capacity = capacity;
+	}
+	memcpy(&p_parser->partial.data[p_parser->partial.length], p_data, len);
+	p_parser->partial.length += len;
+	return JSON_RETVAL_OK;
+}
+
+static inline bool json_parser_is_scalar_char(char c) {
+	return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || c == '-' || c == '+' || c == '.' || c == 'E';
+}
+
+// Length of the continuation of the partial token within the chunk, sets *p_complete when the token ends in it
+static size_t json_parser_partial_scan(json_parser_t* p_parser, const char* p_chunk, size_t chunk_len, bool* p_complete) {
+	size_t i = 0;
+	*p_complete = false;
+	if (p_parser->partial.type == JSON_TOKEN_TYPE_VAL_STRING) {
+		while (i < chunk_len) {
+			char c = p_chunk[i++];
+			if (p_parser->partial.in_escape) {
+				p_parser->partial.in_escape = false;
+			} else if (c == '\\') {
+				p_parser->partial.in_escape = true;
+			} else if (c == '"') {
+				*p_complete = true;
+				break;
+			}
+		}
+		return i;
+	}
+
+	// Numbers and literals end at the first character that cannot continue them
+	while (i < chunk_len && json_parser_is_scalar_char(p_chunk[i])) {
+		i++;
+	}
+	*p_complete = i < chunk_len;
+	return i;
+}
+
+static json_ret_code_t json_parser_partial_begin(json_parser_t* p_parser, const char* p_data, size_t len, json_token_type_t type) {
+	p_parser->partial.length = 0;
+	p_parser->partial.type = type;
+	p_parser->partial.in_escape = false;
+	if (type == JSON_TOKEN_TYPE_VAL_STRING) {
+		bool complete;
+		json_parser_partial_scan(p_parser, p_data + 1, len - 1, &complete);
+	}
+	return json_parser_partial_append(p_parser, p_data, len);
+}
+
+// Lexes the buffered token once it is complete or the input has ended
+static json_ret_code_t json_parser_partial_finish(json_parser_t* p_parser, size_t* p_token_len) {
+	json_token_t token = {0};
+	size_t consumed = 0;
+	json_ret_code_t ret = json_lex_next_token(&p_parser->lex, p_parser->partial.data, p_parser->partial.length, &consumed, &token);
+	if (ret != JSON_RETVAL_OK) {
+		return json_parser_set_lex_error(p_parser, ret, p_parser->partial.offset);
+	}
+	token.offset += p_parser->partial.offset;
+	*p_token_len = consumed;
+	p_parser->partial.length = 0;
+	return json_parser_consume_token(p_parser, &token);
+}
+
+json_parser_t* json_parser_new(json_object_t* p_object) {
+	if (p_object == NULL) {
+		return NULL;
+	}
+	json_parser_t* p_parser = calloc(1, sizeof(json_parser_t));
+	if (p_parser == NULL) {
+		return NULL;
+	}
+	json_parse_object_begin(&p_parser->parse, p_object);
+	// Tokens are parsed while their input is still buffered, the parser places their strings
+	p_parser->lex.flags = JSON_LEX_FLAG_RAW_STRINGS;
+	p_parser->parse.raw_strings = true;
+	p_parser->status = JSON_RETVAL_BUSY;
+	return p_parser;
+}
+
+json_ret_code_t json_parser_feed(json_parser_t* p_parser, const char* p_chunk, size_t chunk_len) {
+	if (p_parser == NULL || (p_chunk == NULL && chunk_len > 0)) {
+		return JSON_RETVAL_INVALID_PARAM;
+	}
+	if (p_parser->status != JSON_RETVAL_BUSY) {
+		return p_parser->status;
+	}
+
+	size_t i = 0;
+	if (p_parser->partial.length > 0) {
+		bool complete;
+		size_t scan_len = json_parser_partial_scan(p_parser, p_chunk, chunk_len, &complete);
+		size_t partial_len = p_parser->partial.length;
+		// Include one character beyond the token, so errors are reported exactly as for contiguous input
+		size_t append_len = complete ? MIN(scan_len + 1, chunk_len) : scan_len;
+		if (json_parser_partial_append(p_parser, p_chunk, append_len) != JSON_RETVAL_OK) {
+			return p_parser->status;
+		}
+		if (!complete) {
+			p_parser->offset += chunk_len;
+			return JSON_RETVAL_BUSY;
+		}
+		size_t token_len = 0;
+		if (json_parser_partial_finish(p_parser, &token_len) != JSON_RETVAL_BUSY) {
+			return p_parser->status;
+		}
+		i = token_len - partial_len;
+	}
+
+	while (i < chunk_len) {
+		json_token_t token = {0};
+		size_t consumed = 0;
+		json_ret_code_t ret = json_lex_next_token(&p_parser->lex, &p_chunk[i], chunk_len - i, &consumed, &token);
+		if (ret == JSON_RETVAL_FINISHED) {
+			break;
+		}
+		if (ret == JSON_RETVAL_INCOMPLETE || (ret == JSON_RETVAL_OK && token.type == JSON_TOKEN_TYPE_VAL_NUMBER &&
+											  i + consumed == chunk_len)) {
+			// The token continues in the next chunk, a number at the very end might still have more digits
+			size_t start = i + (ret == JSON_RETVAL_OK ? token.offset : consumed);
+			p_parser->partial.offset = p_parser->offset + start;
+			json_lex_free_tokens(&token, 1);
+			if (json_parser_partial_begin(p_parser, &p_chunk[start], chunk_len - start,
+										  json_lex_get_token_type(p_chunk[start])) != JSON_RETVAL_OK) {
+				return p_parser->status;
+			}
+			break;
+		}
+		if (ret != JSON_RETVAL_OK) {
+			return json_parser_set_lex_error(p_parser, ret, p_parser->offset + i);
+		}
+		token.offset += p_parser->offset + i;
+		i += consumed;
+		if (json_parser_consume_token(p_parser, &token) != JSON_RETVAL_BUSY) {
+			return p_parser->status;
+		}
+	}
+
+	p_parser->offset += chunk_len;
+	return JSON_RETVAL_BUSY;
+}
+
+json_ret_code_t json_parser_finish(json_parser_t* p_parser, json_error_t* p_error) {
+	if (p_parser == NULL) {
+		return JSON_RETVAL_INVALID_PARAM;
+	}
+	if (p_parser->status == JSON_RETVAL_BUSY && p_parser->partial.length > 0) {
+		size_t token_len = 0;
+		json_parser_partial_finish(p_parser, &token_len);
+	}
+	if (p_parser->status != JSON_RETVAL_BUSY) {
+		if (p_error != NULL) {
+			*p_error = p_parser->error;
+		}
+		return p_parser->status;
+	}
+
+	p_parser->status = json_parse_object_end(&p_parser->parse, p_parser->offset, &p_parser->error);
+	if (p_error != NULL) {
+		*p_error = p_parser->error;
+	}
+	return p_parser->status;
+}
+
+void json_parser_free(json_parser_t* p_parser) {
+	if (p_parser == NULL) {
+		return;
+	}
+	// The parse stack is left over when the parser was not finished
+	json_walk_free(&p_parser->parse.stack);
+	free(p_parser->partial.data);
+	free(p_parser);
+}
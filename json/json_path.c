@@ -0,0 +1,247 @@
+#include <stdlib.h>
+#include <string.h>
+#include "json_lex.h"
+#include "json_path.h"
+
+/*
+ * Compiled paths into a document. An expression is either a JSON Pointer ("/payload/items/3/price", "~0" and "~1"
+ * escape '~' and '/') or a JSONPath subset ("$.payload.items[3]['price']"). Compiling turns it into steps that hold
+ * the key, its length and hash and the array index the token stands for. Evaluation walks the tree without
+ * allocating. A key step selects the first member with the key like json_object_get_value does. Batch evaluation
+ * resolves a step shared with the previous path only once.
+ */
+
+// Array index of a token, only plain decimal numbers without leading zeros are indices
+static uint32_t json_path_parse_index(const char* p_token, size_t length) {
+	if (length == 0 || length > 9 || (length > 1 && p_token[0] == '0')) {
+		return JSON_PATH_NO_INDEX;
+	}
+	uint32_t index = 0;
+	for (size_t i = 0; i < length; i++) {
+		if (p_token[i] < '0' || p_token[i] > '9') {
+			return JSON_PATH_NO_INDEX;
+		}
+		index = index * 10 + (uint32_t) (p_token[i] - '0');
+	}
+	return index;
+}
+
+static json_ret_code_t json_path_add_step(json_path_t* p_path, const char* p_key, size_t length, uint32_t index) {
+	if (p_path->num_steps >= JSON_PATH_MAX_STEPS) {
+		return JSON_RETVAL_INVALID_PARAM;
+	}
+	json_path_step_t* p_step = &p_path->steps[p_path->num_steps++];
+	*p_step = (json_path_step_t) {.index = index};
+	if (p_key == NULL) {
+		return JSON_RETVAL_OK;
+	}
+	if ((p_step->key = malloc(length + 1)) == NULL) {
+		return JSON_RETVAL_FAIL;
+	}
+	memcpy(p_step->key, p_key, length);
+	p_step->key[length] = '\0';
+	p_step->length = length;
+	p_step->hash = json_lex_hash(p_key, length);
+	return JSON_RETVAL_OK;
+}
+
+// Reference tokens of a JSON Pointer, every token is a key and may be an index
+static json_ret_code_t json_path_compile_pointer(json_path_t* p_path, const char* expression, char* p_buffer) {
+	const char* p = expression;
+	while (*p == '/') {
+		p++;
+		size_t length = 0;
+		for (; *p != '\0' && *p != '/'; p++) {
+			if (*p == '~') {
+				if (p[1] != '0' && p[1] != '1') {
+					return JSON_RETVAL_INVALID_PARAM;
+				}
+				p_buffer[length++] = p[1] == '0' ? '~' : '/';
+				p++;
+			} else {
+				p_buffer[length++] = *p;
+			}
+		}
+		json_ret_code_t ret = json_path_add_step(p_path, p_buffer, length, json_path_parse_index(p_buffer, length));
+		if (ret != JSON_RETVAL_OK) {
+			return ret;
+		}
+	}
+	return *p == '\0' ? JSON_RETVAL_OK : JSON_RETVAL_INVALID_PARAM;
+}
+
+// Dot members, bracketed quoted members and bracketed indices after '$'
+static json_ret_code_t json_path_compile_jsonpath(json_path_t* p_path, const char* expression, char* p_buffer) {
+	const char* p = expression + 1;
+	json_ret_code_t ret = JSON_RETVAL_OK;
+	while (*p != '\0' && ret == JSON_RETVAL_OK) {
+		size_t length = 0;
+		if (*p == '.') {
+			for (p++; *p != '\0' && *p != '.' && *p != '['; p++) {
+				p_buffer[length++] = *p;
+			}
+			if (length == 0) {
+				return JSON_RETVAL_INVALID_PARAM;
+			}
+			ret = json_path_add_step(p_path, p_buffer, length, JSON_PATH_NO_INDEX);
+		} else if (*p == '[' && (p[1] == '\'' || p[1] == '"')) {
+			char quote = p[1];
+			for (p += 2; *p != '\0' && *p != quote; p++) {
+				if (*p == '\\' && (p[1] == quote || p[1] == '\\')) {
+					p++;
+				}
+				p_buffer[length++] = *p;
+			}
+			if (*p != quote || p[1] != ']') {
+				return JSON_RETVAL_INVALID_PARAM;
+			}
+			p += 2;
+			ret = json_path_add_step(p_path, p_buffer, length, JSON_PATH_NO_INDEX);
+		} else if (*p == '[') {
+			const char* p_end = strchr(p, ']');
+			uint32_t index = p_end != NULL ? json_path_parse_index(p + 1, (size_t) (p_end - p - 1)) : JSON_PATH_NO_INDEX;
+			if (index == JSON_PATH_NO_INDEX) {
+				return JSON_RETVAL_INVALID_PARAM;
+			}
+			p = p_end + 1;
+			ret = json_path_add_step(p_path, NULL, 0, index);
+		} else {
+			return JSON_RETVAL_INVALID_PARAM;
+		}
+	}
+	return ret;
+}
+
+json_path_t* json_path_compile(const char* expression) {
+	if (expression == NULL || (expression[0] != '/' && expression[0] != '$')) {
+		return NULL;
+	}
+	// Tokens are never longer than the expression, one scratch buffer serves all of them
+	size_t length = strlen(expression);
+	char* p_buffer = malloc(length + 1);
+	json_path_t* p_path = calloc(1, sizeof(json_path_t) + JSON_PATH_MAX_STEPS * sizeof(json_path_step_t));
+	json_ret_code_t ret = JSON_RETVAL_FAIL;
+	if (p_buffer != NULL && p_path != NULL) {
+		ret = expression[0] == '/' ? json_path_compile_pointer(p_path, expression, p_buffer) :
+			  json_path_compile_jsonpath(p_path, expression, p_buffer);
+	}
+	free(p_buffer);
+	// A path to the root object itself has no value to return
+	if (ret != JSON_RETVAL_OK || p_path->num_steps == 0) {
+		json_path_free(p_path);
+		return NULL;
+	}
+	json_path_t* p_shrunk = realloc(p_path, sizeof(json_path_t) + p_path->num_steps * sizeof(json_path_step_t));
+	return p_shrunk != NULL ? p_shrunk : p_path;
+}
+
+void json_path_free(json_path_t* p_path) {
+	if (p_path == NULL) {
+		return;
+	}
+	for (uint32_t i = 0; i < p_path->num_steps; i++) {
+		free(p_path->steps[i].key);
+	}
+	free(p_path);
+}
+
+static inline bool json_path_key_equal(const char* key, const json_path_step_t* p_step) {
+	return key[0] == p_step->key[0] && strcmp(key, p_step->key) == 0;
+}
+
+// The first member with the key, like json_object_get_value
+static json_object_member_t* json_path_find_member(const json_object_t* p_object, const json_path_step_t* p_step) {
+	for (uint32_t i = 0; i < p_object->num_members; i++) {
+		if (json_path_key_equal(p_object->members[i].key, p_step)) {
+			return &p_object->members[i];
+		}
+	}
+	return NULL;
+}
+
+// Applies one step to the container in p_value, the root object is passed with p_value NULL
+static json_value_t* json_path_step(json_path_step_t* p_step, const json_object_t* p_root, json_value_t* p_value,
+									json_value_type_t* p_type) {
+	if (p_value == NULL || *p_type == JSON_VALUE_TYPE_OBJECT) {
+		if (p_step->key == NULL) {
+			return NULL;
+		}
+		json_object_member_t* p_member = json_path_find_member(p_value != NULL ? p_value->object : p_root, p_step);
+		if (p_member == NULL) {
+			return NULL;
+		}
+		*p_type = p_member->type;
+		return &p_member->value;
+	}
+	if (*p_type == JSON_VALUE_TYPE_ARRAY && p_step->index != JSON_PATH_NO_INDEX) {
+		*p_type = json_value_get_array_member_type(p_value, p_step->index);
+		return json_value_get_array_member(p_value, p_step->index);
+	}
+	return NULL;
+}
+
+json_value_t* json_path_eval(json_path_t* p_path, const json_object_t* p_object, json_value_type_t* p_type) {
+	if (p_path == NULL || p_object == NULL) {
+		return NULL;
+	}
+	json_value_t* p_value = NULL;
+	json_value_type_t type = JSON_VALUE_TYPE_OBJECT;
+	for (uint32_t i = 0; i < p_path->num_steps; i++) {
+		if ((p_value = json_path_step(&p_path->steps[i], p_object, p_value, &type)) == NULL) {
+			type = JSON_VALUE_TYPE_UNDEFINED;
+			break;
+		}
+	}
+	if (p_type != NULL) {
+		*p_type = type;
+	}
+	return p_value;
+}
+
+size_t json_path_eval_batch(json_path_t* const* paths, size_t num_paths, const json_object_t* p_object, json_value_t** values,
+							json_value_type_t* types) {
+	if (paths == NULL || p_object == NULL || values == NULL) {
+		return 0;
+	}
+	// Values after each step of the previous path, a path with the same leading steps continues from there
+	json_value_t* resolved[JSON_PATH_MAX_STEPS];
+	json_value_type_t resolved_types[JSON_PATH_MAX_STEPS];
+	const json_path_t* p_previous = NULL;
+	uint32_t num_resolved = 0;
+	size_t num_found = 0;
+	for (size_t i = 0; i < num_paths; i++) {
+		json_path_t* p_path = paths[i];
+		values[i] = NULL;
+		if (types != NULL) {
+			types[i] = JSON_VALUE_TYPE_UNDEFINED;
+		}
+		if (p_path == NULL) {
+			continue;
+		}
+		uint32_t shared = 0;
+		while (p_previous != NULL && shared < num_resolved && shared < p_path->num_steps &&
+			   json_path_step_equal(&p_path->steps[shared], &p_previous->steps[shared])) {
+			shared++;
+		}
+		json_value_t* p_value = shared > 0 ? resolved[shared - 1] : NULL;
+		json_value_type_t type = shared > 0 ? resolved_types[shared - 1] : JSON_VALUE_TYPE_OBJECT;
+		num_resolved = shared;
+		for (uint32_t step = shared; step < p_path->num_steps; step++) {
+			if ((p_value = json_path_step(&p_path->steps[step], p_object, p_value, &type)) == NULL) {
+				break;
+			}
+			resolved[step] = p_value;
+			resolved_types[step] = type;
+			num_resolved = step + 1;
+		}
+		p_previous = p_path;
+		if (num_resolved == p_path->num_steps) {
+			values[i] = resolved[num_resolved - 1];
+			num_found++;
+			if (types != NULL) {
+				types[i] = resolved_types[num_resolved - 1];
+			}
+		}
+	}
+	return num_found;
+}
@@ -0,0 +1,27 @@
+#ifndef JSON_PARSER_JSON_PATH_H
+#define JSON_PARSER_JSON_PATH_H
+
+#include <string.h>
+#include "json.h"
+
+#define JSON_PATH_MAX_STEPS		64
+#define JSON_PATH_NO_INDEX		UINT32_MAX
+
+typedef struct {
+	char* key;			// NULL for index only steps of JSONPath
+	size_t length;
+	uint64_t hash;
+	uint32_t index;		// JSON_PATH_NO_INDEX if the step cannot select an array entry
+} json_path_step_t;
+
+struct json_path_t {
+	uint32_t num_steps;
+	json_path_step_t steps[];
+};
+
+static inline bool json_path_step_equal(const json_path_step_t* p_a, const json_path_step_t* p_b) {
+	return p_a->index == p_b->index && p_a->hash == p_b->hash && p_a->length == p_b->length &&
+		   (p_a->key == NULL) == (p_b->key == NULL) && (p_a->key == NULL || memcmp(p_a->key, p_b->key, p_a->length) == 0);
+}
+
+#endif //JSON_PARSER_JSON_PATH_H
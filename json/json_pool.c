@@ -0,0 +1,224 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "json_pool.h"
+#include "json_lex.h"
+
+/*
+ * Work-stealing thread pool. Every worker owns a deque, it takes its own tasks from the back (most recently
+ * submitted, still in cache) and steals from the front of the other deques when it runs dry. Tasks submitted
+ * from a worker go to its own deque, tasks from other threads are spread round robin. Idle workers sleep on a
+ * condition variable, the threads live until json_pool_free.
+ */
+
+#define JSON_POOL_MAX_THREADS			256
+#define JSON_POOL_DEQUE_MIN_CAPACITY	64
+
+typedef struct {
+	json_pool_task_fn task_fn;
+	void* p_arg;
+	json_pool_group_t* p_group;
+} json_pool_task_t;
+
+typedef struct {
+	pthread_mutex_t mutex;
+	json_pool_task_t* tasks;
+	size_t head;
+	size_t length;
+	size_t capacity;
+} json_pool_deque_t;
+
+struct json_pool_t {
+	uint32_t num_threads;
+	pthread_t threads[JSON_POOL_MAX_THREADS];
+	json_pool_deque_t deques[JSON_POOL_MAX_THREADS];
+	uint64_t num_queued;
+	uint32_t next_deque;
+	bool stop;
+	pthread_mutex_t mutex;
+	pthread_cond_t work_cond;
+	pthread_cond_t done_cond;
+};
+
+typedef struct {
+	json_pool_t* p_pool;
+	uint32_t worker_index;
+} json_pool_worker_t;
+
+static __thread json_pool_worker_t m_pool_worker;
+
+static json_ret_code_t json_pool_deque_push(json_pool_deque_t* p_deque, const json_pool_task_t* p_task) {
+	pthread_mutex_lock(&p_deque->mutex);
+	if (p_deque->length == p_deque->capacity) {
+		size_t capacity = MAX(p_deque->capacity * 2, (size_t) JSON_POOL_DEQUE_MIN_CAPACITY);
+		json_pool_task_t* tasks = malloc(capacity * sizeof(json_pool_task_t));
+		if (tasks == NULL) {
+			pthread_mutex_unlock(&p_deque->mutex);
+			return JSON_RETVAL_FAIL;
+		}
+		for (size_t i = 0; i < p_deque->length; i++) {
+			tasks[i] = p_deque->tasks[(p_deque->head + i) % p_deque->capacity];
+		}
+		free(p_deque->tasks);
+		p_deque->tasks = tasks;
+		p_deque->head = 0;
+		p_deque->capacity = capacity;
+	}
+	p_deque->tasks[(p_deque->head + p_deque->length) % p_deque->capacity] = *p_task;
+	p_deque->length++;
+	pthread_mutex_unlock(&p_deque->mutex);
+	return JSON_RETVAL_OK;
+}
+
+static bool json_pool_deque_pop(json_pool_deque_t* p_deque, json_pool_task_t* p_task, bool steal) {
+	pthread_mutex_lock(&p_deque->mutex);
+	bool found = p_deque->length > 0;
+	if (found && steal) {
+		*p_task = p_deque->tasks[p_deque->head];
+		p_deque->head = (p_deque->head + 1) % p_deque->capacity;
+		p_deque->length--;
+	} else if (found) {
+		*p_task = p_deque->tasks[(p_deque->head + p_deque->length - 1) % p_deque->capacity];
+		p_deque->length--;
+	}
+	pthread_mutex_unlock(&p_deque->mutex);
+	return found;
+}
+
+static bool json_pool_take(json_pool_t* p_pool, uint32_t worker_index, json_pool_task_t* p_task) {
+	if (json_pool_deque_pop(&p_pool->deques[worker_index], p_task, false)) {
+		return true;
+	}
+	// Workers start while json_pool_new is still creating the later ones
+	uint32_t num_threads = __atomic_load_n(&p_pool->num_threads, __ATOMIC_ACQUIRE);
+	for (uint32_t i = 1; i < num_threads; i++) {
+		if (json_pool_deque_pop(&p_pool->deques[(worker_index + i) % num_threads], p_task, true)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static void json_pool_run(json_pool_t* p_pool, json_pool_task_t* p_task, uint32_t worker_index) {
+	__atomic_fetch_sub(&p_pool->num_queued, 1, __ATOMIC_RELAXED);
+	p_task->task_fn(p_task->p_arg, worker_index);
+	if (__atomic_sub_fetch(&p_task->p_group->pending, 1, __ATOMIC_ACQ_REL) == 0) {
+		pthread_mutex_lock(&p_pool->mutex);
+		pthread_cond_broadcast(&p_pool->done_cond);
+		pthread_mutex_unlock(&p_pool->mutex);
+	}
+}
+
+static void* json_pool_worker(void* p_arg) {
+	m_pool_worker = *(json_pool_worker_t*) p_arg;
+	free(p_arg);
+	json_pool_t* p_pool = m_pool_worker.p_pool;
+	uint32_t worker_index = m_pool_worker.worker_index;
+
+	while (true) {
+		json_pool_task_t task;
+		if (json_pool_take(p_pool, worker_index, &task)) {
+			json_pool_run(p_pool, &task, worker_index);
+			continue;
+		}
+		pthread_mutex_lock(&p_pool->mutex);
+		while (__atomic_load_n(&p_pool->num_queued, __ATOMIC_RELAXED) == 0 && !p_pool->stop) {
+			pthread_cond_wait(&p_pool->work_cond, &p_pool->mutex);
+		}
+		bool stop = p_pool->stop;
+		pthread_mutex_unlock(&p_pool->mutex);
+		if (stop) {
+			return NULL;
+		}
+	}
+}
+
+json_pool_t* json_pool_new(uint32_t num_threads) {
+	if (num_threads == 0) {
+		long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		num_threads = num_cpus > 0 ? (uint32_t) num_cpus : 1;
+	}
+	num_threads = MIN(num_threads, (uint32_t) JSON_POOL_MAX_THREADS);
+
+	json_pool_t* p_pool = calloc(1, sizeof(json_pool_t));
+	if (p_pool == NULL) {
+		return NULL;
+	}
+	pthread_mutex_init(&p_pool->mutex, NULL);
+	pthread_cond_init(&p_pool->work_cond, NULL);
+	pthread_cond_init(&p_pool->done_cond, NULL);
+	for (uint32_t i = 0; i < JSON_POOL_MAX_THREADS; i++) {
+		pthread_mutex_init(&p_pool->deques[i].mutex, NULL);
+	}
+
+	for (uint32_t i = 0; i < num_threads; i++) {
+		json_pool_worker_t* p_worker = malloc(sizeof(json_pool_worker_t));
+		if (p_worker == NULL) {
+			break;
+		}
+		*p_worker = (json_pool_worker_t) {.p_pool = p_pool, .worker_index = i};
+		if (pthread_create(&p_pool->threads[i], NULL, json_pool_worker, p_worker) != 0) {
+			free(p_worker);
+			break;
+		}
+		__atomic_store_n(&p_pool->num_threads, i + 1, __ATOMIC_RELEASE);
+	}
+	if (p_pool->num_threads == 0) {
+		json_pool_free(p_pool);
+		return NULL;
+	}
+	return p_pool;
+}
+
+void json_pool_free(json_pool_t* p_pool) {
+	if (p_pool == NULL) {
+		return;
+	}
+	pthread_mutex_lock(&p_pool->mutex);
+	p_pool->stop = true;
+	pthread_cond_broadcast(&p_pool->work_cond);
+	pthread_mutex_unlock(&p_pool->mutex);
+	for (uint32_t i = 0; i < p_pool->num_threads; i++) {
+		pthread_join(p_pool->threads[i], NULL);
+	}
+	for (uint32_t i = 0; i < JSON_POOL_MAX_THREADS; i++) {
+		free(p_pool->deques[i].tasks);
+		pthread_mutex_destroy(&p_pool->deques[i].mutex);
+	}
+	pthread_cond_destroy(&p_pool->work_cond);
+	pthread_cond_destroy(&p_pool->done_cond);
+	pthread_mutex_destroy(&p_pool->mutex);
+	free(p_pool);
+}
+
+uint32_t json_pool_get_num_threads(const json_pool_t* p_pool) {
+	return p_pool->num_threads;
+}
+
+json_ret_code_t json_pool_submit(json_pool_t* p_pool, json_pool_group_t* p_group, json_pool_task_fn task_fn, void* p_arg) {
+	uint32_t deque_index = m_pool_worker.p_pool == p_pool ? m_pool_worker.worker_index
+						   : __atomic_fetch_add(&p_pool->next_deque, 1, __ATOMIC_RELAXED) % p_pool->num_threads;
+	json_pool_task_t task = {.task_fn = task_fn, .p_arg = p_arg, .p_group = p_group};
+
+	__atomic_fetch_add(&p_group->pending, 1, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&p_pool->num_queued, 1, __ATOMIC_RELAXED);
+	if (json_pool_deque_push(&p_pool->deques[deque_index], &task) != JSON_RETVAL_OK) {
+		__atomic_fetch_sub(&p_pool->num_queued, 1, __ATOMIC_RELAXED);
+		__atomic_fetch_sub(&p_group->pending, 1, __ATOMIC_RELAXED);
+		return JSON_RETVAL_FAIL;
+	}
+
+	pthread_mutex_lock(&p_pool->mutex);
+	pthread_cond_signal(&p_pool->work_cond);
+	pthread_mutex_unlock(&p_pool->mutex);
+	return JSON_RETVAL_OK;
+}
+
+void json_pool_wait(json_pool_t* p_pool, json_pool_group_t* p_group) {
+	pthread_mutex_lock(&p_pool->mutex);
+	while (__atomic_load_n(&p_group->pending, __ATOMIC_ACQUIRE) > 0) {
+		pthread_cond_wait(&p_pool->done_cond, &p_pool->mutex);
+	}
+	pthread_mutex_unlock(&p_pool->mutex);
+}
@@ -0,0 +1,17 @@
+#ifndef JSON_PARSER_JSON_POOL_H
+#define JSON_PARSER_JSON_POOL_H
+
+#include "json.h"
+
+typedef void (*json_pool_task_fn)(void* p_arg, uint32_t worker_index);
+
+// Tasks submitted together, json_pool_wait returns once all of them ran
+typedef struct {
+	uint64_t pending;
+} json_pool_group_t;
+
+uint32_t json_pool_get_num_threads(const json_pool_t* p_pool);
+json_ret_code_t json_pool_submit(json_pool_t* p_pool, json_pool_group_t* p_group, json_pool_task_fn task_fn, void* p_arg);
+void json_pool_wait(json_pool_t* p_pool, json_pool_group_t* p_group);
+
+#endif //JSON_PARSER_JSON_POOL_H
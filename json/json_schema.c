@@ -0,0 +1,564 @@
+#include <stdlib.h>
+#include <string.h>
+#include "json.h"
+#include "json_lex.h"
+#include "json_parse.h"
+#include "json_schema.h"
+
+/*
+ * JSON Schema subset compiled into flat tables and checked while the parser builds the tree. A schema becomes one
+ * node per subschema holding the allowed types as a bit set, the bounds and indices of its properties, items and
+ * additionalProperties nodes. The properties of a node are contiguous in the property table, properties that are
+ * only listed in required are added there as well, each required property owns one bit of the seen bit set of the
+ * object being checked.
+ *
+ * The parser reports every key and value in document order and the end of every container, the checker keeps a
+ * stack of the open containers and the node of the next value. Values are checked before containers are allocated,
+ * so a document is rejected at the first violation without building the rest of the tree. The parser derives the
+ * JSON Pointer of the failing value from the path it is at.
+ *
+ * Supported keywords: type, enum, minimum, maximum, exclusiveMinimum, exclusiveMaximum (numbers), minLength and
+ * maxLength (code points), minItems, maxItems, items (one schema for all entries), properties, required and
+ * additionalProperties. Annotations are ignored, any other keyword fails compilation.
+ */
+
+#define JSON_SCHEMA_ANY			UINT32_MAX			// Node that accepts every value
+#define JSON_SCHEMA_FORBIDDEN	(UINT32_MAX - 1)	// Node of the false schema
+#define JSON_SCHEMA_NOT_REQUIRED	UINT32_MAX
+#define JSON_SCHEMA_MAX_COUNT	(1ull << 53)
+
+#define JSON_SCHEMA_TYPE_INTEGER	(1u << 7)
+#define JSON_SCHEMA_TYPE_ALL \
+	((1u << JSON_VALUE_TYPE_STRING) | (1u << JSON_VALUE_TYPE_NUMBER) | (1u << JSON_VALUE_TYPE_BOOLEAN) | \
+	 (1u << JSON_VALUE_TYPE_NULL) | (1u << JSON_VALUE_TYPE_ARRAY) | (1u << JSON_VALUE_TYPE_OBJECT))
+
+#define JSON_SCHEMA_FLAG_MINIMUM			0x01
+#define JSON_SCHEMA_FLAG_MAXIMUM			0x02
+#define JSON_SCHEMA_FLAG_EXCLUSIVE_MINIMUM	0x04
+#define JSON_SCHEMA_FLAG_EXCLUSIVE_MAXIMUM	0x08
+
+typedef struct {
+	uint32_t types;
+	uint32_t flags;
+	double minimum;
+	double maximum;
+	double exclusive_minimum;
+	double exclusive_maximum;
+	size_t min_length;
+	size_t max_length;
+	size_t min_items;
+	size_t max_items;
+	uint32_t first_property;
+	uint32_t num_properties;
+	uint32_t num_required;
+	uint32_t additional;	// Node of keys that are not properties
+	uint32_t items;
+	uint32_t first_enum;
+	uint32_t num_enum;
+} json_schema_node_t;
+
+typedef struct {
+	char* key;
+	size_t length;
+	uint64_t hash;
+	uint32_t node;
+	uint32_t required;	// Bit in the seen bit set of the object
+	bool declared;		// Listed in properties, not only in required
+} json_schema_property_t;
+
+struct json_schema_t {
+	json_schema_node_t* nodes;
+	uint32_t num_nodes;
+	uint32_t max_nodes;
+	json_schema_property_t* properties;
+	uint32_t num_properties;
+	uint32_t max_properties;
+	json_array_member_t* enums;
+	uint32_t num_enums;
+	uint32_t max_enums;
+};
+
+#define JSON_SCHEMA_HANDLE_RET(ret) { \
+	json_ret_code_t _ret = (ret); \
+	if (_ret != JSON_RETVAL_OK) { \
+		return _ret; \
+	} \
+}
+
+// Room for one more entry at index count
+#define JSON_SCHEMA_RESERVE(p_entries, count, max_count) \
+	if ((count) >= (max_count)) { \
+		size_t _max_count = (max_count) == 0 ? 16 : (size_t) (max_count) * 2; \
+		void* _p_entries = realloc((p_entries), _max_count * sizeof(*(p_entries))); \
+		if (_p_entries == NULL) { \
+			return JSON_RETVAL_FAIL; \
+		} \
+		(p_entries) = _p_entries; \
+		(max_count) = _max_count; \
+	}
+
+// Doubles of magnitude 2^53 and above have no fraction
+static bool json_schema_is_integer(double number) {
+	if (number <= -9007199254740992.0 || number >= 9007199254740992.0) {
+		return number - number == 0;
+	}
+	return number == (double) (int64_t) number;
+}
+
+static bool json_schema_get_count(const json_object_member_t* p_member, size_t* p_count) {
+	if (p_member->type != JSON_VALUE_TYPE_NUMBER || p_member->value.number < 0 ||
+		p_member->value.number > (double) JSON_SCHEMA_MAX_COUNT || !json_schema_is_integer(p_member->value.number)) {
+		return false;
+	}
+	*p_count = (size_t) p_member->value.number;
+	return true;
+}
+
+static bool json_schema_get_type(const char* name, uint32_t* p_types) {
+	static const struct {
+		const char* name;
+		uint32_t types;
+	} types[] = {
+		{"object", 1u << JSON_VALUE_TYPE_OBJECT}, {"array", 1u << JSON_VALUE_TYPE_ARRAY},
+		{"string", 1u << JSON_VALUE_TYPE_STRING}, {"number", 1u << JSON_VALUE_TYPE_NUMBER},
+		{"integer", JSON_SCHEMA_TYPE_INTEGER}, {"boolean", 1u << JSON_VALUE_TYPE_BOOLEAN},
+		{"null", 1u << JSON_VALUE_TYPE_NULL},
+	};
+	for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); i++) {
+		if (strcmp(name, types[i].name) == 0) {
+			*p_types |= types[i].types;
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool json_schema_is_annotation(const char* key) {
+	static const char* annotations[] = {"$schema", "$id", "$comment", "title", "description", "default", "examples"};
+	for (size_t i = 0; i < sizeof(annotations) / sizeof(annotations[0]); i++) {
+		if (strcmp(key, annotations[i]) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static json_ret_code_t json_schema_compile_node(json_schema_t* p_schema, const json_object_t* p_object, uint32_t* p_node);
+
+// Subschemas are objects or booleans
+static json_ret_code_t json_schema_compile_subschema(json_schema_t* p_schema, const json_object_member_t* p_member,
+													 uint32_t* p_node) {
+	if (p_member->type == JSON_VALUE_TYPE_BOOLEAN) {
+		*p_node = p_member->value.boolean ? JSON_SCHEMA_ANY : JSON_SCHEMA_FORBIDDEN;
+		return JSON_RETVAL_OK;
+	}
+	if (p_member->type != JSON_VALUE_TYPE_OBJECT) {
+		return JSON_RETVAL_ILLEGAL;
+	}
+	return json_schema_compile_node(p_schema, p_member->value.object, p_node);
+}
+
+static json_ret_code_t json_schema_compile_type(json_schema_node_t* p_node, const json_object_member_t* p_member) {
+	p_node->types = 0;
+	if (p_member->type == JSON_VALUE_TYPE_STRING) {
+		return json_schema_get_type(p_member->value.string, &p_node->types) ? JSON_RETVAL_OK : JSON_RETVAL_ILLEGAL;
+	}
+	if (p_member->type != JSON_VALUE_TYPE_ARRAY) {
+		return JSON_RETVAL_ILLEGAL;
+	}
+	json_value_t array = p_member->value;
+	for (uint32_t i = 0; i < array.array->length; i++) {
+		if (json_value_get_array_member_type(&array, i) != JSON_VALUE_TYPE_STRING ||
+			!json_schema_get_type(json_value_get_array_member(&array, i)->string, &p_node->types)) {
+			return JSON_RETVAL_ILLEGAL;
+		}
+	}
+	return JSON_RETVAL_OK;
+}
+
+// Enum values are copied, strings are owned by the schema
+static json_ret_code_t json_schema_compile_enum(json_schema_t* p_schema, uint32_t node, const json_object_member_t* p_member) {
+	if (p_member->type != JSON_VALUE_TYPE_ARRAY) {
+		return JSON_RETVAL_ILLEGAL;
+	}
+	json_value_t array = p_member->value;
+	p_schema->nodes[node].first_enum = p_schema->num_enums;
+	for (uint32_t i = 0; i < array.array->length; i++) {
+		JSON_SCHEMA_RESERVE(p_schema->enums, p_schema->num_enums, p_schema->max_enums);
+		json_array_member_t* p_enum = &p_schema->enums[p_schema->num_enums];
+		p_enum->type = json_value_get_array_member_type(&array, i);
+		p_enum->value = *json_value_get_array_member(&array, i);
+		if (p_enum->type == JSON_VALUE_TYPE_OBJECT || p_enum->type == JSON_VALUE_TYPE_ARRAY) {
+			return JSON_RETVAL_ILLEGAL;
+		}
+		if (p_enum->type == JSON_VALUE_TYPE_STRING && (p_enum->value.string = strdup(p_enum->value.string)) == NULL) {
+			return JSON_RETVAL_FAIL;
+		}
+		p_schema->num_enums++;
+		p_schema->nodes[node].num_enum++;
+	}
+	return JSON_RETVAL_OK;
+}
+
+static json_ret_code_t json_schema_add_property(json_schema_t* p_schema, const char* key, uint32_t node, bool declared) {
+	JSON_SCHEMA_RESERVE(p_schema->properties, p_schema->num_properties, p_schema->max_properties);
+	json_schema_property_t* p_property = &p_schema->properties[p_schema->num_properties];
+	p_property->length = strlen(key);
+	p_property->hash = json_lex_hash(key, p_property->length);
+	p_property->node = node;
+	p_property->required = JSON_SCHEMA_NOT_REQUIRED;
+	p_property->declared = declared;
+	if ((p_property->key = strdup(key)) == NULL) {
+		return JSON_RETVAL_FAIL;
+	}
+	p_schema->num_properties++;
+	return JSON_RETVAL_OK;
+}
+
+static json_schema_property_t* json_schema_find_property(const json_schema_t* p_schema, const json_schema_node_t* p_node,
+														 const char* key, size_t length) {
+	if (p_node->num_properties == 0) {
+		return NULL;
+	}
+	uint64_t hash = json_lex_hash(key, length);
+	json_schema_property_t* p_property = &p_schema->properties[p_node->first_property];
+	for (uint32_t i = 0; i < p_node->num_properties; i++, p_property++) {
+		if (p_property->hash == hash && p_property->length == length && memcmp(p_property->key, key, length) == 0) {
+			return p_property;
+		}
+	}
+	return NULL;
+}
+
+// The properties of a node are added in one go, nested nodes are compiled afterwards so that the range stays contiguous
+static json_ret_code_t json_schema_compile_properties(json_schema_t* p_schema, uint32_t node, const json_object_member_t* p_properties,
+													  const json_object_member_t* p_required) {
+	if ((p_properties != NULL && p_properties->type != JSON_VALUE_TYPE_OBJECT) ||
+		(p_required != NULL && p_required->type != JSON_VALUE_TYPE_ARRAY)) {
+		return JSON_RETVAL_ILLEGAL;
+	}
+	uint32_t first_property = p_schema->num_properties;
+	p_schema->nodes[node].first_property = first_property;
+	if (p_properties != NULL) {
+		const json_object_t* p_object = p_properties->value.object;
+		for (uint32_t i = 0; i < p_object->num_members; i++) {
+			if (json_schema_find_property(p_schema, &p_schema->nodes[node], p_object->members[i].key,
+										  strlen(p_object->members[i].key)) != NULL) {
+				return JSON_RETVAL_ILLEGAL;
+			}
+			JSON_SCHEMA_HANDLE_RET(json_schema_add_property(p_schema, p_object->members[i].key, JSON_SCHEMA_ANY, true));
+			p_schema->nodes[node].num_properties++;
+		}
+	}
+	if (p_required != NULL) {
+		json_value_t array = p_required->value;
+		for (uint32_t i = 0; i < array.array->length; i++) {
+			if (json_value_get_array_member_type(&array, i) != JSON_VALUE_TYPE_STRING) {
+				return JSON_RETVAL_ILLEGAL;
+			}
+			const char* key = json_value_get_array_member(&array, i)->string;
+			json_schema_property_t* p_property = json_schema_find_property(p_schema, &p_schema->nodes[node], key, strlen(key));
+			if (p_property == NULL) {
+				// Keys that are only required are checked against additionalProperties
+				JSON_SCHEMA_HANDLE_RET(json_schema_add_property(p_schema, key, p_schema->nodes[node].additional, false));
+				p_property = &p_schema->properties[p_schema->num_properties - 1];
+				p_schema->nodes[node].num_properties++;
+			}
+			if (p_property->required == JSON_SCHEMA_NOT_REQUIRED) {
+				p_property->required = p_schema->nodes[node].num_required++;
+			}
+		}
+	}
+	if (p_properties != NULL) {
+		const json_object_t* p_object = p_properties->value.object;
+		for (uint32_t i = 0; i < p_object->num_members; i++) {
+			uint32_t property_node;
+			JSON_SCHEMA_HANDLE_RET(json_schema_compile_subschema(p_schema, &p_object->members[i], &property_node));
+			p_schema->properties[first_property + i].node = property_node;
+		}
+	}
+	return JSON_RETVAL_OK;
+}
+
+static json_ret_code_t json_schema_compile_node(json_schema_t* p_schema, const json_object_t* p_object, uint32_t* p_node) {
+	JSON_SCHEMA_RESERVE(p_schema->nodes, p_schema->num_nodes, p_schema->max_nodes);
+	uint32_t node = p_schema->num_nodes++;
+	p_schema->nodes[node] = (json_schema_node_t) {
+		.types = JSON_SCHEMA_TYPE_ALL | JSON_SCHEMA_TYPE_INTEGER, .max_length = SIZE_MAX, .max_items = SIZE_MAX,
+		.additional = JSON_SCHEMA_ANY, .items = JSON_SCHEMA_ANY,
+	};
+	*p_node = node;
+
+	const json_object_member_t* p_properties = NULL;
+	const json_object_member_t* p_required = NULL;
+	for (uint32_t i = 0; i < p_object->num_members; i++) {
+		const json_object_member_t* p_member = &p_object->members[i];
+		json_schema_node_t* p_current = &p_schema->nodes[node];
+		bool is_number = p_member->type == JSON_VALUE_TYPE_NUMBER;
+		json_ret_code_t ret = JSON_RETVAL_OK;
+		if (strcmp(p_member->key, "type") == 0) {
+			ret = json_schema_compile_type(p_current, p_member);
+		} else if (strcmp(p_member->key, "enum") == 0) {
+			ret = json_schema_compile_enum(p_schema, node, p_member);
+		} else if (strcmp(p_member->key, "minimum") == 0 && is_number) {
+			p_current->minimum = p_member->value.number;
+			p_current->flags |= JSON_SCHEMA_FLAG_MINIMUM;
+		} else if (strcmp(p_member->key, "maximum") == 0 && is_number) {
+			p_current->maximum = p_member->value.number;
+			p_current->flags |= JSON_SCHEMA_FLAG_MAXIMUM;
+		} else if (strcmp(p_member->key, "exclusiveMinimum") == 0 && is_number) {
+			p_current->exclusive_minimum = p_member->value.number;
+			p_current->flags |= JSON_SCHEMA_FLAG_EXCLUSIVE_MINIMUM;
+		} else if (strcmp(p_member->key, "exclusiveMaximum") == 0 && is_number) {
+			p_current->exclusive_maximum = p_member->value.number;
+			p_current->flags |= JSON_SCHEMA_FLAG_EXCLUSIVE_MAXIMUM;
+		} else if (strcmp(p_member->key, "minLength") == 0) {
+			ret = json_schema_get_count(p_member, &p_current->min_length) ? JSON_RETVAL_OK : JSON_RETVAL_ILLEGAL;
+		} else if (strcmp(p_member->key, "maxLength") == 0) {
+			ret = json_schema_get_count(p_member, &p_current->max_length) ? JSON_RETVAL_OK : JSON_RETVAL_ILLEGAL;
+		} else if (strcmp(p_member->key, "minItems") == 0) {
+			ret = json_schema_get_count(p_member, &p_current->min_items) ? JSON_RETVAL_OK : JSON_RETVAL_ILLEGAL;
+		} else if (strcmp(p_member->key, "maxItems") == 0) {
+			ret = json_schema_get_count(p_member, &p_current->max_items) ? JSON_RETVAL_OK : JSON_RETVAL_ILLEGAL;
+		} else if (strcmp(p_member->key, "items") == 0) {
+			uint32_t items = JSON_SCHEMA_ANY;
+			if ((ret = json_schema_compile_subschema(p_schema, p_member, &items)) == JSON_RETVAL_OK) {
+				p_schema->nodes[node].items = items;
+			}
+		} else if (strcmp(p_member->key, "additionalProperties") == 0) {
+			uint32_t additional = JSON_SCHEMA_ANY;
+			if ((ret = json_schema_compile_subschema(p_schema, p_member, &additional)) == JSON_RETVAL_OK) {
+				p_schema->nodes[node].additional = additional;
+			}
+		} else if (strcmp(p_member->key, "properties") == 0) {
+			p_properties = p_member;
+		} else if (strcmp(p_member->key, "required") == 0) {
+			p_required = p_member;
+		} else if (!json_schema_is_annotation(p_member->key)) {
+			ret = JSON_RETVAL_ILLEGAL;
+		}
+		JSON_SCHEMA_HANDLE_RET(ret);
+	}
+
+	if (p_properties != NULL || p_required != NULL) {
+		JSON_SCHEMA_HANDLE_RET(json_schema_compile_properties(p_schema, node, p_properties, p_required));
+	}
+	return JSON_RETVAL_OK;
+}
+
+json_schema_t* json_schema_compile(const char* p_data, size_t size) {
+	if (p_data == NULL) {
+		return NULL;
+	}
+	json_object_t root;
+	if (json_parse(p_data, size, &root) != JSON_RETVAL_OK) {
+		json_object_free(&root);
+		return NULL;
+	}
+	json_schema_t* p_schema = calloc(1, sizeof(json_schema_t));
+	uint32_t node;
+	if (p_schema == NULL || json_schema_compile_node(p_schema, &root, &node) != JSON_RETVAL_OK) {
+		json_schema_free(p_schema);
+		p_schema = NULL;
+	}
+	json_object_free(&root);
+	return p_schema;
+}
+
+void json_schema_free(json_schema_t* p_schema) {
+	if (p_schema == NULL) {
+		return;
+	}
+	for (uint32_t i = 0; i < p_schema->num_properties; i++) {
+		free(p_schema->properties[i].key);
+	}
+	for (uint32_t i = 0; i < p_schema->num_enums; i++) {
+		if (p_schema->enums[i].type == JSON_VALUE_TYPE_STRING) {
+			free(p_schema->enums[i].value.string);
+		}
+	}
+	free(p_schema->nodes);
+	free(p_schema->properties);
+	free(p_schema->enums);
+	free(p_schema);
+}
+
+json_ret_code_t json_parse_schema(const char* p_data, size_t size, const json_schema_t* p_schema, json_object_t* p_object,
+								  json_schema_error_t* p_error) {
+	if (p_data == NULL || p_schema == NULL) {
+		return JSON_RETVAL_INVALID_PARAM;
+	}
+	json_schema_check_t check;
+	json_schema_check_begin(&check, p_schema);
+	json_error_t error = {0};
+	json_ret_code_t ret = json_parse_object_input(p_data, size, JSON_LEX_FLAG_NONE, NULL, NULL, &check, p_object, &error);
+	if (p_error != NULL) {
+		p_error->error = error;
+		p_error->pointer[0] = '\0';
+		if (error.code == JSON_ERROR_SCHEMA) {
+			memcpy(p_error->pointer, check.pointer, sizeof(check.pointer));
+		}
+	}
+	json_schema_check_free(&check);
+	return ret;
+}
+
+void json_schema_check_begin(json_schema_check_t* p_check, const json_schema_t* p_schema) {
+	memset(p_check, 0, sizeof(json_schema_check_t));
+	p_check->p_schema = p_schema;
+}
+
+void json_schema_check_free(json_schema_check_t* p_check) {
+	free(p_check->frames);
+	free(p_check->seen);
+	p_check->frames = NULL;
+	p_check->seen = NULL;
+}
+
+#define JSON_SCHEMA_FAIL(_keyword) { \
+	p_check->keyword = (_keyword); \
+	return JSON_RETVAL_ILLEGAL; \
+}
+
+// Code points, continuation bytes are not counted
+static size_t json_schema_string_length(const char* string) {
+	size_t length = 0;
+	for (; *string != '\0'; string++) {
+		length += ((uint8_t) *string & 0xC0) != 0x80;
+	}
+	return length;
+}
+
+static bool json_schema_enum_contains(const json_schema_t* p_schema, const json_schema_node_t* p_node, json_value_type_t type,
+									  json_value_t value) {
+	for (uint32_t i = 0; i < p_node->num_enum; i++) {
+		const json_array_member_t* p_enum = &p_schema->enums[p_node->first_enum + i];
+		if (p_enum->type != type) {
+			continue;
+		}
+		if ((type == JSON_VALUE_TYPE_NULL) ||
+			(type == JSON_VALUE_TYPE_BOOLEAN && p_enum->value.boolean == value.boolean) ||
+			(type == JSON_VALUE_TYPE_NUMBER && p_enum->value.number == value.number) ||
+			(type == JSON_VALUE_TYPE_STRING && strcmp(p_enum->value.string, value.string) == 0)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static json_ret_code_t json_schema_check_scalar(json_schema_check_t* p_check, const json_schema_node_t* p_node,
+												json_value_type_t type, json_value_t value) {
+	if (!(p_node->types & (1u << type)) &&
+		!(type == JSON_VALUE_TYPE_NUMBER && (p_node->types & JSON_SCHEMA_TYPE_INTEGER) && json_schema_is_integer(value.number))) {
+		JSON_SCHEMA_FAIL("type");
+	}
+	if (p_node->num_enum > 0 && !json_schema_enum_contains(p_check->p_schema, p_node, type, value)) {
+		JSON_SCHEMA_FAIL("enum");
+	}
+	if (type == JSON_VALUE_TYPE_NUMBER && p_node->flags != 0) {
+		if ((p_node->flags & JSON_SCHEMA_FLAG_MINIMUM) && value.number < p_node->minimum) {
+			JSON_SCHEMA_FAIL("minimum");
+		}
+		if ((p_node->flags & JSON_SCHEMA_FLAG_MAXIMUM) && value.number > p_node->maximum) {
+			JSON_SCHEMA_FAIL("maximum");
+		}
+		if ((p_node->flags & JSON_SCHEMA_FLAG_EXCLUSIVE_MINIMUM) && value.number <= p_node->exclusive_minimum) {
+			JSON_SCHEMA_FAIL("exclusiveMinimum");
+		}
+		if ((p_node->flags & JSON_SCHEMA_FLAG_EXCLUSIVE_MAXIMUM) && value.number >= p_node->exclusive_maximum) {
+			JSON_SCHEMA_FAIL("exclusiveMaximum");
+		}
+	}
+	if (type == JSON_VALUE_TYPE_STRING && (p_node->min_length > 0 || p_node->max_length != SIZE_MAX)) {
+		size_t length = json_schema_string_length(value.string);
+		if (length < p_node->min_length) {
+			JSON_SCHEMA_FAIL("minLength");
+		}
+		if (length > p_node->max_length) {
+			JSON_SCHEMA_FAIL("maxLength");
+		}
+	}
+	return JSON_RETVAL_OK;
+}
+
+json_ret_code_t json_schema_check_value(json_schema_check_t* p_check, json_value_type_t type, json_value_t value) {
+	const json_schema_t* p_schema = p_check->p_schema;
+	// The root is checked against the first node, array entries against items and members against the node of their key
+	uint32_t node = 0;
+	if (p_check->num_frames > 0) {
+		json_schema_frame_t* p_frame = &p_check->frames[p_check->num_frames - 1];
+		node = p_check->value_node;
+		if (p_frame->is_array) {
+			p_frame->count++;
+			if (p_frame->node == JSON_SCHEMA_ANY) {
+				node = JSON_SCHEMA_ANY;
+			} else {
+				if (p_frame->count > p_schema->nodes[p_frame->node].max_items) {
+					JSON_SCHEMA_FAIL("maxItems");
+				}
+				node = p_schema->nodes[p_frame->node].items;
+				if (node == JSON_SCHEMA_FORBIDDEN) {
+					JSON_SCHEMA_FAIL("items");
+				}
+			}
+		}
+	}
+	if (node != JSON_SCHEMA_ANY) {
+		JSON_SCHEMA_HANDLE_RET(json_schema_check_scalar(p_check, &p_schema->nodes[node], type, value));
+	}
+	if (type != JSON_VALUE_TYPE_ARRAY && type != JSON_VALUE_TYPE_OBJECT) {
+		return JSON_RETVAL_OK;
+	}
+
+	JSON_SCHEMA_RESERVE(p_check->frames, p_check->num_frames, p_check->max_frames);
+	json_schema_frame_t* p_frame = &p_check->frames[p_check->num_frames++];
+	*p_frame = (json_schema_frame_t) {.node = node, .is_array = type == JSON_VALUE_TYPE_ARRAY, .seen_offset = p_check->num_seen};
+	if (type == JSON_VALUE_TYPE_OBJECT && node != JSON_SCHEMA_ANY) {
+		size_t num_words = (p_schema->nodes[node].num_required + 63) / 64;
+		for (size_t i = 0; i < num_words; i++) {
+			JSON_SCHEMA_RESERVE(p_check->seen, p_check->num_seen, p_check->max_seen);
+			p_check->seen[p_check->num_seen++] = 0;
+		}
+	}
+	return JSON_RETVAL_OK;
+}
+
+json_ret_code_t json_schema_check_key(json_schema_check_t* p_check, const char* key, size_t key_length) {
+	const json_schema_frame_t* p_frame = &p_check->frames[p_check->num_frames - 1];
+	if (p_frame->node == JSON_SCHEMA_ANY) {
+		p_check->value_node = JSON_SCHEMA_ANY;
+		return JSON_RETVAL_OK;
+	}
+	const json_schema_node_t* p_node = &p_check->p_schema->nodes[p_frame->node];
+	const json_schema_property_t* p_property = json_schema_find_property(p_check->p_schema, p_node, key, key_length);
+	p_check->value_node = p_property != NULL ? p_property->node : p_node->additional;
+	if (p_check->value_node == JSON_SCHEMA_FORBIDDEN) {
+		JSON_SCHEMA_FAIL(p_property != NULL && p_property->declared ? "properties" : "additionalProperties");
+	}
+	if (p_property != NULL && p_property->required != JSON_SCHEMA_NOT_REQUIRED) {
+		p_check->seen[p_frame->seen_offset + p_property->required / 64] |= 1ull << (p_property->required % 64);
+	}
+	return JSON_RETVAL_OK;
+}
+
+json_ret_code_t json_schema_check_end(json_schema_check_t* p_check) {
+	const json_schema_frame_t* p_frame = &p_check->frames[--p_check->num_frames];
+	p_check->num_seen = p_frame->seen_offset;
+	if (p_frame->node == JSON_SCHEMA_ANY) {
+		return JSON_RETVAL_OK;
+	}
+	const json_schema_node_t* p_node = &p_check->p_schema->nodes[p_frame->node];
+	if (p_frame->is_array && p_frame->count < p_node->min_items) {
+		JSON_SCHEMA_FAIL("minItems");
+	}
+	if (!p_frame->is_array && p_node->num_required > 0) {
+		uint32_t num_seen = 0;
+		for (size_t i = 0; i < (p_node->num_required + 63) / 64; i++) {
+			num_seen += __builtin_popcountll(p_check->seen[p_frame->seen_offset + i]);
+		}
+		if (num_seen < p_node->num_required) {
+			JSON_SCHEMA_FAIL("required");
+		}
+	}
+	return JSON_RETVAL_OK;
+}
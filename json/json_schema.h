@@ -0,0 +1,35 @@
+#ifndef JSON_PARSER_JSON_SCHEMA_H
+#define JSON_PARSER_JSON_SCHEMA_H
+
+#include "json.h"
+
+// Open container being checked, seen holds one bit per required property of an object
+typedef struct {
+	uint32_t node;
+	bool is_array;
+	size_t count;
+	size_t seen_offset;
+} json_schema_frame_t;
+
+// Checker state of one document, fed by the parser with every key and value in document order
+typedef struct json_schema_check_t {
+	const json_schema_t* p_schema;
+	json_schema_frame_t* frames;
+	size_t num_frames;
+	size_t max_frames;
+	uint64_t* seen;
+	size_t num_seen;
+	size_t max_seen;
+	uint32_t value_node;	// Node of the member value behind the last key
+	const char* keyword;	// Keyword that failed
+	char pointer[JSON_SCHEMA_MAX_POINTER];
+} json_schema_check_t;
+
+// The check functions return JSON_RETVAL_ILLEGAL with keyword set when the document violates the schema
+void json_schema_check_begin(json_schema_check_t* p_check, const json_schema_t* p_schema);
+json_ret_code_t json_schema_check_key(json_schema_check_t* p_check, const char* key, size_t key_length);
+json_ret_code_t json_schema_check_value(json_schema_check_t* p_check, json_value_type_t type, json_value_t value);
+json_ret_code_t json_schema_check_end(json_schema_check_t* p_check);
+void json_schema_check_free(json_schema_check_t* p_check);
+
+#endif //JSON_PARSER_JSON_SCHEMA_H
@@ -0,0 +1,387 @@
+#include <stdlib.h>
+#include <string.h>
+#include "json.h"
+#include "json_lex.h"
+#include "json_path.h"
+
+/*
+ * Streaming extraction of many selectors in one pass over the raw input. The selectors are compiled with
+ * json_path_compile and merged into a trie of steps, shared leading steps become one edge. The scan keeps the set
+ * of trie nodes the current value is reached by. Objects and arrays are only entered when one of those nodes has an
+ * edge for keys or indices, every other value is skipped by matching brackets and strings without tokenizing it.
+ * Skipped values are therefore only checked for balanced brackets and terminated strings, the levels on the way to
+ * a selector are checked fully. Scalars at the end of a selector are decoded, containers are reported by extent.
+ */
+
+typedef struct {
+	json_path_step_t step;	// Owns the key
+	uint32_t child;
+} json_select_edge_t;
+
+typedef struct {
+	json_select_edge_t* edges;
+	uint32_t num_edges;
+	uint32_t* selectors;	// Selectors whose path ends at this node
+	uint32_t num_selectors;
+	bool has_keys;
+	bool has_indices;
+} json_select_node_t;
+
+struct json_selector_t {
+	json_select_node_t* nodes;
+	uint32_t num_nodes;
+	size_t num_expressions;
+	uint32_t max_depth;
+};
+
+typedef struct {
+	json_lex_cursor_t cursor;
+	const json_selector_t* p_selector;
+	json_select_callback_fn callback;
+	void* p_context;
+	uint32_t* states;		// Node sets of every depth, num_nodes entries each
+	char* p_buffer;			// Unescaped keys and strings
+	size_t buffer_size;
+} json_select_scan_t;
+
+static uint32_t json_select_add_node(json_selector_t* p_selector) {
+	json_select_node_t* nodes = realloc(p_selector->nodes, (p_selector->num_nodes + 1) * sizeof(json_select_node_t));
+	if (nodes == NULL) {
+		return UINT32_MAX;
+	}
+	p_selector->nodes = nodes;
+	nodes[p_selector->num_nodes] = (json_select_node_t) {0};
+	return p_selector->num_nodes++;
+}
+
+// Follows the steps of the path through the trie and adds the ones that are missing, the keys are taken over
+static json_ret_code_t json_select_add_path(json_selector_t* p_selector, json_path_t* p_path, uint32_t selector) {
+	uint32_t node = 0;
+	for (uint32_t i = 0; i < p_path->num_steps; i++) {
+		json_path_step_t* p_step = &p_path->steps[i];
+		json_select_node_t* p_node = &p_selector->nodes[node];
+		uint32_t edge = 0;
+		while (edge < p_node->num_edges && !json_path_step_equal(&p_node->edges[edge].step, p_step)) {
+			edge++;
+		}
+		if (edge < p_node->num_edges) {
+			node = p_node->edges[edge].child;
+			continue;
+		}
+
+		uint32_t child = json_select_add_node(p_selector);
+		p_node = &p_selector->nodes[node];
+		json_select_edge_t* edges = realloc(p_node->edges, (p_node->num_edges + 1) * sizeof(json_select_edge_t));
+		if (child == UINT32_MAX || edges == NULL) {
+			p_node->edges = edges != NULL ? edges : p_node->edges;
+			return JSON_RETVAL_FAIL;
+		}
+		p_node->edges = edges;
+		p_node->edges[p_node->num_edges++] = (json_select_edge_t) {.step = *p_step, .child = child};
+		p_node->has_keys = p_node->has_keys || p_step->key != NULL;
+		p_node->has_indices = p_node->has_indices || p_step->index != JSON_PATH_NO_INDEX;
+		p_step->key = NULL;
+		node = child;
+	}
+
+	json_select_node_t* p_node = &p_selector->nodes[node];
+	uint32_t* selectors = realloc(p_node->selectors, (p_node->num_selectors + 1) * sizeof(uint32_t));
+	if (selectors == NULL) {
+		return JSON_RETVAL_FAIL;
+	}
+	p_node->selectors = selectors;
+	p_node->selectors[p_node->num_selectors++] = selector;
+	p_selector->max_depth = MAX(p_selector->max_depth, p_path->num_steps);
+	return JSON_RETVAL_OK;
+}
+
+json_selector_t* json_selector_compile(const char* const* expressions, size_t num_expressions) {
+	if (expressions == NULL || num_expressions == 0 || num_expressions >= UINT32_MAX) {
+		return NULL;
+	}
+	json_selector_t* p_selector = calloc(1, sizeof(json_selector_t));
+	if (p_selector == NULL || json_select_add_node(p_selector) == UINT32_MAX) {
+		json_selector_free(p_selector);
+		return NULL;
+	}
+	p_selector->num_expressions = num_expressions;
+	for (size_t i = 0; i < num_expressions; i++) {
+		json_path_t* p_path = json_path_compile(expressions[i]);
+		json_ret_code_t ret = p_path != NULL ? json_select_add_path(p_selector, p_path, (uint32_t) i) : JSON_RETVAL_INVALID_PARAM;
+		json_path_free(p_path);
+		if (ret != JSON_RETVAL_OK) {
+			json_selector_free(p_selector);
+			return NULL;
+		}
+	}
+	return p_selector;
+}
+
+void json_selector_free(json_selector_t* p_selector) {
+	if (p_selector == NULL) {
+		return;
+	}
+	for (uint32_t i = 0; i < p_selector->num_nodes; i++) {
+		for (uint32_t j = 0; j < p_selector->nodes[i].num_edges; j++) {
+			free(p_selector->nodes[i].edges[j].step.key);
+		}
+		free(p_selector->nodes[i].edges);
+		free(p_selector->nodes[i].selectors);
+	}
+	free(p_selector->nodes);
+	free(p_selector);
+}
+
+#define JSON_SELECT_HANDLE_RET(ret) { \
+	json_ret_code_t _ret = (ret); \
+	if (_ret != JSON_RETVAL_OK) { \
+		return _ret; \
+	} \
+}
+
+static json_ret_code_t json_select_reserve_buffer(json_select_scan_t* p_scan, size_t size) {
+	if (size <= p_scan->buffer_size) {
+		return JSON_RETVAL_OK;
+	}
+	size_t buffer_size = MAX(p_scan->buffer_size * 2, MAX(size, (size_t) 256));
+	char* p_buffer = realloc(p_scan->p_buffer, buffer_size);
+	if (p_buffer == NULL) {
+		return json_lex_cursor_error(&p_scan->cursor, JSON_ERROR_OUT_OF_MEMORY, p_scan->cursor.pos, NULL);
+	}
+	p_scan->p_buffer = p_buffer;
+	p_scan->buffer_size = buffer_size;
+	return JSON_RETVAL_OK;
+}
+
+// String at pos, unescaped into the buffer when it contains escapes
+static json_ret_code_t json_select_string(json_select_scan_t* p_scan, const char** p_string, size_t* p_length, bool terminate) {
+	size_t len;
+	json_error_code_t err = JSON_ERROR_NONE;
+	json_ret_code_t ret = json_lex_scan_string(&p_scan->cursor.p_data[p_scan->cursor.pos], p_scan->cursor.size - p_scan->cursor.pos, &len, &err);
+	if (ret != JSON_RETVAL_OK) {
+		return json_lex_cursor_scan_error(&p_scan->cursor, ret, err, len, "string");
+	}
+	const char* p_raw = &p_scan->cursor.p_data[p_scan->cursor.pos + 1];
+	*p_string = p_raw;
+	*p_length = len - 2;
+	if (terminate || memchr(p_raw, '\\', len - 2) != NULL) {
+		if (json_select_reserve_buffer(p_scan, len - 1) != JSON_RETVAL_OK) {
+			return JSON_RETVAL_FAIL;
+		}
+		json_lex_unescape(p_scan->p_buffer, p_raw, len - 2, p_length);
+		*p_string = p_scan->p_buffer;
+	}
+	p_scan->cursor.pos += len;
+	return JSON_RETVAL_OK;
+}
+
+// Decodes the scalar at pos into the match
+static json_ret_code_t json_select_scalar(json_select_scan_t* p_scan, json_select_match_t* p_match) {
+	const char* p_input = &p_scan->cursor.p_data[p_scan->cursor.pos];
+	size_t input_len = p_scan->cursor.size - p_scan->cursor.pos;
+	size_t len = 0;
+	json_error_code_t err = JSON_ERROR_UNEXPECTED_TOKEN;
+	json_ret_code_t ret;
+	switch (p_input[0]) {
+		case '"': {
+			const char* p_string;
+			if (json_select_string(p_scan, &p_string, &p_match->string_length, true) != JSON_RETVAL_OK) {
+				return JSON_RETVAL_FAIL;
+			}
+			p_match->type = JSON_VALUE_TYPE_STRING;
+			p_match->value.string = (char*) p_string;
+			return JSON_RETVAL_OK;
+		}
+		case 't':
+		case 'f':
+			ret = json_lex_scan_literal(p_input, input_len, p_input[0] == 't' ? "true" : "false", p_input[0] == 't' ? 4 : 5, &len);
+			p_match->type = JSON_VALUE_TYPE_BOOLEAN;
+			p_match->value.boolean = p_input[0] == 't';
+			break;
+		case 'n':
+			ret = json_lex_scan_literal(p_input, input_len, "null", 4, &len);
+			p_match->type = JSON_VALUE_TYPE_NULL;
+			break;
+		default:
+			ret = json_lex_scan_number(p_input, input_len, &len, &err);
+			if (ret == JSON_RETVAL_OK && json_parse_number(&p_match->value.number, p_input, len) != JSON_RETVAL_OK) {
+				return json_lex_cursor_error(&p_scan->cursor, JSON_ERROR_NAN, p_scan->cursor.pos, NULL);
+			}
+			p_match->type = JSON_VALUE_TYPE_NUMBER;
+			break;
+	}
+	if (ret != JSON_RETVAL_OK) {
+		return json_lex_cursor_scan_error(&p_scan->cursor, ret, err, len, "value");
+	}
+	p_scan->cursor.pos += len;
+	return JSON_RETVAL_OK;
+}
+
+// Skips the value at pos without tokenizing it
+static json_ret_code_t json_select_skip(json_select_scan_t* p_scan) {
+	size_t len = 0;
+	char c = p_scan->cursor.p_data[p_scan->cursor.pos];
+	json_ret_code_t ret = JSON_RETVAL_ILLEGAL;
+	if (c != ',' && c != ':' && c != '}' && c != ']') {
+		ret = json_lex_skip_value(&p_scan->cursor.p_data[p_scan->cursor.pos], p_scan->cursor.size - p_scan->cursor.pos, &len);
+	}
+	if (ret != JSON_RETVAL_OK || len == 0) {
+		return json_lex_cursor_scan_error(&p_scan->cursor, ret, JSON_ERROR_UNEXPECTED_TOKEN, 0, "value");
+	}
+	p_scan->cursor.pos += len;
+	return JSON_RETVAL_OK;
+}
+
+static json_ret_code_t json_select_value(json_select_scan_t* p_scan, const uint32_t* states, uint32_t num_states, uint32_t depth);
+
+// Members of the object at pos, members whose key continues a selector are scanned, the others skipped
+static json_ret_code_t json_select_object(json_select_scan_t* p_scan, const uint32_t* states, uint32_t num_states, uint32_t depth) {
+	const json_selector_t* p_selector = p_scan->p_selector;
+	uint32_t* next_states = &p_scan->states[(size_t) (depth + 1) * p_selector->num_nodes];
+	p_scan->cursor.pos++;
+	JSON_SELECT_HANDLE_RET(json_lex_cursor_next_char(&p_scan->cursor, "object key or object end"));
+	if (p_scan->cursor.p_data[p_scan->cursor.pos] == '}') {
+		p_scan->cursor.pos++;
+		return JSON_RETVAL_OK;
+	}
+	while (true) {
+		JSON_SELECT_HANDLE_RET(json_lex_cursor_next_char(&p_scan->cursor, "object key"));
+		if (p_scan->cursor.p_data[p_scan->cursor.pos] != '"') {
+			return json_lex_cursor_error(&p_scan->cursor, JSON_ERROR_UNEXPECTED_TOKEN, p_scan->cursor.pos, "object key");
+		}
+		const char* key;
+		size_t key_len;
+		JSON_SELECT_HANDLE_RET(json_select_string(p_scan, &key, &key_len, false));
+		uint32_t num_next_states = 0;
+		for (uint32_t i = 0; i < num_states; i++) {
+			const json_select_node_t* p_node = &p_selector->nodes[states[i]];
+			for (uint32_t j = 0; j < p_node->num_edges; j++) {
+				const json_path_step_t* p_step = &p_node->edges[j].step;
+				if (p_step->key != NULL && p_step->length == key_len && memcmp(p_step->key, key, key_len) == 0) {
+					next_states[num_next_states++] = p_node->edges[j].child;
+				}
+			}
+		}
+
+		JSON_SELECT_HANDLE_RET(json_lex_cursor_next_char(&p_scan->cursor, "name value delimiter"));
+		if (p_scan->cursor.p_data[p_scan->cursor.pos] != ':') {
+			return json_lex_cursor_error(&p_scan->cursor, JSON_ERROR_UNEXPECTED_TOKEN, p_scan->cursor.pos, "name value delimiter");
+		}
+		p_scan->cursor.pos++;
+		JSON_SELECT_HANDLE_RET(json_lex_cursor_next_char(&p_scan->cursor, "value"));
+		JSON_SELECT_HANDLE_RET(num_next_states > 0 ? json_select_value(p_scan, next_states, num_next_states, depth + 1) :
+						json_select_skip(p_scan));
+
+		JSON_SELECT_HANDLE_RET(json_lex_cursor_next_char(&p_scan->cursor, "member delimiter or object end"));
+		char c = p_scan->cursor.p_data[p_scan->cursor.pos++];
+		if (c == '}') {
+			return JSON_RETVAL_OK;
+		}
+		if (c != ',') {
+			return json_lex_cursor_error(&p_scan->cursor, JSON_ERROR_UNEXPECTED_TOKEN, p_scan->cursor.pos - 1, "member delimiter or object end");
+		}
+	}
+}
+
+// Entries of the array at pos, entries whose index continues a selector are scanned, the others skipped
+static json_ret_code_t json_select_array(json_select_scan_t* p_scan, const uint32_t* states, uint32_t num_states, uint32_t depth) {
+	const json_selector_t* p_selector = p_scan->p_selector;
+	uint32_t* next_states = &p_scan->states[(size_t) (depth + 1) * p_selector->num_nodes];
+	p_scan->cursor.pos++;
+	JSON_SELECT_HANDLE_RET(json_lex_cursor_next_char(&p_scan->cursor, "value or array end"));
+	if (p_scan->cursor.p_data[p_scan->cursor.pos] == ']') {
+		p_scan->cursor.pos++;
+		return JSON_RETVAL_OK;
+	}
+	for (uint32_t index = 0;; index++) {
+		uint32_t num_next_states = 0;
+		for (uint32_t i = 0; i < num_states; i++) {
+			const json_select_node_t* p_node = &p_selector->nodes[states[i]];
+			for (uint32_t j = 0; j < p_node->num_edges; j++) {
+				if (p_node->edges[j].step.index == index) {
+					next_states[num_next_states++] = p_node->edges[j].child;
+				}
+			}
+		}
+		JSON_SELECT_HANDLE_RET(json_lex_cursor_next_char(&p_scan->cursor, "value"));
+		JSON_SELECT_HANDLE_RET(num_next_states > 0 ? json_select_value(p_scan, next_states, num_next_states, depth + 1) :
+						json_select_skip(p_scan));
+
+		JSON_SELECT_HANDLE_RET(json_lex_cursor_next_char(&p_scan->cursor, "value delimiter"));
+		char c = p_scan->cursor.p_data[p_scan->cursor.pos++];
+		if (c == ']') {
+			return JSON_RETVAL_OK;
+		}
+		if (c != ',') {
+			return json_lex_cursor_error(&p_scan->cursor, JSON_ERROR_UNEXPECTED_TOKEN, p_scan->cursor.pos - 1, "value delimiter");
+		}
+	}
+}
+
+// Value at pos reached through the trie nodes in states, selectors ending at one of them are reported
+static json_ret_code_t json_select_value(json_select_scan_t* p_scan, const uint32_t* states, uint32_t num_states, uint32_t depth) {
+	const json_selector_t* p_selector = p_scan->p_selector;
+	bool has_keys = false, has_indices = false, has_selectors = false;
+	for (uint32_t i = 0; i < num_states; i++) {
+		const json_select_node_t* p_node = &p_selector->nodes[states[i]];
+		has_keys = has_keys || p_node->has_keys;
+		has_indices = has_indices || p_node->has_indices;
+		has_selectors = has_selectors || p_node->num_selectors > 0;
+	}
+
+	size_t start = p_scan->cursor.pos;
+	char c = p_scan->cursor.p_data[start];
+	json_select_match_t match = {.offset = start, .type = c == '{' ? JSON_VALUE_TYPE_OBJECT : JSON_VALUE_TYPE_ARRAY};
+	if (c == '{' && has_keys) {
+		JSON_SELECT_HANDLE_RET(json_select_object(p_scan, states, num_states, depth));
+	} else if (c == '[' && has_indices) {
+		JSON_SELECT_HANDLE_RET(json_select_array(p_scan, states, num_states, depth));
+	} else if (c != '{' && c != '[' && has_selectors) {
+		JSON_SELECT_HANDLE_RET(json_select_scalar(p_scan, &match));
+	} else {
+		JSON_SELECT_HANDLE_RET(json_select_skip(p_scan));
+	}
+	if (!has_selectors) {
+		return JSON_RETVAL_OK;
+	}
+
+	match.length = p_scan->cursor.pos - start;
+	for (uint32_t i = 0; i < num_states; i++) {
+		const json_select_node_t* p_node = &p_selector->nodes[states[i]];
+		for (uint32_t j = 0; j < p_node->num_selectors; j++) {
+			match.selector = p_node->selectors[j];
+			JSON_SELECT_HANDLE_RET(p_scan->callback(&match, p_scan->p_context));
+		}
+	}
+	return JSON_RETVAL_OK;
+}
+
+json_ret_code_t json_select(const char* p_data, size_t size, const json_selector_t* p_selector, json_select_callback_fn callback,
+							void* p_context, json_error_t* p_error) {
+	if ((p_data == NULL && size > 0) || p_selector == NULL || callback == NULL) {
+		return JSON_RETVAL_INVALID_PARAM;
+	}
+	json_select_scan_t scan = {.cursor = {.p_data = p_data, .size = size}, .p_selector = p_selector, .callback = callback,
+							   .p_context = p_context};
+	scan.states = malloc((size_t) (p_selector->max_depth + 1) * p_selector->num_nodes * sizeof(uint32_t));
+	json_ret_code_t ret;
+	if (scan.states == NULL) {
+		ret = json_lex_cursor_error(&scan.cursor, JSON_ERROR_OUT_OF_MEMORY, 0, NULL);
+	} else if ((ret = json_lex_cursor_next_char(&scan.cursor, "value")) == JSON_RETVAL_OK) {
+		scan.states[0] = 0;
+		ret = json_select_value(&scan, scan.states, 1, 0);
+	}
+	// Nothing but whitespace may follow the document
+	if (ret == JSON_RETVAL_OK) {
+		scan.cursor.pos += json_lex_skip_whitespace(&p_data[scan.cursor.pos], size - scan.cursor.pos);
+		if (scan.cursor.pos < size) {
+			ret = json_lex_cursor_error(&scan.cursor, JSON_ERROR_UNEXPECTED_TOKEN, scan.cursor.pos, "end of input");
+		}
+	}
+	free(scan.states);
+	free(scan.p_buffer);
+	if (p_error != NULL) {
+		*p_error = scan.cursor.error;
+	}
+	return ret;
+}
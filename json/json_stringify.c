@@ -3,17 +3,31 @@
 //
 
 #include "json_stringify.h"
+#include "json_lex.h"
+#include "json_pool.h"
+#include "json_walk.h"
+#include <float.h>
+#include <limits.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <errno.h>
+#include <sys/uio.h>
 
 #define JSON_STRINGIFY_CHUNK_SIZE		1024
 #define JSON_STRINGIFY_INDENT_SPACES	2
+#define JSON_STRINGIFY_PARALLEL_GRAIN	2048	// Entries rendered by one task
+#define JSON_STRINGIFY_NUMBER_SIZE		(DBL_MAX_10_EXP + 16)	// %f of -DBL_MAX: sign, 309 digits, point and 6 decimals
 
-static struct {
+#ifndef IOV_MAX
+#define IOV_MAX							1024
+#endif
+
+typedef struct {
 	char *string;
-	int max_string_length;
-	int string_length;
-} m_stringify;
+	size_t max_string_length;
+	size_t string_length;
+	bool failed;
+} json_stringify_buffer_t;
 
 #define JSON_STRINGIFY_REPORT_ERROR(msg, ...) { \
     printf("\033[31mFailed to stringify object: "); \
@@ -21,65 +35,68 @@ static struct {
     printf("\033[0m\n");                        \
 }
 
-static void string_append_object(const json_object_t *p_object, bool pretty, int level);
+static inline void string_append_len(json_stringify_buffer_t *p_buffer, const char *cstr, size_t len) {
+	if (p_buffer->string_length + len >= p_buffer->max_string_length) {
+		size_t max_string_length = MAX(p_buffer->max_string_length * 2, (size_t) JSON_STRINGIFY_CHUNK_SIZE);
+		while (p_buffer->string_length + len >= max_string_length) {
+			max_string_length *= 2;
+		}
+		char *string = realloc(p_buffer->string, max_string_length);
+		if (string == NULL) {
+			p_buffer->failed = true;
+			return;
+		}
+		p_buffer->string = string;
+		p_buffer->max_string_length = max_string_length;
+	}
+	memcpy(p_buffer->string + p_buffer->string_length, cstr, len);
+	p_buffer->string_length += len;
+}
 
-static inline void string_append(const char *cstr) {
-	if (m_stringify.string_length + strlen(cstr) >= m_stringify.max_string_length) {
-		m_stringify.max_string_length += JSON_STRINGIFY_CHUNK_SIZE;
-		m_stringify.string = realloc(m_stringify.string, m_stringify.max_string_length);
+static inline void string_append(json_stringify_buffer_t *p_buffer, const char *cstr) {
+	string_append_len(p_buffer, cstr, strlen(cstr));
+}
+
+static inline void string_append_indent(json_stringify_buffer_t *p_buffer, int level) {
+	static const char spaces[] = "                                ";
+	size_t num_spaces = (size_t) level * JSON_STRINGIFY_INDENT_SPACES;
+	while (num_spaces > 0) {
+		size_t len = MIN(num_spaces, sizeof(spaces) - 1);
+		string_append_len(p_buffer, spaces, len);
+		num_spaces -= len;
 	}
-	memcpy(m_stringify.string + m_stringify.string_length, cstr, strlen(cstr));
-	m_stringify.string_length += (int) strlen(cstr);
 }
 
-static inline void string_append_times(const char *cstr, int times) {
-	for (int i = 0; i < times; i++) {
-		string_append(cstr);
+// Line break and indentation between entries, only when pretty printing
+static inline void string_append_newline(json_stringify_buffer_t *p_buffer, bool pretty, int level) {
+	if (pretty) {
+		string_append_len(p_buffer, "\n", 1);
+		string_append_indent(p_buffer, level);
 	}
 }
 
-static void string_append_member(json_value_t *value, json_value_type_t type, bool pretty, int level) {
-	char buf[64];
+static inline void string_append_key(json_stringify_buffer_t *p_buffer, const char *key, bool pretty) {
+	string_append_len(p_buffer, "\"", 1);
+	string_append(p_buffer, key);
+	string_append_len(p_buffer, pretty ? "\": " : "\":", pretty ? 3 : 2);
+}
+
+static inline void string_append_scalar(json_stringify_buffer_t *p_buffer, const json_value_t *value, json_value_type_t type) {
+	char buf[JSON_STRINGIFY_NUMBER_SIZE];
 	switch (type) {
 		case JSON_VALUE_TYPE_STRING:
-			string_append("\"");
-			string_append(value->string);
-			string_append("\"");
+			string_append_len(p_buffer, "\"", 1);
+			string_append(p_buffer, value->string);
+			string_append_len(p_buffer, "\"", 1);
 			break;
 		case JSON_VALUE_TYPE_NUMBER:
-			snprintf(buf, 64, "%f", value->number);
-			string_append(buf);
+			string_append_len(p_buffer, buf, (size_t) snprintf(buf, sizeof(buf), "%f", value->number));
 			break;
 		case JSON_VALUE_TYPE_BOOLEAN:
-			string_append(value->boolean ? "true" : "false");
+			string_append(p_buffer, value->boolean ? "true" : "false");
 			break;
 		case JSON_VALUE_TYPE_NULL:
-			string_append("null");
-			break;
-		case JSON_VALUE_TYPE_ARRAY:
-			string_append("[");
-			if (pretty) {
-				string_append("\n");
-				string_append_times(" ", (level + 1) * JSON_STRINGIFY_INDENT_SPACES);
-			}
-			for (uint32_t j = 0; j < value->array->length; j++) {
-				if (j > 0) {
-					string_append(",");
-					if (pretty) {
-						string_append("\n");
-						string_append_times(" ", (level + 1) * JSON_STRINGIFY_INDENT_SPACES);
-					}
-				}
-				string_append_member(&value->array->values[j]->value, value->array->values[j]->type, pretty, level + 1);
-			}
-			if (pretty) {
-				string_append("\n");
-				string_append_times(" ", level * JSON_STRINGIFY_INDENT_SPACES);
-			}
-			string_append("]");
-			break;
-		case JSON_VALUE_TYPE_OBJECT:
-			string_append_object(value->object, pretty, level);
+			string_append_len(p_buffer, "null", 4);
 			break;
 		case JSON_VALUE_TYPE_UNDEFINED:
 		default:
@@ -88,46 +105,427 @@ static void string_append_member(json_value_t *value, json_value_type_t type, bo
 	}
 }
 
-static void string_append_object(const json_object_t *p_object, bool pretty, int level) {
-	string_append("{");
-	if (pretty) {
-		string_append("\n");
-		string_append_times(" ", (level + 1) * JSON_STRINGIFY_INDENT_SPACES);
+/*
+ * Writes a value with everything below it. Open containers are kept in a json_walk_t instead of recursing, so deep
+ * trees need no more native stack than flat ones. The nesting level of a container follows from its depth.
+ */
+static void string_append_member(json_stringify_buffer_t *p_buffer, const json_value_t *p_value, json_value_type_t type, bool pretty, int level) {
+	json_walk_t walk;
+	json_walk_init(&walk);
+	json_value_t value = *p_value;
+	int base_level = level;
+
+	for (;;) {
+		if (type == JSON_VALUE_TYPE_OBJECT || type == JSON_VALUE_TYPE_ARRAY) {
+			string_append_len(p_buffer, type == JSON_VALUE_TYPE_OBJECT ? "{" : "[", 1);
+			string_append_newline(p_buffer, pretty, level + 1);
+			if (json_walk_push(&walk, value, type) == NULL) {
+				p_buffer->failed = true;
+				break;
+			}
+		} else {
+			string_append_scalar(p_buffer, &value, type);
+		}
+
+		// Close every finished container, the next entry of the innermost open one follows
+		json_walk_frame_t *p_frame;
+		int container_level = base_level;
+		while ((p_frame = json_walk_top(&walk)) != NULL) {
+			bool is_object = p_frame->type == JSON_VALUE_TYPE_OBJECT;
+			container_level = base_level + (int) walk.depth - 1;
+			if (p_frame->index < (is_object ? p_frame->value.object->num_members : p_frame->value.array->length)) {
+				break;
+			}
+			string_append_newline(p_buffer, pretty, container_level);
+			string_append_len(p_buffer, is_object ? "}" : "]", 1);
+			walk.depth--;
+		}
+		if (p_frame == NULL) {
+			break;
+		}
+
+		uint32_t index = p_frame->index++;
+		if (index > 0) {
+			string_append_len(p_buffer, ",", 1);
+			string_append_newline(p_buffer, pretty, container_level + 1);
+		}
+		if (p_frame->type == JSON_VALUE_TYPE_OBJECT) {
+			const json_object_member_t *p_member = &p_frame->value.object->members[index];
+			string_append_key(p_buffer, p_member->key, pretty);
+			value = p_member->value;
+			type = p_member->type;
+		} else if (p_frame->value.array->numbers != NULL) {
+			value.number = p_frame->value.array->numbers[index];
+			type = JSON_VALUE_TYPE_NUMBER;
+		} else {
+			value = p_frame->value.array->values[index].value;
+			type = p_frame->value.array->values[index].type;
+		}
+		level = container_level + 1;
 	}
-	for (uint32_t i = 0; i < p_object->num_members; i++) {
+
+	json_walk_free(&walk);
+}
+
+static void string_append_array_value(json_stringify_buffer_t *p_buffer, const json_array_t *p_array, uint32_t index, bool pretty, int level) {
+	if (index > 0) {
+		string_append_len(p_buffer, ",", 1);
+		string_append_newline(p_buffer, pretty, level + 1);
+	}
+	if (p_array->numbers != NULL) {
+		json_value_t value = {.number = p_array->numbers[index]};
+		string_append_scalar(p_buffer, &value, JSON_VALUE_TYPE_NUMBER);
+		return;
+	}
+	string_append_member(p_buffer, &p_array->values[index].value, p_array->values[index].type, pretty, level + 1);
+}
+
+static void string_append_object_member(json_stringify_buffer_t *p_buffer, const json_object_t *p_object, uint32_t index, bool pretty, int level) {
+	if (index > 0) {
+		string_append_len(p_buffer, ",", 1);
+		string_append_newline(p_buffer, pretty, level + 1);
+	}
+	string_append_key(p_buffer, p_object->members[index].key, pretty);
+	string_append_member(p_buffer, &p_object->members[index].value, p_object->members[index].type, pretty, level + 1);
+}
+
+char *json_object_stringify(const json_object_t *p_object, bool pretty) {
+	if (p_object == NULL) {
+		JSON_STRINGIFY_REPORT_ERROR("Object is NULL");
+		return NULL;
+	}
+
+	json_stringify_buffer_t buffer = {0};
+	json_value_t value = {.object = (json_object_t *) p_object};
+	string_append_member(&buffer, &value, JSON_VALUE_TYPE_OBJECT, pretty, 0);
+	string_append_len(&buffer, "", 1);
+	if (buffer.failed) {
+		free(buffer.string);
+		return NULL;
+	}
+
+	return buffer.string;
+}
+
+/*
+ * Parallel stringify. A serial pass plans the output as a list of segments without rendering any value: the
+ * brackets, separators and keys around large containers become text segments, consecutive entries of a container
+ * become range segments of about JSON_STRINGIFY_PARALLEL_GRAIN entries. An entry is weighed by its direct entries
+ * only, members and array entries that reach the grain that way are planned recursively instead of being put into a
+ * range. Deeper nesting is not weighed, a range of small containers with large grandchildren stays one segment. The
+ * range segments are then rendered by the pool into their own buffers with the same functions as the serial
+ * stringify, so the concatenation is byte-identical.
+ */
+
+typedef struct {
+	json_stringify_buffer_t buffer;
+	const json_object_t *p_object;	// Members of this object or
+	const json_array_t *p_array;	// values of this array are rendered by a task, both NULL for text
+	uint32_t first;
+	uint32_t count;
+	int level;
+	bool pretty;
+} json_stringify_segment_t;
+
+typedef struct {
+	json_stringify_segment_t *segments;
+	size_t num_segments;
+	size_t capacity;
+	bool pretty;
+	bool failed;
+} json_stringify_plan_t;
+
+static size_t json_stringify_get_weight(const json_value_t *p_value, json_value_type_t type) {
+	if (type == JSON_VALUE_TYPE_OBJECT) {
+		return p_value->object->num_members + 1;
+	}
+	if (type == JSON_VALUE_TYPE_ARRAY) {
+		return p_value->array->length + 1;
+	}
+	return 1;
+}
+
+static json_stringify_segment_t *json_stringify_plan_push(json_stringify_plan_t *p_plan) {
+	if (p_plan->num_segments == p_plan->capacity) {
+		size_t capacity = MAX(p_plan->capacity * 2, (size_t) 16);
+		json_stringify_segment_t *segments = realloc(p_plan->segments, capacity * sizeof(json_stringify_segment_t));
+		if (segments == NULL) {
+			p_plan->failed = true;
+			return NULL;
+		}
+		p_plan->segments = segments;
+		p_plan->capacity = capacity;
+	}
+	json_stringify_segment_t *p_segment = &p_plan->segments[p_plan->num_segments++];
+	*p_segment = (json_stringify_segment_t) {.pretty = p_plan->pretty};
+	return p_segment;
+}
+
+// Text is appended to the last segment as long as that one is text too
+static json_stringify_buffer_t *json_stringify_plan_text(json_stringify_plan_t *p_plan) {
+	json_stringify_segment_t *p_segment = p_plan->num_segments > 0 ? &p_plan->segments[p_plan->num_segments - 1] : NULL;
+	if (p_segment == NULL || p_segment->p_object != NULL || p_segment->p_array != NULL) {
+		p_segment = json_stringify_plan_push(p_plan);
+	}
+	return p_segment != NULL ? &p_segment->buffer : NULL;
+}
+
+static void json_stringify_plan_range(json_stringify_plan_t *p_plan, const json_object_t *p_object, const json_array_t *p_array,
+									  uint32_t first, uint32_t end, int level) {
+	if (first == end) {
+		return;
+	}
+	json_stringify_segment_t *p_segment = json_stringify_plan_push(p_plan);
+	if (p_segment != NULL) {
+		p_segment->p_object = p_object;
+		p_segment->p_array = p_array;
+		p_segment->first = first;
+		p_segment->count = end - first;
+		p_segment->level = level;
+	}
+}
+
+static void json_stringify_plan_object(json_stringify_plan_t *p_plan, const json_object_t *p_object, int level);
+
+static void json_stringify_plan_array(json_stringify_plan_t *p_plan, const json_array_t *p_array, int level) {
+	json_stringify_buffer_t *p_text = json_stringify_plan_text(p_plan);
+	if (p_text == NULL) {
+		return;
+	}
+	string_append_len(p_text, "[", 1);
+	string_append_newline(p_text, p_plan->pretty, level + 1);
+
+	uint32_t first = 0;
+	size_t weight = 0;
+	for (uint32_t i = 0; i < p_array->length; i++) {
+		json_array_member_t *p_entry = p_array->numbers != NULL ? NULL : &p_array->values[i];
+		size_t entry_weight = p_entry != NULL ? json_stringify_get_weight(&p_entry->value, p_entry->type) : 1;
+		if (entry_weight < JSON_STRINGIFY_PARALLEL_GRAIN) {
+			weight += entry_weight;
+			if (weight >= JSON_STRINGIFY_PARALLEL_GRAIN) {
+				json_stringify_plan_range(p_plan, NULL, p_array, first, i + 1, level);
+				first = i + 1;
+				weight = 0;
+			}
+			continue;
+		}
+
+		// A large entry is split on its own like a large member, only its separator is text
+		json_stringify_plan_range(p_plan, NULL, p_array, first, i, level);
 		if (i > 0) {
-			string_append(",");
-			if (pretty) {
-				string_append("\n");
-				string_append_times(" ", (level + 1) * JSON_STRINGIFY_INDENT_SPACES);
+			if ((p_text = json_stringify_plan_text(p_plan)) == NULL) {
+				return;
 			}
+			string_append_len(p_text, ",", 1);
+			string_append_newline(p_text, p_plan->pretty, level + 1);
 		}
-		string_append("\"");
-		string_append(p_object->members[i]->key);
-		string_append("\":");
-		if (pretty) string_append(" ");
-		string_append_member(&p_object->members[i]->value, p_object->members[i]->type, pretty, level + 1);
+		if (p_entry->type == JSON_VALUE_TYPE_OBJECT) {
+			json_stringify_plan_object(p_plan, p_entry->value.object, level + 1);
+		} else {
+			json_stringify_plan_array(p_plan, p_entry->value.array, level + 1);
+		}
+		first = i + 1;
+		weight = 0;
 	}
-	if (pretty) {
-		string_append("\n");
-		string_append_times(" ", level * JSON_STRINGIFY_INDENT_SPACES);
+	json_stringify_plan_range(p_plan, NULL, p_array, first, p_array->length, level);
+
+	if ((p_text = json_stringify_plan_text(p_plan)) != NULL) {
+		string_append_newline(p_text, p_plan->pretty, level);
+		string_append_len(p_text, "]", 1);
 	}
-	string_append("}");
 }
 
-char *json_object_stringify(const json_object_t *p_object, bool pretty) {
+static void json_stringify_plan_object(json_stringify_plan_t *p_plan, const json_object_t *p_object, int level) {
+	json_stringify_buffer_t *p_text = json_stringify_plan_text(p_plan);
+	if (p_text == NULL) {
+		return;
+	}
+	string_append_len(p_text, "{", 1);
+	string_append_newline(p_text, p_plan->pretty, level + 1);
+
+	uint32_t first = 0;
+	size_t weight = 0;
+	for (uint32_t i = 0; i < p_object->num_members; i++) {
+		json_object_member_t *p_member = &p_object->members[i];
+		size_t member_weight = json_stringify_get_weight(&p_member->value, p_member->type);
+		if (member_weight < JSON_STRINGIFY_PARALLEL_GRAIN) {
+			weight += member_weight;
+			if (weight >= JSON_STRINGIFY_PARALLEL_GRAIN) {
+				json_stringify_plan_range(p_plan, p_object, NULL, first, i + 1, level);
+				first = i + 1;
+				weight = 0;
+			}
+			continue;
+		}
+
+		// A large value is split on its own, only its separator and key are text
+		json_stringify_plan_range(p_plan, p_object, NULL, first, i, level);
+		if ((p_text = json_stringify_plan_text(p_plan)) == NULL) {
+			return;
+		}
+		if (i > 0) {
+			string_append_len(p_text, ",", 1);
+			string_append_newline(p_text, p_plan->pretty, level + 1);
+		}
+		string_append_key(p_text, p_member->key, p_plan->pretty);
+		if (p_member->type == JSON_VALUE_TYPE_OBJECT) {
+			json_stringify_plan_object(p_plan, p_member->value.object, level + 1);
+		} else {
+			json_stringify_plan_array(p_plan, p_member->value.array, level + 1);
+		}
+		first = i + 1;
+		weight = 0;
+	}
+	json_stringify_plan_range(p_plan, p_object, NULL, first, p_object->num_members, level);
+
+	if ((p_text = json_stringify_plan_text(p_plan)) != NULL) {
+		string_append_newline(p_text, p_plan->pretty, level);
+		string_append_len(p_text, "}", 1);
+	}
+}
+
+static void json_stringify_render_segment(void *p_arg, uint32_t worker_index) {
+	(void) worker_index;
+	json_stringify_segment_t *p_segment = p_arg;
+	for (uint32_t i = p_segment->first; i < p_segment->first + p_segment->count; i++) {
+		if (p_segment->p_object != NULL) {
+			string_append_object_member(&p_segment->buffer, p_segment->p_object, i, p_segment->pretty, p_segment->level);
+		} else {
+			string_append_array_value(&p_segment->buffer, p_segment->p_array, i, p_segment->pretty, p_segment->level);
+		}
+	}
+}
+
+static void json_stringify_plan_free(json_stringify_plan_t *p_plan) {
+	for (size_t i = 0; i < p_plan->num_segments; i++) {
+		free(p_plan->segments[i].buffer.string);
+	}
+	free(p_plan->segments);
+}
+
+// Plans and renders all segments, the plan holds the output in order afterwards
+static json_ret_code_t json_stringify_plan_render(json_stringify_plan_t *p_plan, const json_object_t *p_object, bool pretty,
+												  json_pool_t *p_pool) {
+	*p_plan = (json_stringify_plan_t) {.pretty = pretty};
+	json_stringify_plan_object(p_plan, p_object, 0);
+	if (p_plan->failed) {
+		return JSON_RETVAL_FAIL;
+	}
+
+	// Nothing to split, the whole object is a single segment then
+	size_t num_ranges = 0;
+	for (size_t i = 0; i < p_plan->num_segments; i++) {
+		num_ranges += p_plan->segments[i].p_object != NULL || p_plan->segments[i].p_array != NULL;
+	}
+	bool own_pool = p_pool == NULL && num_ranges > 1;
+	if (own_pool) {
+		p_pool = json_pool_new(0);
+	}
+
+	json_pool_group_t group = {0};
+	for (size_t i = 0; i < p_plan->num_segments; i++) {
+		json_stringify_segment_t *p_segment = &p_plan->segments[i];
+		if (p_segment->p_object == NULL && p_segment->p_array == NULL) {
+			continue;
+		}
+		if (num_ranges == 1 || p_pool == NULL ||
+			json_pool_submit(p_pool, &group, json_stringify_render_segment, p_segment) != JSON_RETVAL_OK) {
+			json_stringify_render_segment(p_segment, 0);
+		}
+	}
+	if (p_pool != NULL) {
+		json_pool_wait(p_pool, &group);
+	}
+	if (own_pool) {
+		json_pool_free(p_pool);
+	}
+
+	for (size_t i = 0; i < p_plan->num_segments; i++) {
+		if (p_plan->segments[i].buffer.failed) {
+			return JSON_RETVAL_FAIL;
+		}
+	}
+	return JSON_RETVAL_OK;
+}
+
+char *json_object_stringify_parallel(const json_object_t *p_object, bool pretty, json_pool_t *p_pool) {
 	if (p_object == NULL) {
 		JSON_STRINGIFY_REPORT_ERROR("Object is NULL");
 		return NULL;
 	}
 
-	m_stringify.max_string_length = JSON_STRINGIFY_CHUNK_SIZE;
-	m_stringify.string = malloc(m_stringify.max_string_length);
-	m_stringify.string_length = 0;
+	json_stringify_plan_t plan;
+	if (json_stringify_plan_render(&plan, p_object, pretty, p_pool) != JSON_RETVAL_OK) {
+		json_stringify_plan_free(&plan);
+		return NULL;
+	}
+
+	size_t length = 0;
+	for (size_t i = 0; i < plan.num_segments; i++) {
+		length += plan.segments[i].buffer.string_length;
+	}
+	char *string = malloc(length + 1);
+	if (string != NULL) {
+		length = 0;
+		for (size_t i = 0; i < plan.num_segments; i++) {
+			memcpy(&string[length], plan.segments[i].buffer.string, plan.segments[i].buffer.string_length);
+			length += plan.segments[i].buffer.string_length;
+		}
+		string[length] = '\0';
+	}
+	json_stringify_plan_free(&plan);
+	return string;
+}
+
+json_ret_code_t json_object_stringify_write(int fd, const json_object_t *p_object, bool pretty, json_pool_t *p_pool) {
+	if (p_object == NULL || fd < 0) {
+		return JSON_RETVAL_INVALID_PARAM;
+	}
 
-	const json_object_t *p_current = p_object;
-	string_append_object(p_current, pretty, 0);
-	m_stringify.string[m_stringify.string_length] = '\0';
+	json_stringify_plan_t plan;
+	if (json_stringify_plan_render(&plan, p_object, pretty, p_pool) != JSON_RETVAL_OK) {
+		json_stringify_plan_free(&plan);
+		return JSON_RETVAL_FAIL;
+	}
+
+	// The segment buffers are written as they are, at most IOV_MAX of them per call
+	json_ret_code_t ret = JSON_RETVAL_OK;
+	size_t segment_index = 0;
+	size_t segment_offset = 0;
+	while (segment_index < plan.num_segments && ret == JSON_RETVAL_OK) {
+		struct iovec iov[IOV_MAX];
+		int num_iov = 0;
+		for (size_t i = segment_index; i < plan.num_segments && num_iov < IOV_MAX; i++) {
+			size_t offset = i == segment_index ? segment_offset : 0;
+			if (plan.segments[i].buffer.string_length > offset) {
+				iov[num_iov].iov_base = plan.segments[i].buffer.string + offset;
+				iov[num_iov].iov_len = plan.segments[i].buffer.string_length - offset;
+				num_iov++;
+			}
+		}
+		if (num_iov == 0) {
+			break;
+		}
+
+		ssize_t written = writev(fd, iov, num_iov);
+		if (written < 0 && errno == EINTR) {
+			continue;
+		}
+		if (written <= 0) {
+			ret = JSON_RETVAL_FAIL;
+			break;
+		}
+
+		// Skip everything that was written, a short write continues within a segment
+		size_t remaining = (size_t) written;
+		while (segment_index < plan.num_segments && remaining >= plan.segments[segment_index].buffer.string_length - segment_offset) {
+			remaining -= plan.segments[segment_index].buffer.string_length - segment_offset;
+			segment_index++;
+			segment_offset = 0;
+		}
+		segment_offset += remaining;
+	}
 
-	return m_stringify.string;
+	json_stringify_plan_free(&plan);
+	return ret;
 }
@@ -8,5 +8,7 @@
 #include "json.h"
 
 char *json_object_stringify(const json_object_t* p_object, bool pretty);
+char *json_object_stringify_parallel(const json_object_t* p_object, bool pretty, json_pool_t* p_pool);
+json_ret_code_t json_object_stringify_write(int fd, const json_object_t* p_object, bool pretty, json_pool_t* p_pool);
 
 #endif //JSON_PARSER_JSON_STRINGIFY_H
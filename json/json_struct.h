@@ -0,0 +1,19 @@
+#ifndef JSON_PARSER_JSON_STRUCT_H
+#define JSON_PARSER_JSON_STRUCT_H
+
+#include "json.h"
+
+// Keys are written as given by json_encode_struct, so none may need escaping
+static inline bool json_struct_key_is_plain(const char* key, size_t key_length) {
+	for (size_t i = 0; i < key_length; i++) {
+		unsigned char c = (unsigned char) key[i];
+		if (c < 0x20 || c == '"' || c == '\\') {
+			return false;
+		}
+	}
+	return true;
+}
+
+json_ret_code_t json_struct_desc_compile(json_struct_desc_t* p_desc);
+
+#endif //JSON_PARSER_JSON_STRUCT_H
@@ -0,0 +1,368 @@
+#include <stdlib.h>
+#include <string.h>
+#include "json.h"
+#include "json_lex.h"
+
+/*
+ * Tape representation of a document. Every value is one 64-bit word in document order, the type character sits
+ * in the top byte and a 56-bit payload below it:
+ *   'r'      header at index 0, payload is the number of words
+ *   '{' '['  payload is the index behind the matching close word (bits 0-31) and the entry count (bits 32-55)
+ *   '}' ']'  payload is the index of the matching open word
+ *   '"'      payload is the offset of the string in the string buffer, stored as uint32 length, bytes and NUL
+ *   'd'      the following word holds the bits of the double
+ *   'n' 't' 'f'
+ * Object members are a key string word followed by the value. Containers can be skipped in O(1) through the
+ * open word, iterating a document is a linear walk over the tape. The accessors on that walk are inline in json.h.
+ */
+
+#define JSON_TAPE_MAX_NESTING_LEVEL		1000
+#define JSON_TAPE_MAX_COUNT				0xFFFFFFull
+#define JSON_TAPE_MAX_INDEX				0xFFFFFFFFull
+
+#define JSON_TAPE_WORD(type, payload)	(((uint64_t) (type) << 56) | (uint64_t) (payload))
+#define JSON_TAPE_COUNT(word)			((uint32_t) (((word) >> 32) & JSON_TAPE_MAX_COUNT))
+
+typedef enum {
+	JSON_TAPE_STATE_INIT,
+	JSON_TAPE_STATE_OBJECT_START,
+	JSON_TAPE_STATE_OBJECT_KEY,
+	JSON_TAPE_STATE_ARRAY_START,
+	JSON_TAPE_STATE_VALUE,
+	JSON_TAPE_STATE_AFTER_VALUE,
+	JSON_TAPE_STATE_MEMBER_DELIM,
+	JSON_TAPE_STATE_END,
+} json_tape_state_t;
+
+typedef struct {
+	size_t start_index;
+	uint64_t count;
+	bool is_object;
+} json_tape_scope_t;
+
+typedef struct {
+	json_tape_t* p_tape;
+	json_tape_state_t state;
+	json_tape_scope_t scopes[JSON_TAPE_MAX_NESTING_LEVEL];
+	uint32_t depth;
+} json_tape_builder_t;
+
+static json_ret_code_t json_tape_reserve(void** p_buffer, size_t* p_capacity, size_t length, size_t additional, size_t element_size) {
+	if (length + additional <= *p_capacity) {
+		return JSON_RETVAL_OK;
+	}
+	size_t capacity = MAX(*p_capacity * 2, (size_t) 64);
+	while (capacity < length + additional) {
+		capacity *= 2;
+	}
+	void* p_new = realloc(*p_buffer, capacity * element_size);
+	if (p_new == NULL) {
+		return JSON_RETVAL_FAIL;
+	}
+	*p_buffer = p_new;
+	*p_capacity = capacity;
+	return JSON_RETVAL_OK;
+}
+
+static inline json_ret_code_t json_tape_push(json_tape_t* p_tape, uint64_t word) {
+	if (p_tape->num_words == p_tape->max_num_words &&
+		json_tape_reserve((void**) &p_tape->words, &p_tape->max_num_words, p_tape->num_words, 1, sizeof(uint64_t)) != JSON_RETVAL_OK) {
+		return JSON_RETVAL_FAIL;
+	}
+	p_tape->words[p_tape->num_words++] = word;
+	return JSON_RETVAL_OK;
+}
+
+static json_ret_code_t json_tape_push_string(json_tape_t* p_tape, const json_token_t* p_token) {
+	size_t raw_len = p_token->value.string.length;
+	if (raw_len > UINT32_MAX || json_tape_reserve((void**) &p_tape->strings, &p_tape->max_strings_length, p_tape->strings_length,
+												  sizeof(uint32_t) + raw_len + 1, 1) != JSON_RETVAL_OK) {
+		return JSON_RETVAL_FAIL;
+	}
+	size_t offset = p_tape->strings_length;
+	size_t length = 0;
+	json_lex_unescape(&p_tape->strings[offset + sizeof(uint32_t)], p_token->value.string.data, raw_len, &length);
+	uint32_t length32 = (uint32_t) length;
+	memcpy(&p_tape->strings[offset], &length32, sizeof(uint32_t));
+	p_tape->strings_length += sizeof(uint32_t) + length + 1;
+	return json_tape_push(p_tape, JSON_TAPE_WORD('"', offset));
+}
+
+// The builder helpers return the error code of the token they were given
+#define JSON_TAPE_ERROR_IF_FAIL(ret) ((ret) == JSON_RETVAL_OK ? JSON_ERROR_NONE : JSON_ERROR_OUT_OF_MEMORY)
+
+static json_error_code_t json_tape_open(json_tape_builder_t* p_builder, bool is_object) {
+	if (p_builder->depth + 1 >= JSON_TAPE_MAX_NESTING_LEVEL) {
+		return JSON_ERROR_MAX_NESTING_LEVEL;
+	}
+	p_builder->scopes[p_builder->depth++] = (json_tape_scope_t) {.start_index = p_builder->p_tape->num_words, .is_object = is_object};
+	p_builder->state = is_object ? JSON_TAPE_STATE_OBJECT_START : JSON_TAPE_STATE_ARRAY_START;
+	return JSON_TAPE_ERROR_IF_FAIL(json_tape_push(p_builder->p_tape, JSON_TAPE_WORD(is_object ? '{' : '[', 0)));
+}
+
+static json_error_code_t json_tape_close(json_tape_builder_t* p_builder) {
+	json_tape_t* p_tape = p_builder->p_tape;
+	json_tape_scope_t* p_scope = &p_builder->scopes[--p_builder->depth];
+	if (p_tape->num_words + 1 > JSON_TAPE_MAX_INDEX ||
+		json_tape_push(p_tape, JSON_TAPE_WORD(p_scope->is_object ? '}' : ']', p_scope->start_index)) != JSON_RETVAL_OK) {
+		return JSON_ERROR_OUT_OF_MEMORY;
+	}
+	uint64_t count = MIN(p_scope->count, JSON_TAPE_MAX_COUNT);
+	p_tape->words[p_scope->start_index] = JSON_TAPE_WORD(p_scope->is_object ? '{' : '[', (count << 32) | p_tape->num_words);
+	p_builder->state = p_builder->depth == 0 ? JSON_TAPE_STATE_END : JSON_TAPE_STATE_AFTER_VALUE;
+	if (p_builder->depth > 0) {
+		p_builder->scopes[p_builder->depth - 1].count++;
+	}
+	return JSON_ERROR_NONE;
+}
+
+static json_error_code_t json_tape_value(json_tape_builder_t* p_builder, const json_token_t* p_token) {
+	json_tape_t* p_tape = p_builder->p_tape;
+	json_ret_code_t ret;
+	switch (p_token->type) {
+		case JSON_TOKEN_TYPE_START_OBJECT:
+			return json_tape_open(p_builder, true);
+		case JSON_TOKEN_TYPE_VAL_START_ARRAY:
+			return json_tape_open(p_builder, false);
+		case JSON_TOKEN_TYPE_VAL_NULL:
+			ret = json_tape_push(p_tape, JSON_TAPE_WORD('n', 0));
+			break;
+		case JSON_TOKEN_TYPE_VAL_BOOLEAN:
+			ret = json_tape_push(p_tape, JSON_TAPE_WORD(p_token->value.boolean ? 't' : 'f', 0));
+			break;
+		case JSON_TOKEN_TYPE_VAL_STRING:
+			ret = json_tape_push_string(p_tape, p_token);
+			break;
+		case JSON_TOKEN_TYPE_VAL_NUMBER: {
+			uint64_t bits;
+			memcpy(&bits, &p_token->value.number, sizeof(bits));
+			ret = json_tape_push(p_tape, JSON_TAPE_WORD('d', 0));
+			if (ret == JSON_RETVAL_OK) {
+				ret = json_tape_push(p_tape, bits);
+			}
+			break;
+		}
+		default:
+			return JSON_ERROR_UNEXPECTED_TOKEN;
+	}
+	p_builder->scopes[p_builder->depth - 1].count++;
+	p_builder->state = JSON_TAPE_STATE_AFTER_VALUE;
+	return JSON_TAPE_ERROR_IF_FAIL(ret);
+}
+
+#define JSON_TAPE_REPORT_ERROR(_code, _expected) { \
+	p_error->code = (_code); \
+	p_error->offset = p_token->offset; \
+	p_error->expected = (_expected); \
+	return JSON_RETVAL_FAIL; \
+}
+
+#define JSON_TAPE_HANDLE_ERROR(err, expected) { \
+	json_error_code_t _err = (err); \
+	if (_err != JSON_ERROR_NONE) { \
+		JSON_TAPE_REPORT_ERROR(_err, _err == JSON_ERROR_UNEXPECTED_TOKEN ? (expected) : NULL); \
+	} \
+	return JSON_RETVAL_OK; \
+}
+
+static json_ret_code_t json_tape_token(json_tape_builder_t* p_builder, const json_token_t* p_token, json_error_t* p_error) {
+	switch (p_builder->state) {
+		case JSON_TAPE_STATE_INIT:
+			if (p_token->type != JSON_TOKEN_TYPE_START_OBJECT) {
+				JSON_TAPE_REPORT_ERROR(JSON_ERROR_UNEXPECTED_TOKEN, "object start");
+			}
+			JSON_TAPE_HANDLE_ERROR(json_tape_open(p_builder, true), NULL);
+		case JSON_TAPE_STATE_OBJECT_START:
+		case JSON_TAPE_STATE_MEMBER_DELIM:
+			if (p_token->type == JSON_TOKEN_TYPE_END_OBJECT && p_builder->state == JSON_TAPE_STATE_OBJECT_START) {
+				JSON_TAPE_HANDLE_ERROR(json_tape_close(p_builder), NULL);
+			}
+			if (p_token->type != JSON_TOKEN_TYPE_VAL_STRING) {
+				JSON_TAPE_REPORT_ERROR(JSON_ERROR_UNEXPECTED_TOKEN, p_builder->state == JSON_TAPE_STATE_OBJECT_START ?
+																	"object key or object end" : "object key");
+			}
+			p_builder->state = JSON_TAPE_STATE_OBJECT_KEY;
+			JSON_TAPE_HANDLE_ERROR(JSON_TAPE_ERROR_IF_FAIL(json_tape_push_string(p_builder->p_tape, p_token)), NULL);
+		case JSON_TAPE_STATE_OBJECT_KEY:
+			if (p_token->type != JSON_TOKEN_TYPE_NAME_VAL_DELIM) {
+				JSON_TAPE_REPORT_ERROR(JSON_ERROR_UNEXPECTED_TOKEN, "name value delimiter");
+			}
+			p_builder->state = JSON_TAPE_STATE_VALUE;
+			return JSON_RETVAL_OK;
+		case JSON_TAPE_STATE_ARRAY_START:
+			if (p_token->type == JSON_TOKEN_TYPE_VAL_END_ARRAY) {
+				JSON_TAPE_HANDLE_ERROR(json_tape_close(p_builder), NULL);
+			}
+			// fallthrough
+		case JSON_TAPE_STATE_VALUE:
+			JSON_TAPE_HANDLE_ERROR(json_tape_value(p_builder, p_token), "value");
+		case JSON_TAPE_STATE_AFTER_VALUE: {
+			bool is_object = p_builder->scopes[p_builder->depth - 1].is_object;
+			if (p_token->type == JSON_TOKEN_TYPE_MEMBER_DELIM) {
+				p_builder->state = is_object ? JSON_TAPE_STATE_MEMBER_DELIM : JSON_TAPE_STATE_VALUE;
+				return JSON_RETVAL_OK;
+			}
+			if (p_token->type != (is_object ? JSON_TOKEN_TYPE_END_OBJECT : JSON_TOKEN_TYPE_VAL_END_ARRAY)) {
+				JSON_TAPE_REPORT_ERROR(JSON_ERROR_UNEXPECTED_TOKEN, is_object ? "member delimiter or object end" : "value delimiter");
+			}
+			JSON_TAPE_HANDLE_ERROR(json_tape_close(p_builder), NULL);
+		}
+		case JSON_TAPE_STATE_END:
+		default:
+			JSON_TAPE_REPORT_ERROR(JSON_ERROR_UNEXPECTED_TOKEN, "end of input");
+	}
+}
+
+json_ret_code_t json_parse_tape(const char* p_data, size_t size, json_tape_t* p_tape, json_error_t* p_error) {
+	if ((p_data == NULL && size > 0) || p_tape == NULL) {
+		return JSON_RETVAL_INVALID_PARAM;
+	}
+	memset(p_tape, 0, sizeof(json_tape_t));
+	json_error_t error = {0};
+	json_tape_builder_t* p_builder = malloc(sizeof(json_tape_builder_t));
+	// About one word per four bytes and half of the input in strings is typical, the buffers grow otherwise
+	if (p_builder == NULL ||
+		json_tape_reserve((void**) &p_tape->words, &p_tape->max_num_words, 0, size / 4 + 2, sizeof(uint64_t)) != JSON_RETVAL_OK ||
+		json_tape_reserve((void**) &p_tape->strings, &p_tape->max_strings_length, 0, size / 2 + 1, 1) != JSON_RETVAL_OK) {
+		free(p_builder);
+		json_tape_free(p_tape);
+		if (p_error != NULL) {
+			*p_error = (json_error_t) {.code = JSON_ERROR_OUT_OF_MEMORY};
+		}
+		return JSON_RETVAL_FAIL;
+	}
+	p_builder->p_tape = p_tape;
+	p_builder->state = JSON_TAPE_STATE_INIT;
+	p_builder->depth = 0;
+	json_tape_push(p_tape, JSON_TAPE_WORD('r', 0));
+
+	json_lex_t lex = {.flags = JSON_LEX_FLAG_RAW_STRINGS};
+	json_ret_code_t ret = JSON_RETVAL_OK;
+	size_t consumed_total = 0;
+	while (true) {
+		json_token_t token = {0};
+		size_t consumed = 0;
+		ret = json_lex_next_token(&lex, &p_data[consumed_total], size - consumed_total, &consumed, &token);
+		if (ret == JSON_RETVAL_FINISHED) {
+			ret = JSON_RETVAL_OK;
+			break;
+		}
+		if (ret != JSON_RETVAL_OK) {
+			error = lex.error;
+			error.offset += consumed_total;
+			ret = ret == JSON_RETVAL_INCOMPLETE ? JSON_RETVAL_ILLEGAL : ret;
+			break;
+		}
+		token.offset += consumed_total;
+		consumed_total += consumed;
+		if ((ret = json_tape_token(p_builder, &token, &error)) != JSON_RETVAL_OK) {
+			break;
+		}
+	}
+
+	if (ret == JSON_RETVAL_OK && p_builder->state != JSON_TAPE_STATE_END) {
+		error = (json_error_t) {.code = JSON_ERROR_UNEXPECTED_EOF, .offset = size,
+								.expected = p_builder->state == JSON_TAPE_STATE_INIT ? "object start" : "object end"};
+		ret = JSON_RETVAL_FAIL;
+	}
+	free(p_builder);
+	if (p_error != NULL) {
+		*p_error = error;
+	}
+	if (ret != JSON_RETVAL_OK) {
+		json_tape_free(p_tape);
+		return ret;
+	}
+
+	p_tape->words[0] = JSON_TAPE_WORD('r', p_tape->num_words);
+
+	// Give back the unused part of the initial estimate
+	uint64_t* words = realloc(p_tape->words, p_tape->num_words * sizeof(uint64_t));
+	if (words != NULL) {
+		p_tape->words = words;
+		p_tape->max_num_words = p_tape->num_words;
+	}
+	char* strings = realloc(p_tape->strings, MAX(p_tape->strings_length, (size_t) 1));
+	if (strings != NULL) {
+		p_tape->strings = strings;
+		p_tape->max_strings_length = MAX(p_tape->strings_length, (size_t) 1);
+	}
+	return JSON_RETVAL_OK;
+}
+
+void json_tape_free(json_tape_t* p_tape) {
+	if (p_tape == NULL) {
+		return;
+	}
+	free(p_tape->words);
+	free(p_tape->strings);
+	memset(p_tape, 0, sizeof(json_tape_t));
+}
+
+json_tape_value_t json_tape_get_root(const json_tape_t* p_tape) {
+	return (json_tape_value_t) {.p_tape = p_tape, .index = p_tape != NULL && p_tape->num_words > 1 ? 1 : 0};
+}
+
+json_tape_value_t json_tape_object_get_value(json_tape_value_t object, const char* key) {
+	json_tape_value_t value = {.p_tape = object.p_tape};
+	if (json_tape_get_type_char(object) != '{' || key == NULL) {
+		return value;
+	}
+	size_t key_len = strlen(key);
+	const json_tape_t* p_tape = object.p_tape;
+	size_t index = object.index + 1;
+	while (JSON_TAPE_TYPE(p_tape->words[index]) != '}') {
+		size_t length;
+		const char* p_key = json_tape_get_string(p_tape, index, &length);
+		if (length == key_len && memcmp(p_key, key, key_len) == 0) {
+			value.index = index + 1;
+			return value;
+		}
+		index = json_tape_skip(p_tape, index + 1);
+	}
+	return value;
+}
+
+json_tape_value_t json_tape_value_get_array_member(json_tape_value_t array, uint32_t index) {
+	json_tape_value_t value = {.p_tape = array.p_tape};
+	if (json_tape_get_type_char(array) != '[') {
+		return value;
+	}
+	const json_tape_t* p_tape = array.p_tape;
+	size_t tape_index = array.index + 1;
+	for (uint32_t i = 0; JSON_TAPE_TYPE(p_tape->words[tape_index]) != ']'; i++) {
+		if (i == index) {
+			value.index = tape_index;
+			return value;
+		}
+		tape_index = json_tape_skip(p_tape, tape_index);
+	}
+	return value;
+}
+
+uint32_t json_tape_value_get_length(json_tape_value_t value) {
+	char type = json_tape_get_type_char(value);
+	if (type != '{' && type != '[') {
+		return 0;
+	}
+	uint32_t count = JSON_TAPE_COUNT(value.p_tape->words[value.index]);
+	if (count < JSON_TAPE_MAX_COUNT) {
+		return count;
+	}
+
+	// The count saturates, larger containers are counted
+	json_tape_iter_t iter = json_tape_iter_begin(value);
+	count = 0;
+	while (json_tape_iter_next(&iter, NULL, NULL)) {
+		count++;
+	}
+	return count;
+}
+
+json_tape_iter_t json_tape_iter_begin(json_tape_value_t container) {
+	char type = json_tape_get_type_char(container);
+	if (type != '{' && type != '[') {
+		return (json_tape_iter_t) {0};
+	}
+	return (json_tape_iter_t) {.p_tape = container.p_tape, .index = container.index + 1, .is_object = type == '{'};
+}
@@ -0,0 +1,157 @@
+#include "json_validate.h"
+#include "json_lex.h"
+
+#define MAX_NESTING_LEVEL		1000
+
+/*
+ * Validation runs the lexer scanners and the grammar state machine directly on the input. No tokens, strings or
+ * objects are created, the only state is a bit stack recording whether each open container is an array.
+ */
+
+typedef enum {
+	JSON_VALIDATE_STATE_VALUE,
+	JSON_VALIDATE_STATE_OBJECT_START,
+	JSON_VALIDATE_STATE_OBJECT_KEY,
+	JSON_VALIDATE_STATE_MEMBER_DELIM,
+	JSON_VALIDATE_STATE_ARRAY_START,
+	JSON_VALIDATE_STATE_VALUE_END,
+} json_validate_state_t;
+
+#define JSON_VALIDATE_REPORT_ERROR(ret, _code, _offset, _expected) { \
+	if (p_error != NULL) { \
+		p_error->code = (_code); \
+		p_error->offset = (_offset); \
+		p_error->expected = (_expected); \
+	} \
+	return (ret); \
+}
+
+#define JSON_VALIDATE_IS_ARRAY(level)		((is_array[(level) / 8] >> ((level) % 8)) & 1)
+#define JSON_VALIDATE_SET_ARRAY(level, b)	is_array[(level) / 8] = (is_array[(level) / 8] & ~(1 << ((level) % 8))) | ((b) << ((level) % 8))
+
+json_ret_code_t json_validate_document(const char* p_data, size_t size, json_error_t* p_error) {
+	if (p_data == NULL) {
+		return JSON_RETVAL_INVALID_PARAM;
+	}
+
+	uint8_t is_array[MAX_NESTING_LEVEL / 8 + 1];
+	uint32_t nesting_level = 0;
+	json_validate_state_t state = JSON_VALIDATE_STATE_VALUE;
+	json_error_code_t err = JSON_ERROR_NONE;
+	size_t pos = 0, len = 0;
+	json_ret_code_t ret;
+
+	while (true) {
+		pos += json_lex_skip_whitespace(&p_data[pos], size - pos);
+		if (pos >= size) {
+			break;
+		}
+		char c = p_data[pos];
+
+		switch (state) {
+			case JSON_VALIDATE_STATE_OBJECT_START:
+				if (c == '}') {
+					nesting_level--;
+					pos++;
+					state = JSON_VALIDATE_STATE_VALUE_END;
+					break;
+				}
+				// fallthrough
+			case JSON_VALIDATE_STATE_MEMBER_DELIM:
+				if (c != '"') {
+					JSON_VALIDATE_REPORT_ERROR(JSON_RETVAL_FAIL, JSON_ERROR_UNEXPECTED_TOKEN, pos,
+											   state == JSON_VALIDATE_STATE_OBJECT_START ? "object key or object end" : "object key");
+				}
+				ret = json_lex_scan_string(&p_data[pos], size - pos, &len, &err);
+				if (ret != JSON_RETVAL_OK) {
+					JSON_VALIDATE_REPORT_ERROR(ret == JSON_RETVAL_INCOMPLETE ? JSON_RETVAL_FAIL : ret, err, pos + len, "string");
+				}
+				pos += len;
+				state = JSON_VALIDATE_STATE_OBJECT_KEY;
+				break;
+			case JSON_VALIDATE_STATE_OBJECT_KEY:
+				if (c != ':') {
+					JSON_VALIDATE_REPORT_ERROR(JSON_RETVAL_FAIL, JSON_ERROR_UNEXPECTED_TOKEN, pos, "name value delimiter");
+				}
+				pos++;
+				state = JSON_VALIDATE_STATE_VALUE;
+				break;
+			case JSON_VALIDATE_STATE_ARRAY_START:
+				if (c == ']') {
+					nesting_level--;
+					pos++;
+					state = JSON_VALIDATE_STATE_VALUE_END;
+					break;
+				}
+				// fallthrough
+			case JSON_VALIDATE_STATE_VALUE:
+				switch (c) {
+					case '{':
+					case '[':
+						if (nesting_level + 1 >= MAX_NESTING_LEVEL) {
+							JSON_VALIDATE_REPORT_ERROR(JSON_RETVAL_FAIL, JSON_ERROR_MAX_NESTING_LEVEL, pos, NULL);
+						}
+						JSON_VALIDATE_SET_ARRAY(nesting_level, c == '[');
+						nesting_level++;
+						pos++;
+						state = c == '[' ? JSON_VALIDATE_STATE_ARRAY_START : JSON_VALIDATE_STATE_OBJECT_START;
+						continue;
+					case '"':
+						ret = json_lex_scan_string(&p_data[pos], size - pos, &len, &err);
+						break;
+					case 't':
+						ret = json_lex_scan_literal(&p_data[pos], size - pos, "true", 4, &len);
+						err = JSON_ERROR_UNEXPECTED_TOKEN;
+						break;
+					case 'f':
+						ret = json_lex_scan_literal(&p_data[pos], size - pos, "false", 5, &len);
+						err = JSON_ERROR_UNEXPECTED_TOKEN;
+						break;
+					case 'n':
+						ret = json_lex_scan_literal(&p_data[pos], size - pos, "null", 4, &len);
+						err = JSON_ERROR_UNEXPECTED_TOKEN;
+						break;
+					default:
+						ret = json_lex_scan_number(&p_data[pos], size - pos, &len, &err);
+						break;
+				}
+				if (ret == JSON_RETVAL_INCOMPLETE) {
+					JSON_VALIDATE_REPORT_ERROR(JSON_RETVAL_FAIL, JSON_ERROR_UNEXPECTED_EOF, size, "value");
+				}
+				if (ret != JSON_RETVAL_OK) {
+					JSON_VALIDATE_REPORT_ERROR(ret, err, pos + len, "value");
+				}
+				pos += len;
+				state = JSON_VALIDATE_STATE_VALUE_END;
+				break;
+			case JSON_VALIDATE_STATE_VALUE_END:
+				if (nesting_level == 0) {
+					JSON_VALIDATE_REPORT_ERROR(JSON_RETVAL_FAIL, JSON_ERROR_UNEXPECTED_TOKEN, pos, "end of input");
+				}
+				if (c == ',') {
+					pos++;
+					state = JSON_VALIDATE_IS_ARRAY(nesting_level - 1) ? JSON_VALIDATE_STATE_VALUE : JSON_VALIDATE_STATE_MEMBER_DELIM;
+					break;
+				}
+				if (c == (JSON_VALIDATE_IS_ARRAY(nesting_level - 1) ? ']' : '}')) {
+					nesting_level--;
+					pos++;
+					break;
+				}
+				JSON_VALIDATE_REPORT_ERROR(JSON_RETVAL_FAIL, JSON_ERROR_UNEXPECTED_TOKEN, pos,
+										   JSON_VALIDATE_IS_ARRAY(nesting_level - 1) ? "value delimiter or array end" : "member delimiter or object end");
+		}
+	}
+
+	if (state != JSON_VALIDATE_STATE_VALUE_END || nesting_level != 0) {
+		JSON_VALIDATE_REPORT_ERROR(JSON_RETVAL_FAIL, JSON_ERROR_UNEXPECTED_EOF, size, NULL);
+	}
+
+	if (p_error != NULL) {
+		p_error->code = JSON_ERROR_NONE;
+		p_error->offset = size;
+		p_error->expected = NULL;
+	}
+
+	return JSON_RETVAL_OK;
+}
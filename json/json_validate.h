@@ -0,0 +1,8 @@
+#ifndef JSON_PARSER_JSON_VALIDATE_H
+#define JSON_PARSER_JSON_VALIDATE_H
+
+#include "json.h"
+
+json_ret_code_t json_validate_document(const char* p_data, size_t size, json_error_t* p_error);
+
+#endif //JSON_PARSER_JSON_VALIDATE_H
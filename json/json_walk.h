@@ -0,0 +1,62 @@
+#ifndef JSON_PARSER_JSON_WALK_H
+#define JSON_PARSER_JSON_WALK_H
+
+#include <stdlib.h>
+#include "json.h"
+
+#define JSON_WALK_INLINE_FRAMES		32
+
+// Open container of an iterative walk over a tree
+typedef struct {
+	json_value_t value;		// Object or array that is walked
+	json_value_type_t type;
+	uint32_t index;			// Next entry
+	json_value_t target;	// Container the entries are copied into, only used by json_object_copy
+} json_walk_frame_t;
+
+// The first frames live on the native stack, deeper trees continue on the heap
+typedef struct {
+	json_walk_frame_t* frames;
+	size_t depth;
+	size_t capacity;
+	json_walk_frame_t inline_frames[JSON_WALK_INLINE_FRAMES];
+} json_walk_t;
+
+static inline void json_walk_init(json_walk_t* p_walk) {
+	p_walk->frames = p_walk->inline_frames;
+	p_walk->depth = 0;
+	p_walk->capacity = JSON_WALK_INLINE_FRAMES;
+}
+
+// NULL when the stack cannot grow
+static inline json_walk_frame_t* json_walk_push(json_walk_t* p_walk, json_value_t value, json_value_type_t type) {
+	if (p_walk->depth == p_walk->capacity) {
+		size_t capacity = p_walk->capacity * 2;
+		json_walk_frame_t* frames = malloc(capacity * sizeof(json_walk_frame_t));
+		if (frames == NULL) {
+			return NULL;
+		}
+		memcpy(frames, p_walk->frames, p_walk->depth * sizeof(json_walk_frame_t));
+		if (p_walk->frames != p_walk->inline_frames) {
+			free(p_walk->frames);
+		}
+		p_walk->frames = frames;
+		p_walk->capacity = capacity;
+	}
+	json_walk_frame_t* p_frame = &p_walk->frames[p_walk->depth++];
+	*p_frame = (json_walk_frame_t) {.value = value, .type = type};
+	return p_frame;
+}
+
+static inline json_walk_frame_t* json_walk_top(json_walk_t* p_walk) {
+	return p_walk->depth > 0 ? &p_walk->frames[p_walk->depth - 1] : NULL;
+}
+
+static inline void json_walk_free(json_walk_t* p_walk) {
+	if (p_walk->frames != p_walk->inline_frames) {
+		free(p_walk->frames);
+	}
+	json_walk_init(p_walk);
+}
+
+#endif //JSON_PARSER_JSON_WALK_H
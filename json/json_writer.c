@@ -0,0 +1,395 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "json.h"
+#include "json_writer.h"
+
+/*
+ * Streaming writer that formats JSON straight from calls like json_writer_key and json_writer_int, without building
+ * a tree first. Output collects in a growable buffer, or with a sink in a fixed buffer that is handed to the sink
+ * whenever it is full. A single flag decides whether the next key or value needs a comma, so release builds keep no
+ * other state per container. Debug builds also keep a stack of the open containers and fail calls that would
+ * produce invalid JSON with JSON_RETVAL_ILLEGAL. Strings are escaped and doubles are written with the fewest digits
+ * that read back the same value, the formatting is shared with json_encode_struct.
+ */
+
+#define JSON_WRITER_MIN_CAPACITY	256
+
+void json_writer_init(json_writer_t* p_writer, json_sink_fn sink, void* p_context) {
+	p_writer->sink = sink;
+	p_writer->p_context = p_context;
+	if (sink != NULL) {
+		p_writer->buffer = p_writer->sink_buffer;
+		p_writer->capacity = JSON_WRITER_SINK_BUFFER_SIZE;
+	} else {
+		p_writer->buffer = NULL;
+		p_writer->capacity = 0;
+	}
+	p_writer->length = 0;
+	p_writer->ret = JSON_RETVAL_OK;
+	p_writer->needs_comma = false;
+#ifndef NDEBUG
+	p_writer->depth = 0;
+	p_writer->is_complete = false;
+#endif
+}
+
+void json_writer_flush(json_writer_t* p_writer) {
+	if (p_writer->sink == NULL) {
+		return;
+	}
+	if (p_writer->length > 0 && p_writer->ret == JSON_RETVAL_OK) {
+		p_writer->ret = p_writer->sink(p_writer->buffer, p_writer->length, p_writer->p_context);
+	}
+	p_writer->length = 0;
+}
+
+// The buffer is full, one byte always stays free for the terminator of the growable buffer
+void json_writer_append_slow(json_writer_t* p_writer, const char* p_data, size_t length) {
+	if (p_writer->ret != JSON_RETVAL_OK) {
+		return;
+	}
+	if (p_writer->sink != NULL) {
+		json_writer_flush(p_writer);
+		if (length >= p_writer->capacity) {
+			if (p_writer->ret == JSON_RETVAL_OK) {
+				p_writer->ret = p_writer->sink(p_data, length, p_writer->p_context);
+			}
+			return;
+		}
+	} else {
+		size_t capacity = p_writer->capacity < JSON_WRITER_MIN_CAPACITY ? JSON_WRITER_MIN_CAPACITY : p_writer->capacity * 2;
+		if (capacity <= p_writer->length + length) {
+			capacity = p_writer->length + length + 1;
+		}
+		char* buffer = realloc(p_writer->buffer, capacity);
+		if (buffer == NULL) {
+			p_writer->ret = JSON_RETVAL_FAIL;
+			return;
+		}
+		p_writer->buffer = buffer;
+		p_writer->capacity = capacity;
+	}
+	memcpy(&p_writer->buffer[p_writer->length], p_data, length);
+	p_writer->length += length;
+}
+
+void json_writer_append_integer(json_writer_t* p_writer, int64_t integer) {
+	char digits[24];
+	size_t i = sizeof(digits);
+	uint64_t value = integer < 0 ? 0 - (uint64_t) integer : (uint64_t) integer;
+	do {
+		digits[--i] = (char) ('0' + value % 10);
+		value /= 10;
+	} while (value > 0);
+	if (integer < 0) {
+		digits[--i] = '-';
+	}
+	json_writer_append(p_writer, &digits[i], sizeof(digits) - i);
+}
+
+// integer / 10^num_decimals with all decimal places written
+static void json_writer_append_fixed(json_writer_t* p_writer, int64_t integer, size_t num_decimals) {
+	char digits[32];
+	size_t i = sizeof(digits);
+	uint64_t value = integer < 0 ? 0 - (uint64_t) integer : (uint64_t) integer;
+	for (size_t j = 0; j < num_decimals; j++) {
+		digits[--i] = (char) ('0' + value % 10);
+		value /= 10;
+	}
+	digits[--i] = '.';
+	do {
+		digits[--i] = (char) ('0' + value % 10);
+		value /= 10;
+	} while (value > 0);
+	if (integer < 0) {
+		digits[--i] = '-';
+	}
+	json_writer_append(p_writer, &digits[i], sizeof(digits) - i);
+}
+
+void json_writer_append_double(json_writer_t* p_writer, double number) {
+	if (!isfinite(number)) {
+		json_writer_append(p_writer, "null", 4);
+		return;
+	}
+	// Integers that a double holds exactly do not need printf
+	if (number > -9007199254740992.0 && number < 9007199254740992.0 && number == (double) (int64_t) number) {
+		json_writer_append_integer(p_writer, (int64_t) number);
+		return;
+	}
+	// Numbers with a few decimal places are an integer scaled down by a power of ten, the division is rounded the same
+	// way as parsing the digits, so the digits read back the same value if it gives the number again. Limited to at
+	// most 15 digits and to numbers that %g writes without exponent, the output is the same as printf's once the
+	// trailing zeros are dropped. A product can be exact only at a higher power than needed, 513.926 at 10^4.
+	static const double powers[] = {1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15};
+	for (size_t i = 0; i < sizeof(powers) / sizeof(powers[0]) && (number >= 1e-4 || number <= -1e-4); i++) {
+		double scaled = number * powers[i];
+		if (scaled <= -1e15 || scaled >= 1e15) {
+			break;
+		}
+		int64_t integer = (int64_t) scaled;
+		if ((double) integer == scaled && (double) integer / powers[i] == number) {
+			size_t num_decimals = i + 1;
+			while (num_decimals > 1 && integer % 10 == 0) {
+				integer /= 10;
+				num_decimals--;
+			}
+			json_writer_append_fixed(p_writer, integer, num_decimals);
+			return;
+		}
+	}
+	char digits[32];
+	int length = snprintf(digits, sizeof(digits), "%.15g", number);
+	if (strtod(digits, NULL) != number) {
+		length = snprintf(digits, sizeof(digits), "%.17g", number);
+	}
+	json_writer_append(p_writer, digits, (size_t) length);
+}
+
+void json_writer_append_string(json_writer_t* p_writer, const char* p_string, size_t length) {
+	static const char hex[] = "0123456789abcdef";
+	json_writer_append_char(p_writer, '"');
+	size_t start = 0;
+	for (size_t i = 0; i < length; i++) {
+		unsigned char c = (unsigned char) p_string[i];
+		if (c >= 0x20 && c != '"' && c != '\\') {
+			continue;
+		}
+		json_writer_append(p_writer, &p_string[start], i - start);
+		start = i + 1;
+		char escape[6] = {'\\', (char) c};
+		size_t escape_length = 2;
+		switch (c) {
+			case '"': case '\\': break;
+			case '\b': escape[1] = 'b'; break;
+			case '\f': escape[1] = 'f'; break;
+			case '\n': escape[1] = 'n'; break;
+			case '\r': escape[1] = 'r'; break;
+			case '\t': escape[1] = 't'; break;
+			default:
+				memcpy(escape, (char[]) {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0x0F]}, 6);
+				escape_length = 6;
+				break;
+		}
+		json_writer_append(p_writer, escape, escape_length);
+	}
+	json_writer_append(p_writer, &p_string[start], length - start);
+	json_writer_append_char(p_writer, '"');
+}
+
+#ifndef NDEBUG
+#define JSON_WRITER_TOP(p_writer)	((p_writer)->depth > 0 ? (p_writer)->containers[(p_writer)->depth - 1] : '\0')
+
+#define JSON_WRITER_FAIL(p_writer) { \
+	(p_writer)->ret = JSON_RETVAL_ILLEGAL; \
+	return JSON_RETVAL_ILLEGAL; \
+}
+
+// A value may start the document, follow a key or be an array entry
+static json_ret_code_t json_writer_check_value(json_writer_t* p_writer) {
+	char top = JSON_WRITER_TOP(p_writer);
+	if (top == '{' || (top == '\0' && p_writer->is_complete)) {
+		JSON_WRITER_FAIL(p_writer);
+	}
+	if (top == ':') {
+		p_writer->containers[p_writer->depth - 1] = '{';
+	} else if (top == '\0') {
+		p_writer->is_complete = true;
+	}
+	return JSON_RETVAL_OK;
+}
+
+#define JSON_WRITER_CHECK_VALUE(p_writer) { \
+	json_ret_code_t _ret = json_writer_check_value(p_writer); \
+	if (_ret != JSON_RETVAL_OK) { \
+		return _ret; \
+	} \
+}
+#else
+#define JSON_WRITER_CHECK_VALUE(p_writer)
+#endif
+
+#define JSON_WRITER_BEGIN_VALUE(p_writer) \
+	if ((p_writer) == NULL) { \
+		return JSON_RETVAL_INVALID_PARAM; \
+	} \
+	if ((p_writer)->ret != JSON_RETVAL_OK) { \
+		return (p_writer)->ret; \
+	} \
+	JSON_WRITER_CHECK_VALUE(p_writer); \
+	if ((p_writer)->needs_comma) { \
+		json_writer_append_char((p_writer), ','); \
+	} \
+	(p_writer)->needs_comma = true;
+
+json_writer_t* json_writer_new(json_sink_fn sink, void* p_context) {
+	json_writer_t* p_writer = malloc(sizeof(json_writer_t));
+	if (p_writer != NULL) {
+		json_writer_init(p_writer, sink, p_context);
+	}
+	return p_writer;
+}
+
+// Keeps the allocated buffer for the next document
+void json_writer_reset(json_writer_t* p_writer) {
+	if (p_writer == NULL) {
+		return;
+	}
+	char* buffer = p_writer->sink == NULL ? p_writer->buffer : NULL;
+	size_t capacity = p_writer->capacity;
+	json_writer_init(p_writer, p_writer->sink, p_writer->p_context);
+	if (buffer != NULL) {
+		p_writer->buffer = buffer;
+		p_writer->capacity = capacity;
+	}
+}
+
+void json_writer_free(json_writer_t* p_writer) {
+	if (p_writer == NULL) {
+		return;
+	}
+	if (p_writer->sink == NULL) {
+		free(p_writer->buffer);
+	}
+	free(p_writer);
+}
+
+static json_ret_code_t json_writer_begin(json_writer_t* p_writer, char container) {
+	JSON_WRITER_BEGIN_VALUE(p_writer);
+#ifndef NDEBUG
+	if (p_writer->depth >= JSON_WRITER_MAX_NESTING_LEVEL) {
+		JSON_WRITER_FAIL(p_writer);
+	}
+	p_writer->containers[p_writer->depth++] = container;
+#endif
+	json_writer_append_char(p_writer, container);
+	p_writer->needs_comma = false;
+	return p_writer->ret;
+}
+
+static json_ret_code_t json_writer_end(json_writer_t* p_writer, char container) {
+	if (p_writer == NULL) {
+		return JSON_RETVAL_INVALID_PARAM;
+	}
+	if (p_writer->ret != JSON_RETVAL_OK) {
+		return p_writer->ret;
+	}
+#ifndef NDEBUG
+	if (JSON_WRITER_TOP(p_writer) != container) {
+		JSON_WRITER_FAIL(p_writer);
+	}
+	p_writer->depth--;
+#endif
+	json_writer_append_char(p_writer, container == '{' ? '}' : ']');
+	p_writer->needs_comma = true;
+	return p_writer->ret;
+}
+
+json_ret_code_t json_writer_begin_object(json_writer_t* p_writer) {
+	return json_writer_begin(p_writer, '{');
+}
+
+json_ret_code_t json_writer_end_object(json_writer_t* p_writer) {
+	return json_writer_end(p_writer, '{');
+}
+
+json_ret_code_t json_writer_begin_array(json_writer_t* p_writer) {
+	return json_writer_begin(p_writer, '[');
+}
+
+json_ret_code_t json_writer_end_array(json_writer_t* p_writer) {
+	return json_writer_end(p_writer, '[');
+}
+
+json_ret_code_t json_writer_key(json_writer_t* p_writer, const char* key) {
+	if (p_writer == NULL || key == NULL) {
+		return JSON_RETVAL_INVALID_PARAM;
+	}
+	if (p_writer->ret != JSON_RETVAL_OK) {
+		return p_writer->ret;
+	}
+#ifndef NDEBUG
+	if (JSON_WRITER_TOP(p_writer) != '{') {
+		JSON_WRITER_FAIL(p_writer);
+	}
+	p_writer->containers[p_writer->depth - 1] = ':';
+#endif
+	if (p_writer->needs_comma) {
+		json_writer_append_char(p_writer, ',');
+	}
+	json_writer_append_string(p_writer, key, strlen(key));
+	json_writer_append_char(p_writer, ':');
+	p_writer->needs_comma = false;
+	return p_writer->ret;
+}
+
+json_ret_code_t json_writer_string(json_writer_t* p_writer, const char* string) {
+	if (string == NULL) {
+		return JSON_RETVAL_INVALID_PARAM;
+	}
+	return json_writer_string_length(p_writer, string, strlen(string));
+}
+
+json_ret_code_t json_writer_string_length(json_writer_t* p_writer, const char* string, size_t length) {
+	if (string == NULL) {
+		return JSON_RETVAL_INVALID_PARAM;
+	}
+	JSON_WRITER_BEGIN_VALUE(p_writer);
+	json_writer_append_string(p_writer, string, length);
+	return p_writer->ret;
+}
+
+json_ret_code_t json_writer_int(json_writer_t* p_writer, int64_t integer) {
+	JSON_WRITER_BEGIN_VALUE(p_writer);
+	json_writer_append_integer(p_writer, integer);
+	return p_writer->ret;
+}
+
+json_ret_code_t json_writer_double(json_writer_t* p_writer, double number) {
+	JSON_WRITER_BEGIN_VALUE(p_writer);
+	json_writer_append_double(p_writer, number);
+	return p_writer->ret;
+}
+
+json_ret_code_t json_writer_bool(json_writer_t* p_writer, bool boolean) {
+	JSON_WRITER_BEGIN_VALUE(p_writer);
+	json_writer_append(p_writer, boolean ? "true" : "false", boolean ? 4 : 5);
+	return p_writer->ret;
+}
+
+json_ret_code_t json_writer_null(json_writer_t* p_writer) {
+	JSON_WRITER_BEGIN_VALUE(p_writer);
+	json_writer_append(p_writer, "null", 4);
+	return p_writer->ret;
+}
+
+// Hands the rest of the output to the sink, debug builds fail documents that are not complete
+json_ret_code_t json_writer_finish(json_writer_t* p_writer) {
+	if (p_writer == NULL) {
+		return JSON_RETVAL_INVALID_PARAM;
+	}
+#ifndef NDEBUG
+	if (p_writer->ret == JSON_RETVAL_OK && (p_writer->depth > 0 || !p_writer->is_complete)) {
+		p_writer->ret = JSON_RETVAL_ILLEGAL;
+	}
+#endif
+	json_writer_flush(p_writer);
+	return p_writer->ret;
+}
+
+// Output written so far when writing without a sink, terminated and valid until the next call on the writer
+const char* json_writer_get_output(json_writer_t* p_writer, size_t* p_length) {
+	if (p_writer == NULL || p_writer->sink != NULL) {
+		return NULL;
+	}
+	if (p_length != NULL) {
+		*p_length = p_writer->length;
+	}
+	if (p_writer->buffer == NULL) {
+		return "";
+	}
+	p_writer->buffer[p_writer->length] = '\0';
+	return p_writer->buffer;
+}
@@ -0,0 +1,53 @@
+#ifndef JSON_PARSER_JSON_WRITER_H
+#define JSON_PARSER_JSON_WRITER_H
+
+#include "json.h"
+
+#define JSON_WRITER_SINK_BUFFER_SIZE	4096
+#define JSON_WRITER_MAX_NESTING_LEVEL	1000
+
+// Output collects in a heap buffer, or in sink_buffer that is handed to the sink whenever it is full
+struct json_writer_t {
+	char* buffer;
+	size_t length;
+	size_t capacity;
+	json_sink_fn sink;
+	void* p_context;
+	json_ret_code_t ret;	// First failure, nothing is written after it
+	bool needs_comma;		// A value or key was written into the open container
+#ifndef NDEBUG
+	// Open containers, debug builds reject calls that would produce invalid JSON
+	uint32_t depth;
+	char containers[JSON_WRITER_MAX_NESTING_LEVEL];	// '{' expecting a key, ':' expecting a value, '['
+	bool is_complete;
+#endif
+	char sink_buffer[JSON_WRITER_SINK_BUFFER_SIZE];
+};
+
+void json_writer_init(json_writer_t* p_writer, json_sink_fn sink, void* p_context);
+void json_writer_flush(json_writer_t* p_writer);
+void json_writer_append_slow(json_writer_t* p_writer, const char* p_data, size_t length);
+
+static inline void json_writer_append(json_writer_t* p_writer, const char* p_data, size_t length) {
+	if (p_writer->length + length >= p_writer->capacity) {
+		json_writer_append_slow(p_writer, p_data, length);
+		return;
+	}
+	memcpy(&p_writer->buffer[p_writer->length], p_data, length);
+	p_writer->length += length;
+}
+
+static inline void json_writer_append_char(json_writer_t* p_writer, char c) {
+	if (p_writer->length + 1 >= p_writer->capacity) {
+		json_writer_append_slow(p_writer, &c, 1);
+		return;
+	}
+	p_writer->buffer[p_writer->length++] = c;
+}
+
+// Values without separators, shared with json_encode_struct
+void json_writer_append_integer(json_writer_t* p_writer, int64_t integer);
+void json_writer_append_double(json_writer_t* p_writer, double number);
+void json_writer_append_string(json_writer_t* p_writer, const char* p_string, size_t length);
+
+#endif //JSON_PARSER_JSON_WRITER_H
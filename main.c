@@ -14,6 +14,22 @@ int main() {
 	test_json_parse();
 	test_json_build();
 	test_json_stringify();
+	test_json_validate();
+	test_json_file();
+	test_json_parser();
+	test_json_ndjson();
+	test_json_parallel();
+	test_json_batch();
+	test_json_tape();
+	test_json_key_pool();
+	test_json_columns();
+	test_json_path();
+	test_json_select();
+	test_json_index();
+	test_json_decode();
+	test_json_encode();
+	test_json_schema();
+	test_json_writer();
 #else
 	json_parse_string("{\"key\":\"value\"}", obj);
 
@@ -9,5 +9,21 @@ int test_json_lex();
 int test_json_parse();
 int test_json_build();
 int test_json_stringify();
+int test_json_validate();
+int test_json_file();
+int test_json_parser();
+int test_json_ndjson();
+int test_json_parallel();
+int test_json_batch();
+int test_json_tape();
+int test_json_key_pool();
+int test_json_columns();
+int test_json_path();
+int test_json_select();
+int test_json_index();
+int test_json_decode();
+int test_json_encode();
+int test_json_schema();
+int test_json_writer();
 
 #endif //JSON_PARSER_TESTS_H
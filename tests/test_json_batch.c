@@ -0,0 +1,145 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "test_json.h"
+#include "json.h"
+
+#define LOG_LEVEL    LOG_LEVEL_DEBUG
+#include "testlib.h"
+
+#define TEST_BATCH_NUM_INPUTS		200
+
+// Messages of different sizes with escaped strings, nested objects and arrays
+static char* test_batch_message(size_t index) {
+	char* buffer = malloc(8 * 1024);
+	size_t size = sprintf(buffer, "{\"id\": %lu, \"name\": \"msg \\\"%lu\\\"\", \"tags\": [\"a\", \"b\\n\", %lu],"
+						  " \"meta\": {\"ok\": %s, \"inner\": {\"n\": null}}, \"values\": [", index, index, index,
+						  index % 2 == 0 ? "true" : "false");
+	for (size_t i = 0; i < 10 + index * 7 % 300; i++) {
+		size += sprintf(&buffer[size], "%s%lu.5", i > 0 ? ", " : "", i);
+	}
+	sprintf(&buffer[size], "]}");
+	return buffer;
+}
+
+TEST_DEF(test_json_batch, batch_parse) {
+	json_input_t* inputs = malloc(TEST_BATCH_NUM_INPUTS * sizeof(json_input_t));
+	json_document_t* outputs = malloc(TEST_BATCH_NUM_INPUTS * sizeof(json_document_t));
+	json_error_t* errors = malloc(TEST_BATCH_NUM_INPUTS * sizeof(json_error_t));
+	TEST_ASSERT_NOT_NULL(inputs);
+	TEST_ASSERT_NOT_NULL(outputs);
+	TEST_ASSERT_NOT_NULL(errors);
+	for (size_t i = 0; i < TEST_BATCH_NUM_INPUTS; i++) {
+		inputs[i].p_data = test_batch_message(i);
+		inputs[i].size = strlen(inputs[i].p_data);
+	}
+
+	// With a pool for the call, persistent pools and the calling thread only
+	json_pool_t* pools[] = {NULL, json_pool_new(1), json_pool_new(4)};
+	size_t num_inputs[] = {TEST_BATCH_NUM_INPUTS, TEST_BATCH_NUM_INPUTS, TEST_BATCH_NUM_INPUTS, 1};
+	size_t num_failed = 0;
+	for (size_t run = 0; run < 4; run++) {
+		json_pool_t* pool = pools[run % 3];
+		if (json_parse_batch(inputs, num_inputs[run], outputs, errors, pool) != JSON_RETVAL_OK) {
+			num_failed++;
+			continue;
+		}
+		for (size_t i = 0; i < num_inputs[run]; i++) {
+			json_object_t expected_object;
+			json_parse((char*) inputs[i].p_data, inputs[i].size, &expected_object);
+			char* expected_string = json_stringify(&expected_object);
+			char* string = json_stringify(&outputs[i].root);
+			if (strcmp(string, expected_string) != 0) {
+				num_failed++;
+			}
+			free(string);
+			free(expected_string);
+			json_object_free(&expected_object);
+			json_document_free(&outputs[i]);
+		}
+	}
+	json_pool_free(pools[1]);
+	json_pool_free(pools[2]);
+
+	TEST_EXPECT_EQ_U64(num_failed, 0);
+
+	for (size_t i = 0; i < TEST_BATCH_NUM_INPUTS; i++) {
+		free((char*) inputs[i].p_data);
+	}
+	free(inputs);
+	free(outputs);
+	free(errors);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+TEST_DEF(test_json_batch, batch_errors) {
+	json_input_t inputs[] = {
+		{"{\"key\": \"value\"}", 16},
+		{"{\"key\": 1.}", 11},
+		{"{\"key\": \"a\\x\"}", 14},
+		{"{\"key\": {\"inner\": [1, 2]", 24},
+		{"", 0},
+		{"{\"k\": \"v\"}", 10},
+	};
+	size_t num_inputs = sizeof(inputs) / sizeof(inputs[0]);
+	json_document_t outputs[sizeof(inputs) / sizeof(inputs[0])];
+	json_error_t errors[sizeof(inputs) / sizeof(inputs[0])];
+
+	// Failed documents report the same error as json_parse_ex and can still be freed
+	TEST_EXPECT_EQ_U8(json_parse_batch(inputs, num_inputs, outputs, errors, NULL), JSON_RETVAL_FAIL);
+	TEST_EXPECT_EQ_STRING(json_object_get_value(&outputs[0].root, "key")->string, "value", 6);
+	TEST_EXPECT_EQ_STRING(json_object_get_value(&outputs[5].root, "k")->string, "v", 2);
+	TEST_EXPECT_EQ_U32(outputs[1].root.num_members, 0);
+	for (size_t i = 0; i < num_inputs; i++) {
+		json_object_t object;
+		json_error_t expected_error = {0};
+		json_parse_ex(inputs[i].p_data, inputs[i].size, &object, &expected_error);
+		json_object_free(&object);
+		TEST_EXPECT_EQ_U32(errors[i].code, expected_error.code);
+		TEST_EXPECT_EQ_U64(errors[i].offset, expected_error.offset);
+		json_document_free(&outputs[i]);
+	}
+	TEST_EXPECT_EQ_U32(outputs[0].root.num_members, 0);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+TEST_DEF(test_json_batch, batch_read_only) {
+	json_input_t input = {"{\"key\": {\"inner\": 1}}", 21};
+	json_document_t document;
+	TEST_ASSERT_EQ_U8(json_parse_batch(&input, 1, &document, NULL, NULL), JSON_RETVAL_OK);
+
+	// Objects of an arena document cannot grow or be freed on their own
+	json_value_t value = {.number = 1};
+	for (size_t i = 0; i < 40; i++) {
+		TEST_EXPECT_EQ_U8(json_object_add_value(&document.root, "added", value, JSON_VALUE_TYPE_NUMBER), JSON_RETVAL_INVALID_PARAM);
+	}
+	json_value_t* p_key = json_object_get_value(&document.root, "key");
+	TEST_ASSERT_NOT_NULL(p_key);
+	TEST_EXPECT_EQ_U8(json_object_add_value(p_key->object, "added", value, JSON_VALUE_TYPE_NUMBER), JSON_RETVAL_INVALID_PARAM);
+	TEST_EXPECT_EQ_U8(json_object_free(&document.root), JSON_RETVAL_INVALID_PARAM);
+	TEST_EXPECT_EQ_U32(document.root.num_members, 1);
+
+	// A copy owns its members and can be modified
+	json_object_t copy;
+	TEST_ASSERT_EQ_U8(json_object_copy(&document.root, &copy), JSON_RETVAL_OK);
+	TEST_EXPECT_EQ_U8(json_document_free(&document), JSON_RETVAL_OK);
+	for (size_t i = 0; i < 40; i++) {
+		TEST_EXPECT_EQ_U8(json_object_add_value(&copy, "added", value, JSON_VALUE_TYPE_NUMBER), JSON_RETVAL_OK);
+	}
+	TEST_EXPECT_EQ_U8(json_object_add_value(json_object_get_value(&copy, "key")->object, "added", value, JSON_VALUE_TYPE_NUMBER),
+					  JSON_RETVAL_OK);
+	TEST_EXPECT_EQ_U32(copy.num_members, 41);
+	json_object_free(&copy);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+int test_json_batch() {
+	TEST_GROUP_REG(test_json_batch);
+	TEST_REG(test_json_batch, batch_parse);
+	TEST_REG(test_json_batch, batch_errors);
+	TEST_REG(test_json_batch, batch_read_only);
+	TESTS_RUN();
+}
@@ -2,7 +2,10 @@
 // Created by tholz on 11.06.2022.
 //
 
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
 #include "test_json.h"
 #include "json.h"
 
@@ -51,9 +54,7 @@ TEST_DEF(test_json_build, build_array) {
 		{.value = value1, .type = JSON_VALUE_TYPE_STRING},
 		{.value = value2, .type = JSON_VALUE_TYPE_STRING},
 	};
-	json_array_t array = {.length = 2};
-	array.values[0] = &array_members[0];
-	array.values[1] = &array_members[1];
+	json_array_t array = {.values = array_members, .length = 2, .max_length = 2};
 	json_value_t value = {.array = &array};
 	json_ret_code_t ret = json_object_add_value(&object, key, value, JSON_VALUE_TYPE_ARRAY);
 	TEST_EXPECT_EQ_U8(ret, JSON_RETVAL_OK);
@@ -70,10 +71,136 @@ TEST_DEF(test_json_build, build_array) {
 	TEST_CLEAN_UP_AND_RETURN(0);
 }
 
+TEST_DEF(test_json_build, build_many_members) {
+	// Members are stored contiguously and move when the object grows
+	json_object_t object = {0};
+	char key[16];
+	for (uint32_t i = 0; i < 20000; i++) {
+		sprintf(key, "key %u", i);
+		TEST_ASSERT_EQ_U8(json_object_add_value(&object, key, (json_value_t) {.number = i}, JSON_VALUE_TYPE_NUMBER), JSON_RETVAL_OK);
+	}
+	TEST_EXPECT_EQ_U32(object.num_members, 20000);
+	TEST_EXPECT(object.max_num_members >= object.num_members);
+	TEST_EXPECT_EQ_STRING(object.members[0].key, "key 0", 6);
+	TEST_EXPECT_EQ_DOUBLE(json_object_get_value(&object, "key 19999")->number, 19999.0);
+	TEST_EXPECT_EQ_U8(json_object_free(&object), JSON_RETVAL_OK);
+	TEST_EXPECT(object.members == NULL);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+TEST_DEF(test_json_build, build_copy) {
+	const char* input = "{\"short\": \"abc\", \"a key that does not fit inline\": \"a string that does not fit inline\","
+						" \"numbers\": [1, 2.5, 3], \"mixed\": [\"x\", true, null, 4], \"nested\": {\"deeper\": {\"n\": 1}}}";
+	json_object_t object;
+	TEST_ASSERT_EQ_U8(json_parse(input, strlen(input), &object), JSON_RETVAL_OK);
+	char* expect = json_stringify(&object);
+	TEST_ASSERT_NOT_NULL(expect);
+
+	// The copy owns everything, it outlives the source
+	json_object_t copy;
+	TEST_ASSERT_EQ_U8(json_object_copy(&object, &copy), JSON_RETVAL_OK);
+	TEST_EXPECT(copy.members != object.members);
+	TEST_EXPECT(json_object_get_value(&copy, "short")->string != json_object_get_value(&object, "short")->string);
+	TEST_EXPECT(json_object_get_value(&copy, "nested")->object->parent == &copy);
+	json_object_free(&object);
+	char* output = json_stringify(&copy);
+	TEST_ASSERT_NOT_NULL(output);
+	TEST_EXPECT_EQ_STRING(output, expect, strlen(expect) + 1);
+	TEST_EXPECT_EQ_DOUBLE(json_array_get_numbers(json_object_get_value(&copy, "numbers")->array, NULL)[1], 2.5);
+	free(output);
+
+	// Interned keys are shared, the pool outlives both trees
+	json_key_pool_t* p_key_pool = json_key_pool_new();
+	TEST_ASSERT_NOT_NULL(p_key_pool);
+	TEST_ASSERT_EQ_U8(json_parse_interned(input, strlen(input), &object, p_key_pool, NULL), JSON_RETVAL_OK);
+	json_object_t interned_copy;
+	TEST_ASSERT_EQ_U8(json_object_copy(&object, &interned_copy), JSON_RETVAL_OK);
+	TEST_EXPECT(interned_copy.members[0].key == object.members[0].key);
+	TEST_EXPECT(interned_copy.members[0].flags & JSON_MEMBER_FLAG_INTERNED_KEY);
+	json_object_free(&object);
+	json_object_free(&interned_copy);
+	json_key_pool_free(p_key_pool);
+
+	json_object_free(&copy);
+	free(expect);
+	TEST_EXPECT_EQ_U8(json_object_copy(NULL, &copy), JSON_RETVAL_INVALID_PARAM);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+#define TEST_BUILD_DEEP_NESTING_LEVEL	100000
+#define TEST_BUILD_DEEP_STACK_SIZE		(256 * 1024)
+
+typedef struct {
+	json_object_t* p_object;
+	char* string;
+	json_ret_code_t copy_ret;
+	char* copy_string;
+} test_build_deep_t;
+
+// Runs on a thread with a small stack, the tree is far deeper than recursion on it could go
+static void* test_build_deep_walk(void* p_arg) {
+	test_build_deep_t* p_deep = p_arg;
+	p_deep->string = json_stringify(p_deep->p_object);
+	json_object_t copy;
+	p_deep->copy_ret = json_object_copy(p_deep->p_object, &copy);
+	if (p_deep->copy_ret == JSON_RETVAL_OK) {
+		p_deep->copy_string = json_stringify(&copy);
+		json_object_free(&copy);
+	}
+	json_object_free(p_deep->p_object);
+	return NULL;
+}
+
+TEST_DEF(test_json_build, build_deep_nesting) {
+	// {"a":[{"a":[ ... {"leaf":true} ... ]}]}, objects and arrays alternate
+	json_object_t object = {0};
+	json_object_t* p_inner = &object;
+	for (uint32_t i = 0; i < TEST_BUILD_DEEP_NESTING_LEVEL / 2; i++) {
+		json_object_t* p_child = calloc(1, sizeof(json_object_t));
+		json_array_t* p_array = calloc(1, sizeof(json_array_t));
+		json_array_member_t* values = malloc(sizeof(json_array_member_t));
+		TEST_ASSERT(p_child != NULL && p_array != NULL && values != NULL);
+		values[0] = (json_array_member_t) {.value.object = p_child, .type = JSON_VALUE_TYPE_OBJECT};
+		*p_array = (json_array_t) {.values = values, .length = 1, .max_length = 1};
+		TEST_ASSERT_EQ_U8(json_object_add_value(p_inner, "a", (json_value_t) {.array = p_array}, JSON_VALUE_TYPE_ARRAY), JSON_RETVAL_OK);
+		p_inner = p_child;
+	}
+	TEST_ASSERT_EQ_U8(json_object_add_value(p_inner, "leaf", (json_value_t) {.boolean = true}, JSON_VALUE_TYPE_BOOLEAN), JSON_RETVAL_OK);
+
+	test_build_deep_t deep = {.p_object = &object};
+	pthread_attr_t attr;
+	pthread_t thread;
+	pthread_attr_init(&attr);
+	pthread_attr_setstacksize(&attr, TEST_BUILD_DEEP_STACK_SIZE);
+	TEST_ASSERT_EQ_I32(pthread_create(&thread, &attr, test_build_deep_walk, &deep), 0);
+	pthread_join(thread, NULL);
+	pthread_attr_destroy(&attr);
+
+	size_t length = TEST_BUILD_DEEP_NESTING_LEVEL / 2 * strlen("{\"a\":[]}") + strlen("{\"leaf\":true}");
+	TEST_ASSERT_NOT_NULL(deep.string);
+	TEST_EXPECT_EQ_U64(strlen(deep.string), length);
+	TEST_EXPECT_EQ_STRING(deep.string, "{\"a\":[{\"a\":[", 11);
+	TEST_EXPECT_EQ_STRING(&deep.string[TEST_BUILD_DEEP_NESTING_LEVEL / 2 * strlen("{\"a\":[")], "{\"leaf\":true}", 13);
+	TEST_EXPECT_EQ_STRING(&deep.string[length - 6], "]}]}]}", 7);
+	TEST_EXPECT_EQ_U8(deep.copy_ret, JSON_RETVAL_OK);
+	TEST_ASSERT_NOT_NULL(deep.copy_string);
+	TEST_EXPECT_EQ_STRING(deep.copy_string, deep.string, length + 1);
+	TEST_EXPECT(object.members == NULL);
+	free(deep.string);
+	free(deep.copy_string);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
 int test_json_build() {
 	TEST_GROUP_REG(test_json_build);
 	TEST_REG(test_json_build, build_simple_key_value);
 	TEST_REG(test_json_build, build_nested);
 	TEST_REG(test_json_build, build_array);
+	TEST_REG(test_json_build, build_many_members);
+	TEST_REG(test_json_build, build_copy);
+	TEST_REG(test_json_build, build_deep_nesting);
 	TESTS_RUN();
 }
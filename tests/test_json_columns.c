@@ -0,0 +1,141 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "test_json.h"
+#include "json.h"
+
+#define LOG_LEVEL    LOG_LEVEL_DEBUG
+#include "testlib.h"
+
+TEST_DEF(test_json_columns, columns_extract) {
+	const char *buffer = "[{\"ts\": 1700000000, \"v\": 1.5, \"host\": \"a\\u0062c\", \"meta\": {\"dc\": \"eu\", \"rack\": 7}},\n"
+						 " {\"v\": null, \"host\": \"d\", \"ts\": 1.5, \"extra\": [1, {\"ts\": 3}], \"meta\": {\"dc\": 1}},\n"
+						 " {\"host\": \"\", \"ts\": -9223372036854775808, \"v\": 2e3, \"meta\": null, \"ho\\u0073t\": \"x\"},\n"
+						 " {\"ts\": 9223372036854775808, \"v\": \"3\", \"meta\": {\"meta\": {\"dc\": \"no\"}, \"dc\": \"us\"}}]";
+	json_column_t columns[] = {
+		{.path = "ts", .type = JSON_COLUMN_TYPE_INT64},
+		{.path = "v", .type = JSON_COLUMN_TYPE_NUMBER},
+		{.path = "host", .type = JSON_COLUMN_TYPE_STRING},
+		{.path = "meta.dc", .type = JSON_COLUMN_TYPE_STRING},
+		{.path = "meta.rack", .type = JSON_COLUMN_TYPE_NUMBER},
+	};
+	size_t num_rows = 0;
+	json_error_t error = {0};
+	TEST_ASSERT_EQ_U8(json_extract_columns(buffer, strlen(buffer), NULL, columns, 5, &num_rows, &error), JSON_RETVAL_OK);
+	TEST_ASSERT_EQ_U64(num_rows, 4);
+
+	// Integers that do not fit or have a fraction are null
+	TEST_EXPECT(columns[0].integers[0] == 1700000000 && !json_column_is_null(&columns[0], 0));
+	TEST_EXPECT(json_column_is_null(&columns[0], 1));
+	TEST_EXPECT(columns[0].integers[2] == INT64_MIN && !json_column_is_null(&columns[0], 2));
+	TEST_EXPECT(json_column_is_null(&columns[0], 3));
+	TEST_EXPECT_EQ_U64(columns[0].num_nulls, 2);
+
+	TEST_EXPECT_EQ_DOUBLE(columns[1].numbers[0], 1.5);
+	TEST_EXPECT(json_column_is_null(&columns[1], 1) && json_column_is_null(&columns[1], 3));
+	TEST_EXPECT_EQ_DOUBLE(columns[1].numbers[2], 2000);
+
+	// Strings are unescaped into one blob, an escaped key matches too but the first member wins
+	TEST_EXPECT_EQ_U64(columns[2].strings_length, 4);
+	TEST_EXPECT_EQ_STRING(columns[2].strings, "abcd", 4);
+	TEST_EXPECT(columns[2].string_offsets[0] == 0 && columns[2].string_offsets[1] == 3);
+	TEST_EXPECT(columns[2].string_offsets[2] == 4 && columns[2].string_offsets[3] == 4 && columns[2].string_offsets[4] == 4);
+	TEST_EXPECT(!json_column_is_null(&columns[2], 2) && json_column_is_null(&columns[2], 3));
+
+	// Nested paths only match the object they name
+	TEST_EXPECT_EQ_U64(columns[3].strings_length, 4);
+	TEST_EXPECT_EQ_STRING(columns[3].strings, "euus", 4);
+	TEST_EXPECT(columns[3].string_offsets[3] == 2 && columns[3].string_offsets[4] == 4);
+	TEST_EXPECT(json_column_is_null(&columns[3], 1) && json_column_is_null(&columns[3], 2));
+	TEST_EXPECT_EQ_DOUBLE(columns[4].numbers[0], 7);
+	TEST_EXPECT_EQ_U64(columns[4].num_nulls, 3);
+
+	json_columns_free(columns, 5);
+	TEST_EXPECT(columns[0].integers == NULL && columns[0].path != NULL);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+TEST_DEF(test_json_columns, columns_array_path) {
+	// Enough rows to grow the columns several times
+	const size_t num_expected = 10000;
+	char *buffer = malloc(num_expected * 48 + 128);
+	TEST_ASSERT_NOT_NULL(buffer);
+	g_current_test.allocated_memory[g_current_test.allocated_memory_count++] = buffer;
+	size_t size = sprintf(buffer, "{\"skip\": {\"rows\": [{\"v\": -1}]}, \"data\": {\"rows\": [");
+	for (size_t i = 0; i < num_expected; i++) {
+		size += sprintf(&buffer[size], "%s{\"id\": %lu, \"name\": \"n%lu\"}", i > 0 ? ", " : "", i, i % 10);
+	}
+	size += sprintf(&buffer[size], "]}, \"data\": {\"rows\": []}}");
+
+	json_column_t columns[] = {
+		{.path = "id", .type = JSON_COLUMN_TYPE_NUMBER},
+		{.path = "name", .type = JSON_COLUMN_TYPE_STRING},
+	};
+	size_t num_rows = 0;
+	TEST_ASSERT_EQ_U8(json_extract_columns(buffer, size, "data.rows", columns, 2, &num_rows, NULL), JSON_RETVAL_OK);
+	TEST_ASSERT_EQ_U64(num_rows, num_expected);
+	bool equal = true;
+	for (size_t i = 0; i < num_expected; i++) {
+		uint64_t offset = columns[1].string_offsets[i];
+		equal = equal && columns[0].numbers[i] == (double) i && columns[1].string_offsets[i + 1] - offset == 2 &&
+				columns[1].strings[offset + 1] == (char) ('0' + i % 10);
+	}
+	TEST_EXPECT(equal);
+	TEST_EXPECT(columns[0].num_nulls == 0 && columns[1].num_nulls == 0);
+	json_columns_free(columns, 2);
+
+	// A missing array has no rows, an empty one neither
+	TEST_EXPECT_EQ_U8(json_extract_columns(buffer, size, "none", columns, 2, &num_rows, NULL), JSON_RETVAL_OK);
+	TEST_EXPECT_EQ_U64(num_rows, 0);
+	TEST_EXPECT_EQ_U8(json_extract_columns("[]", 2, NULL, columns, 2, &num_rows, NULL), JSON_RETVAL_OK);
+	TEST_EXPECT_EQ_U64(num_rows, 0);
+	TEST_EXPECT(columns[0].numbers == NULL && columns[1].string_offsets == NULL);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+TEST_DEF(test_json_columns, columns_errors) {
+	const struct {
+		const char* p_data;
+		const char* array_path;
+		json_error_code_t code;
+		uint64_t offset;
+	} cases[] = {
+		{"[{\"a\": 1}, 2]", NULL, JSON_ERROR_UNEXPECTED_TOKEN, 11},
+		{"{\"a\": 1}", NULL, JSON_ERROR_UNEXPECTED_TOKEN, 0},
+		{"[{\"a\": 1} {\"a\": 2}]", NULL, JSON_ERROR_UNEXPECTED_TOKEN, 10},
+		{"[{\"a\": 1, \"b\": [1, }]", NULL, JSON_ERROR_UNEXPECTED_TOKEN, 19},
+		{"[{\"a\": 1}", NULL, JSON_ERROR_UNEXPECTED_EOF, 9},
+		{"[{\"a\": 1}] x", NULL, JSON_ERROR_UNEXPECTED_TOKEN, 11},
+		{"[{\"a\": 01}]", NULL, JSON_ERROR_UNEXPECTED_TOKEN, 8},
+		{"{\"rows\": 1}", "rows", JSON_ERROR_UNEXPECTED_TOKEN, 9},
+		{"[]", "rows", JSON_ERROR_UNEXPECTED_TOKEN, 0},
+	};
+
+	for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+		json_column_t column = {.path = "a", .type = JSON_COLUMN_TYPE_NUMBER};
+		json_error_t error = {0};
+		size_t num_rows = 1;
+		json_ret_code_t ret = json_extract_columns(cases[i].p_data, strlen(cases[i].p_data), cases[i].array_path, &column, 1,
+												   &num_rows, &error);
+		if (ret == JSON_RETVAL_OK || error.code != cases[i].code || error.offset != cases[i].offset || num_rows != 0 ||
+			column.numbers != NULL) {
+			TEST_FAIL_WITH_MSG("Case %lu: got %u/%u at %lu, expected error %u at %lu", i, ret, error.code, error.offset,
+							   cases[i].code, cases[i].offset);
+		}
+	}
+
+	json_column_t column = {.path = NULL};
+	TEST_EXPECT_EQ_U8(json_extract_columns("[]", 2, NULL, &column, 1, NULL, NULL), JSON_RETVAL_INVALID_PARAM);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+int test_json_columns() {
+	TEST_GROUP_REG(test_json_columns);
+	TEST_REG(test_json_columns, columns_extract);
+	TEST_REG(test_json_columns, columns_array_path);
+	TEST_REG(test_json_columns, columns_errors);
+	TESTS_RUN();
+}
@@ -0,0 +1,171 @@
+#include <pthread.h>
+#include <string.h>
+#include "test_json.h"
+#include "json.h"
+
+#define LOG_LEVEL    LOG_LEVEL_DEBUG
+#include "testlib.h"
+
+#define TEST_DECODE_NUM_THREADS		4
+
+typedef struct {
+	double lat;
+	double lon;
+} test_decode_position_t;
+
+typedef struct {
+	int64_t id;
+	int32_t seq;
+	char symbol[8];
+	double price;
+	bool is_buy;
+	test_decode_position_t position;
+	char note[4];
+} test_decode_order_t;
+
+JSON_STRUCT_DESC(m_test_decode_position_desc,
+	JSON_STRUCT_FIELD(test_decode_position_t, lat, JSON_FIELD_TYPE_DOUBLE),
+	JSON_STRUCT_FIELD(test_decode_position_t, lon, JSON_FIELD_TYPE_DOUBLE),
+);
+
+JSON_STRUCT_DESC(m_test_decode_order_desc,
+	JSON_STRUCT_FIELD(test_decode_order_t, id, JSON_FIELD_TYPE_INT64),
+	JSON_STRUCT_FIELD(test_decode_order_t, seq, JSON_FIELD_TYPE_INT32),
+	JSON_STRUCT_FIELD(test_decode_order_t, symbol, JSON_FIELD_TYPE_STRING),
+	JSON_STRUCT_FIELD(test_decode_order_t, price, JSON_FIELD_TYPE_DOUBLE),
+	JSON_STRUCT_FIELD_KEY(test_decode_order_t, is_buy, "buy", JSON_FIELD_TYPE_BOOL),
+	JSON_STRUCT_FIELD_OBJECT(test_decode_order_t, position, &m_test_decode_position_desc),
+	JSON_STRUCT_FIELD(test_decode_order_t, note, JSON_FIELD_TYPE_STRING),
+);
+
+static const char *m_test_decode_input =
+		"{\"id\": -9223372036854775808, \"unknown\": {\"a\": [1, {\"b\": [true, null, \"}\"]}], \"c\": -1.5e3},"
+		" \"seq\": 2147483647, \"symbol\": \"AB\\u0043DEFG\", \"price\": 101.25, \"buy\": true,"
+		" \"position\": {\"lon\": 13.5, \"alt\": 3, \"lat\": 52.25}, \"\\u006eote\": null, \"tags\": [\"x\"]}";
+
+TEST_DEF(test_json_decode, decode_struct) {
+	test_decode_order_t order = {.note = "n/a"};
+	json_error_t error;
+	json_ret_code_t ret = json_decode_struct(m_test_decode_input, strlen(m_test_decode_input), &m_test_decode_order_desc, &order,
+											 &error);
+	TEST_ASSERT_EQ_U8(ret, JSON_RETVAL_OK);
+	TEST_EXPECT(order.id == INT64_MIN);
+	TEST_EXPECT(order.seq == INT32_MAX);
+	TEST_EXPECT_EQ_STRING(order.symbol, "ABCDEFG", 8);
+	TEST_EXPECT_EQ_DOUBLE(order.price, 101.25);
+	TEST_EXPECT_TRUE(order.is_buy);
+	TEST_EXPECT_EQ_DOUBLE(order.position.lat, 52.25);
+	TEST_EXPECT_EQ_DOUBLE(order.position.lon, 13.5);
+	// null leaves the field as it was
+	TEST_EXPECT_EQ_STRING(order.note, "n/a", 4);
+
+	// Missing fields are left alone as well, the same struct can be decoded into again
+	const char* update = " {\"price\": 99, \"buy\": false, \"note\": \"\\\"q\\\"\"}\n";
+	TEST_ASSERT_EQ_U8(json_decode_struct(update, strlen(update), &m_test_decode_order_desc, &order, NULL), JSON_RETVAL_OK);
+	TEST_EXPECT_EQ_DOUBLE(order.price, 99);
+	TEST_EXPECT_FALSE(order.is_buy);
+	TEST_EXPECT_EQ_STRING(order.note, "\"q\"", 4);
+	TEST_EXPECT_EQ_STRING(order.symbol, "ABCDEFG", 8);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+TEST_DEF(test_json_decode, decode_errors) {
+	const struct {
+		const char* input;
+		json_error_code_t code;
+		uint64_t offset;
+	} cases[] = {
+		{"", JSON_ERROR_UNEXPECTED_EOF, 0},
+		{"[]", JSON_ERROR_UNEXPECTED_TOKEN, 0},
+		{"{\"id\": 1.5}", JSON_ERROR_UNEXPECTED_TOKEN, 7},
+		{"{\"id\": 9223372036854775808}", JSON_ERROR_UNEXPECTED_TOKEN, 7},
+		{"{\"seq\": -2147483649}", JSON_ERROR_UNEXPECTED_TOKEN, 8},
+		{"{\"id\": \"1\"}", JSON_ERROR_UNEXPECTED_TOKEN, 7},
+		{"{\"price\": true}", JSON_ERROR_UNEXPECTED_TOKEN, 10},
+		{"{\"buy\": 1}", JSON_ERROR_UNEXPECTED_TOKEN, 8},
+		{"{\"position\": [1]}", JSON_ERROR_UNEXPECTED_TOKEN, 13},
+		{"{\"symbol\": \"ABCDEFGH\"}", JSON_ERROR_UNEXPECTED_TOKEN, 11},
+		{"{\"note\": \"\\u0041\\u0042\\u0043\\u0044\"}", JSON_ERROR_UNEXPECTED_TOKEN, 9},
+		{"{\"other\": [1, 2}", JSON_ERROR_UNEXPECTED_TOKEN, 15},
+		{"{\"other\": {\"a\" 1}}", JSON_ERROR_UNEXPECTED_TOKEN, 15},
+		{"{\"other\": tru}", JSON_ERROR_UNEXPECTED_TOKEN, 13},
+		{"{\"id\": 1,}", JSON_ERROR_UNEXPECTED_TOKEN, 9},
+		{"{\"id\": 1} {}", JSON_ERROR_UNEXPECTED_TOKEN, 10},
+		{"{\"position\": {\"lat\": 1", JSON_ERROR_UNEXPECTED_EOF, 22},
+	};
+	for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+		test_decode_order_t order = {0};
+		json_error_t error = {0};
+		json_ret_code_t ret = json_decode_struct(cases[i].input, strlen(cases[i].input), &m_test_decode_order_desc, &order, &error);
+		if (ret == JSON_RETVAL_OK || error.code != cases[i].code || error.offset != cases[i].offset) {
+			TEST_FAIL_WITH_MSG("Input %lu: got %u at %lu", i, error.code, error.offset);
+		}
+	}
+
+	char deep[2 * 1100 + 16];
+	size_t length = (size_t) sprintf(deep, "{\"other\": ");
+	for (size_t i = 0; i < 1100; i++) {
+		deep[length++] = '[';
+	}
+	test_decode_order_t order;
+	json_error_t error;
+	TEST_EXPECT_EQ_U8(json_decode_struct(deep, length, &m_test_decode_order_desc, &order, &error), JSON_RETVAL_FAIL);
+	TEST_EXPECT_EQ_U8(error.code, JSON_ERROR_MAX_NESTING_LEVEL);
+
+	// A field whose size does not match its type is rejected
+	JSON_STRUCT_DESC(bad_desc, JSON_STRUCT_FIELD(test_decode_order_t, seq, JSON_FIELD_TYPE_DOUBLE));
+	TEST_EXPECT_EQ_U8(json_decode_struct("{}", 2, &bad_desc, &order, NULL), JSON_RETVAL_INVALID_PARAM);
+	TEST_EXPECT_EQ_U8(json_decode_struct("{}", 2, NULL, &order, NULL), JSON_RETVAL_INVALID_PARAM);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+typedef struct {
+	json_struct_desc_t* p_desc;
+	size_t num_ok;
+} test_decode_thread_t;
+
+static void* test_decode_thread(void* p_arg) {
+	test_decode_thread_t* p_thread = p_arg;
+	for (size_t i = 0; i < 100; i++) {
+		test_decode_order_t order = {0};
+		if (json_decode_struct(m_test_decode_input, strlen(m_test_decode_input), p_thread->p_desc, &order, NULL) == JSON_RETVAL_OK &&
+			order.position.lat == 52.25) {
+			p_thread->num_ok++;
+		}
+	}
+	return NULL;
+}
+
+TEST_DEF(test_json_decode, decode_threads) {
+	// Threads decoding with a descriptor that was never used compile it once
+	JSON_STRUCT_DESC(position_desc,
+		JSON_STRUCT_FIELD(test_decode_position_t, lat, JSON_FIELD_TYPE_DOUBLE),
+		JSON_STRUCT_FIELD(test_decode_position_t, lon, JSON_FIELD_TYPE_DOUBLE),
+	);
+	JSON_STRUCT_DESC(order_desc,
+		JSON_STRUCT_FIELD(test_decode_order_t, id, JSON_FIELD_TYPE_INT64),
+		JSON_STRUCT_FIELD_OBJECT(test_decode_order_t, position, &position_desc),
+	);
+	test_decode_thread_t threads[TEST_DECODE_NUM_THREADS] = {0};
+	pthread_t thread_ids[TEST_DECODE_NUM_THREADS];
+	for (size_t t = 0; t < TEST_DECODE_NUM_THREADS; t++) {
+		threads[t].p_desc = &order_desc;
+		TEST_ASSERT(pthread_create(&thread_ids[t], NULL, test_decode_thread, &threads[t]) == 0);
+	}
+	for (size_t t = 0; t < TEST_DECODE_NUM_THREADS; t++) {
+		pthread_join(thread_ids[t], NULL);
+		TEST_EXPECT_EQ_U64(threads[t].num_ok, 100);
+	}
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+int test_json_decode() {
+	TEST_GROUP_REG(test_json_decode);
+	TEST_REG(test_json_decode, decode_struct);
+	TEST_REG(test_json_decode, decode_errors);
+	TEST_REG(test_json_decode, decode_threads);
+	TESTS_RUN();
+}
@@ -0,0 +1,150 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "test_json.h"
+#include "json.h"
+
+#define LOG_LEVEL    LOG_LEVEL_DEBUG
+#include "testlib.h"
+
+typedef struct {
+	double x;
+	double y;
+} test_encode_point_t;
+
+typedef struct {
+	int64_t id;
+	int32_t count;
+	bool is_active;
+	char name[12];
+	double ratio;
+	test_encode_point_t origin;
+} test_encode_shape_t;
+
+JSON_STRUCT_DESC(m_test_encode_point_desc,
+	JSON_STRUCT_FIELD(test_encode_point_t, x, JSON_FIELD_TYPE_DOUBLE),
+	JSON_STRUCT_FIELD(test_encode_point_t, y, JSON_FIELD_TYPE_DOUBLE),
+);
+
+JSON_STRUCT_DESC(m_test_encode_shape_desc,
+	JSON_STRUCT_FIELD(test_encode_shape_t, id, JSON_FIELD_TYPE_INT64),
+	JSON_STRUCT_FIELD(test_encode_shape_t, count, JSON_FIELD_TYPE_INT32),
+	JSON_STRUCT_FIELD_KEY(test_encode_shape_t, is_active, "active", JSON_FIELD_TYPE_BOOL),
+	JSON_STRUCT_FIELD(test_encode_shape_t, name, JSON_FIELD_TYPE_STRING),
+	JSON_STRUCT_FIELD(test_encode_shape_t, ratio, JSON_FIELD_TYPE_DOUBLE),
+	JSON_STRUCT_FIELD_OBJECT(test_encode_shape_t, origin, &m_test_encode_point_desc),
+);
+
+typedef struct {
+	char* string;
+	size_t length;
+	size_t num_writes;
+	size_t fail_after;		// Fails the write after this many, 0 never fails
+} test_encode_sink_t;
+
+static json_ret_code_t test_encode_sink(const char* p_data, size_t length, void* p_context) {
+	test_encode_sink_t* p_sink = p_context;
+	if (p_sink->fail_after > 0 && p_sink->num_writes == p_sink->fail_after) {
+		return JSON_RETVAL_FAIL;
+	}
+	char* string = realloc(p_sink->string, p_sink->length + length + 1);
+	if (string == NULL) {
+		return JSON_RETVAL_FAIL;
+	}
+	memcpy(&string[p_sink->length], p_data, length);
+	p_sink->string = string;
+	p_sink->length += length;
+	p_sink->string[p_sink->length] = '\0';
+	p_sink->num_writes++;
+	return JSON_RETVAL_OK;
+}
+
+TEST_DEF(test_json_encode, encode_struct) {
+	test_encode_shape_t shape = {
+		.id = INT64_MIN, .count = -7, .is_active = true, .name = "circle", .ratio = 0.1, .origin = {.x = 2, .y = -1.5e-7},
+	};
+	test_encode_sink_t sink = {0};
+	TEST_ASSERT_EQ_U8(json_encode_struct(&m_test_encode_shape_desc, &shape, test_encode_sink, &sink), JSON_RETVAL_OK);
+	const char* expected = "{\"id\":-9223372036854775808,\"count\":-7,\"active\":true,\"name\":\"circle\",\"ratio\":0.1,"
+						   "\"origin\":{\"x\":2,\"y\":-1.5e-07}}";
+	TEST_EXPECT_EQ_U64(sink.length, strlen(expected));
+	TEST_EXPECT_EQ_STRING(sink.string, expected, strlen(expected) + 1);
+	TEST_EXPECT_EQ_U64(sink.num_writes, 1);
+
+	// Decoding the output gives back the struct, doubles are written with enough digits to read back exactly
+	shape.ratio = 1.0 / 3.0;
+	shape.origin.x = 1e300;
+	free(sink.string);
+	sink = (test_encode_sink_t) {0};
+	TEST_ASSERT_EQ_U8(json_encode_struct(&m_test_encode_shape_desc, &shape, test_encode_sink, &sink), JSON_RETVAL_OK);
+	test_encode_shape_t decoded = {0};
+	TEST_ASSERT_EQ_U8(json_decode_struct(sink.string, sink.length, &m_test_encode_shape_desc, &decoded, NULL), JSON_RETVAL_OK);
+	TEST_EXPECT(decoded.id == shape.id && decoded.count == shape.count);
+	TEST_EXPECT(decoded.is_active && strcmp(decoded.name, shape.name) == 0);
+	TEST_EXPECT(strtod(strstr(sink.string, "\"ratio\":") + 8, NULL) == shape.ratio);
+	TEST_EXPECT(strtod(strstr(sink.string, "\"x\":") + 4, NULL) == shape.origin.x);
+	free(sink.string);
+
+	// Values JSON cannot represent are written as null
+	shape.ratio = NAN;
+	sink = (test_encode_sink_t) {0};
+	TEST_ASSERT_EQ_U8(json_encode_struct(&m_test_encode_shape_desc, &shape, test_encode_sink, &sink), JSON_RETVAL_OK);
+	TEST_EXPECT(strstr(sink.string, "\"ratio\":null,") != NULL);
+	free(sink.string);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+TEST_DEF(test_json_encode, encode_strings) {
+	typedef struct {
+		char text[8192];
+		char tail[4];
+	} test_encode_text_t;
+	JSON_STRUCT_DESC(text_desc,
+		JSON_STRUCT_FIELD(test_encode_text_t, text, JSON_FIELD_TYPE_STRING),
+		JSON_STRUCT_FIELD(test_encode_text_t, tail, JSON_FIELD_TYPE_STRING),
+	);
+	test_encode_text_t* p_text = calloc(1, sizeof(test_encode_text_t));
+	TEST_ASSERT_NOT_NULL(p_text);
+	strcpy(p_text->text, "q\"b\\n\n\t\x01/");
+	// A full array has no terminator
+	memcpy(p_text->tail, "abcd", 4);
+
+	test_encode_sink_t sink = {0};
+	TEST_ASSERT_EQ_U8(json_encode_struct(&text_desc, p_text, test_encode_sink, &sink), JSON_RETVAL_OK);
+	const char* expected = "{\"text\":\"q\\\"b\\\\n\\n\\t\\u0001/\",\"tail\":\"abcd\"}";
+	TEST_EXPECT_EQ_STRING(sink.string, expected, strlen(expected) + 1);
+	free(sink.string);
+
+	// Output longer than the buffer is written in parts, a failing sink stops the encoding
+	memset(p_text->text, 'x', sizeof(p_text->text) - 1);
+	sink = (test_encode_sink_t) {0};
+	TEST_ASSERT_EQ_U8(json_encode_struct(&text_desc, p_text, test_encode_sink, &sink), JSON_RETVAL_OK);
+	TEST_EXPECT_EQ_U64(sink.length, sizeof(p_text->text) - 1 + strlen("{\"text\":\"\",\"tail\":\"abcd\"}"));
+	TEST_EXPECT(sink.num_writes > 1);
+	json_object_t object;
+	TEST_EXPECT_EQ_U8(json_parse(sink.string, sink.length, &object), JSON_RETVAL_OK);
+	json_object_free(&object);
+	free(sink.string);
+
+	sink = (test_encode_sink_t) {.fail_after = 1};
+	TEST_EXPECT_EQ_U8(json_encode_struct(&text_desc, p_text, test_encode_sink, &sink), JSON_RETVAL_FAIL);
+	TEST_EXPECT_EQ_U64(sink.num_writes, 1);
+	free(sink.string);
+	free(p_text);
+
+	// Keys are written as given, so keys that need escaping are rejected
+	JSON_STRUCT_DESC(bad_desc, JSON_STRUCT_FIELD_KEY(test_encode_point_t, x, "a\"b", JSON_FIELD_TYPE_DOUBLE));
+	test_encode_point_t point = {0};
+	TEST_EXPECT_EQ_U8(json_encode_struct(&bad_desc, &point, test_encode_sink, &sink), JSON_RETVAL_INVALID_PARAM);
+	TEST_EXPECT_EQ_U8(json_encode_struct(&m_test_encode_point_desc, &point, NULL, NULL), JSON_RETVAL_INVALID_PARAM);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+int test_json_encode() {
+	TEST_GROUP_REG(test_json_encode);
+	TEST_REG(test_json_encode, encode_struct);
+	TEST_REG(test_json_encode, encode_strings);
+	TESTS_RUN();
+}
@@ -0,0 +1,73 @@
+#include <string.h>
+#include "test_json.h"
+#include "json.h"
+
+#define LOG_LEVEL    LOG_LEVEL_DEBUG
+#include "testlib.h"
+
+TEST_DEF(test_json_file, parse_file) {
+	json_document_t document;
+	json_error_t error;
+	TEST_ASSERT_EQ_U8(json_parse_file("tests/files/complete.json", &document, &error), JSON_RETVAL_OK);
+
+	json_value_t *glossary = json_object_get_value(&document.root, "glossary");
+	TEST_ASSERT_NOT_NULL(glossary);
+	json_value_t *title = json_object_get_value(glossary->object, "title");
+	TEST_ASSERT_NOT_NULL(title);
+	TEST_EXPECT_EQ_STRING(title->string, "example glossary", strlen("example glossary"));
+	json_value_t *num_array = json_object_get_value(&document.root, "testNumArray");
+	TEST_ASSERT_NOT_NULL(num_array);
+	TEST_EXPECT_EQ_U32(num_array->array->length, 3);
+
+	TEST_EXPECT_EQ_U8(json_document_free(&document), JSON_RETVAL_OK);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+TEST_DEF(test_json_file, parse_file_escaped) {
+	json_document_t document;
+	json_error_t error;
+	TEST_ASSERT_EQ_U8(json_parse_file("tests/files/escaped.json", &document, &error), JSON_RETVAL_OK);
+
+	// Keys and values are unescaped into their own copies, the mapping is gone after parsing
+	json_value_t *text = json_object_get_value(&document.root, "text");
+	TEST_ASSERT_NOT_NULL(text);
+	TEST_EXPECT_EQ_STRING(text->string, "line\nbreak \"quoted\" A", strlen("line\nbreak \"quoted\" A") + 1);
+	json_value_t *plain = json_object_get_value(&document.root, "plain");
+	TEST_ASSERT_NOT_NULL(plain);
+	TEST_EXPECT_EQ_STRING(plain->string, "abc", strlen("abc") + 1);
+	json_value_t *list = json_object_get_value(&document.root, "list");
+	TEST_ASSERT_NOT_NULL(list);
+	TEST_EXPECT_EQ_STRING(json_value_get_array_member(list, 0)->string, "x\ty", strlen("x\ty") + 1);
+
+	TEST_EXPECT_EQ_U8(json_document_free(&document), JSON_RETVAL_OK);
+
+	// The file itself is unchanged
+	TEST_READ_FILE(buffer, "tests/files/escaped.json");
+	TEST_EXPECT(strstr(buffer, "\"line\\nbreak \\\"quoted\\\" \\u0041\"") != NULL);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+TEST_DEF(test_json_file, parse_file_error) {
+	json_document_t document;
+	json_error_t error;
+	TEST_EXPECT_EQ_U8(json_parse_file("tests/files/missing.json", &document, &error), JSON_RETVAL_FAIL);
+	TEST_EXPECT_EQ_U8(error.code, JSON_ERROR_FILE_ACCESS);
+
+	// A failed parse releases the mapping and everything parsed so far
+	TEST_EXPECT_EQ_U8(json_parse_file("tests/files/truncated.json", &document, &error), JSON_RETVAL_FAIL);
+	TEST_EXPECT_EQ_U8(error.code, JSON_ERROR_UNEXPECTED_EOF);
+	TEST_EXPECT_EQ_U64(error.offset, 30);
+	TEST_EXPECT_EQ_U32(document.root.num_members, 0);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+int test_json_file() {
+	TEST_GROUP_REG(test_json_file);
+	TEST_REG(test_json_file, parse_file);
+	TEST_REG(test_json_file, parse_file_escaped);
+	TEST_REG(test_json_file, parse_file_error);
+	TESTS_RUN();
+}
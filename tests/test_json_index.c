@@ -0,0 +1,193 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "test_json.h"
+#include "json.h"
+
+#define LOG_LEVEL    LOG_LEVEL_DEBUG
+#include "testlib.h"
+
+#define TEST_INDEX_NUM_ROWS		1000
+
+static const char *m_test_index_document =
+		"{\"users\": {\"u0\": {\"id\": 10, \"name\": \"ann\"}, \"u1\": {\"name\": \"bob\", \"id\": 11}, \"u2\": {\"id\": \"x\"},"
+		" \"u3\": {\"other\": 1}, \"u4\": 5, \"u5\": {\"id\": -0, \"name\": \"cy\"}, \"u6\": {\"id\": true}}}";
+
+// Array of objects {"id": i, "name": "row i"} in the root under "rows", the parser does not build arrays of objects
+static json_value_t* test_index_build_rows(json_object_t* p_root, size_t num_rows) {
+	json_array_t* p_array = calloc(1, sizeof(json_array_t));
+	json_array_member_t* values = calloc(num_rows, sizeof(json_array_member_t));
+	if (p_array == NULL || values == NULL) {
+		free(p_array);
+		free(values);
+		return NULL;
+	}
+	*p_array = (json_array_t) {.values = values, .length = num_rows, .max_length = num_rows};
+	*p_root = (json_object_t) {0};
+	json_object_add_value(p_root, "rows", (json_value_t) {.array = p_array}, JSON_VALUE_TYPE_ARRAY);
+	char name[32];
+	for (size_t i = 0; i < num_rows; i++) {
+		json_object_t* p_row = calloc(1, sizeof(json_object_t));
+		values[i] = (json_array_member_t) {.value.object = p_row, .type = JSON_VALUE_TYPE_OBJECT};
+		if (p_row == NULL) {
+			return NULL;
+		}
+		sprintf(name, "row %04lu", i);
+		json_object_add_value(p_row, "id", (json_value_t) {.number = (double) i}, JSON_VALUE_TYPE_NUMBER);
+		json_object_add_value(p_row, "name", (json_value_t) {.string = strdup(name)}, JSON_VALUE_TYPE_STRING);
+	}
+	return json_object_get_value(p_root, "rows");
+}
+
+TEST_DEF(test_json_index, index_lookup) {
+	json_object_t object;
+	TEST_ASSERT_EQ_U8(json_parse(m_test_index_document, strlen(m_test_index_document), &object), JSON_RETVAL_OK);
+	json_value_t* p_users = json_object_get_value(&object, "users");
+	json_object_t* p_u1 = json_object_get_value(p_users->object, "u1")->object;
+	json_object_t* p_u5 = json_object_get_value(p_users->object, "u5")->object;
+
+	const json_index_type_t types[] = {JSON_INDEX_TYPE_HASH, JSON_INDEX_TYPE_SORTED};
+	for (size_t i = 0; i < 2; i++) {
+		json_index_t* p_by_id = json_index_new(p_users, JSON_VALUE_TYPE_OBJECT, "id", types[i]);
+		json_index_t* p_by_name = json_index_new(p_users, JSON_VALUE_TYPE_OBJECT, "name", types[i]);
+		TEST_ASSERT_NOT_NULL(p_by_id);
+		TEST_ASSERT_NOT_NULL(p_by_name);
+		TEST_EXPECT(json_index_find(p_by_id, (json_value_t) {.number = 11}, JSON_VALUE_TYPE_NUMBER) == p_u1);
+		TEST_EXPECT(json_index_find(p_by_id, (json_value_t) {.number = 0}, JSON_VALUE_TYPE_NUMBER) == p_u5);
+		TEST_EXPECT(json_index_find(p_by_id, (json_value_t) {.string = "x"}, JSON_VALUE_TYPE_STRING) != NULL);
+		TEST_EXPECT(json_index_find(p_by_id, (json_value_t) {.number = 12}, JSON_VALUE_TYPE_NUMBER) == NULL);
+		TEST_EXPECT(json_index_find(p_by_id, (json_value_t) {.string = "11"}, JSON_VALUE_TYPE_STRING) == NULL);
+		TEST_EXPECT(json_index_find(p_by_id, (json_value_t) {.boolean = true}, JSON_VALUE_TYPE_BOOLEAN) == NULL);
+		TEST_EXPECT(json_index_find(p_by_name, (json_value_t) {.string = "bob"}, JSON_VALUE_TYPE_STRING) == p_u1);
+		TEST_EXPECT(json_index_find(p_by_name, (json_value_t) {.string = "bo"}, JSON_VALUE_TYPE_STRING) == NULL);
+		json_index_free(p_by_id);
+		json_index_free(p_by_name);
+	}
+
+	TEST_EXPECT(json_index_new(p_users, JSON_VALUE_TYPE_STRING, "id", JSON_INDEX_TYPE_HASH) == NULL);
+	TEST_EXPECT(json_index_new(p_users, JSON_VALUE_TYPE_OBJECT, NULL, JSON_INDEX_TYPE_HASH) == NULL);
+	TEST_EXPECT(json_index_find(NULL, (json_value_t) {.number = 1}, JSON_VALUE_TYPE_NUMBER) == NULL);
+	json_object_free(&object);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+TEST_DEF(test_json_index, index_range) {
+	json_object_t root;
+	json_value_t* p_rows = test_index_build_rows(&root, TEST_INDEX_NUM_ROWS);
+	TEST_ASSERT_NOT_NULL(p_rows);
+	json_index_t* p_by_id = json_index_new(p_rows, JSON_VALUE_TYPE_ARRAY, "id", JSON_INDEX_TYPE_SORTED);
+	json_index_t* p_by_name = json_index_new(p_rows, JSON_VALUE_TYPE_ARRAY, "name", JSON_INDEX_TYPE_SORTED);
+	json_index_t* p_hash = json_index_new(p_rows, JSON_VALUE_TYPE_ARRAY, "id", JSON_INDEX_TYPE_HASH);
+	TEST_ASSERT_NOT_NULL(p_by_id);
+	TEST_ASSERT_NOT_NULL(p_by_name);
+	TEST_ASSERT_NOT_NULL(p_hash);
+
+	for (size_t i = 0; i < TEST_INDEX_NUM_ROWS; i += 7) {
+		json_object_t* p_row = p_rows->array->values[i].value.object;
+		json_value_t key = {.number = (double) i};
+		if (json_index_find(p_by_id, key, JSON_VALUE_TYPE_NUMBER) != p_row || json_index_find(p_hash, key, JSON_VALUE_TYPE_NUMBER) != p_row) {
+			TEST_FAIL_WITH_MSG("Row %lu not found", i);
+		}
+	}
+
+	// Bounds are inclusive and need not be keys, rows come in key order
+	json_object_t* rows[TEST_INDEX_NUM_ROWS];
+	size_t num_rows = json_index_range(p_by_id, (json_value_t) {.number = 99.5}, (json_value_t) {.number = 200},
+									   JSON_VALUE_TYPE_NUMBER, rows, TEST_INDEX_NUM_ROWS);
+	TEST_ASSERT_EQ_U64(num_rows, 101);
+	for (size_t i = 0; i < num_rows; i++) {
+		if (rows[i] != p_rows->array->values[100 + i].value.object) {
+			TEST_FAIL_WITH_MSG("Row %lu out of order", i);
+		}
+	}
+	num_rows = json_index_range(p_by_name, (json_value_t) {.string = "row 0990"}, (json_value_t) {.string = "row 1"},
+								JSON_VALUE_TYPE_STRING, rows, 4);
+	TEST_EXPECT_EQ_U64(num_rows, 10);
+	TEST_EXPECT(rows[3] == p_rows->array->values[993].value.object);
+	TEST_EXPECT_EQ_U64(json_index_range(p_by_id, (json_value_t) {.number = 5}, (json_value_t) {.number = 4},
+										JSON_VALUE_TYPE_NUMBER, NULL, 0), 0);
+	TEST_EXPECT_EQ_U64(json_index_range(p_by_id, (json_value_t) {.string = "a"}, (json_value_t) {.string = "z"},
+										JSON_VALUE_TYPE_STRING, NULL, 0), 0);
+	// Hash indices do not support range scans
+	TEST_EXPECT_EQ_U64(json_index_range(p_hash, (json_value_t) {.number = 0}, (json_value_t) {.number = 10},
+										JSON_VALUE_TYPE_NUMBER, NULL, 0), 0);
+
+	json_index_free(p_by_id);
+	json_index_free(p_by_name);
+	json_index_free(p_hash);
+	json_object_free(&root);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+TEST_DEF(test_json_index, index_mutation) {
+	json_object_t object;
+	TEST_ASSERT_EQ_U8(json_parse(m_test_index_document, strlen(m_test_index_document), &object), JSON_RETVAL_OK);
+	json_value_t* p_users = json_object_get_value(&object, "users");
+	json_object_t* p_u3 = json_object_get_value(p_users->object, "u3")->object;
+
+	const json_index_type_t types[] = {JSON_INDEX_TYPE_HASH, JSON_INDEX_TYPE_SORTED};
+	json_index_t* indices[2];
+	for (size_t i = 0; i < 2; i++) {
+		indices[i] = json_index_new(p_users, JSON_VALUE_TYPE_OBJECT, "id", types[i]);
+		TEST_ASSERT_NOT_NULL(indices[i]);
+	}
+
+	// Rows added to the container and fields added to rows are found without a rebuild
+	char key[16];
+	for (uint32_t i = 0; i < 200; i++) {
+		json_object_t* p_row = calloc(1, sizeof(json_object_t));
+		TEST_ASSERT_NOT_NULL(p_row);
+		json_object_add_value(p_row, "id", (json_value_t) {.number = 1000 + i}, JSON_VALUE_TYPE_NUMBER);
+		sprintf(key, "new %u", i);
+		json_object_add_value(p_users->object, key, (json_value_t) {.object = p_row}, JSON_VALUE_TYPE_OBJECT);
+	}
+	json_object_add_value(p_u3, "id", (json_value_t) {.number = 42}, JSON_VALUE_TYPE_NUMBER);
+	for (size_t i = 0; i < 2; i++) {
+		TEST_EXPECT(json_index_find(indices[i], (json_value_t) {.number = 42}, JSON_VALUE_TYPE_NUMBER) == p_u3);
+		json_object_t* p_row = json_index_find(indices[i], (json_value_t) {.number = 1199}, JSON_VALUE_TYPE_NUMBER);
+		TEST_EXPECT(p_row != NULL && p_row == json_object_get_value(p_users->object, "new 199")->object);
+	}
+	// The indexed field keeps its position while the row grows
+	for (uint32_t i = 0; i < 40; i++) {
+		sprintf(key, "extra %u", i);
+		json_object_add_value(p_u3, key, (json_value_t) {.string = strdup("v")}, JSON_VALUE_TYPE_STRING);
+	}
+	TEST_EXPECT(json_index_find(indices[0], (json_value_t) {.number = 42}, JSON_VALUE_TYPE_NUMBER) == p_u3);
+
+	// Values changed in place are picked up by a rebuild
+	json_object_get_value(p_u3, "id")->number = 43;
+	for (size_t i = 0; i < 2; i++) {
+		TEST_EXPECT_EQ_U8(json_index_rebuild(indices[i]), JSON_RETVAL_OK);
+		TEST_EXPECT(json_index_find(indices[i], (json_value_t) {.number = 42}, JSON_VALUE_TYPE_NUMBER) == NULL);
+		TEST_EXPECT(json_index_find(indices[i], (json_value_t) {.number = 43}, JSON_VALUE_TYPE_NUMBER) == p_u3);
+		json_index_free(indices[i]);
+	}
+	json_object_free(&object);
+
+	// A container that shrank is indexed again
+	json_object_t root;
+	json_value_t* p_rows = test_index_build_rows(&root, 10);
+	TEST_ASSERT_NOT_NULL(p_rows);
+	json_index_t* p_index = json_index_new(p_rows, JSON_VALUE_TYPE_ARRAY, "id", JSON_INDEX_TYPE_HASH);
+	TEST_ASSERT_NOT_NULL(p_index);
+	json_array_member_t last = p_rows->array->values[9];
+	p_rows->array->length = 9;
+	TEST_EXPECT(json_index_find(p_index, (json_value_t) {.number = 9}, JSON_VALUE_TYPE_NUMBER) == NULL);
+	TEST_EXPECT(json_index_find(p_index, (json_value_t) {.number = 8}, JSON_VALUE_TYPE_NUMBER) != NULL);
+	p_rows->array->values[9] = last;
+	p_rows->array->length = 10;
+	json_index_free(p_index);
+	json_object_free(&root);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+int test_json_index() {
+	TEST_GROUP_REG(test_json_index);
+	TEST_REG(test_json_index, index_lookup);
+	TEST_REG(test_json_index, index_range);
+	TEST_REG(test_json_index, index_mutation);
+	TESTS_RUN();
+}
@@ -0,0 +1,145 @@
+#include <string.h>
+#include <stdio.h>
+#include <pthread.h>
+#include "test_json.h"
+#include "json.h"
+
+#define LOG_LEVEL    LOG_LEVEL_DEBUG
+#include "testlib.h"
+
+#define TEST_KEY_POOL_NUM_THREADS	4
+#define TEST_KEY_POOL_NUM_KEYS		2000
+
+TEST_DEF(test_json_key_pool, key_pool_intern) {
+	json_key_pool_t* p_pool = json_key_pool_new();
+	TEST_ASSERT(p_pool != NULL);
+
+	char key[32];
+	const char* interned[TEST_KEY_POOL_NUM_KEYS];
+	for (size_t i = 0; i < TEST_KEY_POOL_NUM_KEYS; i++) {
+		size_t length = sprintf(key, "key_%lu", i);
+		interned[i] = json_key_pool_intern(p_pool, key, length);
+		TEST_ASSERT(interned[i] != NULL && interned[i] != key);
+		TEST_EXPECT_EQ_STRING(interned[i], key, length + 1);
+	}
+	TEST_EXPECT(json_key_pool_get_num_keys(p_pool) == TEST_KEY_POOL_NUM_KEYS);
+
+	// Equal keys map to the same pointer, also after the table has grown
+	for (size_t i = 0; i < TEST_KEY_POOL_NUM_KEYS; i++) {
+		size_t length = sprintf(key, "key_%lu", i);
+		TEST_EXPECT(json_key_pool_intern(p_pool, key, length) == interned[i]);
+	}
+	TEST_EXPECT(json_key_pool_get_num_keys(p_pool) == TEST_KEY_POOL_NUM_KEYS);
+
+	// Only length bytes are part of the key
+	TEST_EXPECT(json_key_pool_intern(p_pool, "key_12345", 5) == interned[1]);
+	TEST_EXPECT(json_key_pool_intern(p_pool, "", 0) != NULL);
+	TEST_EXPECT(json_key_pool_intern(NULL, "key", 3) == NULL);
+
+	json_key_pool_free(p_pool);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+TEST_DEF(test_json_key_pool, key_pool_parse) {
+	json_key_pool_t* p_pool = json_key_pool_new();
+	TEST_ASSERT(p_pool != NULL);
+
+	const char* buffers[] = {
+		"{\"id\": 1, \"name\": \"first\", \"a_rather_long_key_name\": true, \"nested\": {\"id\": 2}}",
+		"{\"name\": \"second\", \"id\": 3, \"a_rather_long_key_name\": [1, 2], \"esc\\u0061ped\": \"x\"}",
+	};
+	json_object_t objects[2];
+	for (size_t i = 0; i < 2; i++) {
+		TEST_ASSERT(json_parse_interned(buffers[i], strlen(buffers[i]), &objects[i], p_pool, NULL) == JSON_RETVAL_OK);
+	}
+
+	// Both documents share one copy of every key
+	const char* id = json_key_pool_intern(p_pool, "id", 2);
+	const char* long_key = json_key_pool_intern(p_pool, "a_rather_long_key_name", 22);
+	TEST_EXPECT(json_key_pool_get_num_keys(p_pool) == 5);
+	TEST_EXPECT(objects[0].members[0].key == id && objects[1].members[1].key == id);
+	TEST_EXPECT(objects[0].members[2].key == long_key && objects[1].members[2].key == long_key);
+	TEST_EXPECT(objects[0].members[3].value.object->members[0].key == id);
+	TEST_EXPECT_EQ_STRING(objects[1].members[3].key, "escaped", 8);
+	TEST_EXPECT(objects[1].members[3].key == json_key_pool_intern(p_pool, "escaped", 7));
+
+	// Lookups by interned key compare addresses, plain lookups still work
+	json_value_t* p_value = json_object_get_value_interned(&objects[1], id);
+	TEST_ASSERT(p_value != NULL);
+	TEST_EXPECT(p_value->number == 3);
+	TEST_EXPECT(json_object_get_value_interned(&objects[1], "id") == NULL);
+	TEST_EXPECT(json_object_get_value(&objects[1], "id") == p_value);
+	TEST_EXPECT_EQ_STRING(json_object_get_value(&objects[0], "name")->string, "first", 6);
+
+	// Keys added afterwards are owned by the document
+	TEST_ASSERT(json_object_add_value(&objects[0], "added", (json_value_t) {.number = 4}, JSON_VALUE_TYPE_NUMBER) == JSON_RETVAL_OK);
+	TEST_EXPECT(json_object_get_value(&objects[0], "added")->number == 4);
+
+	char* string = json_stringify(&objects[1]);
+	TEST_ASSERT(string != NULL);
+	TEST_EXPECT_EQ_STRING(string, "{\"name\":\"second\",\"id\":3.000000,\"a_rather_long_key_name\":[1.000000,2.000000],\"escaped\":\"x\"}",
+						  strlen(string) + 1);
+	free(string);
+
+	json_object_free(&objects[0]);
+	json_object_free(&objects[1]);
+	TEST_EXPECT(json_key_pool_get_num_keys(p_pool) == 5);
+	json_key_pool_free(p_pool);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+typedef struct {
+	json_key_pool_t* p_pool;
+	size_t offset;
+	const char* interned[TEST_KEY_POOL_NUM_KEYS];
+} test_key_pool_thread_t;
+
+// Every thread interns the same keys in a different order
+static void* test_key_pool_thread(void* p_arg) {
+	test_key_pool_thread_t* p_thread = p_arg;
+	char key[32];
+	for (size_t n = 0; n < TEST_KEY_POOL_NUM_KEYS; n++) {
+		size_t i = (n + p_thread->offset) % TEST_KEY_POOL_NUM_KEYS;
+		size_t length = sprintf(key, "key_%lu", i);
+		p_thread->interned[i] = json_key_pool_intern(p_thread->p_pool, key, length);
+	}
+	return NULL;
+}
+
+TEST_DEF(test_json_key_pool, key_pool_threads) {
+	json_key_pool_t* p_pool = json_key_pool_new();
+	TEST_ASSERT(p_pool != NULL);
+
+	static test_key_pool_thread_t threads[TEST_KEY_POOL_NUM_THREADS];
+	pthread_t thread_ids[TEST_KEY_POOL_NUM_THREADS];
+	for (size_t t = 0; t < TEST_KEY_POOL_NUM_THREADS; t++) {
+		threads[t].p_pool = p_pool;
+		threads[t].offset = t * TEST_KEY_POOL_NUM_KEYS / TEST_KEY_POOL_NUM_THREADS;
+		TEST_ASSERT(pthread_create(&thread_ids[t], NULL, test_key_pool_thread, &threads[t]) == 0);
+	}
+	for (size_t t = 0; t < TEST_KEY_POOL_NUM_THREADS; t++) {
+		pthread_join(thread_ids[t], NULL);
+	}
+
+	TEST_EXPECT(json_key_pool_get_num_keys(p_pool) == TEST_KEY_POOL_NUM_KEYS);
+	for (size_t i = 0; i < TEST_KEY_POOL_NUM_KEYS; i++) {
+		TEST_ASSERT(threads[0].interned[i] != NULL);
+		for (size_t t = 1; t < TEST_KEY_POOL_NUM_THREADS; t++) {
+			TEST_EXPECT(threads[t].interned[i] == threads[0].interned[i]);
+		}
+	}
+
+	json_key_pool_free(p_pool);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+int test_json_key_pool() {
+	TEST_GROUP_REG(test_json_key_pool);
+	TEST_REG(test_json_key_pool, key_pool_intern);
+	TEST_REG(test_json_key_pool, key_pool_parse);
+	TEST_REG(test_json_key_pool, key_pool_threads);
+	TESTS_RUN();
+}
@@ -2,6 +2,7 @@
 // Created by tholz on 02.06.2022.
 //
 
+#include <math.h>
 #include <string.h>
 #include "test_json.h"
 #include "json/json_lex.h"
@@ -246,13 +247,13 @@ TEST_DEF(test_json_parse_number, json_parse_number) {
 	TEST_EXPECT_EQ_U8(json_parse_number(&actual_number, actual_str, strlen(actual_str)), JSON_RETVAL_OK);
 	TEST_EXPECT_EQ_DOUBLE(expected_number, actual_number);
 
-	expected_number = 1.0f;
+	expected_number = 10.0;
 	actual_str = "1.0e+1";
 	actual_number = 0.0f;
 	TEST_EXPECT_EQ_U8(json_parse_number(&actual_number, actual_str, strlen(actual_str)), JSON_RETVAL_OK);
 	TEST_EXPECT_EQ_DOUBLE(expected_number, actual_number);
 
-	expected_number = 1.0f;
+	expected_number = 0.1;
 	actual_str = "1.0e-1";
 	actual_number = 0.0f;
 	TEST_EXPECT_EQ_U8(json_parse_number(&actual_number, actual_str, strlen(actual_str)), JSON_RETVAL_OK);
@@ -276,6 +277,44 @@ TEST_DEF(test_json_parse_number, json_parse_number) {
 	TEST_EXPECT_EQ_U8(json_parse_number(&actual_number, actual_str, strlen(actual_str)), JSON_RETVAL_OK);
 	TEST_EXPECT_TRUE(expected_number - actual_number < 0.00001f);
 
+	expected_number = 0.0f;
+	actual_str = "-0";
+	actual_number = 1.0f;
+	TEST_EXPECT_EQ_U8(json_parse_number(&actual_number, actual_str, strlen(actual_str)), JSON_RETVAL_OK);
+	TEST_EXPECT_EQ_DOUBLE(expected_number, actual_number);
+
+	// Values beyond 32 bits, large exponents and more digits than a double holds
+	const struct {
+		const char* str;
+		double expected;
+	} cases[] = {
+		{"5000000000", 5000000000.0},
+		{"5000000000.5", 5000000000.5},
+		{"1700000000123", 1700000000123.0},
+		{"-9007199254740993", -9007199254740993.0},
+		{"18446744073709551616", 18446744073709551616.0},
+		{"123456789012345678901234567890", 123456789012345678901234567890.0},
+		{"1e10", 1e10},
+		{"1E22", 1e22},
+		{"1e23", 1e23},
+		{"2.5e-10", 2.5e-10},
+		{"1e+100", 1e100},
+		{"-1.5e300", -1.5e300},
+		{"1.7976931348623157e308", 1.7976931348623157e308},
+		{"4.9e-324", 4.9e-324},
+		{"0.1", 0.1},
+		{"0.30000000000000004", 0.30000000000000004},
+		{"0.000001234", 0.000001234},
+		{"3.141592653589793238462643383279", 3.141592653589793238462643383279},
+		{"1e999", INFINITY},
+		{"1e-999", 0.0},
+	};
+	for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+		actual_number = 0.0;
+		TEST_EXPECT_EQ_U8(json_parse_number(&actual_number, cases[i].str, strlen(cases[i].str)), JSON_RETVAL_OK);
+		TEST_EXPECT_EQ_DOUBLE(actual_number, cases[i].expected);
+	}
+
 	actual_str = "x";
 	actual_number = 0.0f;
 	TEST_EXPECT_EQ_U8(json_parse_number(&actual_number, actual_str, strlen(actual_str)), JSON_RETVAL_FAIL);
@@ -287,6 +326,43 @@ TEST_DEF(test_json_parse_number, json_parse_number) {
 	TEST_CLEAN_UP_AND_RETURN(0);
 }
 
+TEST_DEF(test_json_parse_integer, json_parse_integer) {
+	// Integers keep all 64 bits, also beyond 2^53 where a double rounds them
+	const struct {
+		const char* str;
+		int64_t expected;
+	} cases[] = {
+		{"0", 0},
+		{"-1", -1},
+		{"1700000000123", 1700000000123},
+		{"-1700000000123", -1700000000123},
+		{"9007199254740993", 9007199254740993},
+		{"9223372036854775807", INT64_MAX},
+		{"-9223372036854775808", INT64_MIN},
+		{"12,", 12},
+	};
+	for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+		int64_t integer = 0;
+		TEST_EXPECT(json_parse_integer(cases[i].str, strlen(cases[i].str), INT64_MIN, INT64_MAX, &integer));
+		TEST_EXPECT(integer == cases[i].expected);
+	}
+
+	// Numbers out of range or with a fraction or exponent are no integers
+	const char* invalid[] = {"9223372036854775808", "-9223372036854775809", "12345678901234567890", "1.5e3", "1.0", "1e2"};
+	for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+		int64_t integer = 0;
+		TEST_EXPECT(!json_parse_integer(invalid[i], strlen(invalid[i]), INT64_MIN, INT64_MAX, &integer));
+	}
+	int64_t integer = 0;
+	TEST_EXPECT(json_parse_integer("-128", 4, INT8_MIN, INT8_MAX, &integer) && integer == -128);
+	TEST_EXPECT(!json_parse_integer("128", 3, INT8_MIN, INT8_MAX, &integer));
+	TEST_EXPECT(!json_parse_integer("-1", 2, 0, UINT32_MAX, &integer));
+	TEST_EXPECT(json_parse_integer("4294967295", 10, 0, UINT32_MAX, &integer) && integer == UINT32_MAX);
+	TEST_EXPECT(!json_parse_integer("4294967296", 10, 0, UINT32_MAX, &integer));
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
 int test_json_lex() {
 	TEST_GROUP_REG(test_json_lex);
 	TEST_REG(test_json_lex, lex_complete);
@@ -297,5 +373,6 @@ int test_json_lex() {
 	TEST_REG(test_json_strcmp_partial, json_strcmp_partial);
 	TEST_REG(test_json_str_unescape, json_str_unescape);
 	TEST_REG(test_json_parse_number, json_parse_number);
+	TEST_REG(test_json_parse_integer, json_parse_integer);
 	TESTS_RUN();
 }
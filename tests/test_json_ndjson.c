@@ -0,0 +1,114 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "test_json.h"
+#include "json.h"
+
+#define LOG_LEVEL    LOG_LEVEL_DEBUG
+#include "testlib.h"
+
+#define TEST_NDJSON_NUM_RECORDS		5000
+
+typedef struct {
+	uint64_t num_records;
+	uint64_t id_sum;
+	uint64_t num_out_of_order;
+	uint64_t num_errors;
+	uint64_t error_offset;
+	uint64_t stop_after;
+} test_ndjson_context_t;
+
+// One record per line, every 10th line is followed by a blank line
+static char* test_ndjson_document(size_t num_records, size_t* p_size) {
+	char* buffer = malloc(num_records * 64);
+	size_t size = 0;
+	for (size_t i = 0; i < num_records; i++) {
+		size += sprintf(&buffer[size], "{\"id\": %lu, \"name\": \"record %lu\"}\n%s", i, i, i % 10 == 0 ? " \r\n" : "");
+	}
+	*p_size = size;
+	return buffer;
+}
+
+static json_ret_code_t test_ndjson_callback(const json_ndjson_record_t* p_record, void* p_context) {
+	test_ndjson_context_t* p_test = p_context;
+	if (p_record->ret != JSON_RETVAL_OK) {
+		__atomic_fetch_add(&p_test->num_errors, 1, __ATOMIC_RELAXED);
+		p_test->error_offset = p_record->error.offset;
+		return JSON_RETVAL_OK;
+	}
+	uint64_t id = (uint64_t) json_object_get_value(p_record->p_object, "id")->number;
+	uint64_t index = __atomic_fetch_add(&p_test->num_records, 1, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&p_test->id_sum, id, __ATOMIC_RELAXED);
+	if (id != index) {
+		__atomic_fetch_add(&p_test->num_out_of_order, 1, __ATOMIC_RELAXED);
+	}
+	if (p_test->stop_after != 0 && index + 1 >= p_test->stop_after) {
+		return JSON_RETVAL_FAIL;
+	}
+	return JSON_RETVAL_OK;
+}
+
+TEST_DEF(test_json_ndjson, ndjson_ordered) {
+	size_t size;
+	char* buffer = test_ndjson_document(TEST_NDJSON_NUM_RECORDS, &size);
+	TEST_ASSERT_NOT_NULL(buffer);
+
+	// Small blocks, so records are spread over many blocks and threads
+	json_ndjson_options_t options = {.num_threads = 4, .block_size = 256};
+	test_ndjson_context_t context = {0};
+	json_ret_code_t ret = json_parse_ndjson(buffer, size, &options, test_ndjson_callback, &context);
+	free(buffer);
+	TEST_EXPECT_EQ_U8(ret, JSON_RETVAL_OK);
+	TEST_EXPECT_EQ_U64(context.num_records, TEST_NDJSON_NUM_RECORDS);
+	TEST_EXPECT_EQ_U64(context.num_out_of_order, 0);
+	TEST_EXPECT_EQ_U64(context.num_errors, 0);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+TEST_DEF(test_json_ndjson, ndjson_unordered) {
+	size_t size;
+	char* buffer = test_ndjson_document(TEST_NDJSON_NUM_RECORDS, &size);
+	TEST_ASSERT_NOT_NULL(buffer);
+
+	json_ndjson_options_t options = {.num_threads = 4, .block_size = 100, .unordered = true};
+	test_ndjson_context_t context = {0};
+	json_ret_code_t ret = json_parse_ndjson(buffer, size - 1, &options, test_ndjson_callback, &context);
+	free(buffer);
+	TEST_EXPECT_EQ_U8(ret, JSON_RETVAL_OK);
+	TEST_EXPECT_EQ_U64(context.num_records, TEST_NDJSON_NUM_RECORDS);
+	TEST_EXPECT_EQ_U64(context.id_sum, (uint64_t) TEST_NDJSON_NUM_RECORDS * (TEST_NDJSON_NUM_RECORDS - 1) / 2);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+TEST_DEF(test_json_ndjson, ndjson_errors) {
+	const char *buffer = "{\"id\": 0}\n{\"id\": 1}\n{\"id\" 2}\n{\"id\": 2}";
+	json_ndjson_options_t options = {.num_threads = 2, .block_size = 8};
+	test_ndjson_context_t context = {0};
+	TEST_EXPECT_EQ_U8(json_parse_ndjson(buffer, strlen(buffer), &options, test_ndjson_callback, &context), JSON_RETVAL_OK);
+	TEST_EXPECT_EQ_U64(context.num_records, 3);
+	TEST_EXPECT_EQ_U64(context.num_errors, 1);
+	TEST_EXPECT_EQ_U64(context.error_offset, 26);
+
+	// A failing callback stops parsing and its return value is passed on
+	size_t size;
+	char* document = test_ndjson_document(TEST_NDJSON_NUM_RECORDS, &size);
+	TEST_ASSERT_NOT_NULL(document);
+	context = (test_ndjson_context_t) {.stop_after = 100};
+	options = (json_ndjson_options_t) {.num_threads = 4, .block_size = 256};
+	json_ret_code_t ret = json_parse_ndjson(document, size, &options, test_ndjson_callback, &context);
+	free(document);
+	TEST_EXPECT_EQ_U8(ret, JSON_RETVAL_FAIL);
+	TEST_EXPECT_EQ_U64(context.num_records, 100);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+int test_json_ndjson() {
+	TEST_GROUP_REG(test_json_ndjson);
+	TEST_REG(test_json_ndjson, ndjson_ordered);
+	TEST_REG(test_json_ndjson, ndjson_unordered);
+	TEST_REG(test_json_ndjson, ndjson_errors);
+	TESTS_RUN();
+}
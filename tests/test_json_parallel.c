@@ -0,0 +1,137 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "test_json.h"
+#include "json.h"
+
+#define LOG_LEVEL    LOG_LEVEL_DEBUG
+#include "testlib.h"
+
+// Large arrays of every type, nested objects and plain scalars as members of the root object
+static char* test_parallel_document(size_t* p_size) {
+	char* buffer = malloc(1024 * 1024);
+	size_t size = sprintf(buffer, "{\"numbers\": [");
+	for (size_t i = 0; i < 5000; i++) {
+		size += sprintf(&buffer[size], "%s%lu.%lu", i > 0 ? ", " : "", i, i % 10);
+	}
+	size += sprintf(&buffer[size], "],\n\"strings\": [");
+	for (size_t i = 0; i < 12000; i++) {
+		size += sprintf(&buffer[size], "%s\"s\\\"%lu\"", i > 0 ? "," : "", i);
+	}
+	size += sprintf(&buffer[size], "], \"mixed\": [true, null, false, -0, \"[{,}]\", [], {}],\n\"records\": [");
+	for (size_t i = 0; i < 500; i++) {
+		size += sprintf(&buffer[size], "%s{\"id\": %lu, \"tags\": [\"t%lu\", [%lu]], \"next\": {}}", i > 0 ? ", " : "", i, i, i);
+	}
+	size += sprintf(&buffer[size], "], \"empty\": [],");
+	for (size_t i = 0; i < 50; i++) {
+		size += sprintf(&buffer[size], " \"object %lu\": {\"id\": %lu, \"inner\": {\"a\": [1, 2, \"]\"]}, \"s\": \"}\"},", i, i);
+	}
+	for (size_t i = 0; i < 11000; i++) {
+		size += sprintf(&buffer[size], " \"m%lu\": %lu,", i, i);
+	}
+	size += sprintf(&buffer[size], " \"empty object\": {}, \"n\": null, \"t\": true, \"num\": 12.5, \"str\": \"x\" }\n");
+	*p_size = size;
+	return buffer;
+}
+
+TEST_DEF(test_json_parallel, parallel_parse) {
+	size_t size;
+	char* buffer = test_parallel_document(&size);
+	TEST_ASSERT_NOT_NULL(buffer);
+
+	json_object_t expected_object;
+	TEST_ASSERT_EQ_U8(json_parse(buffer, size, &expected_object), JSON_RETVAL_OK);
+	char *expected_string = json_stringify(&expected_object);
+	json_object_free(&expected_object);
+
+	// Different pools and chunk sizes produce the same tree as the serial parser
+	const uint32_t thread_counts[] = {1, 2, 4};
+	const size_t chunk_sizes[] = {0, 64, 1000};
+	for (size_t i = 0; i < sizeof(thread_counts) / sizeof(thread_counts[0]); i++) {
+		json_pool_t* pool = json_pool_new(thread_counts[i]);
+		TEST_ASSERT_NOT_NULL(pool);
+		for (size_t j = 0; j < sizeof(chunk_sizes) / sizeof(chunk_sizes[0]); j++) {
+			json_parallel_options_t options = {.p_pool = pool, .chunk_size = chunk_sizes[j]};
+			json_object_t object;
+			json_ret_code_t ret = json_parse_parallel(buffer, size, &object, &options, NULL);
+			char *string = ret == JSON_RETVAL_OK ? json_stringify(&object) : NULL;
+			json_object_free(&object);
+			bool equal = string != NULL && strcmp(string, expected_string) == 0;
+			free(string);
+			if (!equal) {
+				json_pool_free(pool);
+				free(expected_string);
+				free(buffer);
+				TEST_FAIL_WITH_MSG("Threads %u, chunk size %lu produced a different tree", thread_counts[i], chunk_sizes[j]);
+			}
+		}
+		json_pool_free(pool);
+	}
+
+	// Without a pool one is created for the call
+	json_parallel_options_t options = {.chunk_size = 128};
+	json_object_t object;
+	TEST_EXPECT_EQ_U8(json_parse_parallel(buffer, size, &object, &options, NULL), JSON_RETVAL_OK);
+	TEST_EXPECT_EQ_DOUBLE(json_value_get_array_member(json_object_get_value(&object, "numbers"), 4999)->number, 4999.9);
+	TEST_EXPECT(json_array_get_numbers(json_object_get_value(&object, "numbers")->array, NULL) != NULL);
+	TEST_EXPECT(json_array_get_numbers(json_object_get_value(&object, "mixed")->array, NULL) == NULL);
+	TEST_EXPECT_EQ_STRING(json_value_get_array_member(json_object_get_value(&object, "strings"), 7)->string, "s\"7", 4);
+	TEST_EXPECT_EQ_STRING(json_value_get_array_member(json_object_get_value(&object, "strings"), 11999)->string, "s\"11999", 8);
+	TEST_EXPECT_EQ_DOUBLE(json_object_get_value(&object, "m10999")->number, 10999);
+	json_object_t *p_record = json_value_get_array_member(json_object_get_value(&object, "records"), 499)->object;
+	TEST_EXPECT_EQ_DOUBLE(json_object_get_value(p_record, "id")->number, 499);
+	json_object_free(&object);
+
+	free(expected_string);
+	free(buffer);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+TEST_DEF(test_json_parallel, parallel_errors) {
+	const char *buffers[] = {
+		"{\"a\": [1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 1.], \"b\": 1}",
+		"{\"a\": [1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20], \"b\": {\"c\" 1}}",
+		"{\"a\": [1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20 \"b\": 1}",
+		"{\"a\": [1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20], \"b\": [{}]}",
+		"{\"a\": [1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20], \"b\": tru}",
+		"{\"a\": [1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20], \"b\": []}",
+		"{\"a\": [1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20], \"b\": 1} {",
+		"{\"a\": [1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20], \"b\": {\"c\": [1, 2",
+		// Junk behind the last element of a range is only seen by lexing the element
+		"{\"aaaaaaaa\":[1, 2x], \"b\": 1}",
+		"{\"aaaaaaaa\":[1, truex], \"b\": 1}",
+		"{\"aaaaaaaa\":[\"s\", nullz], \"b\": 1}",
+		"{\"a\": [1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12x, 13, 14, 15, 16, 17, 18, 19, 20], \"b\": 1}",
+		"{\"a\": [[1], {\"b\": 2}, [3], {\"c\": 4}, [5], {\"d\": 6}]x, \"b\": 1}",
+	};
+
+	// Errors are reported exactly like the serial parser does
+	json_pool_t* pool = json_pool_new(2);
+	TEST_ASSERT_NOT_NULL(pool);
+	json_parallel_options_t options = {.p_pool = pool, .chunk_size = 16};
+	for (size_t i = 0; i < sizeof(buffers) / sizeof(buffers[0]); i++) {
+		size_t size = strlen(buffers[i]);
+		json_object_t expected_object, object;
+		json_error_t expected_error = {0}, error = {0};
+		json_ret_code_t expected_ret = json_parse_ex(buffers[i], size, &expected_object, &expected_error);
+		json_object_free(&expected_object);
+		json_ret_code_t ret = json_parse_parallel(buffers[i], size, &object, &options, &error);
+		json_object_free(&object);
+		if (ret != expected_ret || error.code != expected_error.code || error.offset != expected_error.offset) {
+			json_pool_free(pool);
+			TEST_FAIL_WITH_MSG("Buffer %lu: got %u/%u at %lu, expected %u/%u at %lu", i, ret, error.code, error.offset,
+							   expected_ret, expected_error.code, expected_error.offset);
+		}
+	}
+	json_pool_free(pool);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+int test_json_parallel() {
+	TEST_GROUP_REG(test_json_parallel);
+	TEST_REG(test_json_parallel, parallel_parse);
+	TEST_REG(test_json_parallel, parallel_errors);
+	TESTS_RUN();
+}
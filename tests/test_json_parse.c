@@ -228,6 +228,343 @@ TEST_DEF(test_json_parse, parse_multiple_keys) {
 	TEST_CLEAN_UP_AND_RETURN(0);
 }
 
+TEST_DEF(test_json_parse, parse_error_report) {
+	const char *buffer = "{\n  \"key\": \"value\",\n  \"key2\" \"value2\"\n}";
+	size_t buffer_size = strlen(buffer);
+	TEST_PRINT_BUFFER(buffer);
+
+	json_object_t object;
+	json_error_t error;
+	json_ret_code_t ret = json_parse_ex(buffer, buffer_size, &object, &error);
+	TEST_EXPECT_EQ_U8(ret, JSON_RETVAL_FAIL);
+	TEST_EXPECT_EQ_U8(error.code, JSON_ERROR_UNEXPECTED_TOKEN);
+	TEST_EXPECT_EQ_U64(error.offset, 29);
+	TEST_ASSERT_NOT_NULL(error.expected);
+	TEST_EXPECT_EQ_STRING(error.expected, "name value delimiter", strlen("name value delimiter"));
+
+	uint64_t line, column;
+	json_error_get_position(buffer, buffer_size, &error, &line, &column);
+	TEST_EXPECT_EQ_U64(line, 3);
+	TEST_EXPECT_EQ_U64(column, 10);
+	json_error_print(buffer, buffer_size, &error);
+	// The members parsed before the error are the caller's to free
+	TEST_EXPECT_EQ_STRING(json_object_get_value(&object, "key")->string, "value", 6);
+	json_object_free(&object);
+
+	buffer = "{\"key\": 1.}";
+	ret = json_parse_ex(buffer, strlen(buffer), &object, &error);
+	TEST_EXPECT_EQ_U8(ret, JSON_RETVAL_ILLEGAL);
+	TEST_EXPECT_EQ_U8(error.code, JSON_ERROR_EXPECTED_DIGIT);
+	TEST_EXPECT_EQ_U64(error.offset, 10);
+	json_object_free(&object);
+
+	buffer = "{\"key\": {\"key2\": 1}";
+	ret = json_parse_ex(buffer, strlen(buffer), &object, &error);
+	TEST_EXPECT_EQ_U8(ret, JSON_RETVAL_FAIL);
+	TEST_EXPECT_EQ_U8(error.code, JSON_ERROR_UNEXPECTED_EOF);
+	TEST_EXPECT_EQ_U64(error.offset, strlen(buffer));
+	json_object_free(&object);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+TEST_DEF(test_json_parse, parse_large_string) {
+	const size_t value_len = 200000;
+	char *buffer = malloc(value_len + 32);
+	TEST_ASSERT_NOT_NULL(buffer);
+	g_current_test.allocated_memory[g_current_test.allocated_memory_count++] = buffer;
+	strcpy(buffer, "{\"key\": \"");
+	size_t prefix_len = strlen(buffer);
+	for (size_t i = 0; i < value_len; i++) {
+		buffer[prefix_len + i] = (char) ('a' + i % 26);
+	}
+	strcpy(&buffer[prefix_len + value_len], "\\n\"}");
+
+	json_object_t object;
+	json_ret_code_t ret = json_parse(buffer, strlen(buffer), &object);
+	TEST_ASSERT_EQ_U8(ret, JSON_RETVAL_OK);
+	json_value_t *val = json_object_get_value(&object, "key");
+	TEST_ASSERT_NOT_NULL(val);
+	TEST_EXPECT_EQ_U64(strlen(val->string), value_len + 1);
+	TEST_EXPECT_EQ_U8(val->string[value_len - 1], 'a' + (value_len - 1) % 26);
+	TEST_EXPECT_EQ_U8(val->string[value_len], '\n');
+
+	TEST_EXPECT_EQ_U8(json_object_free(&object), JSON_RETVAL_OK);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+TEST_DEF(test_json_parse, parse_inline_strings) {
+	// More members than the first allocation holds, inline strings move with their members
+	const char* buffer = "{\"id\": \"abc\", \"a\": \"\\u0041\\n\", \"long key that is not inline\": \"x\", "
+						 "\"k\": \"a value that does not fit\", \"n\": 1, \"e\": \"\"}";
+	json_object_t object;
+	TEST_ASSERT_EQ_U8(json_parse(buffer, strlen(buffer), &object), JSON_RETVAL_OK);
+	TEST_ASSERT_EQ_U32(object.num_members, 6);
+
+	json_object_member_t *p_member = &object.members[0];
+	TEST_EXPECT(JSON_PARSE_IS_INLINE(p_member, p_member->key) && JSON_PARSE_IS_INLINE(p_member, p_member->value.string));
+	TEST_EXPECT_EQ_STRING(p_member->key, "id", 3);
+	TEST_EXPECT_EQ_STRING(p_member->value.string, "abc", 4);
+	TEST_EXPECT_EQ_STRING(object.members[1].value.string, "A\n", 3);
+	p_member = &object.members[2];
+	TEST_EXPECT(!JSON_PARSE_IS_INLINE(p_member, p_member->key) && JSON_PARSE_IS_INLINE(p_member, p_member->value.string));
+	p_member = &object.members[3];
+	TEST_EXPECT(JSON_PARSE_IS_INLINE(p_member, p_member->key) && !JSON_PARSE_IS_INLINE(p_member, p_member->value.string));
+	TEST_EXPECT_EQ_STRING(json_object_get_value(&object, "k")->string, "a value that does not fit", 26);
+	TEST_EXPECT_EQ_STRING(json_object_get_value(&object, "e")->string, "", 1);
+
+	// Short strings move with their members when growing the object moves them, long strings stay in place
+	const char* p_long = json_object_get_value(&object, "k")->string;
+	char key[16];
+	for (uint32_t i = 0; i < 64; i++) {
+		sprintf(key, "added %u", i);
+		TEST_ASSERT_EQ_U8(json_object_add_value(&object, key, (json_value_t) {0}, JSON_VALUE_TYPE_NULL), JSON_RETVAL_OK);
+	}
+	p_member = &object.members[0];
+	TEST_EXPECT(JSON_PARSE_IS_INLINE(p_member, p_member->key) && JSON_PARSE_IS_INLINE(p_member, p_member->value.string));
+	TEST_EXPECT_EQ_STRING(json_object_get_value(&object, "id")->string, "abc", 4);
+	TEST_EXPECT_EQ_STRING(json_object_get_value(&object, "a")->string, "A\n", 3);
+	TEST_EXPECT(json_object_get_value(&object, "k")->string == p_long);
+	TEST_EXPECT_EQ_U8(json_object_get_value_type(&object, "added 63"), JSON_VALUE_TYPE_NULL);
+
+	TEST_EXPECT_EQ_U8(json_object_free(&object), JSON_RETVAL_OK);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+TEST_DEF(test_json_parse, parse_packed_arrays) {
+	// Arrays of numbers only are packed
+	const size_t num_numbers = 100000;
+	char *buffer = malloc(num_numbers * 12 + 64);
+	TEST_ASSERT_NOT_NULL(buffer);
+	g_current_test.allocated_memory[g_current_test.allocated_memory_count++] = buffer;
+	size_t size = sprintf(buffer, "{\"samples\": [");
+	for (size_t i = 0; i < num_numbers; i++) {
+		size += sprintf(&buffer[size], "%s%lu.5", i > 0 ? "," : "", i);
+	}
+	size_t samples_end = size;
+	size += sprintf(&buffer[size], "], \"mixed\": [1, -2e1, \"x\", true]}");
+
+	json_object_t object;
+	TEST_ASSERT_EQ_U8(json_parse(buffer, size, &object), JSON_RETVAL_OK);
+	json_value_t *samples = json_object_get_value(&object, "samples");
+	size_t length = 0;
+	const double *numbers = json_array_get_numbers(samples->array, &length);
+	TEST_ASSERT_NOT_NULL(numbers);
+	TEST_EXPECT_EQ_U64(length, num_numbers);
+	TEST_EXPECT_EQ_DOUBLE(numbers[0], 0.5);
+	TEST_EXPECT_EQ_DOUBLE(numbers[num_numbers - 1], num_numbers - 0.5);
+	TEST_EXPECT_EQ_DOUBLE(json_value_get_array_member(samples, 12345)->number, 12345.5);
+	TEST_EXPECT_EQ_U8(json_value_get_array_member_type(samples, 12345), JSON_VALUE_TYPE_NUMBER);
+
+	// The first entry of another type moves the numbers into generic entries
+	json_value_t *mixed = json_object_get_value(&object, "mixed");
+	TEST_EXPECT(json_array_get_numbers(mixed->array, NULL) == NULL);
+	TEST_EXPECT_EQ_DOUBLE(json_value_get_array_member(mixed, 1)->number, -20);
+	TEST_EXPECT_EQ_U8(json_value_get_array_member_type(mixed, 1), JSON_VALUE_TYPE_NUMBER);
+	TEST_EXPECT_EQ_STRING(json_value_get_array_member(mixed, 2)->string, "x", 2);
+	TEST_EXPECT_EQ_U8(json_value_get_array_member_type(mixed, 3), JSON_VALUE_TYPE_BOOLEAN);
+	TEST_EXPECT_EQ_U8(json_value_get_array_member_type(mixed, 4), JSON_VALUE_TYPE_UNDEFINED);
+	TEST_EXPECT_EQ_U8(json_object_free(&object), JSON_RETVAL_OK);
+
+	// Arrays that are not packed are not limited either
+	size = samples_end + sprintf(&buffer[samples_end], ", null]}");
+	TEST_ASSERT_EQ_U8(json_parse(buffer, size, &object), JSON_RETVAL_OK);
+	samples = json_object_get_value(&object, "samples");
+	TEST_EXPECT_EQ_U64(samples->array->length, num_numbers + 1);
+	TEST_EXPECT_EQ_DOUBLE(json_value_get_array_member(samples, num_numbers - 1)->number, num_numbers - 0.5);
+	TEST_EXPECT_EQ_U8(json_value_get_array_member_type(samples, num_numbers), JSON_VALUE_TYPE_NULL);
+	json_object_free(&object);
+
+	// Nor are objects
+	size = sprintf(buffer, "{");
+	for (size_t i = 0; i < 20000; i++) {
+		size += sprintf(&buffer[size], "%s\"key %lu\": %lu", i > 0 ? ", " : "", i, i);
+	}
+	size += sprintf(&buffer[size], "}");
+	TEST_ASSERT_EQ_U8(json_parse(buffer, size, &object), JSON_RETVAL_OK);
+	TEST_EXPECT_EQ_U32(object.num_members, 20000);
+	TEST_EXPECT_EQ_DOUBLE(json_object_get_value(&object, "key 19999")->number, 19999);
+	json_object_free(&object);
+
+	// Packed arrays allocated from the arena of a batch document are unpacked the same way
+	const char *small = "{\"a\": [1, 2, 3, 4, 5, null], \"b\": [0.25, 7]}";
+	json_input_t input = {.p_data = small, .size = strlen(small)};
+	json_document_t document;
+	TEST_ASSERT_EQ_U8(json_parse_batch(&input, 1, &document, NULL, NULL), JSON_RETVAL_OK);
+	char *string = json_stringify(&document.root);
+	TEST_ASSERT_NOT_NULL(string);
+	TEST_EXPECT_EQ_STRING(string, "{\"a\":[1.000000,2.000000,3.000000,4.000000,5.000000,null],\"b\":[0.250000,7.000000]}",
+						  strlen(string) + 1);
+	free(string);
+	json_document_free(&document);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+TEST_DEF(test_json_parse, parse_nested_arrays) {
+	const char *buffer = "{\"rows\": [{\"id\": 1, \"tags\": [\"a\", \"b\"]}, {\"id\": 2, \"tags\": []}, {}],"
+						 " \"matrix\": [[1, 2], [3, [4, {\"deep\": [null]}]], []], \"empty\": [], \"after\": true}";
+	size_t buffer_size = strlen(buffer);
+	TEST_PRINT_BUFFER(buffer);
+
+	json_object_t object;
+	TEST_ASSERT_EQ_U8(json_parse(buffer, buffer_size, &object), JSON_RETVAL_OK);
+	TEST_EXPECT_EQ_U32(object.num_members, 4);
+	json_value_t *rows = json_object_get_value(&object, "rows");
+	TEST_ASSERT_NOT_NULL(rows);
+	TEST_EXPECT_EQ_U64(rows->array->length, 3);
+	TEST_ASSERT_EQ_U8(json_value_get_array_member_type(rows, 1), JSON_VALUE_TYPE_OBJECT);
+	json_object_t *row = json_value_get_array_member(rows, 1)->object;
+	TEST_EXPECT_EQ_DOUBLE(json_object_get_value(row, "id")->number, 2);
+	TEST_EXPECT_EQ_U64(json_object_get_value(row, "tags")->array->length, 0);
+	TEST_EXPECT(row->parent == NULL);
+	json_value_t *tags = json_object_get_value(json_value_get_array_member(rows, 0)->object, "tags");
+	TEST_EXPECT_EQ_STRING(json_value_get_array_member(tags, 1)->string, "b", 2);
+	TEST_EXPECT_EQ_U32(json_value_get_array_member(rows, 2)->object->num_members, 0);
+
+	// Arrays of arrays, numbers stay packed in the inner ones
+	json_value_t *matrix = json_object_get_value(&object, "matrix");
+	TEST_ASSERT_EQ_U8(json_value_get_array_member_type(matrix, 0), JSON_VALUE_TYPE_ARRAY);
+	TEST_EXPECT(json_array_get_numbers(json_value_get_array_member(matrix, 0)->array, NULL) != NULL);
+	json_value_t *inner = json_value_get_array_member(json_value_get_array_member(matrix, 1), 1);
+	TEST_EXPECT_EQ_DOUBLE(json_value_get_array_member(inner, 0)->number, 4);
+	json_object_t *deep = json_value_get_array_member(inner, 1)->object;
+	TEST_EXPECT_EQ_U8(json_value_get_array_member_type(json_object_get_value(deep, "deep"), 0), JSON_VALUE_TYPE_NULL);
+	TEST_EXPECT_EQ_U64(json_value_get_array_member(matrix, 2)->array->length, 0);
+	TEST_EXPECT_TRUE(json_object_get_value(&object, "after")->boolean);
+
+	char *string = json_stringify(&object);
+	TEST_ASSERT_NOT_NULL(string);
+	const char *expect = "{\"rows\":[{\"id\":1.000000,\"tags\":[\"a\",\"b\"]},{\"id\":2.000000,\"tags\":[]},{}],"
+						 "\"matrix\":[[1.000000,2.000000],[3.000000,[4.000000,{\"deep\":[null]}]],[]],\"empty\":[],\"after\":true}";
+	TEST_EXPECT_EQ_STRING(string, expect, strlen(expect) + 1);
+	free(string);
+	TEST_EXPECT_EQ_U8(json_object_free(&object), JSON_RETVAL_OK);
+
+	// Arrays of containers have no length limit, neither inside an object nor as the document
+	const size_t num_rows = 12000;
+	char *many = malloc(num_rows * 48 + 64);
+	TEST_ASSERT_NOT_NULL(many);
+	size_t size = sprintf(many, "{\"rows\": ");
+	size_t rows_offset = size;
+	size += sprintf(&many[size], "[");
+	for (size_t i = 0; i < num_rows; i++) {
+		size += sprintf(&many[size], "%s{\"id\": %lu, \"tags\": [%lu]}", i > 0 ? ", " : "", i, i % 7);
+	}
+	size += sprintf(&many[size], "]");
+	size_t rows_size = size - rows_offset;
+	size += sprintf(&many[size], "}");
+	TEST_ASSERT_EQ_U8(json_parse(many, size, &object), JSON_RETVAL_OK);
+	rows = json_object_get_value(&object, "rows");
+	TEST_ASSERT_NOT_NULL(rows);
+	TEST_EXPECT_EQ_U64(rows->array->length, num_rows);
+	row = json_value_get_array_member(rows, num_rows - 1)->object;
+	TEST_EXPECT_EQ_DOUBLE(json_object_get_value(row, "id")->number, num_rows - 1);
+	json_object_free(&object);
+
+	json_value_t value;
+	json_value_type_t type;
+	TEST_ASSERT_EQ_U8(json_parse_value(&many[rows_offset], rows_size, &value, &type, NULL), JSON_RETVAL_OK);
+	TEST_ASSERT_EQ_U8(type, JSON_VALUE_TYPE_ARRAY);
+	TEST_EXPECT_EQ_U64(value.array->length, num_rows);
+	row = json_value_get_array_member(&value, num_rows - 1)->object;
+	tags = json_object_get_value(row, "tags");
+	TEST_EXPECT_EQ_DOUBLE(json_value_get_array_member(tags, 0)->number, (num_rows - 1) % 7);
+	json_value_free(&value, type);
+	free(many);
+
+	// Errors inside arrays name the end of the innermost container
+	const struct {
+		const char *buffer;
+		json_error_code_t code;
+		const char *expected;
+		uint64_t offset;
+	} cases[] = {
+		{"{\"a\": [{\"b\": 1} {\"b\": 2}]}", JSON_ERROR_UNEXPECTED_TOKEN, "value delimiter or array end", 16},
+		{"{\"a\": [{\"b\": 1]}", JSON_ERROR_UNEXPECTED_TOKEN, "member delimiter or object end", 14},
+		{"{\"a\": [1, ]}", JSON_ERROR_UNEXPECTED_TOKEN, "value", 10},
+		{"{\"a\": [[1, 2]", JSON_ERROR_UNEXPECTED_EOF, "array end", 13},
+		{"{\"a\": [{\"b\": [", JSON_ERROR_UNEXPECTED_EOF, "array end", 14},
+		{"{\"a\": [{", JSON_ERROR_UNEXPECTED_EOF, "object end", 8},
+		{"[1, 2]", JSON_ERROR_UNEXPECTED_TOKEN, "object start", 0},
+	};
+	for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+		json_error_t error = {0};
+		TEST_EXPECT_EQ_U8(json_parse_ex(cases[i].buffer, strlen(cases[i].buffer), &object, &error), JSON_RETVAL_FAIL);
+		TEST_EXPECT_EQ_U8(error.code, cases[i].code);
+		TEST_EXPECT_EQ_U64(error.offset, cases[i].offset);
+		TEST_ASSERT_NOT_NULL(error.expected);
+		TEST_EXPECT_EQ_STRING(error.expected, cases[i].expected, strlen(cases[i].expected) + 1);
+		json_object_free(&object);
+	}
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+TEST_DEF(test_json_parse, parse_value) {
+	// Any value is a document, not only an object
+	json_value_t value;
+	json_value_type_t type;
+	const char *buffer = " [{\"a\": [1, \"x\"]}, [], 2.5, \"long enough to not fit inline\"] ";
+	TEST_ASSERT_EQ_U8(json_parse_value(buffer, strlen(buffer), &value, &type, NULL), JSON_RETVAL_OK);
+	TEST_ASSERT_EQ_U8(type, JSON_VALUE_TYPE_ARRAY);
+	TEST_EXPECT_EQ_U64(value.array->length, 4);
+	json_value_t *a = json_object_get_value(json_value_get_array_member(&value, 0)->object, "a");
+	TEST_EXPECT_EQ_STRING(json_value_get_array_member(a, 1)->string, "x", 2);
+	TEST_EXPECT_EQ_DOUBLE(json_value_get_array_member(&value, 2)->number, 2.5);
+	TEST_EXPECT_EQ_U8(json_value_free(&value, type), JSON_RETVAL_OK);
+	TEST_EXPECT(value.array == NULL);
+
+	TEST_ASSERT_EQ_U8(json_parse_value("\"top\"", 5, &value, &type, NULL), JSON_RETVAL_OK);
+	TEST_EXPECT_EQ_U8(type, JSON_VALUE_TYPE_STRING);
+	TEST_EXPECT_EQ_STRING(value.string, "top", 4);
+	json_value_free(&value, type);
+	TEST_ASSERT_EQ_U8(json_parse_value("-1e3", 4, &value, &type, NULL), JSON_RETVAL_OK);
+	TEST_EXPECT_EQ_U8(type, JSON_VALUE_TYPE_NUMBER);
+	TEST_EXPECT_EQ_DOUBLE(value.number, -1000);
+	TEST_ASSERT_EQ_U8(json_parse_value("null", 4, &value, &type, NULL), JSON_RETVAL_OK);
+	TEST_EXPECT_EQ_U8(type, JSON_VALUE_TYPE_NULL);
+	TEST_ASSERT_EQ_U8(json_parse_value("{\"k\": {}}", 9, &value, &type, NULL), JSON_RETVAL_OK);
+	TEST_EXPECT_EQ_U8(type, JSON_VALUE_TYPE_OBJECT);
+	TEST_EXPECT(json_object_get_value(value.object, "k")->object->parent == value.object);
+	json_value_free(&value, type);
+
+	// A partial tree is released like a complete one
+	json_error_t error = {0};
+	buffer = "[[{\"a\": \"b\"}, [true";
+	TEST_EXPECT_EQ_U8(json_parse_value(buffer, strlen(buffer), &value, &type, &error), JSON_RETVAL_FAIL);
+	TEST_EXPECT_EQ_U8(error.code, JSON_ERROR_UNEXPECTED_EOF);
+	TEST_EXPECT_EQ_STRING(error.expected, "array end", strlen("array end") + 1);
+	TEST_EXPECT_EQ_U8(type, JSON_VALUE_TYPE_ARRAY);
+	json_value_free(&value, type);
+
+	TEST_EXPECT_EQ_U8(json_parse_value("1 2", 3, &value, &type, &error), JSON_RETVAL_FAIL);
+	TEST_EXPECT_EQ_U8(error.code, JSON_ERROR_UNEXPECTED_TOKEN);
+	TEST_EXPECT_EQ_STRING(error.expected, "end of input", strlen("end of input") + 1);
+	TEST_EXPECT_EQ_U64(error.offset, 2);
+	TEST_EXPECT_EQ_U8(json_parse_value("", 0, &value, &type, &error), JSON_RETVAL_FAIL);
+	TEST_EXPECT_EQ_U8(error.code, JSON_ERROR_UNEXPECTED_EOF);
+	TEST_EXPECT_EQ_STRING(error.expected, "value", strlen("value") + 1);
+	TEST_EXPECT_EQ_U8(json_parse_value(",", 1, &value, &type, &error), JSON_RETVAL_FAIL);
+	TEST_EXPECT_EQ_STRING(error.expected, "value", strlen("value") + 1);
+
+	// The nesting limit holds for arrays as well
+	char *deep = malloc(2001);
+	TEST_ASSERT_NOT_NULL(deep);
+	g_current_test.allocated_memory[g_current_test.allocated_memory_count++] = deep;
+	memset(deep, '[', 1000);
+	memset(&deep[1000], ']', 1000);
+	TEST_EXPECT_EQ_U8(json_parse_value(deep, 2000, &value, &type, &error), JSON_RETVAL_FAIL);
+	TEST_EXPECT_EQ_U8(error.code, JSON_ERROR_MAX_NESTING_LEVEL);
+	json_value_free(&value, type);
+	TEST_EXPECT_EQ_U8(json_parse_value(&deep[1], 1998, &value, &type, &error), JSON_RETVAL_OK);
+	json_value_free(&value, type);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
 int test_json_parse() {
 	TEST_GROUP_REG(test_json_parse);
 	TEST_REG(test_json_parse, parse_complete);
@@ -242,5 +579,11 @@ int test_json_parse() {
 	TEST_REG(test_json_parse, parse_invalid_value);
 	TEST_REG(test_json_parse, parse_invalid_key);
 	TEST_REG(test_json_parse, parse_multiple_keys);
+	TEST_REG(test_json_parse, parse_error_report);
+	TEST_REG(test_json_parse, parse_large_string);
+	TEST_REG(test_json_parse, parse_inline_strings);
+	TEST_REG(test_json_parse, parse_packed_arrays);
+	TEST_REG(test_json_parse, parse_nested_arrays);
+	TEST_REG(test_json_parse, parse_value);
 	TESTS_RUN();
 }
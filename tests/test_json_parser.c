@@ -0,0 +1,124 @@
+#include <string.h>
+#include <stdlib.h>
+#include "test_json.h"
+#include "json.h"
+
+#define LOG_LEVEL    LOG_LEVEL_DEBUG
+#include "testlib.h"
+
+static json_ret_code_t parse_in_chunks(const char* buffer, size_t size, size_t chunk_size, json_object_t* p_object, json_error_t* p_error) {
+	json_parser_t *parser = json_parser_new(p_object);
+	if (parser == NULL) {
+		return JSON_RETVAL_FAIL;
+	}
+	for (size_t i = 0; i < size; i += chunk_size) {
+		size_t len = size - i < chunk_size ? size - i : chunk_size;
+		if (json_parser_feed(parser, &buffer[i], len) != JSON_RETVAL_BUSY) {
+			break;
+		}
+	}
+	json_ret_code_t ret = json_parser_finish(parser, p_error);
+	json_parser_free(parser);
+	return ret;
+}
+
+TEST_DEF(test_json_parser, parser_chunked) {
+	TEST_READ_FILE(buffer, "tests/files/complete.json");
+
+	json_object_t expected_object;
+	TEST_ASSERT_EQ_U8(json_parse(buffer, buffer_size, &expected_object), JSON_RETVAL_OK);
+	char *expected_string = json_stringify(&expected_object);
+	json_object_free(&expected_object);
+
+	// Every chunk size splits tokens at different positions
+	for (size_t chunk_size = 1; chunk_size <= buffer_size; chunk_size++) {
+		json_object_t object;
+		json_error_t error;
+		json_ret_code_t ret = parse_in_chunks(buffer, buffer_size, chunk_size, &object, &error);
+		if (ret != JSON_RETVAL_OK) {
+			free(expected_string);
+			TEST_FAIL_WITH_MSG("Chunk size %lu failed with error %u at %lu", chunk_size, error.code, error.offset);
+		}
+		char *string = json_stringify(&object);
+		json_object_free(&object);
+		bool equal = strcmp(string, expected_string) == 0;
+		free(string);
+		if (!equal) {
+			free(expected_string);
+			TEST_FAIL_WITH_MSG("Chunk size %lu produced a different tree", chunk_size);
+		}
+	}
+
+	free(expected_string);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+TEST_DEF(test_json_parser, parser_partial_tokens) {
+	const char *buffer = "{\"k\\\"ey\": \"a\\\\\\u0041\", \"num\": -12.5e2, \"t\": true, \"n\": null, \"arr\": [false, 7]}";
+	size_t size = strlen(buffer);
+
+	// Split once at every position, inside strings, escapes, numbers and literals
+	for (size_t split = 0; split <= size; split++) {
+		json_object_t object;
+		json_parser_t *parser = json_parser_new(&object);
+		TEST_ASSERT_NOT_NULL(parser);
+		TEST_EXPECT_EQ_U8(json_parser_feed(parser, buffer, split), JSON_RETVAL_BUSY);
+		TEST_EXPECT_EQ_U8(json_parser_feed(parser, &buffer[split], size - split), JSON_RETVAL_BUSY);
+		TEST_ASSERT_EQ_U8(json_parser_finish(parser, NULL), JSON_RETVAL_OK);
+		json_parser_free(parser);
+
+		TEST_EXPECT_EQ_STRING(json_object_get_value(&object, "k\"ey")->string, "a\\A", 4);
+		TEST_EXPECT_EQ_DOUBLE(json_object_get_value(&object, "num")->number, -1250.0);
+		TEST_EXPECT(json_object_get_value(&object, "t")->boolean);
+		TEST_EXPECT_EQ_U8(json_object_get_value_type(&object, "n"), JSON_VALUE_TYPE_NULL);
+		TEST_EXPECT_EQ_DOUBLE(json_value_get_array_member(json_object_get_value(&object, "arr"), 1)->number, 7.0);
+		json_object_free(&object);
+	}
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+TEST_DEF(test_json_parser, parser_errors) {
+	const char *buffers[] = {
+		"{\"key\": 1.}",
+		"{\"key\": tru}",
+		"{\"key\": \"a\\x\"}",
+		"{\"key\": \"value\"",
+		"{\"key\": \"val",
+		"{\"key\": 12",
+		"{\"key\" \"value\"}",
+		"{\"key\": \"value\"} {",
+		"",
+	};
+
+	// Errors are the same as for contiguous input, no matter how the input is split
+	for (size_t i = 0; i < sizeof(buffers) / sizeof(buffers[0]); i++) {
+		size_t size = strlen(buffers[i]);
+		json_object_t object;
+		json_error_t expected_error;
+		json_ret_code_t expected_ret = json_parse_ex(buffers[i], size, &object, &expected_error);
+		TEST_EXPECT(expected_ret != JSON_RETVAL_OK);
+		json_object_free(&object);
+
+		for (size_t chunk_size = 1; chunk_size <= size + 1; chunk_size++) {
+			json_error_t error;
+			json_ret_code_t ret = parse_in_chunks(buffers[i], size, chunk_size, &object, &error);
+			json_object_free(&object);
+			if (ret != expected_ret || error.code != expected_error.code || error.offset != expected_error.offset) {
+				TEST_FAIL_WITH_MSG("\"%s\" in chunks of %lu: got %u/%u at %lu, expected %u/%u at %lu", buffers[i], chunk_size,
+								   ret, error.code, error.offset, expected_ret, expected_error.code, expected_error.offset);
+			}
+		}
+	}
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+int test_json_parser() {
+	TEST_GROUP_REG(test_json_parser);
+	TEST_REG(test_json_parser, parser_chunked);
+	TEST_REG(test_json_parser, parser_partial_tokens);
+	TEST_REG(test_json_parser, parser_errors);
+	TESTS_RUN();
+}
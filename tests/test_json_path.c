@@ -0,0 +1,150 @@
+#include <string.h>
+#include <stdlib.h>
+#include "test_json.h"
+#include "json.h"
+
+#define LOG_LEVEL    LOG_LEVEL_DEBUG
+#include "testlib.h"
+
+static const char *m_test_path_document =
+		"{\"payload\": {\"items\": [1.5, 2.5, 3.5, 4.25], \"tags\": [\"a\", true, null], \"3\": \"three\","
+		" \"a/b\": 1, \"m~n\": 2, \"\": 3, \"it's\": 4, \"owner\": {\"name\": \"x\", \"id\": 7}}, \"count\": 2}";
+
+TEST_DEF(test_json_path, path_eval) {
+	json_object_t object;
+	TEST_ASSERT_EQ_U8(json_parse(m_test_path_document, strlen(m_test_path_document), &object), JSON_RETVAL_OK);
+
+	const struct {
+		const char* expression;
+		json_value_type_t type;
+		double number;
+	} cases[] = {
+		{"/payload/items/3", JSON_VALUE_TYPE_NUMBER, 4.25},
+		{"$.payload.items[3]", JSON_VALUE_TYPE_NUMBER, 4.25},
+		{"$['payload'][\"items\"][0]", JSON_VALUE_TYPE_NUMBER, 1.5},
+		{"/payload/owner/id", JSON_VALUE_TYPE_NUMBER, 7},
+		{"$.payload.owner.id", JSON_VALUE_TYPE_NUMBER, 7},
+		{"/payload/a~1b", JSON_VALUE_TYPE_NUMBER, 1},
+		{"/payload/m~0n", JSON_VALUE_TYPE_NUMBER, 2},
+		{"/payload/", JSON_VALUE_TYPE_NUMBER, 3},
+		{"$.payload['it\\'s']", JSON_VALUE_TYPE_NUMBER, 4},
+		{"/count", JSON_VALUE_TYPE_NUMBER, 2},
+		{"/payload/tags/1", JSON_VALUE_TYPE_BOOLEAN, 0},
+		{"/payload/tags/2", JSON_VALUE_TYPE_NULL, 0},
+		{"/payload/3", JSON_VALUE_TYPE_STRING, 0},
+		{"/payload/owner", JSON_VALUE_TYPE_OBJECT, 0},
+		{"$.payload.tags", JSON_VALUE_TYPE_ARRAY, 0},
+		// Missing members, indices out of range and steps into scalars select nothing
+		{"/payload/items/4", JSON_VALUE_TYPE_UNDEFINED, 0},
+		{"/payload/items/01", JSON_VALUE_TYPE_UNDEFINED, 0},
+		{"/payload/missing", JSON_VALUE_TYPE_UNDEFINED, 0},
+		{"/count/0", JSON_VALUE_TYPE_UNDEFINED, 0},
+		{"$.payload[3]", JSON_VALUE_TYPE_UNDEFINED, 0},
+		{"$.payload.items.x", JSON_VALUE_TYPE_UNDEFINED, 0},
+	};
+
+	for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+		json_path_t* p_path = json_path_compile(cases[i].expression);
+		TEST_ASSERT_NOT_NULL(p_path);
+		json_value_type_t type = JSON_VALUE_TYPE_OBJECT;
+		json_value_t* p_value = json_path_eval(p_path, &object, &type);
+		bool is_match = type == cases[i].type && (p_value != NULL) == (type != JSON_VALUE_TYPE_UNDEFINED) &&
+						(type != JSON_VALUE_TYPE_NUMBER || p_value->number == cases[i].number);
+		json_path_free(p_path);
+		if (!is_match) {
+			TEST_FAIL_WITH_MSG("Path %s: got type %u", cases[i].expression, type);
+		}
+	}
+	json_path_t* p_path = json_path_compile("/payload/3");
+	TEST_EXPECT_EQ_STRING(json_path_eval(p_path, &object, NULL)->string, "three", 6);
+	json_path_free(p_path);
+
+	json_object_free(&object);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+TEST_DEF(test_json_path, path_duplicate_keys) {
+	// With duplicate keys the first member is selected, whatever documents the path saw before
+	const char* documents[] = {"{\"z\": 0, \"k\": 5}", "{\"k\": 1, \"k\": 2}", "{\"z\": 0, \"k\": 3, \"k\": 4}"};
+	const double expected[] = {5, 1, 3};
+	json_path_t* p_path = json_path_compile("/k");
+	TEST_ASSERT_NOT_NULL(p_path);
+	for (size_t i = 0; i < sizeof(documents) / sizeof(documents[0]); i++) {
+		json_object_t object;
+		TEST_ASSERT_EQ_U8(json_parse(documents[i], strlen(documents[i]), &object), JSON_RETVAL_OK);
+		json_value_t* p_value = json_path_eval(p_path, &object, NULL);
+		TEST_EXPECT(p_value == json_object_get_value(&object, "k"));
+		TEST_EXPECT(p_value != NULL && p_value->number == expected[i]);
+		json_object_free(&object);
+	}
+	json_path_free(p_path);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+TEST_DEF(test_json_path, path_compile_errors) {
+	const char* expressions[] = {
+		NULL, "", "payload", "/", "$", "/a~2", "/a~", "$.", "$..a", "$.a[", "$.a[x]", "$.a[-1]", "$['a'", "$['a]", "$a",
+	};
+	for (size_t i = 0; i < sizeof(expressions) / sizeof(expressions[0]); i++) {
+		json_path_t* p_path = json_path_compile(expressions[i]);
+		// "/" selects the member with the empty key
+		if ((p_path == NULL) != (i != 3)) {
+			json_path_free(p_path);
+			TEST_FAIL_WITH_MSG("Expression %lu compiled unexpectedly", i);
+		}
+		json_path_free(p_path);
+	}
+	TEST_EXPECT(json_path_eval(NULL, NULL, NULL) == NULL);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+TEST_DEF(test_json_path, path_eval_batch) {
+	json_object_t object;
+	TEST_ASSERT_EQ_U8(json_parse(m_test_path_document, strlen(m_test_path_document), &object), JSON_RETVAL_OK);
+
+	const char* expressions[] = {
+		"/payload/owner/name", "$.payload.owner.id", "/payload/owner/missing", "/payload/items/2", "$.payload.items[1]",
+		"/count", "/payload/owner/id",
+	};
+	const size_t num_paths = sizeof(expressions) / sizeof(expressions[0]);
+	json_path_t* paths[sizeof(expressions) / sizeof(expressions[0]) + 1];
+	for (size_t i = 0; i < num_paths; i++) {
+		paths[i] = json_path_compile(expressions[i]);
+		TEST_ASSERT_NOT_NULL(paths[i]);
+	}
+	paths[num_paths] = NULL;
+
+	// Shared leading steps give the same results as evaluating every path alone
+	json_value_t* values[sizeof(expressions) / sizeof(expressions[0]) + 1];
+	json_value_type_t types[sizeof(expressions) / sizeof(expressions[0]) + 1];
+	TEST_EXPECT_EQ_U64(json_path_eval_batch(paths, num_paths + 1, &object, values, types), num_paths - 1);
+	for (size_t i = 0; i < num_paths; i++) {
+		json_value_type_t type;
+		TEST_EXPECT(json_path_eval(paths[i], &object, &type) == values[i] && type == types[i]);
+	}
+	TEST_EXPECT(values[2] == NULL && types[2] == JSON_VALUE_TYPE_UNDEFINED && values[num_paths] == NULL);
+	TEST_EXPECT_EQ_STRING(values[0]->string, "x", 2);
+	TEST_EXPECT_EQ_DOUBLE(values[1]->number, 7);
+	TEST_EXPECT_EQ_DOUBLE(values[3]->number, 3.5);
+	TEST_EXPECT_EQ_DOUBLE(values[4]->number, 2.5);
+	TEST_EXPECT_EQ_DOUBLE(values[5]->number, 2);
+
+	for (size_t i = 0; i < num_paths; i++) {
+		json_path_free(paths[i]);
+	}
+	json_object_free(&object);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+int test_json_path() {
+	TEST_GROUP_REG(test_json_path);
+	TEST_REG(test_json_path, path_eval);
+	TEST_REG(test_json_path, path_duplicate_keys);
+	TEST_REG(test_json_path, path_compile_errors);
+	TEST_REG(test_json_path, path_eval_batch);
+	TESTS_RUN();
+}
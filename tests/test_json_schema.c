@@ -0,0 +1,225 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "test_json.h"
+#include "json.h"
+
+#define LOG_LEVEL    LOG_LEVEL_DEBUG
+#include "testlib.h"
+
+static const char *m_test_schema_order =
+		"{\"$schema\": \"https://json-schema.org/draft/2020-12/schema\", \"title\": \"order\", \"type\": \"object\","
+		" \"required\": [\"id\", \"symbol\", \"side\"], \"additionalProperties\": false,"
+		" \"properties\": {"
+		"  \"id\": {\"type\": \"integer\", \"minimum\": 1},"
+		"  \"symbol\": {\"type\": \"string\", \"minLength\": 1, \"maxLength\": 4},"
+		"  \"side\": {\"enum\": [\"buy\", \"sell\"]},"
+		"  \"price\": {\"type\": \"number\", \"exclusiveMinimum\": 0, \"maximum\": 1000},"
+		"  \"tags\": {\"type\": \"array\", \"items\": {\"type\": \"string\"}, \"minItems\": 2, \"maxItems\": 3},"
+		"  \"fills\": {\"type\": \"array\", \"items\": {\"type\": \"number\", \"minimum\": 0}},"
+		"  \"lines\": {\"type\": \"array\", \"items\": {\"type\": \"object\", \"required\": [\"qty\"],"
+		"             \"properties\": {\"qty\": {\"type\": \"integer\", \"minimum\": 1}}}},"
+		"  \"meta\": {\"type\": [\"object\", \"null\"], \"required\": [\"a/b\"], \"properties\": {\"a/b\": {\"type\": \"boolean\"},"
+		"            \"inner\": {\"properties\": {\"x~y\": {\"type\": \"null\"}}}}}"
+		" }}";
+
+typedef struct {
+	const char* document;
+	json_error_code_t code;
+	const char* keyword;
+	const char* pointer;
+	uint64_t offset;
+} test_schema_case_t;
+
+// Parses the document against the schema, the tree is released in any case
+static json_ret_code_t test_schema_parse(const json_schema_t* p_schema, const char* document, json_schema_error_t* p_error) {
+	json_object_t object;
+	json_ret_code_t ret = json_parse_schema(document, strlen(document), p_schema, &object, p_error);
+	json_object_free(&object);
+	return ret;
+}
+
+TEST_DEF(test_json_schema, schema_valid) {
+	json_schema_t* p_schema = json_schema_compile(m_test_schema_order, strlen(m_test_schema_order));
+	TEST_ASSERT_NOT_NULL(p_schema);
+
+	const char* documents[] = {
+		"{\"id\": 1, \"symbol\": \"ACME\", \"side\": \"buy\"}",
+		"{\"side\": \"sell\", \"symbol\": \"\\u0041\", \"id\": 7, \"price\": 1000, \"tags\": [\"a\", \"b\", \"c\"]}",
+		"{\"id\": 1e3, \"symbol\": \"X\", \"side\": \"buy\", \"fills\": [0.5], \"meta\": null}",
+		"{\"id\": 2, \"symbol\": \"\xc3\xa9\xc3\xa9\xc3\xa9\xc3\xa9\", \"side\": \"buy\", \"meta\": {\"a/b\": true, \"extra\": [1, \"x\"],"
+		" \"inner\": {\"x~y\": null, \"z\": \"any\"}}}",
+	};
+	for (size_t i = 0; i < sizeof(documents) / sizeof(documents[0]); i++) {
+		json_schema_error_t error;
+		json_object_t object;
+		TEST_EXPECT_EQ_U8(json_parse_schema(documents[i], strlen(documents[i]), p_schema, &object, &error), JSON_RETVAL_OK);
+		TEST_EXPECT_EQ_U8(error.error.code, JSON_ERROR_NONE);
+		TEST_EXPECT_EQ_STRING(error.pointer, "", 1);
+		json_object_free(&object);
+	}
+
+	// The tree is the same as without a schema
+	json_object_t object;
+	TEST_ASSERT_EQ_U8(json_parse_schema(documents[1], strlen(documents[1]), p_schema, &object, NULL), JSON_RETVAL_OK);
+	TEST_EXPECT_EQ_U32(object.num_members, 5);
+	TEST_EXPECT_EQ_STRING(json_object_get_value(&object, "symbol")->string, "A", 2);
+	TEST_EXPECT_EQ_U32(json_object_get_value(&object, "tags")->array->length, 3);
+	json_object_free(&object);
+
+	json_schema_free(p_schema);
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+TEST_DEF(test_json_schema, schema_violations) {
+	json_schema_t* p_schema = json_schema_compile(m_test_schema_order, strlen(m_test_schema_order));
+	TEST_ASSERT_NOT_NULL(p_schema);
+
+	const test_schema_case_t cases[] = {
+		{"{\"id\": 1.5, \"symbol\": \"A\", \"side\": \"buy\"}", JSON_ERROR_SCHEMA, "type", "/id", 7},
+		{"{\"id\": 0, \"symbol\": \"A\", \"side\": \"buy\"}", JSON_ERROR_SCHEMA, "minimum", "/id", 7},
+		{"{\"id\": 1, \"symbol\": \"ACMEX\", \"side\": \"buy\"}", JSON_ERROR_SCHEMA, "maxLength", "/symbol", 20},
+		{"{\"id\": 1, \"symbol\": \"\", \"side\": \"buy\"}", JSON_ERROR_SCHEMA, "minLength", "/symbol", 20},
+		{"{\"id\": 1, \"symbol\": \"A\", \"side\": \"hold\"}", JSON_ERROR_SCHEMA, "enum", "/side", 33},
+		{"{\"id\": 1, \"symbol\": \"A\"}", JSON_ERROR_SCHEMA, "required", "", 23},
+		{"{\"id\": 1, \"symbol\": \"A\", \"side\": \"buy\", \"qty\": 1}", JSON_ERROR_SCHEMA, "additionalProperties", "/qty", 40},
+		{"{\"id\": 1, \"price\": 0}", JSON_ERROR_SCHEMA, "exclusiveMinimum", "/price", 19},
+		{"{\"id\": 1, \"price\": 1000.5}", JSON_ERROR_SCHEMA, "maximum", "/price", 19},
+		{"{\"id\": 1, \"tags\": \"a\"}", JSON_ERROR_SCHEMA, "type", "/tags", 18},
+		{"{\"id\": 1, \"tags\": [\"a\"]}", JSON_ERROR_SCHEMA, "minItems", "/tags", 22},
+		{"{\"id\": 1, \"tags\": [\"a\", \"b\", \"c\", \"d\"]}", JSON_ERROR_SCHEMA, "maxItems", "/tags/3", 34},
+		{"{\"id\": 1, \"tags\": [\"a\", 2]}", JSON_ERROR_SCHEMA, "type", "/tags/1", 24},
+		{"{\"id\": 1, \"fills\": [1, 2, -3]}", JSON_ERROR_SCHEMA, "minimum", "/fills/2", 26},
+		{"{\"id\": 1, \"lines\": [{\"qty\": 1}, {\"qty\": 0}]}", JSON_ERROR_SCHEMA, "minimum", "/lines/1/qty", 40},
+		{"{\"id\": 1, \"lines\": [{\"qty\": 1}, {}]}", JSON_ERROR_SCHEMA, "required", "/lines/1", 33},
+		{"{\"id\": 1, \"lines\": [[]]}", JSON_ERROR_SCHEMA, "type", "/lines/0", 20},
+		{"{\"id\": 1, \"meta\": 5}", JSON_ERROR_SCHEMA, "type", "/meta", 18},
+		{"{\"id\": 1, \"meta\": {\"x\": 1}}", JSON_ERROR_SCHEMA, "required", "/meta", 25},
+		{"{\"id\": 1, \"meta\": {\"a/b\": 1}}", JSON_ERROR_SCHEMA, "type", "/meta/a~1b", 26},
+		{"{\"id\": 1, \"meta\": {\"a/b\": true, \"inner\": {\"x~y\": 0}}}", JSON_ERROR_SCHEMA, "type", "/meta/inner/x~0y", 49},
+		{"{\"id\": 1, \"symbol\": \"A\", \"side\": \"buy\", \"tags\": [\"a\",]}", JSON_ERROR_UNEXPECTED_TOKEN, "value", "", 53},
+	};
+	for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+		json_schema_error_t error;
+		TEST_EXPECT_EQ_U8(test_schema_parse(p_schema, cases[i].document, &error), JSON_RETVAL_FAIL);
+		TEST_EXPECT_EQ_U8(error.error.code, cases[i].code);
+		TEST_EXPECT_EQ_U64(error.error.offset, cases[i].offset);
+		TEST_EXPECT_EQ_STRING(error.error.expected, cases[i].keyword, strlen(cases[i].keyword) + 1);
+		TEST_EXPECT_EQ_STRING(error.pointer, cases[i].pointer, strlen(cases[i].pointer) + 1);
+	}
+
+	// Long pointers are cut off at the end of the buffer
+	char document[2 * JSON_SCHEMA_MAX_POINTER + 64];
+	char key[2 * JSON_SCHEMA_MAX_POINTER];
+	memset(key, 'k', sizeof(key) - 1);
+	key[sizeof(key) - 1] = '\0';
+	snprintf(document, sizeof(document), "{\"id\": 1, \"%s\": 1}", key);
+	json_schema_error_t error;
+	TEST_EXPECT_EQ_U8(test_schema_parse(p_schema, document, &error), JSON_RETVAL_FAIL);
+	TEST_EXPECT_EQ_U8(error.error.code, JSON_ERROR_SCHEMA);
+	TEST_EXPECT_EQ_U64(strlen(error.pointer), JSON_SCHEMA_MAX_POINTER - 1);
+
+	json_schema_free(p_schema);
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+TEST_DEF(test_json_schema, schema_early_reject) {
+	const char* schema = "{\"additionalProperties\": false, \"properties\": {\"a\": {\"type\": \"object\"},"
+						 " \"b\": {\"type\": \"array\", \"maxItems\": 2}, \"c\": false}}";
+	json_schema_t* p_schema = json_schema_compile(schema, strlen(schema));
+	TEST_ASSERT_NOT_NULL(p_schema);
+
+	// Rejected at the first violation, nothing behind it is parsed and the partial tree is released as usual
+	json_schema_error_t error;
+	json_object_t object;
+	const char* document = "{\"a\": {}, \"b\": [1, 2, 3, \"rest\"], \"c\": {\"not\": \"parsed\"}}";
+	TEST_EXPECT_EQ_U8(json_parse_schema(document, strlen(document), p_schema, &object, &error), JSON_RETVAL_FAIL);
+	TEST_EXPECT_EQ_STRING(error.error.expected, "maxItems", 9);
+	TEST_EXPECT_EQ_STRING(error.pointer, "/b/2", 5);
+	TEST_EXPECT_EQ_U64(error.error.offset, 22);
+	TEST_EXPECT_EQ_U32(object.num_members, 2);
+	TEST_EXPECT_EQ_U32(json_object_get_value(&object, "b")->array->length, 3);
+	json_object_free(&object);
+
+	// Containers are rejected before they are allocated, the member is left null
+	document = "{\"a\": [1, 2]}";
+	TEST_EXPECT_EQ_U8(json_parse_schema(document, strlen(document), p_schema, &object, &error), JSON_RETVAL_FAIL);
+	TEST_EXPECT_EQ_STRING(error.error.expected, "type", 5);
+	TEST_EXPECT_EQ_STRING(error.pointer, "/a", 3);
+	TEST_EXPECT_EQ_U64(error.error.offset, 6);
+	TEST_EXPECT_EQ_U8(json_object_get_value_type(&object, "a"), JSON_VALUE_TYPE_NULL);
+	json_object_free(&object);
+
+	document = "{\"c\": {\"d\": 1}}";
+	TEST_EXPECT_EQ_U8(json_parse_schema(document, strlen(document), p_schema, &object, &error), JSON_RETVAL_FAIL);
+	TEST_EXPECT_EQ_STRING(error.error.expected, "properties", 11);
+	TEST_EXPECT_EQ_STRING(error.pointer, "/c", 3);
+	TEST_EXPECT_EQ_U8(json_object_get_value_type(&object, "c"), JSON_VALUE_TYPE_NULL);
+	json_object_free(&object);
+
+	document = "{\"d\": [1, 2]}";
+	TEST_EXPECT_EQ_U8(json_parse_schema(document, strlen(document), p_schema, &object, &error), JSON_RETVAL_FAIL);
+	TEST_EXPECT_EQ_STRING(error.error.expected, "additionalProperties", 21);
+	TEST_EXPECT_EQ_STRING(error.pointer, "/d", 3);
+	TEST_EXPECT_EQ_U64(error.error.offset, 1);
+	json_object_free(&object);
+
+	json_schema_free(p_schema);
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+TEST_DEF(test_json_schema, schema_compile) {
+	const char* valid[] = {
+		"{}",
+		"{\"type\": [\"integer\", \"string\"], \"enum\": [1, \"a\", null, true], \"description\": \"x\"}",
+		"{\"items\": true, \"additionalProperties\": {\"type\": \"number\"}, \"required\": [\"a\", \"a\"]}",
+	};
+	for (size_t i = 0; i < sizeof(valid) / sizeof(valid[0]); i++) {
+		json_schema_t* p_schema = json_schema_compile(valid[i], strlen(valid[i]));
+		TEST_EXPECT_NOT_NULL(p_schema);
+		json_schema_free(p_schema);
+	}
+
+	const char* invalid[] = {
+		"",
+		"{\"type\": \"float\"}",
+		"{\"type\": 1}",
+		"{\"minLength\": -1}",
+		"{\"maxItems\": 1.5}",
+		"{\"minimum\": \"1\"}",
+		"{\"required\": \"a\"}",
+		"{\"required\": [1]}",
+		"{\"properties\": {\"a\": 1}}",
+		"{\"items\": [{}]}",
+		"{\"pattern\": \"^a\"}",
+		"{\"properties\": {\"a\": {\"$ref\": \"#\"}}}",
+	};
+	for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+		TEST_EXPECT(json_schema_compile(invalid[i], strlen(invalid[i])) == NULL);
+	}
+
+	// Required keys that are not properties still fall under additionalProperties
+	const char* schema = "{\"required\": [\"a\"], \"additionalProperties\": {\"type\": \"string\"}}";
+	json_schema_t* p_schema = json_schema_compile(schema, strlen(schema));
+	TEST_ASSERT_NOT_NULL(p_schema);
+	json_schema_error_t error;
+	TEST_EXPECT_EQ_U8(test_schema_parse(p_schema, "{\"b\": \"x\", \"a\": \"y\"}", &error), JSON_RETVAL_OK);
+	TEST_EXPECT_EQ_U8(test_schema_parse(p_schema, "{\"a\": 1}", &error), JSON_RETVAL_FAIL);
+	TEST_EXPECT_EQ_STRING(error.pointer, "/a", 3);
+	TEST_EXPECT_EQ_U8(test_schema_parse(p_schema, "{\"b\": \"x\"}", &error), JSON_RETVAL_FAIL);
+	TEST_EXPECT_EQ_STRING(error.error.expected, "required", 9);
+	json_schema_free(p_schema);
+
+	TEST_EXPECT_EQ_U8(json_parse_schema("{}", 2, NULL, NULL, NULL), JSON_RETVAL_INVALID_PARAM);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+int test_json_schema() {
+	TEST_GROUP_REG(test_json_schema);
+	TEST_REG(test_json_schema, schema_valid);
+	TEST_REG(test_json_schema, schema_violations);
+	TEST_REG(test_json_schema, schema_early_reject);
+	TEST_REG(test_json_schema, schema_compile);
+	TESTS_RUN();
+}
@@ -0,0 +1,180 @@
+#include <string.h>
+#include <stdlib.h>
+#include "test_json.h"
+#include "json.h"
+
+#define LOG_LEVEL    LOG_LEVEL_DEBUG
+#include "testlib.h"
+
+#define TEST_SELECT_MAX_MATCHES		16
+
+static const char *m_test_select_document =
+		"{\"skip\": [{\"a\": [1, {\"}\": \"]\"}]}, \"x\\\"y\"], \"payload\": {\"items\": [1.5, 2.5, 3.5],"
+		" \"name\": \"a\\tb\\u0041\", \"owner\": {\"id\": 7, \"active\": true, \"note\": null}}, \"count\": -2e1}";
+
+typedef struct {
+	json_select_match_t matches[TEST_SELECT_MAX_MATCHES];
+	char strings[TEST_SELECT_MAX_MATCHES][16];
+	size_t num_matches;
+	size_t stop_after;
+} test_select_context_t;
+
+static json_ret_code_t test_select_collect(const json_select_match_t* p_match, void* p_context) {
+	test_select_context_t* p_ctx = p_context;
+	if (p_ctx->num_matches == TEST_SELECT_MAX_MATCHES) {
+		return JSON_RETVAL_FAIL;
+	}
+	p_ctx->matches[p_ctx->num_matches] = *p_match;
+	if (p_match->type == JSON_VALUE_TYPE_STRING && p_match->string_length < sizeof(p_ctx->strings[0])) {
+		memcpy(p_ctx->strings[p_ctx->num_matches], p_match->value.string, p_match->string_length + 1);
+	}
+	p_ctx->num_matches++;
+	return p_ctx->num_matches == p_ctx->stop_after ? JSON_RETVAL_FINISHED : JSON_RETVAL_OK;
+}
+
+// Match of the selector, NULL if it was not reported
+static const json_select_match_t* test_select_find(const test_select_context_t* p_ctx, size_t selector, size_t* p_index) {
+	for (size_t i = 0; i < p_ctx->num_matches; i++) {
+		if (p_ctx->matches[i].selector == selector) {
+			*p_index = i;
+			return &p_ctx->matches[i];
+		}
+	}
+	return NULL;
+}
+
+TEST_DEF(test_json_select, select_matches) {
+	const char* expressions[] = {
+		"/payload/items/1", "$.payload.name", "/payload/owner/id", "$.payload.owner.active", "/payload/owner/note",
+		"/count", "/payload/owner", "$.payload.items", "/missing", "/payload/items/3", "/skip/0/a",
+	};
+	const size_t num_expressions = sizeof(expressions) / sizeof(expressions[0]);
+	json_selector_t* p_selector = json_selector_compile(expressions, num_expressions);
+	TEST_ASSERT_NOT_NULL(p_selector);
+
+	test_select_context_t ctx = {0};
+	json_error_t error;
+	const char* document = m_test_select_document;
+	json_ret_code_t ret = json_select(document, strlen(document), p_selector, test_select_collect, &ctx, &error);
+	json_selector_free(p_selector);
+	TEST_ASSERT_EQ_U8(ret, JSON_RETVAL_OK);
+	TEST_ASSERT_EQ_U64(ctx.num_matches, num_expressions - 2);
+
+	size_t index;
+	const json_select_match_t* p_match = test_select_find(&ctx, 0, &index);
+	TEST_ASSERT_NOT_NULL(p_match);
+	TEST_EXPECT(p_match->type == JSON_VALUE_TYPE_NUMBER && p_match->value.number == 2.5);
+	TEST_EXPECT(p_match->offset == (uint64_t) (strstr(document, "2.5") - document) && p_match->length == 3);
+
+	p_match = test_select_find(&ctx, 1, &index);
+	TEST_ASSERT_NOT_NULL(p_match);
+	TEST_EXPECT(p_match->type == JSON_VALUE_TYPE_STRING && p_match->string_length == 4);
+	TEST_EXPECT_EQ_STRING(ctx.strings[index], "a\tbA", 5);
+	TEST_EXPECT(p_match->offset == (uint64_t) (strstr(document, "\"a\\t") - document) && p_match->length == 12);
+
+	p_match = test_select_find(&ctx, 2, &index);
+	TEST_EXPECT(p_match != NULL && p_match->type == JSON_VALUE_TYPE_NUMBER && p_match->value.number == 7);
+	p_match = test_select_find(&ctx, 3, &index);
+	TEST_EXPECT(p_match != NULL && p_match->type == JSON_VALUE_TYPE_BOOLEAN && p_match->value.boolean);
+	p_match = test_select_find(&ctx, 4, &index);
+	TEST_EXPECT(p_match != NULL && p_match->type == JSON_VALUE_TYPE_NULL && p_match->length == 4);
+	p_match = test_select_find(&ctx, 5, &index);
+	TEST_EXPECT(p_match != NULL && p_match->type == JSON_VALUE_TYPE_NUMBER && p_match->value.number == -20);
+
+	// Containers are reported by their extent
+	p_match = test_select_find(&ctx, 6, &index);
+	TEST_ASSERT_NOT_NULL(p_match);
+	const char* owner = strstr(document, "{\"id\"");
+	TEST_EXPECT(p_match->type == JSON_VALUE_TYPE_OBJECT && p_match->offset == (uint64_t) (owner - document));
+	TEST_EXPECT(p_match->length == (size_t) (strchr(owner, '}') + 1 - owner));
+	p_match = test_select_find(&ctx, 7, &index);
+	TEST_ASSERT_NOT_NULL(p_match);
+	TEST_EXPECT(p_match->type == JSON_VALUE_TYPE_ARRAY && p_match->length == strlen("[1.5, 2.5, 3.5]"));
+	p_match = test_select_find(&ctx, 10, &index);
+	TEST_EXPECT(p_match != NULL && p_match->type == JSON_VALUE_TYPE_ARRAY && p_match->length == strlen("[1, {\"}\": \"]\"}]"));
+
+	TEST_EXPECT(test_select_find(&ctx, 8, &index) == NULL && test_select_find(&ctx, 9, &index) == NULL);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+TEST_DEF(test_json_select, select_shared_steps) {
+	// The same path in both syntaxes and paths with shared leading steps each report their match
+	const char* expressions[] = {"/payload/owner/id", "$.payload.owner.id", "$['payload']['owner']", "/payload/items/0", "/count"};
+	json_selector_t* p_selector = json_selector_compile(expressions, sizeof(expressions) / sizeof(expressions[0]));
+	TEST_ASSERT_NOT_NULL(p_selector);
+
+	test_select_context_t ctx = {0};
+	json_ret_code_t ret = json_select(m_test_select_document, strlen(m_test_select_document), p_selector, test_select_collect,
+									  &ctx, NULL);
+	TEST_EXPECT_EQ_U8(ret, JSON_RETVAL_OK);
+	TEST_EXPECT_EQ_U64(ctx.num_matches, 5);
+	size_t index0, index1;
+	const json_select_match_t* p_first = test_select_find(&ctx, 0, &index0);
+	const json_select_match_t* p_second = test_select_find(&ctx, 1, &index1);
+	TEST_EXPECT(p_first != NULL && p_second != NULL && p_first->offset == p_second->offset && p_second->value.number == 7);
+
+	// A callback result other than OK ends the pass
+	ctx = (test_select_context_t) {.stop_after = 2};
+	ret = json_select(m_test_select_document, strlen(m_test_select_document), p_selector, test_select_collect, &ctx, NULL);
+	TEST_EXPECT_EQ_U8(ret, JSON_RETVAL_FINISHED);
+	TEST_EXPECT_EQ_U64(ctx.num_matches, 2);
+
+	// The root does not have to be an object
+	ctx = (test_select_context_t) {0};
+	const char* array = " [1, 2] ";
+	TEST_EXPECT_EQ_U8(json_select(array, strlen(array), p_selector, test_select_collect, &ctx, NULL), JSON_RETVAL_OK);
+	TEST_EXPECT_EQ_U64(ctx.num_matches, 0);
+
+	json_selector_free(p_selector);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+TEST_DEF(test_json_select, select_errors) {
+	const char* invalid_expressions[] = {"/a", "$..a"};
+	TEST_EXPECT(json_selector_compile(invalid_expressions, 2) == NULL);
+	TEST_EXPECT(json_selector_compile(invalid_expressions, 0) == NULL);
+	TEST_EXPECT(json_selector_compile(NULL, 1) == NULL);
+
+	const char* expressions[] = {"/a/0", "/b"};
+	json_selector_t* p_selector = json_selector_compile(expressions, 2);
+	TEST_ASSERT_NOT_NULL(p_selector);
+	TEST_EXPECT_EQ_U8(json_select("{}", 2, p_selector, NULL, NULL, NULL), JSON_RETVAL_INVALID_PARAM);
+
+	const struct {
+		const char* input;
+		json_error_code_t code;
+		uint64_t offset;
+	} cases[] = {
+		{"", JSON_ERROR_UNEXPECTED_EOF, 0},
+		{"{\"a\": [1, 2}", JSON_ERROR_UNEXPECTED_TOKEN, 11},
+		{"{\"a\" 1}", JSON_ERROR_UNEXPECTED_TOKEN, 5},
+		{"{\"b\": tru}", JSON_ERROR_UNEXPECTED_TOKEN, 9},
+		{"{\"b\": 01}", JSON_ERROR_UNEXPECTED_TOKEN, 7},
+		{"{\"b\": \"x", JSON_ERROR_UNEXPECTED_EOF, 8},
+		{"{\"c\": [1, {\"d\": 2}", JSON_ERROR_UNEXPECTED_EOF, 18},
+		{"{\"c\": ,}", JSON_ERROR_UNEXPECTED_TOKEN, 6},
+		{"{\"b\": 1} x", JSON_ERROR_UNEXPECTED_TOKEN, 9},
+		{"{\"b\": \"\\q\"}", JSON_ERROR_ILLEGAL_ESCAPE_SEQUENCE, 8},
+	};
+	for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+		test_select_context_t ctx = {0};
+		json_error_t error = {0};
+		json_ret_code_t ret = json_select(cases[i].input, strlen(cases[i].input), p_selector, test_select_collect, &ctx, &error);
+		if (ret == JSON_RETVAL_OK || error.code != cases[i].code || error.offset != cases[i].offset) {
+			TEST_FAIL_WITH_MSG("Input %lu: got %u at %lu", i, error.code, error.offset);
+		}
+	}
+	json_selector_free(p_selector);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+int test_json_select() {
+	TEST_GROUP_REG(test_json_select);
+	TEST_REG(test_json_select, select_matches);
+	TEST_REG(test_json_select, select_shared_steps);
+	TEST_REG(test_json_select, select_errors);
+	TESTS_RUN();
+}
@@ -2,6 +2,8 @@
 // Created by tholz on 12.06.2022.
 //
 
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "test_json.h"
 #include "json.h"
@@ -148,9 +150,7 @@ TEST_DEF(test_json_stringify, stringify_array) {
 			{.value = value1, .type = JSON_VALUE_TYPE_STRING},
 			{.value = value2, .type = JSON_VALUE_TYPE_STRING},
 	};
-	json_array_t array = {.length = 2};
-	array.values[0] = &array_members[0];
-	array.values[1] = &array_members[1];
+	json_array_t array = {.values = array_members, .length = 2, .max_length = 2};
 	json_value_t value = {.array = &array};
 	json_ret_code_t ret = json_object_add_value(&object, key, value, JSON_VALUE_TYPE_ARRAY);
 	TEST_EXPECT_EQ_U8(ret, JSON_RETVAL_OK);
@@ -180,9 +180,7 @@ TEST_DEF(test_json_stringify, stringify_array_pretty) {
 			{.value = value1, .type = JSON_VALUE_TYPE_STRING},
 			{.value = value2, .type = JSON_VALUE_TYPE_STRING},
 	};
-	json_array_t array = {.length = 2};
-	array.values[0] = &array_members[0];
-	array.values[1] = &array_members[1];
+	json_array_t array = {.values = array_members, .length = 2, .max_length = 2};
 	json_value_t value = {.array = &array};
 	json_ret_code_t ret = json_object_add_value(&object, key, value, JSON_VALUE_TYPE_ARRAY);
 	TEST_EXPECT_EQ_U8(ret, JSON_RETVAL_OK);
@@ -203,6 +201,138 @@ TEST_DEF(test_json_stringify, stringify_array_pretty) {
 	TEST_CLEAN_UP_AND_RETURN(0);
 }
 
+// Large array, large nested object, an array of large containers and many root members, so every kind of segment is planned
+static char *test_stringify_large_document(size_t *p_size) {
+	char *buffer = malloc(2 * 1024 * 1024);
+	size_t size = sprintf(buffer, "{\"head\": \"x\", \"numbers\": [");
+	for (size_t i = 0; i < 10000; i++) {
+		size += sprintf(&buffer[size], "%s%lu.5", i > 0 ? ", " : "", i);
+	}
+	size += sprintf(&buffer[size], "], \"nested\": {");
+	for (size_t i = 0; i < 5000; i++) {
+		size += sprintf(&buffer[size], "%s\"k%lu\": {\"a\": [true, null, \"s\"], \"b\": {}}", i > 0 ? ", " : "", i);
+	}
+	size += sprintf(&buffer[size], "}, \"grid\": [[");
+	for (size_t i = 0; i < 3000; i++) {
+		size += sprintf(&buffer[size], "%s%lu", i > 0 ? ", " : "", i);
+	}
+	size += sprintf(&buffer[size], "], [1, {\"x\": 2}], {");
+	for (size_t i = 0; i < 3000; i++) {
+		size += sprintf(&buffer[size], "%s\"g%lu\": [%lu]", i > 0 ? ", " : "", i, i);
+	}
+	size += sprintf(&buffer[size], "}, \"tail\"]");
+	for (size_t i = 0; i < 6000; i++) {
+		size += sprintf(&buffer[size], ", \"m%lu\": %s", i, i % 3 == 0 ? "false" : "\"value\"");
+	}
+	size += sprintf(&buffer[size], "}");
+	*p_size = size;
+	return buffer;
+}
+
+TEST_DEF(test_json_stringify, stringify_numbers) {
+	json_object_t object = {0};
+	double numbers[] = {1e100, -1.7976931348623157e308, 1700000000123.0, 0.25};
+	char key[2] = "a";
+	for (size_t i = 0; i < sizeof(numbers) / sizeof(numbers[0]); i++) {
+		key[0] = (char) ('a' + i);
+		TEST_EXPECT_EQ_U8(json_object_add_value(&object, key, (json_value_t) {.number = numbers[i]}, JSON_VALUE_TYPE_NUMBER), JSON_RETVAL_OK);
+	}
+
+	// Numbers of any magnitude are written in full with %f
+	char *expected_string = malloc(2048);
+	TEST_ASSERT_NOT_NULL(expected_string);
+	size_t size = sprintf(expected_string, "{");
+	for (size_t i = 0; i < sizeof(numbers) / sizeof(numbers[0]); i++) {
+		size += sprintf(&expected_string[size], "%s\"%c\":%f", i > 0 ? "," : "", (char) ('a' + i), numbers[i]);
+	}
+	sprintf(&expected_string[size], "}");
+	char *string = json_stringify(&object);
+	TEST_ASSERT_NOT_NULL(string);
+	TEST_EXPECT_EQ_STRING(string, expected_string, strlen(expected_string) + 1);
+	TEST_EXPECT(strstr(string, "\"a\":10000000000000000159028911097599180468360808563945281389781327557747838772170381060813469985856815104.000000,") != NULL);
+
+	json_object_t parsed;
+	TEST_ASSERT_EQ_U8(json_parse(string, strlen(string), &parsed), JSON_RETVAL_OK);
+	for (size_t i = 0; i < sizeof(numbers) / sizeof(numbers[0]); i++) {
+		TEST_EXPECT(parsed.members[i].value.number == numbers[i]);
+	}
+	free(expected_string);
+	free(string);
+	json_object_free(&parsed);
+	json_object_free(&object);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+TEST_DEF(test_json_stringify, stringify_parallel) {
+	size_t size;
+	char *buffer = test_stringify_large_document(&size);
+	TEST_ASSERT_NOT_NULL(buffer);
+	json_object_t object;
+	TEST_ASSERT_EQ_U8(json_parse(buffer, size, &object), JSON_RETVAL_OK);
+	free(buffer);
+
+	// Output is byte-identical to the serial stringify for any pool
+	json_pool_t *pools[] = {NULL, json_pool_new(1), json_pool_new(4)};
+	size_t num_different = 0;
+	for (size_t pretty = 0; pretty <= 1; pretty++) {
+		char *expected_string = pretty ? json_stringify_pretty(&object) : json_stringify(&object);
+		for (size_t i = 0; i < sizeof(pools) / sizeof(pools[0]); i++) {
+			char *string = json_stringify_parallel(&object, pretty, pools[i]);
+			num_different += string == NULL || strcmp(string, expected_string) != 0;
+			free(string);
+		}
+		free(expected_string);
+	}
+	json_pool_free(pools[1]);
+	json_pool_free(pools[2]);
+	json_object_free(&object);
+	TEST_EXPECT_EQ_U64(num_different, 0);
+
+	// Objects below the threshold are a single segment
+	json_parse_string("{\"key\": [1, 2], \"inner\": {\"a\": null}}", small);
+	TEST_ASSERT_EQ_U8(small_return, JSON_RETVAL_OK);
+	char *expected_string = json_stringify_pretty(&small);
+	char *string = json_stringify_parallel(&small, true, NULL);
+	TEST_EXPECT_EQ_STRING(string, expected_string, strlen(expected_string) + 1);
+	free(string);
+	free(expected_string);
+	json_object_free(&small);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+TEST_DEF(test_json_stringify, stringify_write) {
+	size_t size;
+	char *buffer = test_stringify_large_document(&size);
+	TEST_ASSERT_NOT_NULL(buffer);
+	json_object_t object;
+	TEST_ASSERT_EQ_U8(json_parse(buffer, size, &object), JSON_RETVAL_OK);
+	free(buffer);
+
+	FILE *file = tmpfile();
+	TEST_ASSERT_NOT_NULL(file);
+	json_pool_t *pool = json_pool_new(2);
+	TEST_EXPECT_EQ_U8(json_stringify_write(fileno(file), &object, true, pool), JSON_RETVAL_OK);
+	json_pool_free(pool);
+
+	char *expected_string = json_stringify_pretty(&object);
+	size_t expected_size = strlen(expected_string);
+	json_object_free(&object);
+	char *written = malloc(expected_size + 1);
+	rewind(file);
+	size_t written_size = fread(written, 1, expected_size + 1, file);
+	fclose(file);
+	TEST_EXPECT_EQ_U64(written_size, expected_size);
+	TEST_EXPECT(memcmp(written, expected_string, expected_size) == 0);
+	free(written);
+	free(expected_string);
+
+	TEST_EXPECT_EQ_U8(json_stringify_write(-1, &object, false, NULL), JSON_RETVAL_INVALID_PARAM);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
 int test_json_stringify() {
 	TEST_GROUP_REG(test_json_stringify);
 	TEST_REG(test_json_stringify, stringify_simple_key_value);
@@ -213,5 +343,8 @@ int test_json_stringify() {
 	TEST_REG(test_json_stringify, stringify_nested_pretty);
 	TEST_REG(test_json_stringify, stringify_array);
 	TEST_REG(test_json_stringify, stringify_array_pretty);
+	TEST_REG(test_json_stringify, stringify_numbers);
+	TEST_REG(test_json_stringify, stringify_parallel);
+	TEST_REG(test_json_stringify, stringify_write);
 	TESTS_RUN();
 }
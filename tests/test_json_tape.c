@@ -0,0 +1,152 @@
+#include <string.h>
+#include <stdlib.h>
+#include "test_json.h"
+#include "json.h"
+
+#define LOG_LEVEL    LOG_LEVEL_DEBUG
+#include "testlib.h"
+
+static bool test_tape_equal_value(const json_value_t* p_value, json_value_type_t type, json_tape_value_t tape_value);
+
+// Walks the tree and the tape side by side, members and entries must match in order
+static bool test_tape_equal_object(const json_object_t* p_object, json_tape_value_t tape_object) {
+	if (json_tape_value_get_type(tape_object) != JSON_VALUE_TYPE_OBJECT ||
+		json_tape_value_get_length(tape_object) != p_object->num_members) {
+		return false;
+	}
+	json_tape_iter_t iter = json_tape_iter_begin(tape_object);
+	json_tape_value_t tape_value;
+	const char* key = NULL;
+	for (uint32_t i = 0; i < p_object->num_members; i++) {
+		if (!json_tape_iter_next(&iter, &tape_value, &key) || strcmp(key, p_object->members[i].key) != 0 ||
+			!test_tape_equal_value(&p_object->members[i].value, p_object->members[i].type, tape_value)) {
+			return false;
+		}
+	}
+	return !json_tape_iter_next(&iter, &tape_value, &key);
+}
+
+static bool test_tape_equal_value(const json_value_t* p_value, json_value_type_t type, json_tape_value_t tape_value) {
+	if (json_tape_value_get_type(tape_value) != type) {
+		return false;
+	}
+	switch (type) {
+		case JSON_VALUE_TYPE_STRING:
+			return strcmp(json_tape_value_get_string(tape_value, NULL), p_value->string) == 0;
+		case JSON_VALUE_TYPE_NUMBER:
+			return json_tape_value_get_number(tape_value) == p_value->number;
+		case JSON_VALUE_TYPE_BOOLEAN:
+			return json_tape_value_get_boolean(tape_value) == p_value->boolean;
+		case JSON_VALUE_TYPE_ARRAY:
+			if (json_tape_value_get_length(tape_value) != p_value->array->length) {
+				return false;
+			}
+			for (uint32_t i = 0; i < p_value->array->length; i++) {
+				if (!test_tape_equal_value(json_value_get_array_member((json_value_t*) p_value, i),
+										   json_value_get_array_member_type(p_value, i),
+										   json_tape_value_get_array_member(tape_value, i))) {
+					return false;
+				}
+			}
+			return true;
+		case JSON_VALUE_TYPE_OBJECT:
+			return test_tape_equal_object(p_value->object, tape_value);
+		default:
+			return true;
+	}
+}
+
+TEST_DEF(test_json_tape, tape_parse) {
+	TEST_READ_FILE(buffer, "tests/files/complete.json");
+
+	json_object_t object;
+	json_tape_t tape;
+	TEST_ASSERT_EQ_U8(json_parse(buffer, buffer_size, &object), JSON_RETVAL_OK);
+	TEST_ASSERT_EQ_U8(json_parse_tape(buffer, buffer_size, &tape, NULL), JSON_RETVAL_OK);
+	bool equal = test_tape_equal_object(&object, json_tape_get_root(&tape));
+	json_object_free(&object);
+	TEST_EXPECT(equal);
+
+	json_tape_value_t glossary = json_tape_object_get_value(json_tape_get_root(&tape), "glossary");
+	TEST_EXPECT_EQ_STRING(json_tape_value_get_string(json_tape_object_get_value(glossary, "title"), NULL), "example glossary", 17);
+	TEST_EXPECT_EQ_U8(json_tape_value_get_type(json_tape_object_get_value(glossary, "missing")), JSON_VALUE_TYPE_UNDEFINED);
+	json_tape_free(&tape);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+TEST_DEF(test_json_tape, tape_nested) {
+	// Arrays of containers and empty containers, which the tree does not hold
+	const char* buffer = "{\"a\": [{\"x\": 1}, [2, [3]], [], {}], \"s\": \"q\\\"\\u0041\", \"e\": {}, \"n\": null}";
+	json_tape_t tape;
+	TEST_ASSERT_EQ_U8(json_parse_tape(buffer, strlen(buffer), &tape, NULL), JSON_RETVAL_OK);
+
+	json_tape_value_t root = json_tape_get_root(&tape);
+	json_tape_value_t array = json_tape_object_get_value(root, "a");
+	TEST_EXPECT_EQ_U32(json_tape_value_get_length(root), 4);
+	TEST_EXPECT_EQ_U32(json_tape_value_get_length(array), 4);
+	TEST_EXPECT_EQ_DOUBLE(json_tape_value_get_number(json_tape_object_get_value(json_tape_value_get_array_member(array, 0), "x")), 1.0);
+	json_tape_value_t inner = json_tape_value_get_array_member(json_tape_value_get_array_member(array, 1), 1);
+	TEST_EXPECT_EQ_DOUBLE(json_tape_value_get_number(json_tape_value_get_array_member(inner, 0)), 3.0);
+	TEST_EXPECT_EQ_U32(json_tape_value_get_length(json_tape_value_get_array_member(array, 2)), 0);
+	TEST_EXPECT_EQ_U8(json_tape_value_get_type(json_tape_value_get_array_member(array, 3)), JSON_VALUE_TYPE_OBJECT);
+	TEST_EXPECT_EQ_U8(json_tape_value_get_type(json_tape_value_get_array_member(array, 4)), JSON_VALUE_TYPE_UNDEFINED);
+
+	size_t length = 0;
+	const char* string = json_tape_value_get_string(json_tape_object_get_value(root, "s"), &length);
+	TEST_EXPECT_EQ_U64(length, 3);
+	TEST_EXPECT_EQ_STRING(string, "q\"A", 4);
+	TEST_EXPECT_EQ_U8(json_tape_value_get_type(json_tape_object_get_value(root, "n")), JSON_VALUE_TYPE_NULL);
+
+	json_tape_iter_t iter = json_tape_iter_begin(root);
+	const char* keys[] = {"a", "s", "e", "n"};
+	const char* key = NULL;
+	for (size_t i = 0; i < 4; i++) {
+		TEST_EXPECT(json_tape_iter_next(&iter, NULL, &key));
+		TEST_EXPECT_EQ_STRING(key, keys[i], 2);
+	}
+	TEST_EXPECT(!json_tape_iter_next(&iter, NULL, &key));
+	json_tape_free(&tape);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+TEST_DEF(test_json_tape, tape_errors) {
+	const char *buffers[] = {
+		"{\"key\": 1.}",
+		"{\"key\": tru}",
+		"{\"key\": \"a\\x\"}",
+		"{\"key\": \"value\"",
+		"{\"key\" \"value\"}",
+		"{\"key\": \"value\"} {",
+		"{\"key\": \"value\",}",
+		"{\"key\": [1 2]}",
+		"[1]",
+		"",
+	};
+
+	// Documents the tree accepts fail with the same error
+	for (size_t i = 0; i < sizeof(buffers) / sizeof(buffers[0]); i++) {
+		json_object_t object;
+		json_tape_t tape;
+		json_error_t expected_error = {0}, error = {0};
+		json_ret_code_t expected_ret = json_parse_ex(buffers[i], strlen(buffers[i]), &object, &expected_error);
+		json_object_free(&object);
+		json_ret_code_t ret = json_parse_tape(buffers[i], strlen(buffers[i]), &tape, &error);
+		if (ret != expected_ret || error.code != expected_error.code || error.offset != expected_error.offset) {
+			TEST_FAIL_WITH_MSG("Buffer %lu: got %u/%u at %lu, expected %u/%u at %lu", i, ret, error.code, error.offset,
+							   expected_ret, expected_error.code, expected_error.offset);
+		}
+		TEST_EXPECT(tape.words == NULL);
+	}
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+int test_json_tape() {
+	TEST_GROUP_REG(test_json_tape);
+	TEST_REG(test_json_tape, tape_parse);
+	TEST_REG(test_json_tape, tape_nested);
+	TEST_REG(test_json_tape, tape_errors);
+	TESTS_RUN();
+}
@@ -0,0 +1,118 @@
+#include <string.h>
+#include "test_json.h"
+#include "json.h"
+
+#define LOG_LEVEL    LOG_LEVEL_DEBUG
+#include "testlib.h"
+
+TEST_DEF(test_json_validate, validate_complete) {
+	TEST_READ_FILE(buffer, "tests/files/complete.json");
+
+	json_error_t error;
+	TEST_EXPECT_EQ_U8(json_validate(buffer, buffer_size, &error), JSON_RETVAL_OK);
+	TEST_EXPECT_EQ_U8(error.code, JSON_ERROR_NONE);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+TEST_DEF(test_json_validate, validate_valid) {
+	const char *buffers[] = {
+		"{}",
+		"[]",
+		" {\"key\" : [1, -2.5e+3, 0.1, true, false, null, \"value\"]} ",
+		"{\"key\": {\"key2\": [[], [{}], {\"a\": [1]}]}}",
+		"\"string with \\\"escapes\\\" \\u00e4\\n\"",
+		"-0",
+		"null",
+	};
+
+	for (size_t i = 0; i < sizeof(buffers) / sizeof(buffers[0]); i++) {
+		json_error_t error;
+		json_ret_code_t ret = json_validate(buffers[i], strlen(buffers[i]), &error);
+		if (ret != JSON_RETVAL_OK) {
+			TEST_FAIL_WITH_MSG("Expected \"%s\" to be valid, got error %u at %lu", buffers[i], error.code, error.offset);
+		}
+	}
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+TEST_DEF(test_json_validate, validate_invalid) {
+	struct {
+		const char *buffer;
+		json_error_code_t code;
+		uint64_t offset;
+	} cases[] = {
+		{"", JSON_ERROR_UNEXPECTED_EOF, 0},
+		{"{\"key\":\"value\"", JSON_ERROR_UNEXPECTED_EOF, 14},
+		{"{\"key\"::\"value\"}", JSON_ERROR_UNEXPECTED_TOKEN, 7},
+		{",{\"key\":\"value\"}", JSON_ERROR_UNEXPECTED_TOKEN, 0},
+		{"{\"key\":1 2 3}", JSON_ERROR_UNEXPECTED_TOKEN, 9},
+		{"{1: \"value\"}", JSON_ERROR_UNEXPECTED_TOKEN, 1},
+		{"{\"key\":\"value\"}\"garbage\"", JSON_ERROR_UNEXPECTED_TOKEN, 15},
+		{"{\"key\": 1.}", JSON_ERROR_EXPECTED_DIGIT, 10},
+		{"{\"key\": \"a\\u123x\"}", JSON_ERROR_INVALID_UNICODE_CHAR, 15},
+		{"{\"key\": \"a\\x\"}", JSON_ERROR_ILLEGAL_ESCAPE_SEQUENCE, 11},
+		{"{\"key\": \"a\nb\"}", JSON_ERROR_CONTROL_CHAR, 10},
+		{"{\"key\": invalidValue}", JSON_ERROR_UNEXPECTED_TOKEN, 8},
+		{"{\"key\": tru}", JSON_ERROR_UNEXPECTED_TOKEN, 11},
+		{"[1, 2}", JSON_ERROR_UNEXPECTED_TOKEN, 5},
+		{"{\"key\": 1,}", JSON_ERROR_UNEXPECTED_TOKEN, 10},
+	};
+
+	for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+		json_error_t error;
+		json_ret_code_t ret = json_validate(cases[i].buffer, strlen(cases[i].buffer), &error);
+		TEST_EXPECT_TRUE(ret != JSON_RETVAL_OK);
+		if (error.code != cases[i].code || error.offset != cases[i].offset) {
+			TEST_ERROR_WITH_MSG("\"%s\": expected error %u at %lu, got %u at %lu", cases[i].buffer,
+								cases[i].code, cases[i].offset, error.code, error.offset);
+		}
+	}
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+TEST_DEF(test_json_validate, validate_max_nesting) {
+	char buffer[2048];
+	memset(buffer, '[', sizeof(buffer));
+
+	json_error_t error;
+	TEST_EXPECT_EQ_U8(json_validate(buffer, sizeof(buffer), &error), JSON_RETVAL_FAIL);
+	TEST_EXPECT_EQ_U8(error.code, JSON_ERROR_MAX_NESTING_LEVEL);
+	TEST_EXPECT_EQ_U8(json_validate(buffer, sizeof(buffer), NULL), JSON_RETVAL_FAIL);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+TEST_DEF(test_json_validate, validate_error_position) {
+	const size_t num_lines = 70000;
+	char *buffer = malloc(num_lines + 16);
+	TEST_ASSERT_NOT_NULL(buffer);
+	g_current_test.allocated_memory[g_current_test.allocated_memory_count++] = buffer;
+	buffer[0] = '{';
+	memset(&buffer[1], '\n', num_lines);
+	strcpy(&buffer[num_lines + 1], "  \"key\" 1}");
+	size_t buffer_size = strlen(buffer);
+
+	json_error_t error;
+	TEST_EXPECT_EQ_U8(json_validate(buffer, buffer_size, &error), JSON_RETVAL_FAIL);
+	TEST_EXPECT_EQ_U64(error.offset, num_lines + 9);
+
+	uint64_t line, column;
+	json_error_get_position(buffer, buffer_size, &error, &line, &column);
+	TEST_EXPECT_EQ_U64(line, num_lines + 1);
+	TEST_EXPECT_EQ_U64(column, 9);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+int test_json_validate() {
+	TEST_GROUP_REG(test_json_validate);
+	TEST_REG(test_json_validate, validate_complete);
+	TEST_REG(test_json_validate, validate_valid);
+	TEST_REG(test_json_validate, validate_invalid);
+	TEST_REG(test_json_validate, validate_max_nesting);
+	TEST_REG(test_json_validate, validate_error_position);
+	TESTS_RUN();
+}
@@ -0,0 +1,245 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "test_json.h"
+#include "json.h"
+
+#define LOG_LEVEL    LOG_LEVEL_DEBUG
+#include "testlib.h"
+
+typedef struct {
+	char* string;
+	size_t length;
+	size_t num_writes;
+} test_writer_sink_t;
+
+static json_ret_code_t test_writer_sink(const char* p_data, size_t length, void* p_context) {
+	test_writer_sink_t* p_sink = p_context;
+	char* string = realloc(p_sink->string, p_sink->length + length + 1);
+	if (string == NULL) {
+		return JSON_RETVAL_FAIL;
+	}
+	memcpy(&string[p_sink->length], p_data, length);
+	p_sink->string = string;
+	p_sink->length += length;
+	p_sink->string[p_sink->length] = '\0';
+	p_sink->num_writes++;
+	return JSON_RETVAL_OK;
+}
+
+static json_ret_code_t test_writer_fail_sink(const char* p_data, size_t length, void* p_context) {
+	(void) p_data;
+	(void) length;
+	(void) p_context;
+	return JSON_RETVAL_FAIL;
+}
+
+TEST_DEF(test_json_writer, writer_output) {
+	json_writer_t* p_writer = json_writer_new(NULL, NULL);
+	TEST_ASSERT_NOT_NULL(p_writer);
+	size_t length;
+	TEST_EXPECT_EQ_STRING(json_writer_get_output(p_writer, &length), "", 1);
+	TEST_EXPECT_EQ_U64(length, 0);
+
+	TEST_EXPECT_EQ_U8(json_writer_begin_object(p_writer), JSON_RETVAL_OK);
+	json_writer_key(p_writer, "id");
+	json_writer_int(p_writer, -9223372036854775807ll - 1);
+	json_writer_key(p_writer, "name");
+	json_writer_string(p_writer, "a \"quoted\"\\ line\n\ttab\x01");
+	json_writer_key(p_writer, "ke\"y");
+	json_writer_string_length(p_writer, "abcdef", 3);
+	json_writer_key(p_writer, "numbers");
+	json_writer_begin_array(p_writer);
+	json_writer_double(p_writer, 0.1);
+	json_writer_double(p_writer, 1e300);
+	json_writer_double(p_writer, -2);
+	json_writer_double(p_writer, 1.0 / 0.0);
+	json_writer_int(p_writer, 0);
+	json_writer_end_array(p_writer);
+	json_writer_key(p_writer, "empty");
+	json_writer_begin_object(p_writer);
+	json_writer_end_object(p_writer);
+	json_writer_key(p_writer, "nested");
+	json_writer_begin_array(p_writer);
+	json_writer_begin_array(p_writer);
+	json_writer_end_array(p_writer);
+	json_writer_begin_object(p_writer);
+	json_writer_key(p_writer, "ok");
+	json_writer_bool(p_writer, true);
+	json_writer_key(p_writer, "no");
+	json_writer_bool(p_writer, false);
+	json_writer_end_object(p_writer);
+	json_writer_null(p_writer);
+	json_writer_end_array(p_writer);
+	TEST_EXPECT_EQ_U8(json_writer_end_object(p_writer), JSON_RETVAL_OK);
+	TEST_EXPECT_EQ_U8(json_writer_finish(p_writer), JSON_RETVAL_OK);
+
+	const char* expect = "{\"id\":-9223372036854775808,\"name\":\"a \\\"quoted\\\"\\\\ line\\n\\ttab\\u0001\",\"ke\\\"y\":\"abc\","
+						 "\"numbers\":[0.1,1e+300,-2,null,0],\"empty\":{},\"nested\":[[],{\"ok\":true,\"no\":false},null]}";
+	const char* output = json_writer_get_output(p_writer, &length);
+	TEST_EXPECT_EQ_STRING(output, expect, strlen(expect) + 1);
+	TEST_EXPECT_EQ_U64(length, strlen(expect));
+
+	// Reused for the next document, scalars are documents too
+	json_writer_reset(p_writer);
+	json_writer_string(p_writer, "top");
+	TEST_EXPECT_EQ_U8(json_writer_finish(p_writer), JSON_RETVAL_OK);
+	TEST_EXPECT_EQ_STRING(json_writer_get_output(p_writer, NULL), "\"top\"", 6);
+
+	// Doubles read back as the same value
+	const double numbers[] = {0.3, 0.1 + 0.2, 1.5e-7, 123.456, -0.001, 1.0 / 3, 5e-324, 1.7976931348623157e308, -4503599627370495.5};
+	for (size_t i = 0; i < sizeof(numbers) / sizeof(numbers[0]); i++) {
+		json_writer_reset(p_writer);
+		json_writer_double(p_writer, numbers[i]);
+		TEST_EXPECT_EQ_DOUBLE(strtod(json_writer_get_output(p_writer, NULL), NULL), numbers[i]);
+	}
+	json_writer_reset(p_writer);
+	json_writer_double(p_writer, 123.456);
+	TEST_EXPECT_EQ_STRING(json_writer_get_output(p_writer, NULL), "123.456", 8);
+
+	// Doubles are written like the shortest of %.15g and %.17g that reads back, without trailing zeros
+	const double exact_numbers[] = {513.926, -2056.05, 39.3584, 75.5422, 0.5, -1234.5678, 1e-4, 99999999999999.9};
+	const char* exact_strings[] = {"513.926", "-2056.05", "39.3584", "75.5422", "0.5", "-1234.5678", "0.0001", "99999999999999.9"};
+	for (size_t i = 0; i < sizeof(exact_numbers) / sizeof(exact_numbers[0]); i++) {
+		json_writer_reset(p_writer);
+		json_writer_double(p_writer, exact_numbers[i]);
+		TEST_EXPECT_EQ_STRING(json_writer_get_output(p_writer, NULL), exact_strings[i], strlen(exact_strings[i]) + 1);
+	}
+	size_t num_different = 0;
+	uint64_t seed = 0x9e3779b97f4a7c15ull;
+	for (size_t i = 0; i < 100000; i++) {
+		seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+		static const double powers[] = {1, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7};
+		double number = (double) ((seed >> 33) % 100000000) / powers[(seed >> 8) % 8] * ((seed >> 16) & 1 ? -1 : 1);
+		char expected[32];
+		snprintf(expected, sizeof(expected), "%.15g", number);
+		if (strtod(expected, NULL) != number) {
+			snprintf(expected, sizeof(expected), "%.17g", number);
+		}
+		json_writer_reset(p_writer);
+		json_writer_double(p_writer, number);
+		num_different += strcmp(json_writer_get_output(p_writer, NULL), expected) != 0;
+	}
+	TEST_EXPECT_EQ_U64(num_different, 0);
+
+	json_writer_free(p_writer);
+	TEST_EXPECT(json_writer_get_output(NULL, NULL) == NULL);
+	TEST_EXPECT_EQ_U8(json_writer_int(NULL, 1), JSON_RETVAL_INVALID_PARAM);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+TEST_DEF(test_json_writer, writer_sink) {
+	test_writer_sink_t sink = {0};
+	json_writer_t* p_writer = json_writer_new(test_writer_sink, &sink);
+	TEST_ASSERT_NOT_NULL(p_writer);
+
+	// Larger than the writer buffer, handed over in several writes and readable by the parser
+	char key[16];
+	char* long_string = malloc(10000);
+	TEST_ASSERT_NOT_NULL(long_string);
+	memset(long_string, 'x', 9999);
+	long_string[9999] = '\0';
+	json_writer_begin_object(p_writer);
+	for (int i = 0; i < 500; i++) {
+		sprintf(key, "k%d", i);
+		json_writer_key(p_writer, key);
+		json_writer_double(p_writer, i + 0.5);
+	}
+	json_writer_key(p_writer, "long");
+	json_writer_string(p_writer, long_string);
+	json_writer_end_object(p_writer);
+	TEST_EXPECT(json_writer_get_output(p_writer, NULL) == NULL);
+	TEST_EXPECT_EQ_U8(json_writer_finish(p_writer), JSON_RETVAL_OK);
+	TEST_EXPECT(sink.num_writes > 2);
+
+	json_object_t object;
+	TEST_ASSERT_EQ_U8(json_parse(sink.string, sink.length, &object), JSON_RETVAL_OK);
+	TEST_EXPECT_EQ_U32(object.num_members, 501);
+	TEST_EXPECT_EQ_DOUBLE(json_object_get_value(&object, "k499")->number, 499.5);
+	TEST_EXPECT_EQ_U64(strlen(json_object_get_value(&object, "long")->string), 9999);
+	json_object_free(&object);
+	json_writer_free(p_writer);
+	free(long_string);
+	free(sink.string);
+
+	// A failing sink stops the writer, the failure is returned by every later call
+	p_writer = json_writer_new(test_writer_fail_sink, NULL);
+	TEST_ASSERT_NOT_NULL(p_writer);
+	json_ret_code_t ret = JSON_RETVAL_OK;
+	json_writer_begin_array(p_writer);
+	for (int i = 0; i < 10000 && ret == JSON_RETVAL_OK; i++) {
+		ret = json_writer_int(p_writer, i);
+	}
+	TEST_EXPECT_EQ_U8(ret, JSON_RETVAL_FAIL);
+	TEST_EXPECT_EQ_U8(json_writer_end_array(p_writer), JSON_RETVAL_FAIL);
+	TEST_EXPECT_EQ_U8(json_writer_finish(p_writer), JSON_RETVAL_FAIL);
+	json_writer_free(p_writer);
+
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+TEST_DEF(test_json_writer, writer_nesting) {
+#ifndef NDEBUG
+	json_writer_t* p_writer = json_writer_new(NULL, NULL);
+	TEST_ASSERT_NOT_NULL(p_writer);
+
+	// Every misuse fails the writer until it is reset
+	json_writer_begin_object(p_writer);
+	TEST_EXPECT_EQ_U8(json_writer_int(p_writer, 1), JSON_RETVAL_ILLEGAL);
+	TEST_EXPECT_EQ_U8(json_writer_key(p_writer, "a"), JSON_RETVAL_ILLEGAL);
+	json_writer_reset(p_writer);
+
+	json_writer_begin_object(p_writer);
+	json_writer_key(p_writer, "a");
+	TEST_EXPECT_EQ_U8(json_writer_key(p_writer, "b"), JSON_RETVAL_ILLEGAL);
+	json_writer_reset(p_writer);
+
+	json_writer_begin_object(p_writer);
+	json_writer_key(p_writer, "a");
+	TEST_EXPECT_EQ_U8(json_writer_end_object(p_writer), JSON_RETVAL_ILLEGAL);
+	json_writer_reset(p_writer);
+
+	json_writer_begin_array(p_writer);
+	TEST_EXPECT_EQ_U8(json_writer_key(p_writer, "a"), JSON_RETVAL_ILLEGAL);
+	json_writer_reset(p_writer);
+
+	json_writer_begin_array(p_writer);
+	TEST_EXPECT_EQ_U8(json_writer_end_object(p_writer), JSON_RETVAL_ILLEGAL);
+	json_writer_reset(p_writer);
+
+	TEST_EXPECT_EQ_U8(json_writer_end_array(p_writer), JSON_RETVAL_ILLEGAL);
+	json_writer_reset(p_writer);
+
+	json_writer_null(p_writer);
+	TEST_EXPECT_EQ_U8(json_writer_null(p_writer), JSON_RETVAL_ILLEGAL);
+	json_writer_reset(p_writer);
+
+	// Incomplete documents
+	TEST_EXPECT_EQ_U8(json_writer_finish(p_writer), JSON_RETVAL_ILLEGAL);
+	json_writer_reset(p_writer);
+	json_writer_begin_object(p_writer);
+	TEST_EXPECT_EQ_U8(json_writer_finish(p_writer), JSON_RETVAL_ILLEGAL);
+	json_writer_reset(p_writer);
+
+	// Deeply nested arrays are fine up to the nesting limit
+	json_ret_code_t ret = JSON_RETVAL_OK;
+	int depth = 0;
+	for (; depth < 2000 && ret == JSON_RETVAL_OK; depth++) {
+		ret = json_writer_begin_array(p_writer);
+	}
+	TEST_EXPECT_EQ_U8(ret, JSON_RETVAL_ILLEGAL);
+	TEST_EXPECT_EQ_I32(depth, 1001);
+
+	json_writer_free(p_writer);
+#endif
+	TEST_CLEAN_UP_AND_RETURN(0);
+}
+
+int test_json_writer() {
+	TEST_GROUP_REG(test_json_writer);
+	TEST_REG(test_json_writer, writer_output);
+	TEST_REG(test_json_writer, writer_sink);
+	TEST_REG(test_json_writer, writer_nesting);
+	TESTS_RUN();
+}